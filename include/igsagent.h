@@ -140,6 +140,8 @@ INGESCAPE_EXPORT double igsagent_output_double (igsagent_t *self, const char *na
 INGESCAPE_EXPORT char * igsagent_output_string (igsagent_t *self, const char *name);//caller owns returned value
 INGESCAPE_EXPORT igs_result_t igsagent_output_data (igsagent_t *self, const char *name, void **data, size_t *size);
 
+INGESCAPE_EXPORT igs_io_handle_t * igsagent_input_handle (igsagent_t *self, const char *name);
+
 INGESCAPE_EXPORT igs_result_t igsagent_input_set_bool (igsagent_t *self, const char *name, bool value);
 INGESCAPE_EXPORT igs_result_t igsagent_input_set_int (igsagent_t *self, const char *name, int value);
 INGESCAPE_EXPORT igs_result_t igsagent_input_set_double (igsagent_t *self, const char *name, double value);
@@ -153,6 +155,9 @@ INGESCAPE_EXPORT igs_result_t igsagent_output_set_double (igsagent_t *self, cons
 INGESCAPE_EXPORT igs_result_t igsagent_output_set_string (igsagent_t *self, const char *name, const char *value);
 INGESCAPE_EXPORT igs_result_t igsagent_output_set_impulsion (igsagent_t *self, const char *name);
 INGESCAPE_EXPORT igs_result_t igsagent_output_set_data (igsagent_t *self, const char *name, void *value, size_t size);
+INGESCAPE_EXPORT igs_result_t igsagent_output_set_data_owned (igsagent_t *self, const char *name, void *data, size_t size,
+                                                              igs_data_free_fn *free_fn, void *hint);
+INGESCAPE_EXPORT igs_data_t * igsagent_input_data_ref (igsagent_t *self, const char *name);
 
 INGESCAPE_EXPORT void igsagent_constraints_enforce(igsagent_t *self, bool enforce); //default is false, i.e. disabled
 INGESCAPE_EXPORT igs_result_t igsagent_input_add_constraint(igsagent_t *self, const char *name, const char *constraint);
@@ -195,6 +200,9 @@ INGESCAPE_EXPORT void igsagent_output_mute (igsagent_t *self, const char *name);
 INGESCAPE_EXPORT void igsagent_output_unmute (igsagent_t *self, const char *name);
 INGESCAPE_EXPORT bool igsagent_output_is_muted (igsagent_t *self, const char *name);
 
+INGESCAPE_EXPORT igs_result_t igsagent_input_set_conflated (igsagent_t *self, const char *name, bool conflated);
+INGESCAPE_EXPORT bool igsagent_input_is_conflated (igsagent_t *self, const char *name);
+
 // Services edition & inspection
 INGESCAPE_EXPORT igs_result_t igsagent_service_call (igsagent_t *self,
                                                      const char *agent_name_or_uuid,
@@ -202,6 +210,25 @@ INGESCAPE_EXPORT igs_result_t igsagent_service_call (igsagent_t *self,
                                                      igs_service_arg_t **list,
                                                      const char *token);
 
+//see igs_service_call_async in ingescape.h
+typedef void (igsagent_service_reply_fn) (igsagent_t *agent,
+                                          const char *replier_agent_name,
+                                          const char *replier_agent_uuid,
+                                          const char *reply_name,
+                                          igs_service_arg_t *first_argument,
+                                          size_t args_nbr,
+                                          const char *token,
+                                          igs_service_call_status_t status,
+                                          void *data);
+INGESCAPE_EXPORT char * igsagent_service_call_async (igsagent_t *self,
+                                                     const char *agent_name_or_uuid,
+                                                     const char *service_name,
+                                                     igs_service_arg_t **list,
+                                                     unsigned int timeout_ms,
+                                                     igsagent_service_reply_fn cb,
+                                                     void *data); //caller owns returned token
+INGESCAPE_EXPORT igs_result_t igsagent_service_call_cancel (igsagent_t *self, const char *token);
+
 typedef void (igsagent_service_fn) (igsagent_t *agent,
                                     const char *sender_agent_name,
                                     const char *sender_agent_uuid,
@@ -305,6 +332,16 @@ INGESCAPE_EXPORT igs_result_t igsagent_split_remove_with_name (igsagent_t *self,
                                                                const char *from_our_input,
                                                                const char *to_agent,
                                                                const char *with_output);
+INGESCAPE_EXPORT igs_result_t igsagent_split_set_credit (igsagent_t *self, uint64_t id, int credit);
+INGESCAPE_EXPORT igs_result_t igsagent_output_split_balanced (igsagent_t *self, const char *name);
+INGESCAPE_EXPORT igs_result_t igsagent_output_split_by_json_field (igsagent_t *self, const char *name, const char *field_path);
+INGESCAPE_EXPORT igs_result_t igsagent_output_split_by_data_range (igsagent_t *self, const char *name, size_t offset, size_t size);
+INGESCAPE_EXPORT igs_result_t igsagent_output_split_by_key (igsagent_t *self, const char *name, const char *key);
+INGESCAPE_EXPORT igs_split_mode_t igsagent_output_split_mode (igsagent_t *self, const char *name);
+INGESCAPE_EXPORT igs_result_t igsagent_output_set_split_queue (igsagent_t *self, const char *name, size_t capacity,
+                                                               igs_split_queue_policy_t policy);
+INGESCAPE_EXPORT igs_result_t igsagent_output_split_queue_stats (igsagent_t *self, const char *name,
+                                                                 igs_split_queue_stats_t *stats);
 
 INGESCAPE_EXPORT bool igsagent_mapping_outputs_request (igsagent_t *self);
 INGESCAPE_EXPORT void igsagent_mapping_set_outputs_request (igsagent_t *self, bool notify);
@@ -323,6 +360,10 @@ INGESCAPE_EXPORT void igsagent_rt_set_timestamps(igsagent_t *agent, bool enable)
 INGESCAPE_EXPORT bool igsagent_rt_timestamps(igsagent_t *agent);
 INGESCAPE_EXPORT void igsagent_rt_set_synchronous_mode(igsagent_t *agent, bool enable);
 INGESCAPE_EXPORT bool igsagent_rt_synchronous_mode(igsagent_t *agent);
+INGESCAPE_EXPORT void igsagent_rt_set_keyframe_interval(igsagent_t *agent, unsigned int ticks);
+INGESCAPE_EXPORT unsigned int igsagent_rt_keyframe_interval(igsagent_t *agent);
+INGESCAPE_EXPORT void igsagent_output_batch_begin(igsagent_t *agent);
+INGESCAPE_EXPORT igs_result_t igsagent_output_batch_commit(igsagent_t *agent);
 
 ///////////////////////////////////////////////////////
 // Administration, logging, configuration and utilities
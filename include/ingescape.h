@@ -303,6 +303,24 @@ INGESCAPE_EXPORT double igs_output_double(const char *name);
 INGESCAPE_EXPORT char * igs_output_string(const char *name); //caller owns returned value
 INGESCAPE_EXPORT igs_result_t igs_output_data(const char *name, void **data, size_t *size); //caller owns returned value
 
+/* Lock-free reads of scalar inputs
+ A handle gives access to the current value of an input without locking
+ the agent model and without looking the input up by name, which suits
+ high-frequency loops reading many inputs. Handles are owned by the agent
+ and remain valid until the agent is destroyed. They follow their input
+ when it is removed and created again or when the definition is reloaded:
+ while the input does not exist, igs_io_handle_type returns IGS_UNKNOWN_T.
+ Bool, integer and double inputs are supported, with the same implicit
+ conversions as igs_input_bool/int/double. Other value types read as
+ false or 0.
+ */
+typedef struct _igs_io_handle_t igs_io_handle_t;
+INGESCAPE_EXPORT igs_io_handle_t * igs_input_handle(const char *name); //NULL if input does not exist
+INGESCAPE_EXPORT igs_io_value_type_t igs_io_handle_type(igs_io_handle_t *handle);
+INGESCAPE_EXPORT bool igs_io_handle_bool(igs_io_handle_t *handle);
+INGESCAPE_EXPORT int igs_io_handle_int(igs_io_handle_t *handle);
+INGESCAPE_EXPORT double igs_io_handle_double(igs_io_handle_t *handle);
+
 //write IOs per value type
 INGESCAPE_EXPORT igs_result_t igs_input_set_bool(const char *name, bool value);
 INGESCAPE_EXPORT igs_result_t igs_input_set_int(const char *name, int value);
@@ -318,6 +336,30 @@ INGESCAPE_EXPORT igs_result_t igs_output_set_string(const char *name, const char
 INGESCAPE_EXPORT igs_result_t igs_output_set_impulsion(const char *name);
 INGESCAPE_EXPORT igs_result_t igs_output_set_data(const char *name, void *value, size_t size);
 
+/* Zero-copy data on IOs
+ igs_data_t is an immutable, reference-counted data buffer, which avoids
+ copying large payloads (images, point clouds, etc.) between our code,
+ our IOs and the network.
+ igs_output_set_data_owned transfers the ownership of data to the output:
+ data shall not be modified afterwards and free_fn (optional) is called
+ with data and hint when neither the output nor the pending network
+ publications need it anymore. NB: free_fn may be called from a ZeroMQ
+ I/O thread. If the function fails, data remains owned by the caller.
+ igs_input_data_ref gives a reference on the current value of a data input
+ without copying it. The value remains valid, even if the input is written
+ again, until the reference is released with igs_data_unref. Returns NULL if
+ the input is not a data input or has no value.
+ */
+typedef struct _igs_data_t igs_data_t;
+typedef void (igs_data_free_fn)(void *data, void *hint);
+INGESCAPE_EXPORT igs_result_t igs_output_set_data_owned(const char *name, void *data, size_t size,
+                                                        igs_data_free_fn *free_fn, void *hint);
+INGESCAPE_EXPORT igs_data_t * igs_input_data_ref(const char *name); //release with igs_data_unref
+INGESCAPE_EXPORT const void * igs_data_bytes(igs_data_t *data);
+INGESCAPE_EXPORT size_t igs_data_size(igs_data_t *data);
+INGESCAPE_EXPORT igs_data_t * igs_data_ref(igs_data_t *data);
+INGESCAPE_EXPORT void igs_data_unref(igs_data_t **data);
+
 /*Constraints on IOs
  Constraints enable verifications upon sending or receiving information
  with inputs and outputs. The syntax for the constraints is global but
@@ -397,6 +439,14 @@ INGESCAPE_EXPORT void igs_output_mute(const char *name);
 INGESCAPE_EXPORT void igs_output_unmute(const char *name);
 INGESCAPE_EXPORT bool igs_output_is_muted(const char *name);
 
+/*conflate an input
+ Publications received for a conflated input and waiting to be handled are
+ coalesced : only the most recent one is written to the input and triggers its
+ callbacks. This is useful for high-rate streams when only the latest value
+ matters and the consumer is slower than the producer.*/
+INGESCAPE_EXPORT igs_result_t igs_input_set_conflated(const char *name, bool conflated);
+INGESCAPE_EXPORT bool igs_input_is_conflated(const char *name);
+
 
 /* Services edition & inspection
  - one and only one mandatory callback per service, set using igs_service_init :
@@ -444,6 +494,40 @@ INGESCAPE_EXPORT igs_result_t igs_service_call(const char *agent_name_or_uuid,
                                                igs_service_arg_t **list,
                                                const char *token);
 
+/*call a service asynchronously and get notified of its reply
+ The returned token is generated by ingescape and passed to the called service. The called agent
+ replies by calling back a service on the caller with this same token, e.g. from its service callback:
+    igs_service_call(sender_agent_uuid, "my_reply", &reply_args, token);
+ The first reply carrying the token completes the call and triggers the callback. Reply arguments
+ are typed using the reply declared in the called agent definition (see igs_service_reply_add)
+ or passed as IGS_DATA_T otherwise.
+ If no reply arrives within timeout_ms (0 means no timeout), the callback is triggered with
+ IGS_SERVICE_CALL_TIMED_OUT. Deadlines are checked by the ingescape loop every few milliseconds.
+ Any number of calls may be pending at the same time, including to the same agent.
+ Passed arguments list will be deallocated and destroyed by the call.
+ Returns NULL if the call could not be made. Caller owns the returned token. */
+typedef enum {
+    IGS_SERVICE_CALL_REPLIED = 0,
+    IGS_SERVICE_CALL_TIMED_OUT,
+    IGS_SERVICE_CALL_CANCELED
+} igs_service_call_status_t;
+typedef void (igs_service_reply_fn)(const char *replier_agent_name, //NULL if not replied
+                                    const char *replier_agent_uuid, //NULL if not replied
+                                    const char *reply_name, //NULL if not replied
+                                    igs_service_arg_t *first_argument,
+                                    size_t args_nbr,
+                                    const char *token,
+                                    igs_service_call_status_t status,
+                                    void *my_data);
+INGESCAPE_EXPORT char * igs_service_call_async(const char *agent_name_or_uuid,
+                                               const char *service_name,
+                                               igs_service_arg_t **list,
+                                               unsigned int timeout_ms,
+                                               igs_service_reply_fn cb,
+                                               void *my_data);
+//triggers the callback with IGS_SERVICE_CALL_CANCELED if the call is still pending
+INGESCAPE_EXPORT igs_result_t igs_service_call_cancel(const char *token);
+
 /*create /remove / edit a service offered by our agent
  WARNING: only one callback shall be attached to a service
  (further attempts will be ignored and signaled by an error log).*/
@@ -565,6 +649,60 @@ INGESCAPE_EXPORT igs_result_t igs_split_remove_with_id(uint64_t the_id);
 INGESCAPE_EXPORT igs_result_t igs_split_remove_with_name(const char *from_our_input,
                                                          const char *to_agent,
                                                          const char *with_output);
+/*Our inputs receive the works of a split in advance, up to the number of
+ credits we grant to the splitting agent. By default, this credit window
+ sizes itself from the measured round trip with the splitting agent and
+ our processing time for each work. A positive credit sets a fixed window.*/
+INGESCAPE_EXPORT igs_result_t igs_split_set_credit(uint64_t the_id, int credit); //0 for adaptive window
+/*Works of a split output go to any worker with credits by default.
+ Keyed splits send the works sharing the same key to the same worker, so
+ that workers may keep a state for each key (e.g. a track or a session).
+ Keys are read from a field of a JSON string output, given as a path
+ separated by slashes (e.g. "track/id"), from a byte range of a data
+ output, or set explicitly for the next writes of the output. When workers
+ join or leave, only a fair share of the keys moves to other workers.
+ Works without a usable key are balanced between workers.*/
+typedef enum {
+    IGS_SPLIT_BALANCED = 0,
+    IGS_SPLIT_BY_JSON_FIELD,
+    IGS_SPLIT_BY_DATA_RANGE,
+    IGS_SPLIT_BY_KEY
+} igs_split_mode_t;
+INGESCAPE_EXPORT igs_result_t igs_output_split_balanced(const char *name);
+INGESCAPE_EXPORT igs_result_t igs_output_split_by_json_field(const char *name, const char *field_path);
+INGESCAPE_EXPORT igs_result_t igs_output_split_by_data_range(const char *name, size_t offset, size_t size);
+INGESCAPE_EXPORT igs_result_t igs_output_split_by_key(const char *name, const char *key); //key of the next writes
+INGESCAPE_EXPORT igs_split_mode_t igs_output_split_mode(const char *name);
+/*Works of a split output wait for workers with credits in a queue bounded
+ to 4096 works by default. When the queue is full, the policy below decides
+ what happens to a new work:
+ - IGS_SPLIT_QUEUE_DROP_OLDEST (default) : the oldest work waiting for the
+ same worker, or for any worker when the work has no key, is dropped.
+ - IGS_SPLIT_QUEUE_DROP_NEWEST : the new work is dropped.
+ - IGS_SPLIT_QUEUE_CONFLATE : the new work replaces the most recent waiting
+ work with the same key, or the oldest one when there is none.
+ - IGS_SPLIT_QUEUE_BLOCK : the publishing thread waits for room in the
+ queue. Publications made by callbacks running in the ingescape loop, and
+ outputs published by batches, are conflated instead.
+ Works still waiting when the last worker of an output leaves are dropped.*/
+typedef enum {
+    IGS_SPLIT_QUEUE_DROP_OLDEST = 0,
+    IGS_SPLIT_QUEUE_DROP_NEWEST,
+    IGS_SPLIT_QUEUE_CONFLATE,
+    IGS_SPLIT_QUEUE_BLOCK
+} igs_split_queue_policy_t;
+typedef struct {
+    size_t enqueued; //works written on the output while it had workers
+    size_t dispatched; //works sent to workers
+    size_t dropped;
+    size_t conflated;
+    size_t blocked; //IGS_SPLIT_QUEUE_BLOCK, publications that had to wait
+    size_t pending; //works currently waiting for workers
+    size_t max_pending;
+} igs_split_queue_stats_t;
+INGESCAPE_EXPORT igs_result_t igs_output_set_split_queue(const char *name, size_t capacity,
+                                                         igs_split_queue_policy_t policy); //0 for default capacity
+INGESCAPE_EXPORT igs_result_t igs_output_split_queue_stats(const char *name, igs_split_queue_stats_t *stats);
 
 /*When mapping other agents' outputs, it is possible to ask the mapped
  agents to send us their current output values through a dedicated
@@ -621,6 +759,20 @@ INGESCAPE_EXPORT igs_result_t igs_channel_whisper_str(const char *agent_name_or_
 INGESCAPE_EXPORT igs_result_t igs_channel_whisper_data(const char *agent_name_or_agent_id_or_peer_id, void *data, size_t size);
 INGESCAPE_EXPORT igs_result_t igs_channel_whisper_zmsg(const char *agent_name_or_agent_id_or_peer_id, zmsg_t **msg_p); //destroys message after sending it
 
+/*Private commands are whispered messages whose first frame is a command name
+ registered by the application. They are dispatched by ingescape alongside its
+ own protocol commands instead of being left to igs_observe_channels callbacks.
+ The callback runs in the ingescape thread and receives the message without its
+ command frame: it may take ownership of it by setting *msg_p to NULL.
+ NB: commands of the ingescape protocol cannot be registered.*/
+typedef void (igs_private_command_fn) (const char *peer_id,
+                                       const char *peer_name,
+                                       const char *command,
+                                       zmsg_t **msg_p,
+                                       void *my_data);
+INGESCAPE_EXPORT igs_result_t igs_private_command_init(const char *command, igs_private_command_fn cb, void *my_data);
+INGESCAPE_EXPORT igs_result_t igs_private_command_remove(const char *command);
+
 //set zyre headers
 INGESCAPE_EXPORT igs_result_t igs_peer_add_header(const char *key, const char *value);
 INGESCAPE_EXPORT igs_result_t igs_peer_remove_header(const char *key);
@@ -771,7 +923,8 @@ INGESCAPE_EXPORT int64_t igs_rt_time(void);
 /* ENABLE SYNCHRONOUS MODE
  When this mode is enabled, outputs are published only when igs_rt_set_time
  is called. The call to igs_rt_set_time is the trigger for output publication
- in this synchronous real-time mode. All published outputs are timestamped
+ in this synchronous real-time mode. Only the outputs written since the
+ previous call are published. All published outputs are timestamped
  with the value set by igs_rt_set_time.
  NB: Ingescape services and channels are not affected by the synchronous mode.
  NB: This mode is set at agent level.
@@ -779,6 +932,29 @@ INGESCAPE_EXPORT int64_t igs_rt_time(void);
 INGESCAPE_EXPORT void igs_rt_set_synchronous_mode(bool enable);
 INGESCAPE_EXPORT bool igs_rt_synchronous_mode(void);
 
+/* KEYFRAMES IN SYNCHRONOUS MODE
+ When the keyframe interval is set to N > 0, all outputs are published,
+ written or not, every N calls to igs_rt_set_time. This helps agents
+ joining late or missing publications to catch up. Default is 0 (no
+ keyframe): agents get the current outputs of the agents they map when
+ they discover them anyway.
+ NB: This setting is set at agent level.
+ */
+INGESCAPE_EXPORT void igs_rt_set_keyframe_interval(unsigned int ticks);
+INGESCAPE_EXPORT unsigned int igs_rt_keyframe_interval(void);
+
+/* BATCHED OUTPUT PUBLICATION
+ Between igs_output_batch_begin and igs_output_batch_commit, outputs
+ written by our agent are not published immediately. On commit, the last
+ value of each written output is published, in a single network message
+ for all the peers supporting it. Observe callbacks on our outputs are not
+ affected. Each output is published once per batch, even if it has been
+ written several times. Batches cannot be nested.
+ NB: igs_rt_set_time uses batches for agents in synchronous mode.
+ */
+INGESCAPE_EXPORT void igs_output_batch_begin(void);
+INGESCAPE_EXPORT igs_result_t igs_output_batch_commit(void);
+
 
 ///////////////////////////////////////////////////////
 // Administration, logging, configuration and utilities
@@ -844,8 +1020,30 @@ INGESCAPE_EXPORT bool igs_log_file(void);
 INGESCAPE_EXPORT void igs_log_set_file_path(const char *path); //default directory is ~/ on UNIX systems and current PATH on Windows
 INGESCAPE_EXPORT char * igs_log_file_path(void); // caller owns returned value
 
+/*Logs are written to the file, stream and system logs by the thread calling
+ igs_log and its variants. When asynchronous logs are enabled, the calling
+ thread only formats the log and pushes it in a bounded queue, and a dedicated
+ thread writes the waiting logs by batches. Console logs remain synchronous.
+ When the queue is full, the policy below decides what happens to a new log:
+ - IGS_LOG_QUEUE_DROP_NEWEST (default) : the new log is dropped.
+ - IGS_LOG_QUEUE_DROP_OLDEST : the oldest waiting log is dropped.
+ - IGS_LOG_QUEUE_BLOCK : the calling thread waits for room in the queue.
+ Queue capacity is rounded to a power of 2 and can only be changed before
+ asynchronous logs are enabled for the first time.*/
+typedef enum {
+    IGS_LOG_QUEUE_DROP_NEWEST = 0,
+    IGS_LOG_QUEUE_DROP_OLDEST,
+    IGS_LOG_QUEUE_BLOCK
+} igs_log_queue_policy_t;
+INGESCAPE_EXPORT void igs_log_set_async(bool async); //default is false
+INGESCAPE_EXPORT bool igs_log_async(void);
+INGESCAPE_EXPORT void igs_log_set_queue_capacity(size_t capacity); //default is 4096
+INGESCAPE_EXPORT void igs_log_set_queue_policy(igs_log_queue_policy_t policy);
+INGESCAPE_EXPORT size_t igs_log_dropped(void); //asynchronous logs dropped because the queue was full
+
 INGESCAPE_EXPORT void igs_log_include_data(bool enable); //log details of data IOs in log files , default is false.
 INGESCAPE_EXPORT void igs_log_include_services(bool enable); //log details about call/excecute services in log files, default is false.
+INGESCAPE_EXPORT void igs_log_shout_services(bool enable); //shout each service call and execution on the agent channels for monitoring tools, default is false.
 INGESCAPE_EXPORT void igs_log_no_warning_if_undefined_service(bool enable); //warns or not if an unknown service is called on this agent, default is warning (false).
 
 /*DEFINITION & MAPPING FILE MANAGEMENT
@@ -875,6 +1073,19 @@ INGESCAPE_EXPORT bool igs_has_ipc(void);
 //set IPC folder path on UNIX systems (default is /tmp/ingescape/)
 INGESCAPE_EXPORT void igs_set_ipc_dir(const char *path);
 INGESCAPE_EXPORT const char * igs_ipc_dir(void);
+/*On UNIX systems, large data values can also be exchanged through
+ shared memory with the agents on the same computer, the UNIX domain
+ sockets then only carrying small descriptors. Data outputs larger than
+ the threshold are written once in a ring of the given size, in which
+ receivers copy them. Values overwritten before being received are lost:
+ the ring shall hold several of the largest values, and values larger
+ than a quarter of the ring still use the sockets. Shared memory is
+ never used when security is enabled. These functions shall be called
+ when the peer is stopped.*/
+INGESCAPE_EXPORT void igs_set_shm(bool allow); //default is false
+INGESCAPE_EXPORT bool igs_has_shm(void);
+INGESCAPE_EXPORT void igs_set_shm_size(size_t size); //in bytes, default is 64 MB
+INGESCAPE_EXPORT void igs_set_shm_threshold(size_t size); //in bytes, default is 64 kB
 #endif
 
 
@@ -899,21 +1110,61 @@ INGESCAPE_EXPORT void igs_net_set_high_water_marks(int hwm_value);
 
 
 /* SATURATION CONTROL
- In situations where an agent inputs in the peer are excessively
- sollicited and it results in even more intensive output publications,
- it may saturate the ingescape loop with HANDLE_PUBLICATION messages,
- which will end up reaching more than 1000 messages, corresponding to
- the default High Water Marks on the pipe PAIR socket. The saturated
- PAIR socket will then block and freeze the agent.
- We allow here to remove the HWM and to print in real-time the number
- of HANDLE_PUBLICATION message stacked in the pipe.
- Please note, that disabling the HWM may induce a memory exhaustion
- for the agent and the operating system: USE WITH CAUTION.
+ Publications between agents in the same peer go through a bounded queue
+ handled by batches in the ingescape loop. In situations where the inputs
+ of an agent are excessively sollicited and it results in even more intensive
+ output publications, the queue may get full. The policy below decides what
+ happens then:
+ - IGS_LOCAL_QUEUE_BLOCK (default) : the publishing thread waits for room in
+ the queue, releasing the model meanwhile. Publications made by callbacks
+ running in the ingescape loop, and outputs published by batches, are
+ conflated instead.
+ - IGS_LOCAL_QUEUE_DROP_OLDEST : the oldest waiting publication is dropped.
+ - IGS_LOCAL_QUEUE_CONFLATE : the publication replaces any value of the same
+ output waiting outside the queue, to be handled after the queue content.
+ Queue capacity is rounded to a power of 2 and can only be changed when the
+ peer is stopped. igs_monitor_pipe_stack prints the number of publications
+ waiting in the queue in real-time. igs_unbind_pipe removes the HWM on the
+ pipe between our thread and the ingescape loop, which now only carries
+ commands and queue notifications.
  */
+typedef enum {
+    IGS_LOCAL_QUEUE_BLOCK = 0,
+    IGS_LOCAL_QUEUE_DROP_OLDEST,
+    IGS_LOCAL_QUEUE_CONFLATE
+} igs_local_queue_policy_t;
+typedef struct {
+    size_t published; //publications for the agents in our peer
+    size_t dispatched; //publications handled by the ingescape loop
+    size_t dropped; //IGS_LOCAL_QUEUE_DROP_OLDEST
+    size_t conflated; //IGS_LOCAL_QUEUE_CONFLATE and IGS_LOCAL_QUEUE_BLOCK from the ingescape loop
+    size_t blocked; //IGS_LOCAL_QUEUE_BLOCK, publications that had to wait
+    size_t pending; //publications currently in the queue
+    size_t max_pending;
+} igs_local_queue_stats_t;
+INGESCAPE_EXPORT void igs_local_queue_set_capacity(size_t capacity); //default is 4096
+INGESCAPE_EXPORT void igs_local_queue_set_policy(igs_local_queue_policy_t policy);
+INGESCAPE_EXPORT void igs_local_queue_stats(igs_local_queue_stats_t *stats);
 INGESCAPE_EXPORT void igs_unbind_pipe(void);
 INGESCAPE_EXPORT void igs_monitor_pipe_stack(bool monitor); //default is false
 
 
+/* CALLBACKS THREAD POOL
+ By default, IO callbacks and services called by other agents are executed
+ by the ingescape thread, which also receives all the network traffic: a
+ slow callback delays all the other publications and messages.
+ With a thread pool, these callbacks are executed asynchronously by worker
+ threads, including for IOs written by the application itself. Callbacks
+ of a given IO, and services of a given agent, keep their order and never
+ run concurrently, but callbacks of different IOs may run in parallel and
+ shall thus be thread-safe.
+ The peer must be stopped to change the number of threads. Zero (default)
+ disables the pool.
+ */
+INGESCAPE_EXPORT void igs_set_callbacks_thread_pool(size_t nb_threads);
+INGESCAPE_EXPORT size_t igs_callbacks_thread_pool(void);
+
+
 /*PERFORMANCE CHECK
  sends number of messages with defined size and displays performance
  information when finished (information displayed as INFO-level log)*/
@@ -39,6 +39,12 @@
 extern "C" {
 #endif
 
+#if defined (_MSC_VER)
+#   define IGS_THREAD_LOCAL __declspec(thread)
+#else
+#   define IGS_THREAD_LOCAL _Thread_local
+#endif
+
 // strndup utility function (for availability on all platforms)
 extern char *
 s_strndup(const char *str, size_t chars);
@@ -58,6 +64,139 @@ typedef CRITICAL_SECTION igs_mutex_t;
 #   define IGS_MUTEX_DESTROY(m) DeleteCriticalSection (&m)
 #endif
 
+//  Atomic macros
+//  Variables shared between threads without lock use the igs_atomic_*_t types
+//  and these macros, taking the variables themselves like the macros above.
+//  MSVC has no C11 atomics: Interlocked functions are used instead, ignoring
+//  memory orders because they are full barriers. Compare and exchange may fail
+//  spuriously and uses a relaxed order on failure.
+#if defined (_MSC_VER) && !defined (__clang__)
+#include <intrin.h>
+typedef volatile long igs_atomic_int_t;
+typedef volatile unsigned long igs_atomic_uint_t;
+typedef volatile char igs_atomic_bool_t;
+typedef volatile size_t igs_atomic_size_t;
+typedef volatile unsigned __int64 igs_atomic_uint64_t;
+#   define IGS_MEMORY_ORDER_RELAXED 0
+#   define IGS_MEMORY_ORDER_ACQUIRE 0
+#   define IGS_MEMORY_ORDER_RELEASE 0
+#   define IGS_MEMORY_ORDER_ACQ_REL 0
+#   define IGS_MEMORY_ORDER_SEQ_CST 0
+static __inline unsigned __int64 igs_atomic_exchange_msvc (volatile void *a, unsigned __int64 value, size_t size)
+{
+    if (size == 8)
+        return (unsigned __int64) InterlockedExchange64 ((volatile __int64 *) a, (__int64) value);
+    if (size == 4)
+        return (unsigned long) InterlockedExchange ((volatile long *) a, (long) value);
+    return (unsigned char) _InterlockedExchange8 ((volatile char *) a, (char) value);
+}
+static __inline unsigned __int64 igs_atomic_fetch_add_msvc (volatile void *a, __int64 value, size_t size)
+{
+    if (size == 8)
+        return (unsigned __int64) InterlockedExchangeAdd64 ((volatile __int64 *) a, value);
+    if (size == 4)
+        return (unsigned long) InterlockedExchangeAdd ((volatile long *) a, (long) value);
+    return (unsigned char) _InterlockedExchangeAdd8 ((volatile char *) a, (char) value);
+}
+static __inline bool igs_atomic_compare_exchange_msvc (volatile void *a, void *expected,
+                                                       unsigned __int64 desired, size_t size)
+{
+    if (size == 8) {
+        __int64 previous = InterlockedCompareExchange64 ((volatile __int64 *) a, (__int64) desired,
+                                                         *(__int64 *) expected);
+        bool is_exchanged = (previous == *(__int64 *) expected);
+        *(__int64 *) expected = previous;
+        return is_exchanged;
+    }
+    if (size == 4) {
+        long previous = InterlockedCompareExchange ((volatile long *) a, (long) desired, *(long *) expected);
+        bool is_exchanged = (previous == *(long *) expected);
+        *(long *) expected = previous;
+        return is_exchanged;
+    }
+    char previous = _InterlockedCompareExchange8 ((volatile char *) a, (char) desired, *(char *) expected);
+    bool is_exchanged = (previous == *(char *) expected);
+    *(char *) expected = previous;
+    return is_exchanged;
+}
+#   define IGS_ATOMIC_INIT(a, value)                  ((a) = (value))
+#   define IGS_ATOMIC_LOAD(a, order)                  igs_atomic_fetch_add_msvc (&(a), 0, sizeof (a))
+#   define IGS_ATOMIC_STORE(a, value, order)          ((void) igs_atomic_exchange_msvc (&(a), (unsigned __int64) (value), sizeof (a)))
+#   define IGS_ATOMIC_EXCHANGE(a, value, order)       igs_atomic_exchange_msvc (&(a), (unsigned __int64) (value), sizeof (a))
+#   define IGS_ATOMIC_FETCH_ADD(a, value, order)      igs_atomic_fetch_add_msvc (&(a), (__int64) (value), sizeof (a))
+#   define IGS_ATOMIC_FETCH_SUB(a, value, order)      igs_atomic_fetch_add_msvc (&(a), -(__int64) (value), sizeof (a))
+#   define IGS_ATOMIC_COMPARE_EXCHANGE(a, expected, desired, order) \
+        igs_atomic_compare_exchange_msvc (&(a), &(expected), (unsigned __int64) (desired), sizeof (a))
+#   define IGS_ATOMIC_FENCE(order)                    MemoryBarrier ()
+#else
+#include <stdatomic.h>
+typedef atomic_int igs_atomic_int_t;
+typedef atomic_uint igs_atomic_uint_t;
+typedef atomic_bool igs_atomic_bool_t;
+typedef atomic_size_t igs_atomic_size_t;
+typedef atomic_uint_least64_t igs_atomic_uint64_t;
+#   define IGS_MEMORY_ORDER_RELAXED memory_order_relaxed
+#   define IGS_MEMORY_ORDER_ACQUIRE memory_order_acquire
+#   define IGS_MEMORY_ORDER_RELEASE memory_order_release
+#   define IGS_MEMORY_ORDER_ACQ_REL memory_order_acq_rel
+#   define IGS_MEMORY_ORDER_SEQ_CST memory_order_seq_cst
+#   define IGS_ATOMIC_INIT(a, value)                  atomic_init (&(a), value)
+#   define IGS_ATOMIC_LOAD(a, order)                  atomic_load_explicit (&(a), order)
+#   define IGS_ATOMIC_STORE(a, value, order)          atomic_store_explicit (&(a), value, order)
+#   define IGS_ATOMIC_EXCHANGE(a, value, order)       atomic_exchange_explicit (&(a), value, order)
+#   define IGS_ATOMIC_FETCH_ADD(a, value, order)      atomic_fetch_add_explicit (&(a), value, order)
+#   define IGS_ATOMIC_FETCH_SUB(a, value, order)      atomic_fetch_sub_explicit (&(a), value, order)
+#   define IGS_ATOMIC_COMPARE_EXCHANGE(a, expected, desired, order) \
+        atomic_compare_exchange_weak_explicit (&(a), &(expected), desired, order, memory_order_relaxed)
+#   define IGS_ATOMIC_FENCE(order)                    atomic_thread_fence (order)
+#endif
+
+//  Reader/writer lock macros
+#if defined (__UNIX__)
+typedef pthread_rwlock_t igs_rwlock_t;
+#   define IGS_RWLOCK_INIT(l)           pthread_rwlock_init (&l, NULL)
+#   define IGS_RWLOCK_READ_LOCK(l)      pthread_rwlock_rdlock (&l)
+#   define IGS_RWLOCK_READ_UNLOCK(l)    pthread_rwlock_unlock (&l)
+#   define IGS_RWLOCK_WRITE_LOCK(l)     pthread_rwlock_wrlock (&l)
+#   define IGS_RWLOCK_WRITE_UNLOCK(l)   pthread_rwlock_unlock (&l)
+#   define IGS_RWLOCK_DESTROY(l)        pthread_rwlock_destroy (&l)
+#elif defined (__WINDOWS__)
+typedef SRWLOCK igs_rwlock_t;
+#   define IGS_RWLOCK_INIT(l)           InitializeSRWLock (&l)
+#   define IGS_RWLOCK_READ_LOCK(l)      AcquireSRWLockShared (&l)
+#   define IGS_RWLOCK_READ_UNLOCK(l)    ReleaseSRWLockShared (&l)
+#   define IGS_RWLOCK_WRITE_LOCK(l)     AcquireSRWLockExclusive (&l)
+#   define IGS_RWLOCK_WRITE_UNLOCK(l)   ReleaseSRWLockExclusive (&l)
+#   define IGS_RWLOCK_DESTROY(l)
+#endif
+
+//  Condition variable macros, used with an igs_mutex_t
+#if defined (__UNIX__)
+typedef pthread_cond_t igs_cond_t;
+#   define IGS_COND_INIT(c)         pthread_cond_init (&c, NULL)
+#   define IGS_COND_WAIT(c, m)      pthread_cond_wait (&c, &m)
+#   define IGS_COND_BROADCAST(c)    pthread_cond_broadcast (&c)
+#   define IGS_COND_DESTROY(c)      pthread_cond_destroy (&c)
+#elif defined (__WINDOWS__)
+typedef CONDITION_VARIABLE igs_cond_t;
+#   define IGS_COND_INIT(c)         InitializeConditionVariable (&c)
+#   define IGS_COND_WAIT(c, m)      SleepConditionVariableCS (&c, &m, INFINITE)
+#   define IGS_COND_BROADCAST(c)    WakeAllConditionVariable (&c)
+#   define IGS_COND_DESTROY(c)
+#endif
+
+//  Wakeup for threads waiting on a condition owned by other threads (room
+//  in a bounded queue, etc.). Waiters read the count with core_signal_prepare
+//  before checking their condition, then sleep in core_signal_wait until it
+//  changes, so that no notification is lost between the check and the wait.
+//  core_signal_notify only takes the mutex when someone is waiting.
+typedef struct igs_signal {
+    igs_mutex_t mutex;
+    igs_cond_t cond;
+    uint64_t count;
+    igs_atomic_size_t waiters;
+} igs_signal_t;
+
 typedef struct igs_core_context igs_core_context_t;
 
 typedef enum {
@@ -76,6 +215,14 @@ typedef struct igs_observe_wrapper{
     void* data;
 } igs_observe_io_wrapper_t;
 
+// immutable copy of the io callbacks, replaced each time a callback is
+// added, so that callbacks can be executed without holding the model lock
+typedef struct igs_io_callbacks{
+    igs_atomic_int_t references;
+    size_t count;
+    igs_observe_io_wrapper_t callbacks[];
+} igs_io_callbacks_t;
+
 typedef enum {
     IGS_CONSTRAINT_MIN = 0,
     IGS_CONSTRAINT_MAX,
@@ -113,6 +260,140 @@ typedef struct igs_constraint{
     };
 } igs_constraint_t;
 
+// Prebuilt publication frames for an output, created at its first
+// publication and freed with the output (see network_publish_output).
+// Scalar frames are small enough to be copied by value by ZeroMQ when
+// sent with ZFRAME_REUSE: they are updated in place at each publication.
+typedef struct igs_publication_cache {
+    igs_io_value_type_t value_type;
+    uint64_t topic;
+    zframe_t *legacy_topic; //"uuid-output"
+    zframe_t *legacy_type; //value type as a string
+    zframe_t *legacy_value; //scalar values only
+    zframe_t *compact; //scalar values only
+    zframe_t *compact_timestamped; //scalar values only
+    bool is_topic_owner; //only one of our outputs per topic uses compact publications
+} igs_publication_cache_t;
+
+/*
+ Handles give lock-free access to scalar input values, using a seqlock:
+ the writer, always holding the model lock, makes the sequence odd while
+ updating the value, and readers retry until they see the same even
+ sequence before and after reading it. value stores the bool, int or
+ double value in place.
+ */
+struct _igs_io_handle_t {
+    char *name;
+    struct igs_io *io; //NULL while the input does not exist
+    igs_atomic_uint_t sequence;
+    igs_atomic_int_t value_type;
+    igs_atomic_uint64_t value;
+};
+
+// reference-counted data buffers (see igs_data_t in ingescape.h)
+struct _igs_data_t {
+    igs_atomic_int_t references;
+    void *data;
+    size_t size;
+    igs_data_free_fn *free_fn;
+    void *hint;
+};
+
+// latest value received for a conflated input, waiting to be written
+// by the ingescape loop (see core_context->conflated_values)
+typedef struct igs_conflated_value {
+    char agent_uuid[IGS_AGENT_UUID_LENGTH + 1];
+    char input_name[IGS_MAX_IO_NAME_LENGTH + 1];
+    igs_io_value_type_t value_type;
+    igs_data_t *buffer;
+    int64_t timestamp;
+} igs_conflated_value_t;
+
+// publication from one of our agents to the other agents in our peer
+typedef struct igs_local_publication {
+    char agent_uuid[IGS_AGENT_UUID_LENGTH + 1];
+    char *agent_name; //stored after the structure
+    char *output_name; //stored after the structure
+    igs_io_value_type_t value_type;
+    union {
+        int i;
+        double d;
+        bool b;
+    } scalar;
+    igs_data_t *buffer; //string and data values
+    int64_t timestamp;
+} igs_local_publication_t;
+
+// bounded multi-producer queue of local publications, drained by batches
+// in the ingescape loop (see igs_local_queue_set_policy)
+typedef struct igs_local_queue_cell {
+    igs_atomic_size_t sequence;
+    igs_local_publication_t *publication;
+} igs_local_queue_cell_t;
+
+typedef struct igs_local_queue {
+    igs_local_queue_cell_t *cells;
+    size_t mask;
+    igs_atomic_size_t enqueue_position;
+    igs_atomic_size_t dequeue_position;
+    igs_atomic_bool_t is_signaled; //a notification is waiting in the pipe
+    igs_atomic_size_t published;
+    igs_atomic_size_t dispatched;
+    igs_atomic_size_t dropped;
+    igs_atomic_size_t conflated;
+    igs_atomic_size_t blocked;
+    igs_atomic_size_t max_pending;
+    zhashx_t *overflow; //igs_local_publication_t by agent uuid and output name (model locked)
+} igs_local_queue_t;
+
+// log written by the asynchronous log writer (see igs_log_set_async),
+// strings are stored after the structure
+typedef struct igs_log_record {
+    igs_log_level_t level;
+    int64_t timestamp; //microseconds since epoch
+    bool to_file;
+    bool to_stream;
+    bool to_syslog;
+    char *agent_name;
+    char *function;
+    char *content;
+} igs_log_record_t;
+
+// bounded multi-producer queue of logs, drained by the log writer thread
+typedef struct igs_log_queue_cell {
+    igs_atomic_size_t sequence;
+    igs_log_record_t *record;
+} igs_log_queue_cell_t;
+
+typedef struct igs_log_queue {
+    igs_log_queue_cell_t *cells;
+    size_t mask;
+    igs_atomic_size_t enqueue_position;
+    igs_atomic_size_t dequeue_position;
+    igs_atomic_size_t dropped;
+    igs_signal_t room; //notified by the writer when logs are popped
+    igs_signal_t records; //notified by the producers when logs are pushed
+    igs_atomic_bool_t is_terminated; //the writer exits after writing the waiting logs
+} igs_log_queue_t;
+
+// start of a shared memory segment, followed by the ring of values
+// (see shared memory publications below)
+typedef struct igs_shm_header {
+    uint32_t magic; //IGS_SHM_MAGIC
+    uint32_t header_size;
+    uint64_t capacity; //bytes available for values after the header
+    igs_atomic_uint64_t reserved; //end position of the last reserved value
+} igs_shm_header_t;
+
+typedef struct igs_shm_segment {
+    char *name;
+    igs_shm_header_t *header; //start of the mapped segment
+    uint8_t *values;
+    uint64_t capacity;
+    size_t mapped_size;
+    bool is_owner; //created by our peer, unlinked at loop stop
+} igs_shm_segment_t;
+
 typedef struct igs_io{
     char* name;
     char *description;
@@ -128,9 +409,26 @@ typedef struct igs_io{
         void* data;
     } value;
     size_t value_size;
+    igs_data_t *data_buffer; //string and data values only, when value is shared
     bool is_muted;
+    bool is_in_batch; //outputs only, written during the pending batch
+    bool is_dirty; //outputs only, written in synchronous mode since last publication
     zlist_t *io_callbacks; //igs_observe_io_wrapper_t
+    igs_io_callbacks_t *callbacks_snapshot; //NULL if no callback
     igs_constraint_t *constraint;
+    igs_publication_cache_t *publication_cache; //outputs only
+    bool has_colliding_topic; //outputs only, also published in legacy form (see network_publication_topic)
+    igs_io_handle_t *handle; //inputs only
+    bool is_conflated; //inputs only
+    igs_conflated_value_t *conflated_value; //inputs only, NULL if no value is waiting
+    igs_split_mode_t split_mode; //outputs only
+    char **split_key_path; //outputs only, NULL-terminated JSON path
+    size_t split_key_offset; //outputs only, data range of the split key
+    size_t split_key_size;
+    char *split_key; //outputs only, explicit split key
+    size_t split_queue_capacity; //outputs only, 0 for default
+    igs_split_queue_policy_t split_queue_policy; //outputs only
+    igs_split_queue_stats_t split_stats; //outputs only, pending is computed when read
 } igs_io_t;
 
 typedef struct igs_service{
@@ -161,8 +459,30 @@ typedef struct igs_definition{
     zhashx_t* outputs_table; //igs_io_t
     zlist_t* services_names_ordered; // char*, to keep insertion order
     zhashx_t *services_table; //igs_service_t
+    uint64_t revision; //incremented by definition_update_json
+    uint64_t published_revision; //revision when last sent to our peers
+    zlist_t *deltas; //igs_definition_delta_t, changes since published_revision
+    char *cache_key; //remote definition shared through the cache, NULL if private
 } igs_definition_t;
 
+// remote definitions received with the same content are parsed once
+// and shared by the remote agents, which shall not modify them
+typedef struct igs_remote_definition{
+    char *key; //content hash and size of the received JSON
+    char *source; //received JSON, to rule out hash collisions
+    igs_definition_t *definition;
+    size_t references;
+} igs_remote_definition_t;
+
+// IO creation or removal in a definition, sent to peers instead of
+// the whole definition when possible (see network versioned updates)
+typedef struct igs_definition_delta{
+    bool removed;
+    igs_io_type_t type;
+    igs_io_value_type_t value_type;
+    char *name;
+} igs_definition_delta_t;
+
 typedef struct igs_map{
     uint64_t id;
     char* from_input;
@@ -175,6 +495,10 @@ typedef struct igs_split{
     char* from_input;
     char* to_agent;
     char* to_output;
+    int credit; //fixed credit window, 0 for adaptive (see igs_split_set_credit)
+    int window; //credits granted to the splitter, used or not
+    double round_trip; //microseconds, moving average
+    double processing_time; //microseconds per work, moving average
 } igs_split_t;
 
 typedef struct igs_mapping{
@@ -182,10 +506,34 @@ typedef struct igs_mapping{
     char *json_legacy;
     zlist_t* map_elements; //igs_map_t
     zlist_t* split_elements; //igs_split_t
+    uint64_t revision; //incremented by mapping_update_json
+    uint64_t published_revision; //revision when last sent to our peers
+    zlist_t *deltas; //igs_mapping_delta_t, changes since published_revision
 } igs_mapping_t;
 
+// map element addition or removal, sent to peers instead of the whole
+// mapping when possible (see network versioned updates)
+typedef struct igs_mapping_delta{
+    bool removed;
+    char* from_input;
+    char* to_agent;
+    char* to_output;
+} igs_mapping_delta_t;
+
+// local input targeted by a remote output, stored in the
+// mapping index of the core context
+typedef struct igs_mapping_target {
+    igsagent_t *agent;
+    char *input_name;
+} igs_mapping_target_t;
+
 typedef struct igs_mapping_filter {
     char *filter;
+    // compact publications only (see network section below)
+    bool is_compact;
+    uint64_t topic;
+    char *output_name;
+    struct igs_remote_agent *remote_agent;
 } igs_mapping_filter_t;
 
 typedef struct igs_worker{
@@ -193,6 +541,11 @@ typedef struct igs_worker{
     char *agent_uuid;
     int credit;
     int uses;
+    size_t heap_index; //position in splitter->workers_heap
+    bool batches_works; //worker supports SPLITTER_WORKS and WORKER_CREDIT
+    int64_t credit_timestamp; //from the last WORKER_CREDIT, echoed with the works sent immediately
+    zlist_t *keyed_works; //igs_queued_work_t routed to this worker by their key
+    void *ready_handle; //in splitter->ready_workers, NULL when not ready
 }igs_worker_t;
 
 typedef struct igs_queued_works{
@@ -205,13 +558,30 @@ typedef struct igs_queued_works{
         void* data;
     } value;
     size_t value_size;
+    bool has_key; //keyed split
+    uint64_t key;
+    void *buffer; //string and data values, kept by pooled works
+    size_t buffer_size;
 }igs_queued_work_t;
 
+// point of a worker on the consistent hashing ring of a splitter
+typedef struct igs_split_ring_point{
+    uint64_t hash;
+    igs_worker_t *worker;
+}igs_split_ring_point_t;
+
 typedef struct igs_splitter{
     char *agent_uuid;
     char *output_name;
-    zlist_t *workers; //igs_worker_t
+    zhashx_t *workers; //igs_worker_t by agent uuid and input name
+    igs_worker_t **workers_heap; //best worker first: most credits, then fewest uses
+    size_t workers_heap_size;
+    size_t workers_heap_capacity;
     zlist_t *queued_works; //igs_queued_work_t
+    igs_split_ring_point_t *ring; //sorted by hash, IGS_SPLIT_RING_POINTS per worker
+    size_t ring_size;
+    size_t keyed_works; //works waiting in the keyed_works of our workers
+    zlistx_t *ready_workers; //igs_worker_t having keyed works and credits
 }igs_splitter_t;
 
 //////////////////  NETWORK  STRUCTURES AND ENUMS   //////////////////
@@ -223,6 +593,17 @@ typedef struct igs_zyre_peer {
     int reconnected;
     bool has_joined_private_channel;
     char *protocol;
+    bool compact_publications; //peer protocol supports compact publications
+    bool batch_publications; //peer protocol supports batch publications
+    bool versioned_updates; //peer protocol supports definition and mapping deltas
+    bool split_batches; //peer protocol supports batched split works and credits
+    bool has_publisher; //ingescape peer, counted in the legacy or compact peers
+    bool is_local; //peer on the same computer, in another process
+    bool shm_publications; //peer confirmed its attachment to our shared memory segment
+    igs_shm_segment_t *shm; //segment of the peer, when we could attach to it
+    zhashx_t *publication_topics; //igs_mapping_filter_t, compact subscriptions by topic
+    uint64_t *colliding_topics; //sorted topics shared by several outputs of the peer's agents
+    size_t colliding_topics_size;
 } igs_zyre_peer_t;
 
 // remote agent we are subscribing to
@@ -233,7 +614,10 @@ typedef struct igs_remote_agent{
     igs_definition_t *definition;
     bool shall_send_outputs_request;
     igs_mapping_t *mapping;
+    uint64_t definition_version; //0 if the agent does not version its definition
+    uint64_t mapping_version; //0 if the agent does not version its mapping
     zlist_t *mapping_filters; //igs_mapping_filter_t
+    bool batch_subscription; //subscribed to the agent's batch publications
     int timer_id;
 } igs_remote_agent_t;
 
@@ -274,6 +658,22 @@ typedef struct igs_channels_wrapper {
     void *my_data;
 } igs_channels_wrapper_t;
 
+typedef struct igs_private_command {
+    char *command;
+    igs_private_command_fn *cb;
+    void *my_data;
+} igs_private_command_t;
+
+typedef struct igs_pending_service_call {
+    char *token; //key in core_context->pending_service_calls
+    igsagent_t *agent; //caller
+    char *service_name;
+    int64_t deadline; //zclock_mono in milliseconds, 0 for no deadline
+    igsagent_service_reply_fn *agent_cb;
+    igs_service_reply_fn *cb; //used instead of agent_cb for calls made by the core agent
+    void *my_data;
+} igs_pending_service_call_t;
+
 typedef struct igs_forced_stop_wrapper {
     igs_forced_stop_fn *callback_ptr;
     void *my_data;
@@ -352,6 +752,7 @@ struct _igsagent_t {
     // definition
     char *definition_path;
     igs_definition_t* definition;
+    zhashx_t *io_handles; //igs_io_handle_t by input name, created on demand
 
     // mapping
     char *mapping_path;
@@ -361,10 +762,16 @@ struct _igsagent_t {
     bool rt_timestamps_enabled;
     int64_t rt_current_timestamp_microseconds;
     bool rt_synchronous_mode_enabled;
+    unsigned int rt_keyframe_interval; //0 for no keyframes
+    unsigned int rt_ticks_since_keyframe;
+    zlist_t *output_batch; //names of outputs written during the pending batch, NULL outside batches
     
     //network
     bool network_need_to_send_definition_update;
     bool network_need_to_send_mapping_update;
+    uint64_t network_definition_version; //version of the definition last sent to our peers
+    uint64_t network_mapping_version; //version of the mapping last sent to our peers
+    bool network_definition_snapshot_sent; //full definition sent, mapping shall follow
     bool network_request_outputs_from_mapped_agents;
     bool network_activation_during_runtime;
 
@@ -372,6 +779,10 @@ struct _igsagent_t {
     zlist_t *mute_callbacks; //igs_mute_wrapper_t
 
     zlist_t *elections;
+
+    //callbacks thread pool
+    igs_atomic_size_t pool_tasks; //tasks posted for the agent and not finished yet
+    bool is_freed_by_pool; //destroyed with pending tasks, freed by the last one
 };
 
 /*
@@ -396,11 +807,17 @@ typedef struct igs_core_context {
     bool use_color_in_console;
     bool enable_data_logging;
     bool enable_service_logging;
+    bool enable_service_shouts;
     igs_log_level_t log_level;
     igs_log_level_t log_file_level;
     size_t log_file_max_line_length;
     char log_file_path[IGS_MAX_PATH_LENGTH];
     int log_nb_of_entries; //for fflush rotation
+    igs_atomic_bool_t log_async; //read by logging threads without lock
+    size_t log_queue_capacity; //0 for default
+    igs_log_queue_policy_t log_queue_policy;
+    igs_log_queue_t *log_queue; //created when asynchronous logs are first enabled
+    zactor_t *log_writer;
     
     //model
     bool allow_undefined_services;
@@ -416,6 +833,9 @@ typedef struct igs_core_context {
     // network
     bool network_allow_ipc;
     bool network_allow_inproc;
+    bool network_allow_shm;
+    size_t network_shm_size; //0 for default
+    size_t network_shm_threshold; //0 for default
     int network_zyre_port;
     int network_hwm_value;
     unsigned int network_discovery_interval;
@@ -440,7 +860,13 @@ typedef struct igs_core_context {
 
     // performance
     bool unbind_pipe; //removes HWM on PAIR pipe between main thread and ingescape thread
-    bool monitor_pipe_stack; //counts piled messages in the pipe in real-time
+    bool monitor_pipe_stack; //prints the number of waiting local publications in real-time
+    igs_local_queue_t *local_queue; //created on first local publication
+    size_t local_queue_capacity; //0 for default
+    igs_local_queue_policy_t local_queue_policy;
+    igs_signal_t queue_room; //notified when local queues and splitters make room
+    zactor_t **callbacks_pool; //see igs_set_callbacks_thread_pool
+    size_t callbacks_pool_size;
     size_t performance_msg_counter;
     size_t performance_msg_count_target;
     size_t performance_msg_size;
@@ -470,10 +896,29 @@ typedef struct igs_core_context {
     char *network_ipc_endpoint;
     zhashx_t *zyre_peers; //igs_zyre_peer_t
     zlist_t *zyre_callbacks; //igs_channels_wrapper_t
+    zhashx_t *private_commands; //igs_private_command_t, created on first use
+    zhashx_t *pending_service_calls; //igs_pending_service_call_t, created on first use
+    igs_atomic_size_t pending_call_deadlines; //pending calls with a deadline, read by the loop without lock
+    size_t service_calls_counter; //used to generate tokens for asynchronous service calls
     zhashx_t *agents; //igsagent_t, all active agents we own
     zhashx_t *created_agents; //igsagent_t, all created agents we own (some may be inactive)
     zhashx_t *remote_agents; //igs_remote_agent_t, all known external agents
-    zlist_t *splitters; //igs_splitter_t
+    zhashx_t *remote_definitions; //igs_remote_definition_t, created on first use
+    zhashx_t *remote_agents_by_name; //zlist_t of igs_remote_agent_t, created on first use
+    zhashx_t *zyre_peers_by_name; //zlist_t of igs_zyre_peer_t, created on first use
+    zhashx_t *mapping_index; //zhashx_t per remote agent name, of zlist_t per output name, of igs_mapping_target_t
+    zhashx_t *splitters; //igs_splitter_t by agent uuid and output name
+    igs_queued_work_t **split_work_pool; //released works, reused by our splitters
+    size_t split_work_pool_size;
+    zhashx_t *published_topics; //igs_publication_cache_t of our outputs using compact publications, by topic
+    zlist_t *conflated_values; //igs_conflated_value_t, written after each batch of received publications
+    bool conflation_is_used; //received publications are handled by batches once an input is conflated
+    size_t network_legacy_peers; //peers not supporting compact publications
+    size_t network_compact_peers; //peers supporting compact publications
+    size_t network_batch_peers; //peers supporting batch publications (also counted as compact)
+    size_t network_local_peers; //compact peers on the same computer, in other processes
+    size_t network_shm_peers; //local peers attached to our shared memory segment
+    igs_shm_segment_t *shm_segment; //our shared memory segment, when enabled
     zactor_t *network_actor;
     zsock_t *internal_pipe;
     zyre_t *node;
@@ -506,11 +951,47 @@ INGESCAPE_EXPORT extern igsagent_t *core_agent;
  */
 INGESCAPE_EXPORT void core_init_context(void);
 INGESCAPE_EXPORT void core_init_agent(void);
+INGESCAPE_EXPORT zhashx_t *core_new_topic_table(void);
+INGESCAPE_EXPORT void core_signal_init(igs_signal_t *signal);
+INGESCAPE_EXPORT void core_signal_destroy(igs_signal_t *signal);
+INGESCAPE_EXPORT uint64_t core_signal_prepare(igs_signal_t *signal);
+INGESCAPE_EXPORT void core_signal_wait(igs_signal_t *signal, uint64_t count);
+INGESCAPE_EXPORT void core_signal_cancel(igs_signal_t *signal);
+INGESCAPE_EXPORT void core_signal_notify(igs_signal_t *signal);
 
 // definition
 INGESCAPE_EXPORT void definition_free_definition (igs_definition_t **definition);
 INGESCAPE_EXPORT void definition_free_constraint (igs_constraint_t **constraint);
 INGESCAPE_EXPORT void definition_update_json (igs_definition_t *definition);
+// legacy exports are generated on first use and kept until the next update
+INGESCAPE_EXPORT const char *definition_json_legacy_v3 (igs_definition_t *definition);
+INGESCAPE_EXPORT const char *definition_json_legacy_v4 (igs_definition_t *definition);
+/*
+ Definition and mapping deltas: IO creations and removals, and map element
+ additions and removals, are recorded by the public API functions after
+ their call to definition_update_json or mapping_update_json. When every
+ revision since the last publication has a recorded delta, peers supporting
+ versioned updates receive the deltas instead of the whole JSON document.
+ Any other change leaves a revision without delta and a full snapshot is
+ sent. Deltas are applied idempotently on reception.
+ */
+INGESCAPE_EXPORT void definition_record_delta (igs_definition_t *definition, igs_io_t *io, bool removed);
+INGESCAPE_EXPORT bool definition_has_complete_deltas (igs_definition_t *definition);
+INGESCAPE_EXPORT void definition_reset_deltas (igs_definition_t *definition); //after publication
+INGESCAPE_EXPORT void definition_apply_delta (igs_definition_t *definition, const char *name, igs_io_type_t type,
+                                              igs_io_value_type_t value_type, bool removed);
+/*
+ Remote definitions are parsed from the JSON received from other agents.
+ Identical
+ JSON strings share the same parsed definition through a cache indexed by
+ content hash: these definitions shall be released with
+ definition_release_remote and made private before any modification.
+ These functions shall be called inside the model lock.
+ */
+INGESCAPE_EXPORT igs_definition_t *definition_load_remote (const char *json_str); //NULL if invalid
+INGESCAPE_EXPORT void definition_release_remote (igs_definition_t **definition);
+INGESCAPE_EXPORT void definition_make_private (igs_definition_t **definition); //before modification
+INGESCAPE_EXPORT void definition_free_remote_cache (void);
 
 // mapping
 INGESCAPE_EXPORT void mapping_free_mapping (igs_mapping_t **map);
@@ -524,6 +1005,26 @@ INGESCAPE_EXPORT bool mapping_is_equal(const char *first_str, const char *second
 INGESCAPE_EXPORT uint64_t mapping_djb2_hash (unsigned char *str);
 INGESCAPE_EXPORT bool mapping_check_input_output_compatibility(igsagent_t *agent, igs_io_t *found_input, igs_io_t *found_output);
 INGESCAPE_EXPORT void mapping_update_json (igs_mapping_t *mapping);
+INGESCAPE_EXPORT const char *mapping_json_legacy (igs_mapping_t *mapping); //generated on first use
+INGESCAPE_EXPORT void mapping_record_delta (igs_mapping_t *mapping, igs_map_t *map_elmt, bool removed);
+INGESCAPE_EXPORT bool mapping_has_complete_deltas (igs_mapping_t *mapping);
+INGESCAPE_EXPORT void mapping_reset_deltas (igs_mapping_t *mapping); //after publication
+INGESCAPE_EXPORT void mapping_apply_delta (igs_mapping_t *mapping, const char *from_input,
+                                           const char *to_agent, const char *to_output, bool removed);
+/*
+ The mapping index provides, for each remote agent name and output name,
+ the list of local agents and inputs mapped to this output. It is used
+ to dispatch received publications without iterating on all the mapping
+ elements of all our agents. The index contains active agents only and
+ is rebuilt agent by agent, each time the mapping of an agent changes or
+ an agent is activated or deactivated. Inputs are referenced by name and
+ resolved at dispatch time, so that definition changes do not invalidate
+ the index. These functions shall be called inside the model lock.
+ */
+INGESCAPE_EXPORT void mapping_index_update_agent (igsagent_t *agent);
+INGESCAPE_EXPORT void mapping_index_remove_agent (igsagent_t *agent);
+INGESCAPE_EXPORT void mapping_index_destroy (void);
+INGESCAPE_EXPORT zlist_t * mapping_index_targets (const char *agent_name, const char *output_name);
 
 // split
 /*
@@ -559,10 +1060,18 @@ INGESCAPE_EXPORT void mapping_update_json (igs_mapping_t *mapping);
  For an output of our agent are a set of Splitters. For an input of a remote
  agent are a set of Workers.
  
+ Splitters are indexed by agent uuid and output name in context->splitters,
+ so that publishing an output without splitter only costs a lookup. The
+ Workers of a Splitter are indexed by remote agent uuid and input name, and
+ kept in a binary heap whose first element is the best Worker, i.e. the one
+ with the most credits and then the fewest uses. The Workers having keyed
+ Works and credits are also listed in splitter->ready_workers, so that
+ dispatching a Work never scans all the Workers.
+
  At the end of the call to s_split_add_credit_to_worker,
  s_split_trigger_send_message_to_worker is called for our output. This call
- iterates on our Splitters, Workers and Works, using the credits and number
- of uses to execute the Works with the best available Workers. It sends a
+ sends the queued Works of the Splitter to its best Worker, as long as this
+ Worker has credits, updating the heap after each Work. It sends a
  SPLITTER_WORK_MSG to the remote agents corresponding to the selected Worker
  for a given Work, i.e. a publication with its value type and data.
  
@@ -577,7 +1086,40 @@ INGESCAPE_EXPORT void mapping_update_json (igs_mapping_t *mapping);
  
  Upon receiving WORKER_READY_MSG, our agent calls s_split_add_credit_to_worker,
  which runs again the machanism to send our Works to available Workers.
+
+ Since protocol v9, Works sent to a Worker are batched: a SPLITTER_WORKS_MSG
+ carries up to IGS_SPLIT_MAX_BATCH Works, i.e. their number and an echoed
+ timestamp, followed by the value type and value of each Work. The Worker
+ handles all of them and then replies with a single WORKER_CREDIT_MSG,
+ giving back a number of credits and a timestamp of its own clock. When
+ queued Works are sent immediately upon receiving credits, the splitter
+ echoes this timestamp, "0" otherwise. The credits granted by a Worker,
+ i.e. its credit window, are fixed (see igs_split_set_credit) or sized from
+ the round trip measured with the echoed timestamps and the average
+ processing time of the Works: the window keeps enough Works in flight to
+ cover twice the round trip, up to IGS_SPLIT_MAX_WINDOW. Credits given
+ back to a splitter can be zero when the window shrinks.
  
+ Outputs may also be split by key (see igs_output_split_by_json_field and
+ the like): split_add_work_to_queue hashes the key of each Work and looks
+ it up on a consistent hashing ring, where each Worker of the Splitter owns
+ IGS_SPLIT_RING_POINTS points derived from its uuid and input name. The Work
+ is queued to the keyed_works of the Worker owning the next point, and
+ s_split_trigger_send_message_to_worker sends the keyed Works of the Workers
+ having credits before the shared queued Works, which are balanced as
+ usual. The ring is rebuilt when Workers are added or removed, so that only
+ the keys of the points gained or lost by a Worker move. The keyed Works
+ of a removed Worker are queued again to the Workers now owning their keys.
+
+ The Works of a Splitter, shared or keyed, are bounded by the queue capacity
+ of our output. When it is reached, split_add_work_to_queue applies the
+ queue policy of the output. Waiting for room (IGS_SPLIT_QUEUE_BLOCK)
+ unlocks the model so that credits can be received, which means that the
+ output must be looked up again afterwards. Queue counters are kept in the
+ output so that they survive the Splitter. Released Works are kept in a
+ pool of the context with their string or data buffer, up to
+ IGS_SPLIT_WORK_POOL_SIZE Works.
+
  WORKER_GOODBYE_MSG is sent when an agent removes a given Split.
  Upon receiving WORKER_GOODBYE_MSG, split_remove_worker is called
  with the effect of removing our Workers for this agent in all our
@@ -598,10 +1140,21 @@ INGESCAPE_EXPORT void split_free_splitter (igs_splitter_t **splitter);
 INGESCAPE_EXPORT igs_split_t* split_create_split_element(const char * from_input,
                                                          const char *to_agent,
                                                          const char* to_output);
-INGESCAPE_EXPORT void split_add_work_to_queue(igs_core_context_t *context, char* agent_uuid, const igs_io_t *output);
+INGESCAPE_EXPORT igs_io_t *split_add_work_to_queue(igs_core_context_t *context, char* agent_uuid,
+                                                    igs_io_t *output, bool can_wait); //NULL if output was removed while waiting
 INGESCAPE_EXPORT void split_remove_worker(igs_core_context_t *context, char *worker_uuid, char *input_name);
-INGESCAPE_EXPORT int split_message_from_worker(char *command, zmsg_t *msg, igs_core_context_t *context);
-INGESCAPE_EXPORT int split_message_from_splitter(zmsg_t *msg, igs_core_context_t *context);
+INGESCAPE_EXPORT int split_message_from_worker(const char *command, zmsg_t *msg, igs_core_context_t *context);
+INGESCAPE_EXPORT int split_message_from_splitter(const char *command, zmsg_t *msg, igs_core_context_t *context);
+INGESCAPE_EXPORT int split_hello_credit(igs_split_t *split); //credits to send in WORKER_HELLO_MSG
+INGESCAPE_EXPORT void split_clear_output_key(igs_io_t *output); //frees the split key settings of an output
+INGESCAPE_EXPORT void split_free_work_pool(igs_core_context_t *context);
+#define IGS_SPLIT_BATCH_PROTOCOL 9
+#define IGS_SPLIT_MAX_BATCH 64
+#define IGS_SPLIT_RING_POINTS 64
+#define IGS_SPLIT_DEFAULT_QUEUE_CAPACITY 4096
+#define IGS_SPLIT_WORK_POOL_SIZE 1024 //released works kept for reuse
+#define IGS_SPLIT_POOLED_BUFFER_SIZE 4096 //larger string and data buffers are not kept
+#define IGS_SPLIT_MAX_WINDOW 1024
 
 // model
 /*
@@ -611,6 +1164,13 @@ INGESCAPE_EXPORT int split_message_from_splitter(zmsg_t *msg, igs_core_context_t
  The mutexes protect the model on all possible accesses and modifications involving:
  - public functions
  - readers and timers attached to zloops
+ The model lock is a reader/writer lock: model_read_write_lock takes it exclusively
+ and shall be used whenever the model is modified or iterated, whereas model_read_lock
+ takes it shared and is reserved to pure getters (io values, types, descriptions,
+ existence checks). Hash lookups in czmq update an internal cache, so lookups made by
+ these getters are additionally serialized by a short internal mutex in igs_model.c.
+ Neither lock is recursive: code holding the write lock shall never call these
+ getters, but their model_ equivalents (asserted in debug builds).
  Public functions are prefixed either by igs_ or igsagent_. When an igs_
  function has an igsagent_ equivalent, the latter shall be protected because
  it wraps the former.
@@ -628,9 +1188,12 @@ INGESCAPE_EXPORT int split_message_from_splitter(zmsg_t *msg, igs_core_context_t
  their objects are not destroyed when used.
  Here is the list of the callback structures and functions actually executing them:
  - io_callbacks (in each io object)
-    executed in model_write and model_LOCKED_handle_io_callbacks
+    executed in model_LOCKED_handle_io_callbacks, using an immutable snapshot of the
+    callbacks and a reference on string and data values, without any lock, or by the
+    callbacks thread pool (see igs_set_callbacks_thread_pool)
  - service_cb (in each service object)
-    - executed by s_manage_zyre_incoming (CALL_SERVICE_MSG), igsagent_service_call
+    - executed by s_manage_zyre_incoming (CALL_SERVICE_MSG) or the callbacks thread pool,
+    igsagent_service_call
  - igs_monitor_wrapper_t (monitor_callbacks)
     - executed by igs_monitor_trigger_network_check (#core_context->network_device)
  - igs_mute_wrapper_t (mute_callbacks)
@@ -639,6 +1202,12 @@ INGESCAPE_EXPORT int split_message_from_splitter(zmsg_t *msg, igs_core_context_t
     - executed by igs_freeze, igs_unfreeze (#core_context->is_frozen)
  - igs_channels_wrapper_t (zyre_callbacks)
     - executed by s_manage_zyre_incoming (#nothing)
+ - igs_private_command_t (private_commands)
+    - executed by s_manage_zyre_incoming (WHISPER with a registered title) (#nothing)
+ - igs_pending_service_call_t (pending_service_calls)
+    - executed by service_complete_pending_call, after removal from the table, from s_manage_zyre_incoming
+    (CALL_SERVICE_MSG), igsagent_service_call, s_check_service_call_deadlines, igsagent_service_call_cancel
+    and service_cancel_pending_calls (#nothing)
  - igs_forced_stop_wrapper_t (external_stop_calbacks)
     - executed by s_run_loop (loop stopping) (#nothing)
  - igsagent_wrapper_t (activate_callbacks)
@@ -657,19 +1226,172 @@ INGESCAPE_EXPORT int split_message_from_splitter(zmsg_t *msg, igs_core_context_t
 #define IGS_MODEL_READ_WRITE_MUTEX_DEBUG 0
 INGESCAPE_EXPORT void model_read_write_lock(const char *function, int line);
 INGESCAPE_EXPORT void model_read_write_unlock(const char *function, int line);
+INGESCAPE_EXPORT void model_read_lock(const char *function, int line); //shared, for pure getters only
+INGESCAPE_EXPORT void model_read_unlock(const char *function, int line);
+INGESCAPE_EXPORT void *model_lookup(zhashx_t *table, const char *key); //serialized zhashx_lookup, for read locked code
 INGESCAPE_EXPORT size_t model_clean_string(char *string, int64_t max); //returns number of changes
 INGESCAPE_EXPORT bool model_check_string(const char *string, int64_t max); //false if invalid, no limit if max <= 0
 INGESCAPE_EXPORT uint8_t *model_string_to_bytes (char *string);
 INGESCAPE_EXPORT igs_io_t* model_write (igsagent_t *agent, const char *io_name, igs_io_type_t type,
                                         igs_io_value_type_t val_type, void* value, size_t size);
+INGESCAPE_EXPORT igs_io_t* model_write_data (igsagent_t *agent, const char *io_name, igs_io_type_t type,
+                                             igs_io_value_type_t val_type, igs_data_t *data); //shares data with the io when possible
+//NB: string data shall include its terminating zero
 INGESCAPE_EXPORT void model_LOCKED_handle_io_callbacks (igsagent_t *agent, igs_io_t *io);
+INGESCAPE_EXPORT igs_data_t *model_data_new (void *data, size_t size, igs_data_free_fn *free_fn, void *hint);
+INGESCAPE_EXPORT igs_data_t *model_data_copy (const void *data, size_t size); //single allocation
+INGESCAPE_EXPORT igs_data_t *model_data_from_frame (zframe_t **frame, size_t offset); //takes frame ownership
+INGESCAPE_EXPORT igs_data_t *model_share_io_data (igs_io_t *io); //string and data values, NULL if none, borrowed reference
+INGESCAPE_EXPORT void model_free_io_data (igs_io_t *io); //string and data values
+INGESCAPE_EXPORT void model_free_io_callbacks (igs_io_callbacks_t **callbacks);
+// callbacks thread pool: tasks with the same agent and key are executed in
+// order by the same worker, model lock shall be held when posting. Each task
+// references its agent until it calls model_pool_task_done, so that an agent
+// destroyed meanwhile is freed by the last of its tasks.
+typedef void (model_pool_fn)(void *args);
+INGESCAPE_EXPORT bool model_pool_post (igsagent_t *agent, const char *key,
+                                       model_pool_fn *run, void *args); //false if task was not posted
+INGESCAPE_EXPORT void model_pool_task_done (igsagent_t *agent); //model unlocked, agent may be freed
+INGESCAPE_EXPORT void model_update_io_handle (igs_io_t *io);
+INGESCAPE_EXPORT void model_detach_io_handle (igs_io_t *io);
+INGESCAPE_EXPORT void model_attach_io_handles (igsagent_t *agent); //after definition has been replaced
+INGESCAPE_EXPORT void model_free_io_handles (igsagent_t *agent);
 INGESCAPE_EXPORT igs_io_t* model_find_io_by_name(igsagent_t *agent, const char* name, igs_io_type_t type);
+INGESCAPE_EXPORT igs_io_value_type_t model_get_io_value_type(igsagent_t *agent, const char* name, igs_io_type_t type); //model locked
 INGESCAPE_EXPORT igs_constraint_t* model_parse_constraint(igs_io_value_type_t type, const char *expression, char **error);
 
 // network
 #define IGS_PRIVATE_CHANNEL "INGESCAPE_PRIVATE"
 #define IGS_DEFAULT_AGENT_NAME "no_name"
-INGESCAPE_EXPORT igs_result_t network_publish_output (igsagent_t *agent, const igs_io_t *io);
+/*
+ Compact publications
+ --------------------
+ Since protocol v6, outputs are also published as a single frame with a
+ fixed binary header, avoiding string formatting and parsing on both sides:
+ - 1 byte: IGS_COMPACT_PUBLICATION_MARKER, which cannot start a legacy
+ "uuid-output" topic
+ - 8 bytes: topic, i.e. network_publication_topic (agent uuid, output name),
+ little endian
+ - 1 byte: value type, using IGS_TIMESTAMPED_*_T values for timestamped values
+ - 8 bytes: timestamp in microseconds, little endian, for timestamped values only
+ - remaining bytes: value (strings include their terminating zero)
+ The first 9 bytes are used as PUB/SUB filter. Compact subscriptions are
+ used with peers advertising protocol v6 or later. Legacy multi-frame
+ publications are still sent as long as peers not supporting compact
+ publications are present.
+ Topics are 64 bits hashes and several outputs of the agents in a peer may
+ share the same topic. These outputs are always published in legacy form as
+ well and subscribed to in legacy form, because publishers and subscribers
+ both know them from the definitions of the peer's agents. Only one of them
+ at a time, the topic owner, is also published in compact form, so that
+ subscriptions made before the collision is known never receive the values
+ of another output. Compact subscriptions are indexed by peer: topics of
+ outputs in different peers never collide.
+ */
+#define IGS_COMPACT_PUBLICATION_PROTOCOL 6
+#define IGS_COMPACT_PUBLICATION_MARKER 0x01
+#define IGS_COMPACT_PUBLICATION_FILTER_SIZE 9
+#define IGS_COMPACT_PUBLICATION_HEADER_SIZE 10
+#define IGS_MAX_REUSED_FRAME_SIZE 33 //ZeroMQ very small messages, copied by value
+/*
+ Batch publications
+ ------------------
+ Since protocol v7, several outputs of an agent can be published in a
+ single frame (see igs_output_batch_begin/commit and igs_rt_set_time):
+ - 1 byte: IGS_BATCH_PUBLICATION_MARKER
+ - IGS_AGENT_UUID_LENGTH bytes: uuid of the publishing agent
+ - for each output: 4 bytes for the entry size, little endian, followed
+ by the output as a compact publication (see above)
+ The first IGS_BATCH_PUBLICATION_HEADER_SIZE bytes are used as PUB/SUB
+ filter: peers subscribe to the batches of a remote agent as soon as they
+ have a compact subscription to one of its outputs, and ignore the entries
+ matching none of their compact subscriptions. Batch frames are only sent
+ when all the peers supporting compact publications also support batches:
+ otherwise, outputs in a batch are published individually.
+ Under the same condition, outputs published individually with a data value
+ use two frames: a compact publication without value, followed by a frame
+ sharing the value with ZeroMQ, without copy. Data values are received in
+ the same way, as views on the received frames (see igs_input_data_ref).
+ */
+#define IGS_BATCH_PUBLICATION_PROTOCOL 7
+#define IGS_BATCH_PUBLICATION_MARKER 0x02
+#define IGS_BATCH_PUBLICATION_HEADER_SIZE (1 + IGS_AGENT_UUID_LENGTH)
+#define IGS_BATCH_PUBLICATION_ENTRY_SIZE 4
+/*
+ Versioned updates
+ -----------------
+ Since protocol v8, definitions and mappings sent to a peer carry a version,
+ incremented each time they are sent: EXTERNAL_DEFINITION# gets two more
+ frames, the runtime activation flag ("0" or "1") and the version, and
+ EXTERNAL_MAPPING# gets the version as an additional frame. When all the
+ changes since the last version are IO creations or removals (resp. map
+ element additions or removals), peers receive a DEFINITION_DELTA (resp.
+ MAPPING_DELTA) message instead of the whole JSON document:
+ - agent uuid, base version, new version
+ - for each change: "+" or "-", followed by the IO type and name, and the
+ value type for IO creations (resp. the input, agent and output names)
+ A peer receiving a delta whose base version is not the one it knows
+ replies with GET_SNAPSHOT and the agent uuid, and receives the full
+ definition and mapping again.
+ */
+#define IGS_VERSIONED_UPDATES_PROTOCOL 8
+// apply the changes of a delta to a remote agent (model locked): IGS_FAILURE
+// when its base version is not ours or when it is invalid, a snapshot being needed
+INGESCAPE_EXPORT igs_result_t network_apply_definition_delta (igs_remote_agent_t *remote_agent, const char *base_version,
+                                                              const char *version, zmsg_t *msg);
+INGESCAPE_EXPORT igs_result_t network_apply_mapping_delta (igs_remote_agent_t *remote_agent, const char *base_version,
+                                                           const char *version, zmsg_t *msg);
+/*
+ Shared memory publications
+ --------------------------
+ When enabled (see igs_set_shm), a peer creates a POSIX shared memory
+ segment at start and advertises its name in the "shm" zyre header. Peers
+ on the same computer attach to the segments advertised by the others.
+ A segment starts with an igs_shm_header_t, followed by a ring of values
+ addressed by absolute positions, i.e. at position % capacity in the ring.
+ A data value published individually and larger than the threshold is
+ written once in the ring, and the IPC publisher sends, instead of the
+ compact publication of the value:
+ - the compact publication header, with IGS_SHM_PUBLICATION_FLAG added to
+ the value type, which is not part of the PUB/SUB filter
+ - a frame of IGS_SHM_DESCRIPTOR_SIZE bytes: position and size of the
+ value in the ring, both little endian on 8 bytes
+ Writers reserve the values by moving the reserved position forward and
+ never split a value around the end of the ring. Receivers copy the value
+ from the ring, then check that its bytes were not reserved again in the
+ meantime, i.e. that the reserved position is not beyond position + capacity:
+ values overwritten before being received are rejected. A peer which
+ attached to a segment confirms it to its owner with SHM_ATTACHED.
+ Descriptors are only sent when all the compact peers on the same computer
+ confirmed, never when security is enabled, and only for values smaller
+ than capacity / IGS_SHM_MAX_VALUE_RATIO.
+ */
+#define IGS_SHM_MAGIC 0x69677368
+#define IGS_SHM_HEADER_SIZE 64
+#define IGS_SHM_PUBLICATION_FLAG 0x80
+#define IGS_SHM_DESCRIPTOR_SIZE 16
+#define IGS_SHM_MAX_VALUE_RATIO 4
+#define IGS_SHM_DEFAULT_SIZE (64 * 1024 * 1024)
+#define IGS_SHM_DEFAULT_THRESHOLD (64 * 1024)
+INGESCAPE_EXPORT igs_result_t network_publish_output (igsagent_t *agent, igs_io_t *io);
+INGESCAPE_EXPORT igs_result_t network_publish_outputs (igsagent_t *agent, zlist_t *outputs); //igs_io_t
+INGESCAPE_EXPORT uint64_t network_publication_topic (const char *agent_uuid, const char *output_name);
+INGESCAPE_EXPORT void network_free_publication_cache (igs_publication_cache_t **cache);
+INGESCAPE_EXPORT void network_release_publication_caches (igsagent_t *agent);
+INGESCAPE_EXPORT void network_update_colliding_topics (igs_core_context_t *context);
+INGESCAPE_EXPORT bool network_is_protocol_command (const char *title);
+/*
+ Remote agents and zyre peers are indexed by name, in addition to their
+ uuid and peer id, so that messages and service calls addressed by name
+ do not iterate on all of them. These functions return a new list (to be
+ destroyed by the caller) of the remote agents, resp. peers, whose name or
+ uuid matches, each agent or peer appearing once. They shall be called
+ inside the model lock.
+ */
+INGESCAPE_EXPORT zlist_t *network_remote_agents_named (const char *name_or_uuid); //igs_remote_agent_t
+INGESCAPE_EXPORT zlist_t *network_zyre_peers_named (const char *name_or_peer_id); //igs_zyre_peer_t
+INGESCAPE_EXPORT void network_local_queue_destroy (igs_local_queue_t **queue);
+INGESCAPE_EXPORT bool network_is_loop_thread (void); //true in the ingescape loop and its callbacks
 
 // parser
 INGESCAPE_EXPORT igs_definition_t *parser_parse_definition_from_node (igs_json_node_t **json);
@@ -686,6 +1408,11 @@ INGESCAPE_EXPORT igs_mapping_t* parser_load_mapping_from_path (const char* load_
 // admin
 INGESCAPE_EXPORT void admin_make_file_path(const char *from, char *to, size_t size_of_to);
 INGESCAPE_EXPORT void admin_log(igsagent_t *agent, igs_log_level_t, const char *function, const char *format, ...)  CHECK_PRINTF (4);
+INGESCAPE_EXPORT void admin_log_lock(void); //protects log file and stream against the log writer
+INGESCAPE_EXPORT void admin_log_unlock(void);
+INGESCAPE_EXPORT void admin_stop_log_writer(void); //writes the waiting logs and frees the log queue
+#define IGS_LOG_QUEUE_DEFAULT_CAPACITY 4096
+#define IGS_LOG_WRITER_BATCH 256
 
 // channels
 #define IGS_ZYRE_PEER_MUTEX_DEBUG 0
@@ -699,16 +1426,41 @@ INGESCAPE_EXPORT igs_result_t service_make_values_to_arguments_from_message(igs_
 INGESCAPE_EXPORT void service_free_values_in_arguments(zlist_t *args);
 INGESCAPE_EXPORT void service_log_received_service(igsagent_t *agent, const char *caller_agent_name, const char *caller_agentuuid,
                                                    const char *service_name, igs_service_arg_t *args, int64_t timestamp);
+#define IGS_SERVICE_CALL_DEADLINE_CHECK 10 //ms, resolution of asynchronous service calls timeouts
+INGESCAPE_EXPORT char * service_call_async(igsagent_t *agent, const char *agent_name_or_uuid, const char *service_name,
+                                           igs_service_arg_t **list, unsigned int timeout_ms,
+                                           igsagent_service_reply_fn agent_cb, igs_service_reply_fn cb, void *my_data);
+//pending calls are removed from core_context->pending_service_calls by the functions below (model locked)
+INGESCAPE_EXPORT igs_pending_service_call_t * service_take_pending_call(igsagent_t *agent, const char *token);
+INGESCAPE_EXPORT zlist_t * service_take_expired_calls(int64_t now); //NULL if none
+INGESCAPE_EXPORT void service_restore_pending_call(igs_pending_service_call_t *call); //puts back a taken call (model locked)
+INGESCAPE_EXPORT igs_result_t service_make_reply_arguments_from_message(igs_service_arg_t **args, igs_remote_agent_t *replier,
+                                                                         const char *service_name, const char *reply_name,
+                                                                         zmsg_t *msg);
+//triggers the call callback and frees the call (model unlocked)
+INGESCAPE_EXPORT void service_complete_pending_call(igs_pending_service_call_t **call, const char *replier_agent_name,
+                                                    const char *replier_agent_uuid, const char *reply_name,
+                                                    igs_service_arg_t *args, igs_service_call_status_t status);
+INGESCAPE_EXPORT void service_cancel_pending_calls(igsagent_t *agent); //model unlocked
+INGESCAPE_EXPORT void service_free_pending_calls(void);
 
 // agent
 INGESCAPE_EXPORT void agent_LOCKED_propagate_agent_event(igs_agent_event_t event, const char *uuid, const char *name, void *event_data);
 
+// local publications (see igs_local_queue_set_policy)
+#define LOCAL_PUBLICATIONS_CMD "LOCAL_PUBLICATIONS" //sent on the parent pipe when the queue is not empty
+#define IGS_LOCAL_QUEUE_DEFAULT_CAPACITY 4096
+#define IGS_LOCAL_QUEUE_BATCH 64 //local publications handled at once in the model lock
+
 // protocol messages
 #define REMOTE_AGENT_EXIT_MSG "REMOTE_AGENT_EXIT"
 #define REMOTE_PEER_KNOWS_AGENT_MSG "REMOTE_PEER_KNOWS_AGENT"
 
 #define EXTERNAL_DEFINITION_MSG "EXTERNAL_DEFINITION#"
 #define EXTERNAL_MAPPING_MSG "EXTERNAL_MAPPING#"
+#define DEFINITION_DELTA_MSG "DEFINITION_DELTA"
+#define MAPPING_DELTA_MSG "MAPPING_DELTA"
+#define GET_SNAPSHOT_MSG "GET_SNAPSHOT"
 
 #define LOAD_DEFINITION_MSG "LOAD_THIS_DEFINITION#"
 #define LOAD_MAPPING_MSG "LOAD_THIS_MAPPING#"
@@ -763,6 +1515,9 @@ INGESCAPE_EXPORT void agent_LOCKED_propagate_agent_event(igs_agent_event_t event
 #define WORKER_GOODBYE_MSG "WORKER_GOODBYE"
 #define WORKER_READY_MSG "WORKER_READY"
 #define SPLITTER_WORK_MSG "SPLITTER_WORK"
+#define WORKER_CREDIT_MSG "WORKER_CREDIT"
+#define SPLITTER_WORKS_MSG "SPLITTER_WORKS"
+#define SHM_ATTACHED_MSG "SHM_ATTACHED"
 
 #define SET_DEFINITION_PATH_MSG "SET_DEFINITION_PATH"
 #define DEFINITION_FILE_PATH_MSG "DEFINITION_FILE_PATH"
@@ -20,7 +20,7 @@
 #include "ingescape_classes.h"
 #include "ingescape_private.h"
 
-#define INGESCAPE_PROTOCOL 5
+#define INGESCAPE_PROTOCOL 9
 #define NUMBER_OF_LOGS_FOR_FFLUSH 0
 
 #ifndef W_OK
@@ -61,6 +61,393 @@ void admin_make_file_path (const char *from, char *to, size_t size_of_to)
         strncpy (to, from, size_of_to);
 }
 
+void s_admin_lock_init (void)
+{
+    if (!s_lock_initialized) {
+        IGS_MUTEX_INIT (lock);
+        s_lock_initialized = true;
+    }
+}
+
+int64_t s_log_timestamp (void)
+{
+#if defined(__WINDOWS__)
+    return zclock_time () * 1000;
+#else
+    struct timeval tick;
+    gettimeofday (&tick, NULL);
+    return (int64_t) tick.tv_sec * 1000000 + tick.tv_usec;
+#endif
+}
+
+// log content for file and stream, with escaped line breaks
+char *s_log_rectify (const char *content, size_t max_length)
+{
+    char *rectified = (char *) zmalloc (max_length * 2 + 1);
+    size_t j = 0;
+    for (size_t i = 0; i < max_length && content[i] != '\0'; i++) {
+        if (content[i] == '\n') {
+            rectified[j++] = '\\';
+            rectified[j++] = 'n';
+        } else
+            rectified[j++] = content[i];
+    }
+    rectified[j] = '\0';
+    return rectified;
+}
+
+// NB: the functions below are called with the admin lock held
+void s_log_to_file (const char *agent_name, igs_log_level_t level, const char *function,
+                    const char *content, int64_t timestamp, bool is_batched)
+{
+    if (!core_context->log_file && strlen (core_context->log_file_path) == 0) {
+        // Current path is empty and log file is not already initiated, create
+        // file with default path
+        char buff[IGS_MAX_PATH_LENGTH] = "";
+        snprintf (core_context->log_file_path, IGS_MAX_PATH_LENGTH, IGS_DEFAULT_LOG_DIR);
+        strncpy (buff, core_context->log_file_path, IGS_MAX_PATH_LENGTH);
+        admin_make_file_path (buff, core_context->log_file_path, IGS_MAX_PATH_LENGTH);
+        if (!zsys_file_exists (core_context->log_file_path)) {
+            printf ("creating log dir %s\n", core_context->log_file_path);
+            if (zsys_dir_create (core_context->log_file_path) != 0)
+                printf ("error while creating log dir %s\n", core_context->log_file_path);
+        }
+        strncat (core_context->log_file_path, agent_name, IGS_MAX_PATH_LENGTH);
+        strncat (core_context->log_file_path, ".log", IGS_MAX_PATH_LENGTH);
+        printf ("using log file %s\n", core_context->log_file_path);
+        if (core_context && core_context->node) {
+            igsagent_t *a = zhashx_first(core_context->agents);
+            while (a) {
+                zmsg_t *msg = zmsg_new ();
+                zmsg_addstr (msg, LOG_FILE_PATH_MSG);
+                zmsg_addstr (msg, core_context->log_file_path);
+                zmsg_addstr (msg, a->uuid);
+                s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                zyre_shout (core_context->node, IGS_PRIVATE_CHANNEL, &msg);
+                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                a = zhashx_next(core_context->agents);
+            }
+        }
+    }
+    if (!core_context->log_file
+        || !zsys_file_exists (core_context->log_file_path)) {
+        core_context->log_file = fopen (core_context->log_file_path, "a");
+        if (!core_context->log_file)
+            printf ("error while trying to create/open log file: %s\n", core_context->log_file_path);
+    }
+    if (core_context->log_file) {
+        time_t seconds = (time_t) (timestamp / 1000000);
+        struct tm *tm = localtime (&seconds);
+        snprintf (log_time, LOG_TIME_LENGTH,
+                  "%02d/%02d/%d;%02d:%02d:%02d.%06d", tm->tm_mday,
+                  tm->tm_mon + 1, tm->tm_year + 1900, tm->tm_hour,
+                  tm->tm_min, tm->tm_sec, (int) (timestamp % 1000000));
+        if (fprintf (core_context->log_file, "%s;%s;%s;%s;%s\n",
+                     agent_name, log_time, log_levels[level],
+                     function, content) > 0) {
+            // batches are flushed once by the log writer
+            if (!is_batched && ++core_context->log_nb_of_entries > NUMBER_OF_LOGS_FOR_FFLUSH) {
+                core_context->log_nb_of_entries = 0;
+                fflush (core_context->log_file);
+            }
+        }
+        else
+            printf ("error while writing logs in %s\n", core_context->log_file_path);
+    }
+}
+
+void s_log_to_console (const char *agent_name, igs_log_level_t level, const char *function, const char *content)
+{
+    FILE *stream = (level >= IGS_LOG_WARN) ? stderr : stdout;
+    if (core_context->use_color_in_console)
+        fprintf (stream, "%s;%s%s\x1b[0m;%s;%s\n",
+                 agent_name, log_colors[level],
+                 log_levels[level], function, content);
+    else
+        fprintf (stream, "%s;%s;%s;%s\n", agent_name,
+                 log_levels[level], function, content);
+}
+
+void s_log_to_syslog (const char *agent_name, igs_log_level_t level, const char *function, const char *content)
+{
+#if defined (__UNIX__)
+#   if defined (__UTYPE_ANDROID)
+    int priority = ANDROID_LOG_DEFAULT;
+    switch (level) {
+        case IGS_LOG_FATAL:
+            priority = ANDROID_LOG_FATAL;
+            break;
+        case IGS_LOG_ERROR:
+            priority = ANDROID_LOG_ERROR;
+            break;
+        case IGS_LOG_WARN:
+            priority = ANDROID_LOG_WARN;
+            break;
+        case IGS_LOG_INFO:
+            priority = ANDROID_LOG_INFO;
+            break;
+        case IGS_LOG_DEBUG:
+            priority = ANDROID_LOG_DEBUG;
+            break;
+        case IGS_LOG_TRACE:
+            priority = ANDROID_LOG_VERBOSE;
+            break;
+            
+        default:
+            break;
+    }
+    __android_log_print(priority, agent_name, "%s;%s;%s",
+                        log_levels[level], function, content);
+#   else
+    int priority = LOG_DEBUG;
+    switch (level) {
+        case IGS_LOG_FATAL:
+            priority = LOG_CRIT;
+            break;
+        case IGS_LOG_ERROR:
+            priority = LOG_ERR;
+            break;
+        case IGS_LOG_WARN:
+            priority = LOG_WARNING;
+            break;
+        case IGS_LOG_INFO:
+            priority = LOG_NOTICE;
+            break;
+        case IGS_LOG_DEBUG:
+            priority = LOG_INFO;
+            break;
+        case IGS_LOG_TRACE:
+            priority = LOG_DEBUG;
+            break;
+            
+        default:
+            break;
+    }
+    syslog(priority, "%s;%s;%s;%s", agent_name,
+           log_levels[level], function, content);
+#   endif
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+// ASYNCHRONOUS LOGS
+////////////////////////////////////////////////////////////////////////
+
+igs_log_queue_t *s_log_queue_new (size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    igs_log_queue_t *queue = (igs_log_queue_t *) zmalloc (sizeof (igs_log_queue_t));
+    queue->cells = (igs_log_queue_cell_t *) zmalloc (size * sizeof (igs_log_queue_cell_t));
+    for (size_t i = 0; i < size; i++)
+        IGS_ATOMIC_INIT (queue->cells[i].sequence, i);
+    queue->mask = size - 1;
+    IGS_ATOMIC_INIT (queue->enqueue_position, 0);
+    IGS_ATOMIC_INIT (queue->dequeue_position, 0);
+    IGS_ATOMIC_INIT (queue->dropped, 0);
+    core_signal_init (&queue->room);
+    core_signal_init (&queue->records);
+    IGS_ATOMIC_INIT (queue->is_terminated, false);
+    return queue;
+}
+
+bool s_log_queue_push (igs_log_queue_t *queue, igs_log_record_t *record)
+{
+    igs_log_queue_cell_t *cell = NULL;
+    size_t position = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = IGS_ATOMIC_LOAD (cell->sequence, IGS_MEMORY_ORDER_ACQUIRE);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) position;
+        if (diff == 0) {
+            if (IGS_ATOMIC_COMPARE_EXCHANGE (queue->enqueue_position, position, position + 1, IGS_MEMORY_ORDER_RELAXED))
+                break;
+        } else if (diff < 0)
+            return false; //queue is full
+        else
+            position = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+    }
+    cell->record = record;
+    IGS_ATOMIC_STORE (cell->sequence, position + 1, IGS_MEMORY_ORDER_RELEASE);
+    return true;
+}
+
+igs_log_record_t *s_log_queue_pop (igs_log_queue_t *queue)
+{
+    igs_log_queue_cell_t *cell = NULL;
+    size_t position = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = IGS_ATOMIC_LOAD (cell->sequence, IGS_MEMORY_ORDER_ACQUIRE);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) (position + 1);
+        if (diff == 0) {
+            if (IGS_ATOMIC_COMPARE_EXCHANGE (queue->dequeue_position, position, position + 1, IGS_MEMORY_ORDER_RELAXED))
+                break;
+        } else if (diff < 0)
+            return NULL; //queue is empty
+        else
+            position = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+    }
+    igs_log_record_t *record = cell->record;
+    IGS_ATOMIC_STORE (cell->sequence, position + queue->mask + 1, IGS_MEMORY_ORDER_RELEASE);
+    return record;
+}
+
+// format the log in the calling thread, the outputs being handled
+// by the log writer
+void s_log_push (igsagent_t *agent, igs_log_level_t level, const char *function,
+                 const char *fmt, va_list list)
+{
+    bool to_file = (core_context->log_in_file && level >= core_context->log_file_level);
+    bool to_stream = (core_context->log_in_stream && core_context->logger);
+    bool to_syslog = core_context->log_in_syslog;
+    bool to_console = (core_context->log_in_console && level >= core_context->log_level);
+    if (!to_file && !to_stream && !to_syslog && !to_console)
+        return;
+    char content[IGS_MAX_LOG_LENGTH] = "";
+    va_list copy;
+    va_copy (copy, list);
+    int length = vsnprintf (content, IGS_MAX_LOG_LENGTH, fmt, copy);
+    va_end (copy);
+    if (length < 0)
+        return;
+    if (to_console)
+        s_log_to_console (agent->definition->name, level, function, content);
+    if (!to_file && !to_stream && !to_syslog)
+        return;
+
+    // file and stream logs may be longer than console and system logs
+    char *long_content = NULL;
+    size_t content_length = strlen (content);
+    if ((size_t) length >= IGS_MAX_LOG_LENGTH && (to_file || to_stream)
+        && core_context->log_file_max_line_length >= IGS_MAX_LOG_LENGTH) {
+        content_length = ((size_t) length < core_context->log_file_max_line_length) ?
+                         (size_t) length : core_context->log_file_max_line_length;
+        long_content = (char *) malloc (content_length + 1);
+        vsnprintf (long_content, content_length + 1, fmt, list);
+    }
+    size_t agent_name_length = strlen (agent->definition->name) + 1;
+    size_t function_length = strlen (function) + 1;
+    igs_log_record_t *record = (igs_log_record_t *) malloc (sizeof (igs_log_record_t) + agent_name_length
+                                                            + function_length + content_length + 1);
+    assert (record);
+    record->level = level;
+    record->timestamp = s_log_timestamp ();
+    record->to_file = to_file;
+    record->to_stream = to_stream;
+    record->to_syslog = to_syslog;
+    record->agent_name = (char *) (record + 1);
+    record->function = record->agent_name + agent_name_length;
+    record->content = record->function + function_length;
+    memcpy (record->agent_name, agent->definition->name, agent_name_length);
+    memcpy (record->function, function, function_length);
+    memcpy (record->content, (long_content) ? long_content : content, content_length);
+    record->content[content_length] = '\0';
+    if (long_content)
+        free (long_content);
+
+    igs_log_queue_t *queue = core_context->log_queue;
+    while (!s_log_queue_push (queue, record)) {
+        if (core_context->log_queue_policy == IGS_LOG_QUEUE_DROP_OLDEST) {
+            igs_log_record_t *oldest = s_log_queue_pop (queue);
+            if (oldest) {
+                free (oldest);
+                IGS_ATOMIC_FETCH_ADD (queue->dropped, 1, IGS_MEMORY_ORDER_RELAXED);
+            }
+        } else if (core_context->log_queue_policy == IGS_LOG_QUEUE_BLOCK && core_context->log_writer) {
+            // the writer wakes us up when it pops logs or stops
+            uint64_t count = core_signal_prepare (&queue->room);
+            size_t dequeued = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+            size_t enqueued = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+            if (core_context->log_writer && enqueued - dequeued > queue->mask)
+                core_signal_wait (&queue->room, count);
+            else
+                core_signal_cancel (&queue->room);
+        } else {
+            free (record);
+            IGS_ATOMIC_FETCH_ADD (queue->dropped, 1, IGS_MEMORY_ORDER_RELAXED);
+            break;
+        }
+    }
+    core_signal_notify (&queue->records);
+}
+
+// write the waiting logs by batches, flushing the log file once per batch
+void s_log_writer_drain (igs_log_queue_t *queue)
+{
+    igs_log_record_t *batch[IGS_LOG_WRITER_BATCH];
+    size_t nb_records = 0;
+    do {
+        nb_records = 0;
+        while (nb_records < IGS_LOG_WRITER_BATCH
+               && (batch[nb_records] = s_log_queue_pop (queue)) != NULL)
+            nb_records++;
+        if (nb_records == 0)
+            break;
+        core_signal_notify (&queue->room); //producers blocked on a full queue
+        IGS_MUTEX_LOCK (lock);
+        bool has_file_logs = false;
+        for (size_t i = 0; i < nb_records; i++) {
+            igs_log_record_t *record = batch[i];
+            if ((record->to_stream && core_context->logger) || record->to_file) {
+                char *rectified = s_log_rectify (record->content, core_context->log_file_max_line_length);
+                if (record->to_stream && core_context->logger)
+                    zstr_sendf (core_context->logger, "%s;%s;%s;%s\n",
+                                record->agent_name, log_levels[record->level], record->function, rectified);
+                if (record->to_file) {
+                    s_log_to_file (record->agent_name, record->level, record->function,
+                                   rectified, record->timestamp, true);
+                    has_file_logs = true;
+                }
+                free (rectified);
+            }
+            if (record->to_syslog) {
+                snprintf (log_content, IGS_MAX_LOG_LENGTH, "%s", record->content);
+                s_log_to_syslog (record->agent_name, record->level, record->function, log_content);
+            }
+        }
+        if (has_file_logs && core_context->log_file)
+            fflush (core_context->log_file);
+        IGS_MUTEX_UNLOCK (lock);
+        for (size_t i = 0; i < nb_records; i++)
+            free (batch[i]);
+    } while (nb_records == IGS_LOG_WRITER_BATCH);
+}
+
+// The log writer sleeps until logs are pushed so that logging threads
+// never use its pipe. Waiting logs are written before it exits.
+void s_log_writer (zsock_t *pipe, void *args)
+{
+    igs_log_queue_t *queue = (igs_log_queue_t *) args;
+    zsock_signal (pipe, 0);
+    bool is_terminated = false;
+    while (!is_terminated) {
+        uint64_t count = core_signal_prepare (&queue->records);
+        is_terminated = IGS_ATOMIC_LOAD (queue->is_terminated, IGS_MEMORY_ORDER_ACQUIRE);
+        size_t dequeued = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+        size_t enqueued = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+        if (!is_terminated && enqueued == dequeued)
+            core_signal_wait (&queue->records, count);
+        else
+            core_signal_cancel (&queue->records);
+        s_log_writer_drain (queue);
+    }
+}
+
+// stop a log writer, outside the admin lock which it needs to write the
+// waiting logs, and release the producers waiting for it
+void s_log_writer_stop (zactor_t **writer, igs_log_queue_t *queue)
+{
+    assert (writer);
+    assert (*writer);
+    assert (queue);
+    IGS_ATOMIC_STORE (queue->is_terminated, true, IGS_MEMORY_ORDER_RELEASE);
+    core_signal_notify (&queue->records);
+    zactor_destroy (writer);
+    core_signal_notify (&queue->room);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // PRIVATE API
 ////////////////////////////////////////////////////////////////////////
@@ -94,39 +481,24 @@ void admin_log (igsagent_t *agent,
     assert (function);
     assert (fmt);
 
-    if (!s_lock_initialized) {
-        IGS_MUTEX_INIT (lock);
-        s_lock_initialized = true;
+    s_admin_lock_init ();
+    va_list list;
+    if (IGS_ATOMIC_LOAD (core_context->log_async, IGS_MEMORY_ORDER_ACQUIRE) && core_context->log_queue) {
+        va_start (list, fmt);
+        s_log_push (agent, level, function, fmt, list);
+        va_end (list);
+        return;
     }
     IGS_MUTEX_LOCK (lock);
     
     // generate log entries for stream and file
-    va_list list;
-    va_start (list, fmt);
-    size_t full_log_length = vsnprintf (NULL, 0, fmt, list);
-    va_end (list);
-    size_t full_log_length_offset = 0;
     char *full_log_content_rectified = NULL;
     if (core_context->log_in_file || (core_context->log_in_stream && core_context->logger)) {
-        full_log_content_rectified = (char*)zmalloc(core_context->log_file_max_line_length * 2 + 1);
         char *full_log_content = (char*)zmalloc(core_context->log_file_max_line_length + 1);
         va_start (list, fmt);
         vsnprintf (full_log_content, core_context->log_file_max_line_length + 1, fmt, list);
         va_end (list);
-        size_t j = 0;
-        for (size_t i = 0; i < full_log_length; i++) {
-            if (full_log_content[i] == '\n') {
-                full_log_content_rectified[j] = '\\';
-                full_log_content_rectified[j + 1] = 'n';
-                j++;
-                full_log_length_offset++;
-            } else if (full_log_content[i] == '\0')
-                break;
-            else
-                full_log_content_rectified[j] = full_log_content[i];
-            j++;
-        }
-        full_log_content_rectified[j] = '\0';
+        full_log_content_rectified = s_log_rectify (full_log_content, core_context->log_file_max_line_length);
         free(full_log_content);
     }
 
@@ -135,72 +507,9 @@ void admin_log (igsagent_t *agent,
         zstr_sendf (core_context->logger, "%s;%s;%s;%s\n",
                     agent->definition->name, log_levels[level], function, full_log_content_rectified);
     
-    if (core_context->log_in_file && level >= core_context->log_file_level) {
-        full_log_content_rectified[full_log_length + full_log_length_offset] = '\0';
-        if (!core_context->log_file && strlen (core_context->log_file_path) == 0) {
-            // Current path is empty and log file is not already initiated, create
-            // file with default path
-            char buff[IGS_MAX_PATH_LENGTH] = "";
-            snprintf (core_context->log_file_path, IGS_MAX_PATH_LENGTH, IGS_DEFAULT_LOG_DIR);
-            strncpy (buff, core_context->log_file_path, IGS_MAX_PATH_LENGTH);
-            admin_make_file_path (buff, core_context->log_file_path, IGS_MAX_PATH_LENGTH);
-            if (!zsys_file_exists (core_context->log_file_path)) {
-                printf ("creating log dir %s\n", core_context->log_file_path);
-                if (zsys_dir_create (core_context->log_file_path) != 0)
-                    printf ("error while creating log dir %s\n", core_context->log_file_path);
-            }
-            strncat (core_context->log_file_path, agent->definition->name, IGS_MAX_PATH_LENGTH);
-            strncat (core_context->log_file_path, ".log", IGS_MAX_PATH_LENGTH);
-            printf ("using log file %s\n", core_context->log_file_path);
-            if (core_context && core_context->node) {
-                igsagent_t *a = zhashx_first(core_context->agents);
-                while (a) {
-                    zmsg_t *msg = zmsg_new ();
-                    zmsg_addstr (msg, LOG_FILE_PATH_MSG);
-                    zmsg_addstr (msg, core_context->log_file_path);
-                    zmsg_addstr (msg, a->uuid);
-                    s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                    zyre_shout (core_context->node, IGS_PRIVATE_CHANNEL, &msg);
-                    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-                    a = zhashx_next(core_context->agents);
-                }
-            }
-        }
-        if (!core_context->log_file
-            || !zsys_file_exists (core_context->log_file_path)) {
-            core_context->log_file = fopen (core_context->log_file_path, "a");
-            if (!core_context->log_file)
-                printf ("error while trying to create/open log file: %s\n", core_context->log_file_path);
-        }
-        if (core_context->log_file) {
-#if defined(__WINDOWS__)
-            SYSTEMTIME lt;
-            GetLocalTime (&lt);
-            snprintf (log_time, LOG_TIME_LENGTH,
-                      "%02d/%02d/%d;%02d:%02d:%02d.%06ld", lt.wDay, lt.wMonth,
-                      lt.wYear, lt.wHour, lt.wMinute, lt.wSecond,
-                      lt.wMilliseconds);
-#else
-            struct timeval tick;
-            gettimeofday (&tick, NULL);
-            struct tm *tm = localtime (&tick.tv_sec);
-            snprintf (log_time, LOG_TIME_LENGTH,
-                      "%02d/%02d/%d;%02d:%02d:%02d.%06d", tm->tm_mday,
-                      tm->tm_mon + 1, tm->tm_year + 1900, tm->tm_hour,
-                      tm->tm_min, tm->tm_sec, (int) tick.tv_usec);
-#endif
-            if (fprintf (core_context->log_file, "%s;%s;%s;%s;%s\n",
-                         agent->definition->name, log_time, log_levels[level],
-                         function, full_log_content_rectified) > 0) {
-                if (++core_context->log_nb_of_entries > NUMBER_OF_LOGS_FOR_FFLUSH) {
-                    core_context->log_nb_of_entries = 0;
-                    fflush (core_context->log_file);
-                }
-            }
-            else
-                printf ("error while writing logs in %s\n", core_context->log_file_path);
-        }
-    }
+    if (core_context->log_in_file && level >= core_context->log_file_level)
+        s_log_to_file (agent->definition->name, level, function,
+                       full_log_content_rectified, s_log_timestamp (), false);
     
     if (core_context->log_in_syslog || (core_context->log_in_console && level >= core_context->log_level)){
         va_start (list, fmt);
@@ -208,86 +517,11 @@ void admin_log (igsagent_t *agent,
         va_end (list);
     }
     
-    if (core_context->log_in_console && level >= core_context->log_level) {
-        if (level >= IGS_LOG_WARN) {
-            if (core_context->use_color_in_console)
-                fprintf (stderr, "%s;%s%s\x1b[0m;%s;%s\n",
-                         agent->definition->name, log_colors[level],
-                         log_levels[level], function, log_content);
-            else
-                fprintf (stderr, "%s;%s;%s;%s\n", agent->definition->name,
-                         log_levels[level], function, log_content);
-        }
-        else {
-            if (core_context->use_color_in_console)
-                fprintf (stdout, "%s;%s%s\x1b[0m;%s;%s\n",
-                         agent->definition->name, log_colors[level],
-                         log_levels[level], function, log_content);
-            else
-                fprintf (stdout, "%s;%s;%s;%s\n", agent->definition->name,
-                         log_levels[level], function, log_content);
-        }
-    }
+    if (core_context->log_in_console && level >= core_context->log_level)
+        s_log_to_console (agent->definition->name, level, function, log_content);
     
-    if (core_context->log_in_syslog){
-#if defined (__UNIX__)
-#   if defined (__UTYPE_ANDROID)
-        int priority = ANDROID_LOG_DEFAULT;
-        switch (level) {
-            case IGS_LOG_FATAL:
-                priority = ANDROID_LOG_FATAL;
-                break;
-            case IGS_LOG_ERROR:
-                priority = ANDROID_LOG_ERROR;
-                break;
-            case IGS_LOG_WARN:
-                priority = ANDROID_LOG_WARN;
-                break;
-            case IGS_LOG_INFO:
-                priority = ANDROID_LOG_INFO;
-                break;
-            case IGS_LOG_DEBUG:
-                priority = ANDROID_LOG_DEBUG;
-                break;
-            case IGS_LOG_TRACE:
-                priority = ANDROID_LOG_VERBOSE;
-                break;
-                
-            default:
-                break;
-        }
-        __android_log_print(priority, agent->definition->name, "%s;%s;%s",
-                            log_levels[level], function, log_content);
-#   else
-        int priority = LOG_DEBUG;
-        switch (level) {
-            case IGS_LOG_FATAL:
-                priority = LOG_CRIT;
-                break;
-            case IGS_LOG_ERROR:
-                priority = LOG_ERR;
-                break;
-            case IGS_LOG_WARN:
-                priority = LOG_WARNING;
-                break;
-            case IGS_LOG_INFO:
-                priority = LOG_NOTICE;
-                break;
-            case IGS_LOG_DEBUG:
-                priority = LOG_INFO;
-                break;
-            case IGS_LOG_TRACE:
-                priority = LOG_DEBUG;
-                break;
-                
-            default:
-                break;
-        }
-        syslog(priority, "%s;%s;%s;%s", agent->definition->name,
-               log_levels[level], function, log_content);
-#   endif
-#endif
-    }
+    if (core_context->log_in_syslog)
+        s_log_to_syslog (agent->definition->name, level, function, log_content);
     
     if (full_log_content_rectified)
         free (full_log_content_rectified);
@@ -295,6 +529,38 @@ void admin_log (igsagent_t *agent,
     IGS_MUTEX_UNLOCK (lock);
 }
 
+void admin_log_lock (void)
+{
+    s_admin_lock_init ();
+    IGS_MUTEX_LOCK (lock);
+}
+
+void admin_log_unlock (void)
+{
+    IGS_MUTEX_UNLOCK (lock);
+}
+
+void admin_stop_log_writer (void)
+{
+    if (!core_context)
+        return;
+    IGS_ATOMIC_STORE (core_context->log_async, false, IGS_MEMORY_ORDER_RELEASE);
+    if (core_context->log_writer)
+        s_log_writer_stop (&core_context->log_writer, core_context->log_queue);
+    if (core_context->log_queue) {
+        igs_log_record_t *record = s_log_queue_pop (core_context->log_queue);
+        while (record) {
+            free (record);
+            record = s_log_queue_pop (core_context->log_queue);
+        }
+        core_signal_destroy (&core_context->log_queue->room);
+        core_signal_destroy (&core_context->log_queue->records);
+        free (core_context->log_queue->cells);
+        free (core_context->log_queue);
+        core_context->log_queue = NULL;
+    }
+}
+
 void igs_log_set_console_level (igs_log_level_t level)
 {
     core_init_agent ();
@@ -487,3 +753,57 @@ void igs_log_set_file_max_line_length (size_t size)
     core_init_agent ();
     core_context->log_file_max_line_length = size;
 }
+
+void igs_log_set_async (bool async)
+{
+    core_init_agent ();
+    zactor_t *stopped_writer = NULL;
+    admin_log_lock ();
+    if (async && !core_context->log_writer) {
+        if (!core_context->log_queue)
+            core_context->log_queue = s_log_queue_new ((core_context->log_queue_capacity > 0) ?
+                                                       core_context->log_queue_capacity :
+                                                       IGS_LOG_QUEUE_DEFAULT_CAPACITY);
+        IGS_ATOMIC_STORE (core_context->log_queue->is_terminated, false, IGS_MEMORY_ORDER_RELAXED);
+        core_context->log_writer = zactor_new (s_log_writer, core_context->log_queue);
+        IGS_ATOMIC_STORE (core_context->log_async, true, IGS_MEMORY_ORDER_RELEASE);
+    } else if (!async && core_context->log_writer) {
+        IGS_ATOMIC_STORE (core_context->log_async, false, IGS_MEMORY_ORDER_RELEASE);
+        stopped_writer = core_context->log_writer;
+        core_context->log_writer = NULL;
+    }
+    admin_log_unlock ();
+    // the writer handles the waiting logs before exiting
+    if (stopped_writer)
+        s_log_writer_stop (&stopped_writer, core_context->log_queue);
+}
+
+bool igs_log_async (void)
+{
+    core_init_agent ();
+    return IGS_ATOMIC_LOAD (core_context->log_async, IGS_MEMORY_ORDER_ACQUIRE);
+}
+
+void igs_log_set_queue_capacity (size_t capacity)
+{
+    core_init_agent ();
+    admin_log_lock ();
+    bool is_created = (core_context->log_queue != NULL);
+    if (!is_created)
+        core_context->log_queue_capacity = capacity;
+    admin_log_unlock ();
+    if (is_created)
+        igs_error ("log queue capacity must be set before asynchronous logs are enabled");
+}
+
+void igs_log_set_queue_policy (igs_log_queue_policy_t policy)
+{
+    core_init_agent ();
+    core_context->log_queue_policy = policy;
+}
+
+size_t igs_log_dropped (void)
+{
+    core_init_agent ();
+    return (core_context->log_queue) ? IGS_ATOMIC_LOAD (core_context->log_queue->dropped, IGS_MEMORY_ORDER_SEQ_CST) : 0;
+}
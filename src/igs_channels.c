@@ -178,47 +178,45 @@ igs_result_t igs_channel_whisper_str (const char *agent_name_or_agent_id_or_peer
     }
     model_read_write_lock(__FUNCTION__, __LINE__);
     bool has_sent = false;
-    // we iterate first on agents
-    igs_remote_agent_t *agent = zhashx_first(core_context->remote_agents);
+    // we look first for agents
+    zlist_t *agents = network_remote_agents_named (agent_name_or_agent_id_or_peerid);
+    igs_remote_agent_t *agent = zlist_first(agents);
     while (agent) {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peerid)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peerid)) {
+        char content[IGS_MAX_STRING_MSG_LENGTH] = "";
+        va_list list;
+        va_start (list, msg);
+        vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
+        va_end (list);
+        zmsg_t *msg_to_send = zmsg_new ();
+        zmsg_addstr (msg_to_send, content);
+        zmsg_addstr (msg_to_send, agent->uuid);
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg_to_send) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        // NB: no break to support multiple agents with same name
+        agent = zlist_next(agents);
+    }
+    zlist_destroy(&agents);
+
+    // if no agent found, we look for peers
+    if (!has_sent) {
+        zlist_t *peers = network_zyre_peers_named (agent_name_or_agent_id_or_peerid);
+        igs_zyre_peer_t *el = zlist_first(peers);
+        while (el) {
             char content[IGS_MAX_STRING_MSG_LENGTH] = "";
             va_list list;
             va_start (list, msg);
             vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
             va_end (list);
-            zmsg_t *msg_to_send = zmsg_new ();
-            zmsg_addstr (msg_to_send, content);
-            zmsg_addstr (msg_to_send, agent->uuid);
             s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg_to_send) != 0)
+            if (zyre_whispers (core_context->node, el->peer_id, "%s", content) != 0)
                 res = IGS_FAILURE;
             s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            has_sent = true;
-            // NB: no break to support multiple agents with same name
-        }
-        agent = zhashx_next(core_context->remote_agents);
-    }
-
-    // if no agent found, we iterate on peers
-    if (!has_sent) {
-        igs_zyre_peer_t *el = zhashx_first(core_context->zyre_peers);
-        while (el) {
-            if (streq (el->name, agent_name_or_agent_id_or_peerid)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peerid)) {
-                char content[IGS_MAX_STRING_MSG_LENGTH] = "";
-                va_list list;
-                va_start (list, msg);
-                vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
-                va_end (list);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whispers (core_context->node, el->peer_id, "%s", content) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            }
-            el = zhashx_next(core_context->zyre_peers);
+            el = zlist_next(peers);
         }
+        zlist_destroy(&peers);
     }
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return res;
@@ -235,41 +233,39 @@ igs_result_t igs_channel_whisper_data (const char *agent_name_or_agent_id_or_pee
     model_read_write_lock(__FUNCTION__, __LINE__);
     bool has_sent = false;
     igs_result_t res = IGS_SUCCESS;
-    // we iterate first on agents
-    igs_remote_agent_t *agent = zhashx_first(core_context->remote_agents);
+    // we look first for agents
+    zlist_t *agents = network_remote_agents_named (agent_name_or_agent_id_or_peerid);
+    igs_remote_agent_t *agent = zlist_first(agents);
     while (agent) {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peerid)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peerid)) {
+        zframe_t *frame = zframe_new (data, size);
+        zmsg_t *msg = zmsg_new ();
+        zmsg_append (msg, &frame);
+        zmsg_addstr (msg, agent->uuid);
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        // NB: no break to support multiple agents with same name
+        agent = zlist_next(agents);
+    }
+    zlist_destroy(&agents);
+
+    // if no agent found, we look for peers
+    if (!has_sent) {
+        zlist_t *peers = network_zyre_peers_named (agent_name_or_agent_id_or_peerid);
+        igs_zyre_peer_t *el = zlist_first(peers);
+        while (el) {
             zframe_t *frame = zframe_new (data, size);
             zmsg_t *msg = zmsg_new ();
             zmsg_append (msg, &frame);
-            zmsg_addstr (msg, agent->uuid);
             s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg) != 0)
+            if (zyre_whisper (core_context->node, el->peer_id, &msg) != 0)
                 res = IGS_FAILURE;
             s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            has_sent = true;
-            // NB: no break to support multiple agents with same name
-        }
-        agent = zhashx_next(core_context->remote_agents);
-    }
-
-    // if no agent found, we iterate on peers
-    if (!has_sent) {
-        igs_zyre_peer_t *el = zhashx_first(core_context->zyre_peers);
-        while (el) {
-            if (streq (el->name, agent_name_or_agent_id_or_peerid)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peerid)) {
-                zframe_t *frame = zframe_new (data, size);
-                zmsg_t *msg = zmsg_new ();
-                zmsg_append (msg, &frame);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whisper (core_context->node, el->peer_id, &msg) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            }
-            el = zhashx_next(core_context->zyre_peers);
+            el = zlist_next(peers);
         }
+        zlist_destroy(&peers);
     }
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return res;
@@ -288,39 +284,36 @@ igs_result_t igs_channel_whisper_zmsg (const char *agent_name_or_agent_id_or_pee
     model_read_write_lock(__FUNCTION__, __LINE__);
     bool has_sent = false;
     igs_result_t res = IGS_SUCCESS;
-    // we iterate first on agents
-    igs_remote_agent_t *agent = zhashx_first(core_context->remote_agents);
+    // we look first for agents
+    zlist_t *agents = network_remote_agents_named (agent_name_or_agent_id_or_peer_id);
+    igs_remote_agent_t *agent = zlist_first(agents);
     while (agent) {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peer_id)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peer_id)) {
+        zmsg_t *dup = zmsg_dup (*msg_p);
+        zmsg_addstr ( dup, agent->uuid); // add agent uuid at the end of the message
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &dup) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        // NB: no break here to properly support multiple agents with same name
+        agent = zlist_next(agents);
+    }
+    zlist_destroy(&agents);
+
+    // if no agent found, we look for peers
+    if (!has_sent) {
+        zlist_t *peers = network_zyre_peers_named (agent_name_or_agent_id_or_peer_id);
+        igs_zyre_peer_t *el = zlist_first(peers);
+        while (el) {
             zmsg_t *dup = zmsg_dup (*msg_p);
-            zmsg_addstr ( dup, agent->uuid); // add agent uuid at the end of the message
             s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &dup) != 0)
+            if (zyre_whisper (core_context->node, el->peer_id, &dup) != 0)
                 res = IGS_FAILURE;
             s_unlock_zyre_peer (__FUNCTION__, __LINE__);
             has_sent = true;
-            // NB: no break here to properly support multiple agents with same name
-        }
-        agent = zhashx_next(core_context->remote_agents);
-    }
-
-    // if no agent found, we iterate on peers
-    if (!has_sent) {
-        igs_zyre_peer_t *el = zhashx_first(core_context->zyre_peers);
-        while (el) {
-            if (streq (el->name, agent_name_or_agent_id_or_peer_id)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peer_id)) {
-                zmsg_t *dup = zmsg_dup (*msg_p);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whisper (core_context->node, el->peer_id, &dup) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-                has_sent = true;
-            }
-            
-            el = zhashx_next(core_context->zyre_peers);
+            el = zlist_next(peers);
         }
+        zlist_destroy(&peers);
     }
 
     if (has_sent)
@@ -31,6 +31,88 @@ igs_core_context_t *core_context = NULL;
 igsagent_t *core_agent = NULL;
 
 //////////////////  CORE CONTEXT //////////////////
+// compact publication topics are 64 bits integers used as keys
+size_t s_core_topic_hasher (const void *key)
+{
+    return (size_t) *((const uint64_t *) key);
+}
+
+int s_core_topic_comparator (const void *item1, const void *item2)
+{
+    uint64_t topic1 = *((const uint64_t *) item1);
+    uint64_t topic2 = *((const uint64_t *) item2);
+    return (topic1 < topic2) ? -1 : ((topic1 > topic2) ? 1 : 0);
+}
+
+zhashx_t *core_new_topic_table (void)
+{
+    zhashx_t *table = zhashx_new ();
+    zhashx_set_key_hasher (table, s_core_topic_hasher);
+    zhashx_set_key_comparator (table, s_core_topic_comparator);
+    zhashx_set_key_duplicator (table, NULL);
+    zhashx_set_key_destructor (table, NULL);
+    return table;
+}
+
+void core_signal_init (igs_signal_t *signal)
+{
+    assert (signal);
+    IGS_MUTEX_INIT (signal->mutex);
+    IGS_COND_INIT (signal->cond);
+    signal->count = 0;
+    IGS_ATOMIC_INIT (signal->waiters, 0);
+}
+
+void core_signal_destroy (igs_signal_t *signal)
+{
+    assert (signal);
+    assert (IGS_ATOMIC_LOAD (signal->waiters, IGS_MEMORY_ORDER_RELAXED) == 0);
+    IGS_COND_DESTROY (signal->cond);
+    IGS_MUTEX_DESTROY (signal->mutex);
+}
+
+uint64_t core_signal_prepare (igs_signal_t *signal)
+{
+    assert (signal);
+    // registering before reading the count makes notifiers
+    // that change the condition afterwards see us
+    IGS_ATOMIC_FETCH_ADD (signal->waiters, 1, IGS_MEMORY_ORDER_SEQ_CST);
+    IGS_MUTEX_LOCK (signal->mutex);
+    uint64_t count = signal->count;
+    IGS_MUTEX_UNLOCK (signal->mutex);
+    return count;
+}
+
+void core_signal_wait (igs_signal_t *signal, uint64_t count)
+{
+    assert (signal);
+    IGS_MUTEX_LOCK (signal->mutex);
+    while (signal->count == count)
+        IGS_COND_WAIT (signal->cond, signal->mutex);
+    IGS_MUTEX_UNLOCK (signal->mutex);
+    IGS_ATOMIC_FETCH_SUB (signal->waiters, 1, IGS_MEMORY_ORDER_SEQ_CST);
+}
+
+void core_signal_cancel (igs_signal_t *signal)
+{
+    assert (signal);
+    IGS_ATOMIC_FETCH_SUB (signal->waiters, 1, IGS_MEMORY_ORDER_SEQ_CST);
+}
+
+void core_signal_notify (igs_signal_t *signal)
+{
+    assert (signal);
+    // pairs with the registration in core_signal_prepare: the condition
+    // has been changed before we read the number of waiters
+    IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_SEQ_CST);
+    if (IGS_ATOMIC_LOAD (signal->waiters, IGS_MEMORY_ORDER_SEQ_CST) == 0)
+        return;
+    IGS_MUTEX_LOCK (signal->mutex);
+    signal->count++;
+    IGS_COND_BROADCAST (signal->cond);
+    IGS_MUTEX_UNLOCK (signal->mutex);
+}
+
 void core_init_context (void)
 {
     if (!core_context) {
@@ -56,7 +138,12 @@ void core_init_context (void)
         core_context->agents = zhashx_new();
         core_context->created_agents = zhashx_new ();
         core_context->remote_agents = zhashx_new ();
-        core_context->splitters = zlist_new();
+        core_context->mapping_index = zhashx_new ();
+        core_context->splitters = zhashx_new ();
+        core_context->published_topics = core_new_topic_table ();
+        core_signal_init (&core_context->queue_room);
+        IGS_ATOMIC_INIT (core_context->log_async, false);
+        IGS_ATOMIC_INIT (core_context->pending_call_deadlines, 0);
         // default values for context variables
         // NB: other values stay at zero / NULL until they are changed
         // by other functions.
@@ -110,6 +197,9 @@ void igs_clear_context (void)
         return;
     igs_stop ();
     igs_monitor_stop ();
+    if (core_context->callbacks_pool_size > 0)
+        igs_set_callbacks_thread_pool (0);
+    admin_stop_log_writer ();
     
     model_read_write_lock(__FUNCTION__, __LINE__);
     
@@ -269,6 +359,19 @@ void igs_clear_context (void)
         zyre_cb = zlist_next(core_context->zyre_callbacks);
     }
     zlist_destroy(&core_context->zyre_callbacks);
+
+    if (core_context->private_commands) {
+        igs_private_command_t *private_command = zhashx_first(core_context->private_commands);
+        while (private_command) {
+            free(private_command->command);
+            free(private_command);
+            private_command = zhashx_next(core_context->private_commands);
+        }
+        zhashx_destroy(&core_context->private_commands);
+    }
+    service_free_pending_calls ();
+    if (core_context->local_queue)
+        network_local_queue_destroy (&core_context->local_queue);
     
     
     igsagent_t *a = (igsagent_t *) zhashx_first(core_context->created_agents);
@@ -282,13 +385,19 @@ void igs_clear_context (void)
     core_agent = NULL;
     
     zhashx_destroy(&core_context->agents);
+    mapping_index_destroy();
+    definition_free_remote_cache();
     
-    igs_splitter_t *splitter = zlist_first(core_context->splitters);
+    igs_splitter_t *splitter = zhashx_first(core_context->splitters);
     while (splitter) {
         split_free_splitter(&splitter);
-        splitter = zlist_next(core_context->splitters);
+        splitter = zhashx_next(core_context->splitters);
     }
-    zlist_destroy(&core_context->splitters);
+    zhashx_destroy(&core_context->splitters);
+    split_free_work_pool(core_context);
+    
+    // publication caches are owned by our outputs
+    zhashx_destroy(&core_context->published_topics);
     
     assert(core_context->network_actor == NULL);
     assert(core_context->internal_pipe == NULL);
@@ -299,6 +408,7 @@ void igs_clear_context (void)
     assert(core_context->logger == NULL);
     assert(core_context->loop == NULL);
     
+    core_signal_destroy(&core_context->queue_room);
     free (core_context);
     core_context = NULL;
     model_read_write_unlock(__FUNCTION__, __LINE__);
@@ -488,6 +598,12 @@ igs_result_t igs_output_data (const char *name, void **data, size_t *size)
     return igsagent_output_data (core_agent, name, data, size);
 }
 
+igs_io_handle_t *igs_input_handle (const char *name)
+{
+    core_init_agent ();
+    return igsagent_input_handle (core_agent, name);
+}
+
 bool igs_attribute_bool (const char *name)
 {
     core_init_agent ();
@@ -590,6 +706,19 @@ igs_result_t igs_output_set_data (const char *name, void *value, size_t size)
     return igsagent_output_set_data (core_agent, name, value, size);
 }
 
+igs_result_t igs_output_set_data_owned (const char *name, void *data, size_t size,
+                                        igs_data_free_fn *free_fn, void *hint)
+{
+    core_init_agent ();
+    return igsagent_output_set_data_owned (core_agent, name, data, size, free_fn, hint);
+}
+
+igs_data_t *igs_input_data_ref (const char *name)
+{
+    core_init_agent ();
+    return igsagent_input_data_ref (core_agent, name);
+}
+
 igs_result_t igs_attribute_set_bool (const char *name, bool value)
 {
     core_init_agent ();
@@ -807,6 +936,18 @@ bool igs_output_is_muted (const char *name)
     return igsagent_output_is_muted (core_agent, name);
 }
 
+igs_result_t igs_input_set_conflated (const char *name, bool conflated)
+{
+    core_init_agent ();
+    return igsagent_input_set_conflated (core_agent, name, conflated);
+}
+
+bool igs_input_is_conflated (const char *name)
+{
+    core_init_agent ();
+    return igsagent_input_is_conflated (core_agent, name);
+}
+
 igs_io_value_type_t igs_input_type (const char *name)
 {
     core_init_agent ();
@@ -1160,6 +1301,54 @@ igs_result_t igs_split_remove_with_name (const char *from_our_input,
                                             to_agent, with_output);
 }
 
+igs_result_t igs_split_set_credit (uint64_t the_id, int credit)
+{
+    core_init_agent ();
+    return igsagent_split_set_credit (core_agent, the_id, credit);
+}
+
+igs_result_t igs_output_split_balanced (const char *name)
+{
+    core_init_agent ();
+    return igsagent_output_split_balanced (core_agent, name);
+}
+
+igs_result_t igs_output_split_by_json_field (const char *name, const char *field_path)
+{
+    core_init_agent ();
+    return igsagent_output_split_by_json_field (core_agent, name, field_path);
+}
+
+igs_result_t igs_output_split_by_data_range (const char *name, size_t offset, size_t size)
+{
+    core_init_agent ();
+    return igsagent_output_split_by_data_range (core_agent, name, offset, size);
+}
+
+igs_result_t igs_output_split_by_key (const char *name, const char *key)
+{
+    core_init_agent ();
+    return igsagent_output_split_by_key (core_agent, name, key);
+}
+
+igs_split_mode_t igs_output_split_mode (const char *name)
+{
+    core_init_agent ();
+    return igsagent_output_split_mode (core_agent, name);
+}
+
+igs_result_t igs_output_set_split_queue (const char *name, size_t capacity, igs_split_queue_policy_t policy)
+{
+    core_init_agent ();
+    return igsagent_output_set_split_queue (core_agent, name, capacity, policy);
+}
+
+igs_result_t igs_output_split_queue_stats (const char *name, igs_split_queue_stats_t *stats)
+{
+    core_init_agent ();
+    return igsagent_output_split_queue_stats (core_agent, name, stats);
+}
+
 // admin
 
 void igs_mapping_set_outputs_request (bool notify)
@@ -1247,6 +1436,25 @@ igs_result_t igs_service_call (const char *agent_name_oruuid,
                                    list, token);
 }
 
+char * igs_service_call_async (const char *agent_name_or_uuid,
+                               const char *service_name,
+                               igs_service_arg_t **list,
+                               unsigned int timeout_ms,
+                               igs_service_reply_fn cb,
+                               void *my_data)
+{
+    core_init_agent ();
+    assert (cb);
+    return service_call_async (core_agent, agent_name_or_uuid, service_name,
+                               list, timeout_ms, NULL, cb, my_data);
+}
+
+igs_result_t igs_service_call_cancel (const char *token)
+{
+    core_init_agent ();
+    return igsagent_service_call_cancel (core_agent, token);
+}
+
 void core_service_callback (igsagent_t *agent,
                             const char *sender_agent_name,
                             const char *sender_agentuuid,
@@ -1482,7 +1690,6 @@ bool igs_rt_timestamps(void){
 void igs_rt_set_time(int64_t microseconds){
     core_init_agent ();
     model_read_write_lock(__FUNCTION__, __LINE__);
-    igs_info("set rt time to %lld", microseconds);
     core_context->rt_current_microseconds = microseconds;
     igsagent_t *agent = zhashx_first(core_context->agents);
     while (agent) {
@@ -1490,14 +1697,26 @@ void igs_rt_set_time(int64_t microseconds){
         if (agent->rt_synchronous_mode_enabled
             && agent->definition
             && agent->definition->outputs_table){
-            //iterate on outputs and publish them separately
-            //NB: we do not create a single gathering message because it would not be compatible
-            //with the mapping filters: only the 1st output would serve in the filter.
+            //publish outputs written since previous tick, or all outputs
+            //for keyframes, as a batch (see network_publish_outputs)
+            bool is_keyframe = false;
+            if (agent->rt_keyframe_interval > 0
+                && ++agent->rt_ticks_since_keyframe >= agent->rt_keyframe_interval){
+                is_keyframe = true;
+                agent->rt_ticks_since_keyframe = 0;
+            }
+            zlist_t *outputs = zlist_new();
             igs_io_t *io = zhashx_first(agent->definition->outputs_table);
             while (io) {
-                network_publish_output(agent, io);
+                if (io->is_dirty || is_keyframe){
+                    io->is_dirty = false;
+                    zlist_append(outputs, io);
+                }
                 io = zhashx_next(agent->definition->outputs_table);
             }
+            if (zlist_size(outputs) > 0)
+                network_publish_outputs(agent, outputs);
+            zlist_destroy(&outputs);
         }
         agent = zhashx_next(core_context->agents);
     }
@@ -1519,6 +1738,26 @@ bool igs_rt_synchronous_mode(void){
     return igsagent_rt_synchronous_mode(core_agent);
 }
 
+void igs_rt_set_keyframe_interval(unsigned int ticks){
+    core_init_agent ();
+    igsagent_rt_set_keyframe_interval(core_agent, ticks);
+}
+
+unsigned int igs_rt_keyframe_interval(void){
+    core_init_agent ();
+    return igsagent_rt_keyframe_interval(core_agent);
+}
+
+void igs_output_batch_begin(void){
+    core_init_agent ();
+    igsagent_output_batch_begin(core_agent);
+}
+
+igs_result_t igs_output_batch_commit(void){
+    core_init_agent ();
+    return igsagent_output_batch_commit(core_agent);
+}
+
 //DEPRECATED functions management for parameters
 igs_result_t igs_parameter_create(const char *name,
                                   igs_iop_value_type_t value_type,
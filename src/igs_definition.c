@@ -42,12 +42,8 @@ void s_definition_free_io (igs_io_t **io)
 
     switch ((*io)->value_type) {
         case IGS_STRING_T:
-            if ((*io)->value.s)
-                free ((char *) (*io)->value.s);
-            break;
         case IGS_DATA_T:
-            if ((*io)->value.data)
-                free ((*io)->value.data);
+            model_free_io_data(*io);
             break;
         default:
             break;
@@ -61,8 +57,14 @@ void s_definition_free_io (igs_io_t **io)
         }
         zlist_destroy(&(*io)->io_callbacks);
     }
+    model_free_io_callbacks(&(*io)->callbacks_snapshot);
     if ((*io)->constraint)
         definition_free_constraint(&(*io)->constraint);
+    if ((*io)->publication_cache)
+        network_free_publication_cache(&(*io)->publication_cache);
+    if ((*io)->handle)
+        model_detach_io_handle(*io);
+    split_clear_output_key(*io);
     if ((*io)->description)
         free((*io)->description);
     if ((*io)->detailed_type)
@@ -74,6 +76,16 @@ void s_definition_free_io (igs_io_t **io)
     *io = NULL;
 }
 
+void s_definition_free_delta (igs_definition_delta_t **delta)
+{
+    assert (delta);
+    assert (*delta);
+    if ((*delta)->name)
+        free ((*delta)->name);
+    free (*delta);
+    *delta = NULL;
+}
+
 igs_result_t definition_add_io_to_definition (igsagent_t *agent,
                                                igs_io_t *io,
                                                igs_io_type_t io_type,
@@ -104,6 +116,14 @@ igs_result_t definition_add_io_to_definition (igsagent_t *agent,
         case IGS_INPUT_T:
             zlist_append(def->inputs_names_ordered, strdup(io->name));
             zhashx_insert(def->inputs_table, io->name, io);
+            if (def == agent->definition && agent->io_handles) {
+                igs_io_handle_t *handle = zhashx_lookup(agent->io_handles, io->name);
+                if (handle) {
+                    handle->io = io;
+                    io->handle = handle;
+                    model_update_io_handle(io);
+                }
+            }
             break;
         case IGS_OUTPUT_T:
             zlist_append(def->outputs_names_ordered, strdup(io->name));
@@ -240,6 +260,9 @@ void definition_free_definition (igs_definition_t **def)
         service = zhashx_next((*def)->services_table);
     }
     zhashx_destroy(&(*def)->services_table);
+    if ((*def)->deltas)
+        definition_reset_deltas (*def);
+    zlist_destroy(&(*def)->deltas);
     free (*def);
     *def = NULL;
 }
@@ -259,9 +282,202 @@ void definition_update_json (igs_definition_t *def)
         free ((char *) def->json_legacy_v4);
         def->json_legacy_v4 = NULL;
     }
+    // legacy exports are generated on demand, for legacy peers only
     def->json = parser_export_definition (def);
-    def->json_legacy_v3 = parser_export_definition_legacy_v3 (def);
-    def->json_legacy_v4 = parser_export_definition_legacy_v4 (def);
+    def->revision++;
+}
+
+const char *definition_json_legacy_v3 (igs_definition_t *def)
+{
+    assert(def);
+    if (!def->json_legacy_v3)
+        def->json_legacy_v3 = parser_export_definition_legacy_v3 (def);
+    return def->json_legacy_v3;
+}
+
+const char *definition_json_legacy_v4 (igs_definition_t *def)
+{
+    assert(def);
+    if (!def->json_legacy_v4)
+        def->json_legacy_v4 = parser_export_definition_legacy_v4 (def);
+    return def->json_legacy_v4;
+}
+
+// FNV-1a, see http://www.isthe.com/chongo/tech/comp/fnv/
+uint64_t s_definition_content_hash (const char *str)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    while (*str) {
+        hash ^= (unsigned char) *str++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+igs_definition_t *definition_load_remote (const char *json_str)
+{
+    assert (json_str);
+    assert (core_context);
+    if (!core_context->remote_definitions)
+        core_context->remote_definitions = zhashx_new ();
+    char key[64] = "";
+    snprintf (key, sizeof (key), "%016llx-%zu",
+              (unsigned long long) s_definition_content_hash (json_str), strlen (json_str));
+    igs_remote_definition_t *entry = zhashx_lookup (core_context->remote_definitions, key);
+    if (entry && streq (entry->source, json_str)) {
+        entry->references++;
+        return entry->definition;
+    }
+
+    igs_definition_t *def = parser_load_definition (json_str);
+    if (!def)
+        return NULL;
+    definition_update_json (def);
+    if (!entry && def->name) {
+        // NB: in the very unlikely case of a hash collision, the
+        // definition remains private to its remote agent
+        entry = (igs_remote_definition_t *) zmalloc (sizeof (igs_remote_definition_t));
+        entry->key = strdup (key);
+        entry->source = strdup (json_str);
+        entry->definition = def;
+        entry->references = 1;
+        def->cache_key = entry->key;
+        zhashx_insert (core_context->remote_definitions, entry->key, entry);
+    }
+    return def;
+}
+
+void definition_release_remote (igs_definition_t **def)
+{
+    assert (def);
+    assert (*def);
+    igs_remote_definition_t *entry = ((*def)->cache_key && core_context->remote_definitions) ?
+        zhashx_lookup (core_context->remote_definitions, (*def)->cache_key) : NULL;
+    if (entry) {
+        assert (entry->definition == *def);
+        entry->references--;
+        if (entry->references == 0) {
+            zhashx_delete (core_context->remote_definitions, entry->key);
+            (*def)->cache_key = NULL;
+            definition_free_definition (def);
+            free (entry->key);
+            free (entry->source);
+            free (entry);
+        }
+        *def = NULL;
+    } else
+        definition_free_definition (def);
+}
+
+void definition_make_private (igs_definition_t **def)
+{
+    assert (def);
+    assert (*def);
+    if (!(*def)->cache_key)
+        return;
+    igs_definition_t *copy = parser_load_definition ((*def)->json);
+    assert (copy); //the definition has been loaded from the same JSON
+    definition_update_json (copy);
+    definition_release_remote (def);
+    *def = copy;
+}
+
+void definition_free_remote_cache (void)
+{
+    if (!core_context || !core_context->remote_definitions)
+        return;
+    // remote agents have all been released at this point
+    igs_remote_definition_t *entry = zhashx_first (core_context->remote_definitions);
+    while (entry) {
+        entry->definition->cache_key = NULL;
+        definition_free_definition (&entry->definition);
+        free (entry->key);
+        free (entry->source);
+        free (entry);
+        entry = zhashx_next (core_context->remote_definitions);
+    }
+    zhashx_destroy (&core_context->remote_definitions);
+}
+
+void definition_record_delta (igs_definition_t *def, igs_io_t *io, bool removed)
+{
+    assert (def);
+    assert (io);
+    assert (io->name);
+    if (!def->deltas)
+        def->deltas = zlist_new ();
+    igs_definition_delta_t *delta = (igs_definition_delta_t *) zmalloc (sizeof (igs_definition_delta_t));
+    delta->removed = removed;
+    delta->type = io->type;
+    delta->value_type = io->value_type;
+    delta->name = strdup (io->name);
+    zlist_append (def->deltas, delta);
+}
+
+bool definition_has_complete_deltas (igs_definition_t *def)
+{
+    assert (def);
+    // each recorded delta follows exactly one JSON update: any other
+    // change since the last publication requires a full snapshot
+    size_t nb_deltas = (def->deltas) ? zlist_size (def->deltas) : 0;
+    return (nb_deltas > 0 && nb_deltas == def->revision - def->published_revision);
+}
+
+void definition_reset_deltas (igs_definition_t *def)
+{
+    assert (def);
+    if (def->deltas) {
+        igs_definition_delta_t *delta = zlist_pop (def->deltas);
+        while (delta) {
+            s_definition_free_delta (&delta);
+            delta = zlist_pop (def->deltas);
+        }
+    }
+    def->published_revision = def->revision;
+}
+
+void definition_apply_delta (igs_definition_t *def, const char *name, igs_io_type_t type,
+                             igs_io_value_type_t value_type, bool removed)
+{
+    assert (def);
+    assert (name);
+    zlist_t *names = NULL;
+    zhashx_t *table = NULL;
+    switch (type) {
+        case IGS_INPUT_T:
+            names = def->inputs_names_ordered;
+            table = def->inputs_table;
+            break;
+        case IGS_OUTPUT_T:
+            names = def->outputs_names_ordered;
+            table = def->outputs_table;
+            break;
+        case IGS_ATTRIBUTE_T:
+            names = def->attributes_names_ordered;
+            table = def->attributes_table;
+            break;
+        default:
+            igs_error ("unknown IO type %d in definition delta", type);
+            return;
+    }
+    // NB: an IO may already be present or absent if the last snapshot
+    // we received was sent after the change, so that both operations
+    // replace the existing IO, if any
+    igs_io_t *io = zhashx_lookup (table, name);
+    if (io) {
+        zlist_remove (names, io->name);
+        zhashx_delete (table, name);
+        s_definition_free_io (&io);
+    }
+    if (!removed) {
+        io = (igs_io_t *) zmalloc (sizeof (igs_io_t));
+        io->io_callbacks = zlist_new ();
+        io->name = s_strndup (name, IGS_MAX_IO_NAME_LENGTH);
+        io->type = type;
+        io->value_type = value_type;
+        zlist_append (names, strdup (io->name));
+        zhashx_insert (table, io->name, io);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -491,6 +707,7 @@ igs_result_t igsagent_input_create (igsagent_t *agent,
         return IGS_FAILURE;
     }
     definition_update_json (agent->definition);
+    definition_record_delta (agent->definition, io, false);
     agent->network_need_to_send_definition_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
@@ -514,6 +731,7 @@ igs_result_t igsagent_output_create (igsagent_t *agent,
         return IGS_FAILURE;
     }
     definition_update_json (agent->definition);
+    definition_record_delta (agent->definition, io, false);
     agent->network_need_to_send_definition_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
@@ -537,6 +755,7 @@ igs_result_t igsagent_attribute_create (igsagent_t *agent,
         return IGS_FAILURE;
     }
     definition_update_json (agent->definition);
+    definition_record_delta (agent->definition, io, false);
     agent->network_need_to_send_definition_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
@@ -558,6 +777,7 @@ igs_result_t igsagent_input_remove (igsagent_t *agent, const char *name)
     }
     zlist_remove(agent->definition->inputs_names_ordered, io->name);
     zhashx_delete(agent->definition->inputs_table, io->name);
+    definition_record_delta (agent->definition, io, true);
     s_definition_free_io (&io);
     definition_update_json (agent->definition);
     agent->network_need_to_send_definition_update = true;
@@ -581,6 +801,7 @@ igs_result_t igsagent_output_remove (igsagent_t *agent, const char *name)
     }
     zlist_remove(agent->definition->outputs_names_ordered, io->name);
     zhashx_delete(agent->definition->outputs_table, io->name);
+    definition_record_delta (agent->definition, io, true);
     s_definition_free_io (&io);
     definition_update_json (agent->definition);
     agent->network_need_to_send_definition_update = true;
@@ -604,6 +825,7 @@ igs_result_t igsagent_attribute_remove (igsagent_t *agent, const char *name)
     }
     zlist_remove(agent->definition->attributes_names_ordered, io->name);
     zhashx_delete(agent->definition->attributes_table, io->name);
+    definition_record_delta (agent->definition, io, true);
     s_definition_free_io (&io);
     definition_update_json (agent->definition);
     agent->network_need_to_send_definition_update = true;
@@ -44,6 +44,20 @@ void s_mapping_free_mapping_element (igs_map_t **map_elmt)
     *map_elmt = NULL;
 }
 
+void s_mapping_free_delta (igs_mapping_delta_t **delta)
+{
+    assert (delta);
+    assert (*delta);
+    if ((*delta)->from_input)
+        free ((*delta)->from_input);
+    if ((*delta)->to_agent)
+        free ((*delta)->to_agent);
+    if ((*delta)->to_output)
+        free ((*delta)->to_output);
+    free (*delta);
+    *delta = NULL;
+}
+
 void mapping_free_mapping (igs_mapping_t **mapping)
 {
     assert (mapping);
@@ -70,6 +84,9 @@ void mapping_free_mapping (igs_mapping_t **mapping)
         current_split_elmt = zlist_next((*mapping)->split_elements);
     }
     zlist_destroy(&(*mapping)->split_elements);
+    if ((*mapping)->deltas)
+        mapping_reset_deltas (*mapping);
+    zlist_destroy(&(*mapping)->deltas);
     free (*mapping);
     *mapping = NULL;
 }
@@ -227,8 +244,201 @@ void mapping_update_json (igs_mapping_t *mapping)
         free ((char *) mapping->json_legacy);
         mapping->json_legacy = NULL;
     }
+    // legacy export is generated on demand, for legacy peers only
     mapping->json = parser_export_mapping (mapping);
-    mapping->json_legacy = parser_export_mapping_legacy (mapping);
+    mapping->revision++;
+}
+
+const char *mapping_json_legacy (igs_mapping_t *mapping)
+{
+    assert(mapping);
+    if (!mapping->json_legacy)
+        mapping->json_legacy = parser_export_mapping_legacy (mapping);
+    return mapping->json_legacy;
+}
+
+void mapping_record_delta (igs_mapping_t *mapping, igs_map_t *map_elmt, bool removed)
+{
+    assert (mapping);
+    assert (map_elmt);
+    if (!mapping->deltas)
+        mapping->deltas = zlist_new ();
+    igs_mapping_delta_t *delta = (igs_mapping_delta_t *) zmalloc (sizeof (igs_mapping_delta_t));
+    delta->removed = removed;
+    delta->from_input = strdup (map_elmt->from_input);
+    delta->to_agent = strdup (map_elmt->to_agent);
+    delta->to_output = strdup (map_elmt->to_output);
+    zlist_append (mapping->deltas, delta);
+}
+
+bool mapping_has_complete_deltas (igs_mapping_t *mapping)
+{
+    assert (mapping);
+    // each recorded delta follows exactly one JSON update: any other
+    // change since the last publication requires a full snapshot
+    size_t nb_deltas = (mapping->deltas) ? zlist_size (mapping->deltas) : 0;
+    return (nb_deltas > 0 && nb_deltas == mapping->revision - mapping->published_revision);
+}
+
+void mapping_reset_deltas (igs_mapping_t *mapping)
+{
+    assert (mapping);
+    if (mapping->deltas) {
+        igs_mapping_delta_t *delta = zlist_pop (mapping->deltas);
+        while (delta) {
+            s_mapping_free_delta (&delta);
+            delta = zlist_pop (mapping->deltas);
+        }
+    }
+    mapping->published_revision = mapping->revision;
+}
+
+void mapping_apply_delta (igs_mapping_t *mapping, const char *from_input,
+                          const char *to_agent, const char *to_output, bool removed)
+{
+    assert (mapping);
+    assert (from_input);
+    assert (to_agent);
+    assert (to_output);
+    size_t len = strlen (from_input) + strlen (to_agent) + strlen (to_output) + 2 + 1;
+    char *mashup = (char *) zmalloc (len * sizeof (char));
+    snprintf (mashup, len, "%s.%s.%s", from_input, to_agent, to_output);
+    uint64_t hash = mapping_djb2_hash ((unsigned char *) mashup);
+    free (mashup);
+
+    // NB: deltas are idempotent because the last snapshot we received
+    // may have been sent after the change
+    igs_map_t *map_elmt = zlist_first (mapping->map_elements);
+    while (map_elmt && map_elmt->id != hash)
+        map_elmt = zlist_next (mapping->map_elements);
+    if (removed && map_elmt) {
+        zlist_remove (mapping->map_elements, map_elmt);
+        s_mapping_free_mapping_element (&map_elmt);
+    } else if (!removed && !map_elmt) {
+        map_elmt = mapping_create_mapping_element (from_input, to_agent, to_output);
+        map_elmt->id = hash;
+        zlist_append (mapping->map_elements, map_elmt);
+    }
+}
+
+void s_mapping_free_mapping_target (igs_mapping_target_t **target)
+{
+    assert (target);
+    assert (*target);
+    if ((*target)->input_name)
+        free ((*target)->input_name);
+    free (*target);
+    *target = NULL;
+}
+
+void mapping_index_remove_agent (igsagent_t *agent)
+{
+    assert (agent);
+    if (!core_context || !core_context->mapping_index)
+        return;
+    zlist_t *empty_agents = zlist_new ();
+    zlist_autofree (empty_agents);
+    zhashx_t *outputs = zhashx_first (core_context->mapping_index);
+    while (outputs) {
+        zlist_t *empty_outputs = zlist_new ();
+        zlist_autofree (empty_outputs);
+        zlist_t *targets = zhashx_first (outputs);
+        while (targets) {
+            igs_mapping_target_t *target = zlist_first (targets);
+            while (target) {
+                if (target->agent == agent) {
+                    zlist_remove (targets, target);
+                    s_mapping_free_mapping_target (&target);
+                }
+                target = zlist_next (targets);
+            }
+            if (zlist_size (targets) == 0)
+                zlist_append (empty_outputs, (char *) zhashx_cursor (outputs));
+            targets = zhashx_next (outputs);
+        }
+        char *output_name = zlist_first (empty_outputs);
+        while (output_name) {
+            zlist_t *empty = zhashx_lookup (outputs, output_name);
+            zlist_destroy (&empty);
+            zhashx_delete (outputs, output_name);
+            output_name = zlist_next (empty_outputs);
+        }
+        zlist_destroy (&empty_outputs);
+        if (zhashx_size (outputs) == 0)
+            zlist_append (empty_agents, (char *) zhashx_cursor (core_context->mapping_index));
+        outputs = zhashx_next (core_context->mapping_index);
+    }
+    char *agent_name = zlist_first (empty_agents);
+    while (agent_name) {
+        zhashx_t *empty = zhashx_lookup (core_context->mapping_index, agent_name);
+        zhashx_destroy (&empty);
+        zhashx_delete (core_context->mapping_index, agent_name);
+        agent_name = zlist_next (empty_agents);
+    }
+    zlist_destroy (&empty_agents);
+}
+
+void mapping_index_update_agent (igsagent_t *agent)
+{
+    assert (agent);
+    if (!core_context || !core_context->mapping_index)
+        return;
+    mapping_index_remove_agent (agent);
+    if (!agent->uuid || !agent->mapping
+        || !zhashx_lookup (core_context->agents, agent->uuid))
+        return; //only active agents are indexed
+    igs_map_t *elmt = zlist_first (agent->mapping->map_elements);
+    while (elmt) {
+        zhashx_t *outputs = zhashx_lookup (core_context->mapping_index, elmt->to_agent);
+        if (!outputs) {
+            outputs = zhashx_new ();
+            zhashx_insert (core_context->mapping_index, elmt->to_agent, outputs);
+        }
+        zlist_t *targets = zhashx_lookup (outputs, elmt->to_output);
+        if (!targets) {
+            targets = zlist_new ();
+            zhashx_insert (outputs, elmt->to_output, targets);
+        }
+        igs_mapping_target_t *target = (igs_mapping_target_t *) zmalloc (sizeof (igs_mapping_target_t));
+        target->agent = agent;
+        target->input_name = strdup (elmt->from_input);
+        zlist_append (targets, target);
+        elmt = zlist_next (agent->mapping->map_elements);
+    }
+}
+
+void mapping_index_destroy (void)
+{
+    if (!core_context || !core_context->mapping_index)
+        return;
+    zhashx_t *outputs = zhashx_first (core_context->mapping_index);
+    while (outputs) {
+        zlist_t *targets = zhashx_first (outputs);
+        while (targets) {
+            igs_mapping_target_t *target = zlist_first (targets);
+            while (target) {
+                s_mapping_free_mapping_target (&target);
+                target = zlist_next (targets);
+            }
+            zlist_destroy (&targets);
+            targets = zhashx_next (outputs);
+        }
+        zhashx_destroy (&outputs);
+        outputs = zhashx_next (core_context->mapping_index);
+    }
+    zhashx_destroy (&core_context->mapping_index);
+}
+
+zlist_t *mapping_index_targets (const char *agent_name, const char *output_name)
+{
+    assert (agent_name);
+    assert (output_name);
+    if (!core_context || !core_context->mapping_index)
+        return NULL;
+    zhashx_t *outputs = zhashx_lookup (core_context->mapping_index, agent_name);
+    if (!outputs)
+        return NULL;
+    return zhashx_lookup (outputs, output_name);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -263,6 +473,7 @@ igs_result_t igsagent_mapping_load_str (igsagent_t *agent,
             mapping_free_mapping (&agent->mapping);
         agent->mapping = tmp;
         mapping_update_json(agent->mapping);
+        mapping_index_update_agent(agent);
         agent->network_need_to_send_mapping_update = true;
     }
     model_read_write_unlock(__FUNCTION__, __LINE__);
@@ -288,6 +499,7 @@ igs_result_t igsagent_mapping_load_file (igsagent_t *agent,
     agent->mapping_path = s_strndup (file_path, IGS_MAX_PATH_LENGTH - 1);
     agent->mapping = tmp;
     mapping_update_json(agent->mapping);
+    mapping_index_update_agent(agent);
     agent->network_need_to_send_mapping_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
@@ -305,6 +517,7 @@ void igsagent_clear_mappings (igsagent_t *agent)
     agent->mapping->map_elements = zlist_new();
     agent->mapping->split_elements = zlist_new();
     mapping_update_json(agent->mapping);
+    mapping_index_update_agent(agent);
     agent->network_need_to_send_mapping_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
@@ -327,8 +540,10 @@ void igsagent_clear_mappings_with_agent (igsagent_t *agent,
             }
             elmt = zlist_next(agent->mapping->map_elements);
         }
-        if (agent->network_need_to_send_mapping_update)
+        if (agent->network_need_to_send_mapping_update){
             mapping_update_json(agent->mapping);
+            mapping_index_update_agent(agent);
+        }
     }
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
@@ -352,8 +567,10 @@ void igsagent_clear_mappings_for_input (igsagent_t *agent,
         }
         elmt = zlist_next(agent->mapping->map_elements);
     }
-    if (agent->network_need_to_send_mapping_update)
+    if (agent->network_need_to_send_mapping_update){
         mapping_update_json(agent->mapping);
+        mapping_index_update_agent(agent);
+    }
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
 
@@ -428,6 +645,8 @@ uint64_t igsagent_mapping_add (igsagent_t *agent,
         new->id = hash;
         zlist_append(agent->mapping->map_elements, new);
         mapping_update_json(agent->mapping);
+        mapping_record_delta(agent->mapping, new, false);
+        mapping_index_update_agent(agent);
         agent->network_need_to_send_mapping_update = true;
     } else
         igsagent_debug (agent,"mapping combination %s->%s.%s already exists and will not be duplicated",
@@ -459,8 +678,10 @@ igs_result_t igsagent_mapping_remove_with_id (igsagent_t *agent,
         return IGS_FAILURE;
     }
     zlist_remove(agent->mapping->map_elements, lookup);
+    mapping_record_delta(agent->mapping, lookup, true);
     s_mapping_free_mapping_element (&lookup);
     mapping_update_json(agent->mapping);
+    mapping_index_update_agent(agent);
     agent->network_need_to_send_mapping_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
@@ -510,8 +731,10 @@ igs_result_t igsagent_mapping_remove_with_name (igsagent_t *agent,
         return IGS_FAILURE;
     }
     zlist_remove(agent->mapping->map_elements, lookup);;
+    mapping_record_delta(agent->mapping, lookup, true);
     s_mapping_free_mapping_element (&lookup);
     mapping_update_json(agent->mapping);
+    mapping_index_update_agent(agent);
     agent->network_need_to_send_mapping_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
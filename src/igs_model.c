@@ -27,13 +27,30 @@
 ////////////////////////////////////////////////////////////////////////
 #pragma mark INTERNAL FUNCTIONS
 ////////////////////////////////////////////////////////////////////////
+// zhashx_lookup updates the table's cached index, which makes it a write
+// for the hash table itself: lookups performed under the shared model lock
+// must thus be serialized between readers.
+static igs_mutex_t s_model_lookup_mutex;
+void *s_model_lookup (zhashx_t *table, const char *name)
+{
+    IGS_MUTEX_LOCK (s_model_lookup_mutex);
+    void *found = zhashx_lookup (table, name);
+    IGS_MUTEX_UNLOCK (s_model_lookup_mutex);
+    return found;
+}
+
+void *model_lookup (zhashx_t *table, const char *key)
+{
+    return s_model_lookup (table, key);
+}
+
 igs_io_t *s_model_find_input_by_name (igsagent_t *agent, const char *name)
 {
     assert(agent);
     assert(name);
     igs_io_t *found = NULL;
     if (name && agent->definition)
-        found = zhashx_lookup(agent->definition->inputs_table, name);
+        found = s_model_lookup(agent->definition->inputs_table, name);
     return found;
 }
 
@@ -43,7 +60,7 @@ igs_io_t *s_model_find_output_by_name (igsagent_t *agent, const char *name)
     assert(name);
     igs_io_t *found = NULL;
     if (name && agent->definition)
-        found = zhashx_lookup(agent->definition->outputs_table, name);
+        found = s_model_lookup(agent->definition->outputs_table, name);
     return found;
 }
 
@@ -53,10 +70,54 @@ igs_io_t *s_model_find_attribute_by_name (igsagent_t *agent, const char *name)
     assert(name);
     igs_io_t *found = NULL;
     if (name && agent->definition)
-        found = zhashx_lookup(agent->definition->attributes_table, name);
+        found = s_model_lookup(agent->definition->attributes_table, name);
     return found;
 }
 
+void s_model_store_io_handle (igs_io_handle_t *handle,
+                              igs_io_value_type_t value_type,
+                              uint64_t value)
+{
+    //single writer, protected by the model lock
+    unsigned int sequence = IGS_ATOMIC_LOAD (handle->sequence, IGS_MEMORY_ORDER_RELAXED);
+    IGS_ATOMIC_STORE (handle->sequence, sequence + 1, IGS_MEMORY_ORDER_RELAXED);
+    IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_RELEASE);
+    IGS_ATOMIC_STORE (handle->value_type, value_type, IGS_MEMORY_ORDER_RELAXED);
+    IGS_ATOMIC_STORE (handle->value, value, IGS_MEMORY_ORDER_RELAXED);
+    IGS_ATOMIC_STORE (handle->sequence, sequence + 2, IGS_MEMORY_ORDER_RELEASE);
+}
+
+void s_model_load_io_handle (igs_io_handle_t *handle,
+                             igs_io_value_type_t *value_type,
+                             uint64_t *value)
+{
+    unsigned int sequence = 0;
+    do {
+        sequence = IGS_ATOMIC_LOAD (handle->sequence, IGS_MEMORY_ORDER_ACQUIRE);
+        *value_type = (igs_io_value_type_t) IGS_ATOMIC_LOAD (handle->value_type, IGS_MEMORY_ORDER_RELAXED);
+        *value = IGS_ATOMIC_LOAD (handle->value, IGS_MEMORY_ORDER_RELAXED);
+        IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_ACQUIRE);
+    } while ((sequence & 1)
+             || sequence != IGS_ATOMIC_LOAD (handle->sequence, IGS_MEMORY_ORDER_RELAXED));
+}
+
+double s_model_io_handle_as_double (igs_io_value_type_t value_type, uint64_t value)
+{
+    double d = 0;
+    switch (value_type) {
+        case IGS_BOOL_T:
+        case IGS_INTEGER_T:
+            d = (int) (int64_t) value;
+            break;
+        case IGS_DOUBLE_T:
+            memcpy (&d, &value, sizeof (double));
+            break;
+        default:
+            break;
+    }
+    return d;
+}
+
 void *
 s_model_get_value_for (igsagent_t *agent, const char *name, igs_io_type_t type)
 {
@@ -488,7 +549,7 @@ char * s_model_get_description(igsagent_t *self, igs_io_type_t type,
     assert(name);
     igs_io_t *io = NULL;
     if (type == IGS_INPUT_T) {
-        io = zhashx_lookup (self->definition->inputs_table, name);
+        io = s_model_lookup (self->definition->inputs_table, name);
         if (!io) {
             igsagent_error (self, "Input %s cannot be found", name);
             return NULL;
@@ -496,7 +557,7 @@ char * s_model_get_description(igsagent_t *self, igs_io_type_t type,
     }
     else
         if (type == IGS_OUTPUT_T) {
-            io = zhashx_lookup (self->definition->outputs_table, name);
+            io = s_model_lookup (self->definition->outputs_table, name);
             if (!io) {
                 igsagent_error (self, "Output %s cannot be found", name);
                 return NULL;
@@ -504,7 +565,7 @@ char * s_model_get_description(igsagent_t *self, igs_io_type_t type,
         }
         else
             if (type == IGS_ATTRIBUTE_T) {
-                io = zhashx_lookup (self->definition->attributes_table, name);
+                io = s_model_lookup (self->definition->attributes_table, name);
                 if (!io) {
                     igsagent_error (self, "Parameter %s cannot be found", name);
                     return NULL;
@@ -573,7 +634,7 @@ igs_io_value_type_t s_model_get_type_for_io (igsagent_t *agent,
     assert (name && strlen (name) > 0);
     igs_io_t *io = NULL;
     if (type == IGS_INPUT_T) {
-        io = zhashx_lookup (agent->definition->inputs_table, name);
+        io = s_model_lookup (agent->definition->inputs_table, name);
         if (io == NULL) {
             igsagent_error (agent, "Input %s cannot be found", name);
             return IGS_UNKNOWN_T;
@@ -581,7 +642,7 @@ igs_io_value_type_t s_model_get_type_for_io (igsagent_t *agent,
     }
     else
         if (type == IGS_OUTPUT_T) {
-            io = zhashx_lookup (agent->definition->outputs_table, name);
+            io = s_model_lookup (agent->definition->outputs_table, name);
             if (io == NULL) {
                 igsagent_error (agent, "Output %s cannot be found", name);
                 return IGS_UNKNOWN_T;
@@ -589,7 +650,7 @@ igs_io_value_type_t s_model_get_type_for_io (igsagent_t *agent,
         }
         else
             if (type == IGS_ATTRIBUTE_T) {
-                io = zhashx_lookup (agent->definition->attributes_table, name);
+                io = s_model_lookup (agent->definition->attributes_table, name);
                 if (io == NULL) {
                     igsagent_error (agent, "Parameter %s cannot be found", name);
                     return IGS_UNKNOWN_T;
@@ -612,7 +673,7 @@ bool s_model_check_io_existence (igsagent_t *agent,
         igsagent_error (agent, "Definition is NULL");
         return false;
     }
-    igs_io_t *io = zhashx_lookup (hash, name);
+    igs_io_t *io = s_model_lookup (hash, name);
     return (io?true:false);
 }
 
@@ -694,6 +755,20 @@ static void s_model_observe (igsagent_t *agent,
     new_callback->callback_ptr = cb;
     new_callback->data = my_data;
     zlist_append (io->io_callbacks, new_callback);
+
+    // replace the callbacks snapshot, the previous one remaining valid
+    // for callbacks being currently executed
+    size_t count = zlist_size (io->io_callbacks);
+    igs_io_callbacks_t *callbacks = (igs_io_callbacks_t *) zmalloc (sizeof (igs_io_callbacks_t)
+                                                                    + count * sizeof (igs_observe_io_wrapper_t));
+    IGS_ATOMIC_INIT (callbacks->references, 1);
+    igs_observe_io_wrapper_t *wrapper = zlist_first (io->io_callbacks);
+    while (wrapper) {
+        callbacks->callbacks[callbacks->count++] = *wrapper;
+        wrapper = zlist_next (io->io_callbacks);
+    }
+    model_free_io_callbacks (&io->callbacks_snapshot);
+    io->callbacks_snapshot = callbacks;
 }
 
 void s_model_clear_io (igsagent_t *agent, const char *name, igs_io_type_t type)
@@ -707,18 +782,12 @@ void s_model_clear_io (igsagent_t *agent, const char *name, igs_io_type_t type)
         case IGS_IMPULSION_T:
             break;
         case IGS_DATA_T:
-            if (io->value.data) {
-                free (io->value.data);
-                io->value.data = NULL;
-                io->value_size = 0;
-            }
+            model_free_io_data (io);
+            io->value_size = 0;
             break;
         case IGS_STRING_T:
-            if (io->value.s) {
-                free (io->value.s);
-                io->value.s = NULL;
-                io->value_size = 0;
-            }
+            model_free_io_data (io);
+            io->value_size = 0;
             break;
         case IGS_DOUBLE_T:
             io->value.d = 0;
@@ -867,9 +936,30 @@ bool model_check_string(const char *string, int64_t max){
     return true;
 }
 
-igs_mutex_t s_model_read_write_mutex;
+igs_rwlock_t s_model_read_write_mutex;
 static bool s_model_read_write_mutex_initialized = false;
 static int s_model_lock_counter = 0;
+// the model lock is not recursive (see ingescape_private.h)
+static IGS_THREAD_LOCAL bool s_model_is_write_locked = false;
+static void s_model_init_locks (void)
+{
+    if (s_model_read_write_mutex_initialized)
+        return;
+#if defined (__UNIX__) && defined (__GLIBC__)
+    // glibc favors readers by default: frequent getters from application
+    // threads would then starve the network thread writing received values.
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init (&attr);
+    pthread_rwlockattr_setkind_np (&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init (&s_model_read_write_mutex, &attr);
+    pthread_rwlockattr_destroy (&attr);
+#else
+    IGS_RWLOCK_INIT (s_model_read_write_mutex);
+#endif
+    IGS_MUTEX_INIT (s_model_lookup_mutex);
+    s_model_read_write_mutex_initialized = true;
+}
+
 void model_read_write_lock (const char *function, int line)
 {
     if (IGS_MODEL_READ_WRITE_MUTEX_DEBUG){
@@ -877,11 +967,10 @@ void model_read_write_lock (const char *function, int line)
         if (s_model_lock_counter++)
             printf("---model_read_write_lock ACTIVE\n");
     }
-    if (!s_model_read_write_mutex_initialized) {
-        IGS_MUTEX_INIT (s_model_read_write_mutex);
-        s_model_read_write_mutex_initialized = true;
-    }
-    IGS_MUTEX_LOCK (s_model_read_write_mutex);
+    assert (!s_model_is_write_locked);
+    s_model_init_locks ();
+    IGS_RWLOCK_WRITE_LOCK (s_model_read_write_mutex);
+    s_model_is_write_locked = true;
 }
 
 void model_read_write_unlock (const char *function, int line)
@@ -891,12 +980,240 @@ void model_read_write_unlock (const char *function, int line)
         s_model_lock_counter--;
     }
     assert (s_model_read_write_mutex_initialized);
-    IGS_MUTEX_UNLOCK (s_model_read_write_mutex);
+    s_model_is_write_locked = false;
+    IGS_RWLOCK_WRITE_UNLOCK (s_model_read_write_mutex);
 }
 
-igs_io_t *model_write (igsagent_t *agent, const char *name,
-                       igs_io_type_t type, igs_io_value_type_t value_type,
-                       void *value, size_t size)
+void model_read_lock (const char *function, int line)
+{
+    if (IGS_MODEL_READ_WRITE_MUTEX_DEBUG)
+        printf("---model_read_lock from %s (line %d)\n", function, line);
+    assert (!s_model_is_write_locked);
+    s_model_init_locks ();
+    IGS_RWLOCK_READ_LOCK (s_model_read_write_mutex);
+}
+
+void model_read_unlock (const char *function, int line)
+{
+    if (IGS_MODEL_READ_WRITE_MUTEX_DEBUG)
+        printf("-model_read_unlock from %s (line %d)\n", function, line);
+    assert (s_model_read_write_mutex_initialized);
+    IGS_RWLOCK_READ_UNLOCK (s_model_read_write_mutex);
+}
+
+// worker of the callbacks thread pool, executing its tasks in order
+static void s_model_pool_worker (zsock_t *pipe, void *args)
+{
+    IGS_UNUSED (args)
+    zsock_set_unbounded (pipe);
+    zsock_signal (pipe, 0);
+    while (true) {
+        char *command = NULL;
+        void *run = NULL;
+        void *task = NULL;
+        if (zsock_recv (pipe, "spp", &command, &run, &task) != 0)
+            break; //interrupted
+        bool is_terminated = (!command || streq (command, "$TERM"));
+        if (!is_terminated && streq (command, "TASK") && run)
+            ((model_pool_fn *) run) (task);
+        free (command);
+        if (is_terminated)
+            break;
+    }
+}
+
+bool model_pool_post (igsagent_t *agent, const char *key, model_pool_fn *run, void *args)
+{
+    assert (agent);
+    assert (agent->uuid);
+    assert (key);
+    assert (run);
+    if (!core_context || core_context->callbacks_pool_size == 0)
+        return false;
+    // same agent and key, same worker: tasks are executed in order
+    uint64_t hash = network_publication_topic (agent->uuid, key);
+    zactor_t *worker = core_context->callbacks_pool[hash % core_context->callbacks_pool_size];
+    IGS_ATOMIC_FETCH_ADD (agent->pool_tasks, 1, IGS_MEMORY_ORDER_RELAXED);
+    if (zsock_send (worker, "spp", "TASK", run, args) != 0) {
+        IGS_ATOMIC_FETCH_SUB (agent->pool_tasks, 1, IGS_MEMORY_ORDER_RELAXED);
+        igs_error ("could not post task to the callbacks thread pool");
+        return false;
+    }
+    return true;
+}
+
+void model_pool_task_done (igsagent_t *agent)
+{
+    assert (agent);
+    // igsagent_destroy sets is_freed_by_pool under the write lock when
+    // tasks are pending: the last of them frees the agent
+    model_read_lock(__FUNCTION__, __LINE__);
+    size_t remaining = IGS_ATOMIC_FETCH_SUB (agent->pool_tasks, 1, IGS_MEMORY_ORDER_ACQ_REL) - 1;
+    bool must_free = (remaining == 0 && agent->is_freed_by_pool);
+    model_read_unlock(__FUNCTION__, __LINE__);
+    if (must_free)
+        free (agent);
+}
+
+void s_model_free_frame (void *data, void *hint)
+{
+    IGS_UNUSED (data)
+    zframe_t *frame = (zframe_t *) hint;
+    zframe_destroy (&frame);
+}
+
+void s_model_free_data (void *data, void *hint)
+{
+    IGS_UNUSED (hint)
+    free (data);
+}
+
+igs_data_t *model_data_new (void *data, size_t size, igs_data_free_fn *free_fn, void *hint)
+{
+    igs_data_t *buffer = (igs_data_t *) zmalloc (sizeof (igs_data_t));
+    IGS_ATOMIC_INIT (buffer->references, 1);
+    buffer->data = data;
+    buffer->size = size;
+    buffer->free_fn = free_fn;
+    buffer->hint = hint;
+    return buffer;
+}
+
+igs_data_t *model_data_copy (const void *data, size_t size)
+{
+    igs_data_t *buffer = (igs_data_t *) zmalloc (sizeof (igs_data_t) + size);
+    IGS_ATOMIC_INIT (buffer->references, 1);
+    buffer->data = buffer + 1;
+    buffer->size = size;
+    if (data && size > 0)
+        memcpy (buffer->data, data, size);
+    return buffer;
+}
+
+igs_data_t *model_data_from_frame (zframe_t **frame, size_t offset)
+{
+    assert (frame);
+    assert (*frame);
+    assert (offset <= zframe_size (*frame));
+    igs_data_t *buffer = model_data_new (zframe_data (*frame) + offset, zframe_size (*frame) - offset,
+                                         s_model_free_frame, *frame);
+    *frame = NULL;
+    return buffer;
+}
+
+igs_data_t *model_share_io_data (igs_io_t *io)
+{
+    assert (io);
+    if ((io->value_type != IGS_DATA_T && io->value_type != IGS_STRING_T) || !io->value.data)
+        return NULL;
+    if (!io->data_buffer)
+        // the io value becomes a shared buffer, without copy
+        io->data_buffer = model_data_new (io->value.data, io->value_size, s_model_free_data, NULL);
+    return io->data_buffer;
+}
+
+void model_free_io_data (igs_io_t *io)
+{
+    assert (io);
+    if (io->data_buffer)
+        igs_data_unref (&io->data_buffer);
+    else if (io->value.data)
+        free (io->value.data);
+    io->value.data = NULL;
+}
+
+void model_free_io_callbacks (igs_io_callbacks_t **callbacks)
+{
+    assert (callbacks);
+    if (*callbacks
+        && IGS_ATOMIC_FETCH_SUB ((*callbacks)->references, 1, IGS_MEMORY_ORDER_ACQ_REL) == 1)
+        free (*callbacks);
+    *callbacks = NULL;
+}
+
+// replace the value of a string io, sharing buffer when not NULL
+void s_model_set_string (igs_io_t *io, const char *value, igs_data_t *buffer)
+{
+    assert (io);
+    assert (value);
+    // value may be the current one of io: replace it before release
+    igs_data_t *data = (buffer) ? igs_data_ref (buffer) : model_data_copy (value, strlen (value) + 1);
+    model_free_io_data (io);
+    io->data_buffer = data;
+    io->value.s = (char *) io->data_buffer->data;
+    io->value_size = io->data_buffer->size;
+}
+
+void model_update_io_handle (igs_io_t *io)
+{
+    assert (io);
+    if (!io->handle)
+        return;
+    uint64_t value = 0;
+    switch (io->value_type) {
+        case IGS_BOOL_T:
+            value = io->value.b ? 1 : 0;
+            break;
+        case IGS_INTEGER_T:
+            value = (uint64_t) (int64_t) io->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            memcpy (&value, &io->value.d, sizeof (double));
+            break;
+        default:
+            break;
+    }
+    s_model_store_io_handle (io->handle, io->value_type, value);
+}
+
+void model_detach_io_handle (igs_io_t *io)
+{
+    assert (io);
+    if (!io->handle)
+        return;
+    io->handle->io = NULL;
+    s_model_store_io_handle (io->handle, IGS_UNKNOWN_T, 0);
+    io->handle = NULL;
+}
+
+void model_attach_io_handles (igsagent_t *agent)
+{
+    assert (agent);
+    if (!agent->io_handles || !agent->definition)
+        return;
+    igs_io_handle_t *handle = zhashx_first (agent->io_handles);
+    while (handle) {
+        igs_io_t *io = zhashx_lookup (agent->definition->inputs_table, handle->name);
+        if (io) {
+            handle->io = io;
+            io->handle = handle;
+            model_update_io_handle (io);
+        }
+        handle = zhashx_next (agent->io_handles);
+    }
+}
+
+void model_free_io_handles (igsagent_t *agent)
+{
+    assert (agent);
+    if (!agent->io_handles)
+        return;
+    igs_io_handle_t *handle = zhashx_first (agent->io_handles);
+    while (handle) {
+        if (handle->io)
+            handle->io->handle = NULL;
+        free (handle->name);
+        free (handle);
+        handle = zhashx_next (agent->io_handles);
+    }
+    zhashx_destroy (&agent->io_handles);
+}
+
+// write an io, sharing buffer instead of copying value for string
+// and data ios when buffer is not NULL
+igs_io_t *s_model_write (igsagent_t *agent, const char *name,
+                         igs_io_type_t type, igs_io_value_type_t value_type,
+                         void *value, size_t size, igs_data_t *buffer)
 {
     assert (agent);
     assert (name);
@@ -1050,24 +1367,19 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value.b = (value == NULL)? false : ((*(int *) (value)) ? true : false);
                     break;
                 case IGS_STRING_T: {
-                    if (io->value.s)
-                        free (io->value.s);
-                    if (!value)
-                        io->value.s = strdup ("");
+                    if (value == NULL)
+                        s_model_set_string (io, "", NULL);
                     else {
                         snprintf (buf, NUMBER_TO_STRING_MAX_LENGTH + 1, "%d",
-                                  (value == NULL) ? 0 : *(int *) (value));
-                        io->value.s = strdup (buf);
+                                  *(int *) (value));
+                        s_model_set_string (io, buf, NULL);
                     }
-                    io->value_size = (strlen (io->value.s) + 1) * sizeof (char);
                 } break;
                 case IGS_IMPULSION_T:
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
+                    model_free_io_data (io);
                     io->value.data = (void *) zmalloc (sizeof (int));
                     memcpy (io->value.data, value, sizeof (int));
                     io->value_size = sizeof (int);
@@ -1094,24 +1406,19 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value.b = (value == NULL) ? false : (((int) (*(double *) (value))) ? true : false);
                     break;
                 case IGS_STRING_T: {
-                    if (io->value.s)
-                        free (io->value.s);
                     if (value == NULL)
-                        io->value.s = strdup ("");
+                        s_model_set_string (io, "", NULL);
                     else {
                         snprintf (buf, NUMBER_TO_STRING_MAX_LENGTH + 1, "%lf",
-                                  (value == NULL) ? 0 : *(double *) (value));
-                        io->value.s = strdup (buf);
+                                  *(double *) (value));
+                        s_model_set_string (io, buf, NULL);
                     }
-                    io->value_size = (strlen (io->value.s) + 1) * sizeof (char);
                 } break;
                 case IGS_IMPULSION_T:
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
+                    model_free_io_data (io);
                     io->value.data = (void *) zmalloc (sizeof (double));
                     memcpy (io->value.data, value, sizeof (double));
                     io->value_size = sizeof (double);
@@ -1138,25 +1445,19 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value.b = (value == NULL) ? false : *(bool *) value;
                     break;
                 case IGS_STRING_T: {
-                    if (io->value.s)
-                        free (io->value.s);
                     if (value == NULL)
-                        io->value.s = strdup ("");
+                        s_model_set_string (io, "", NULL);
                     else {
                         snprintf (buf, NUMBER_TO_STRING_MAX_LENGTH + 1, "%d",
-                                  (value == NULL) ? 0 : *(bool *) value);
-                        io->value.s = strdup (buf);
+                                  *(bool *) value);
+                        s_model_set_string (io, buf, NULL);
                     }
-                    io->value_size =
-                    (strlen (io->value.s) + 1) * sizeof (char);
                 } break;
                 case IGS_IMPULSION_T:
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
+                    model_free_io_data (io);
                     io->value.data = (void *) zmalloc (sizeof (bool));
                     memcpy (io->value.data, value, sizeof (bool));
                     io->value_size = sizeof (bool);
@@ -1191,22 +1492,16 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value_size = sizeof (bool);
                     break;
                 case IGS_STRING_T: {
-                    if (io->value.s)
-                        free (io->value.s);
                     if (value == NULL)
-                        io->value.s = strdup ("");
+                        s_model_set_string (io, "", NULL);
                     else
-                        io->value.s = strdup ((char *) value);
-                    io->value_size =
-                    (strlen (io->value.s) + 1) * sizeof (char);
+                        s_model_set_string (io, (char *) value, buffer);
                 } break;
                 case IGS_IMPULSION_T:
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
+                    model_free_io_data (io);
                     size_t s = 0;
                     if (value) {
                         uint8_t *converted = model_string_to_bytes (value);
@@ -1241,18 +1536,13 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value.b = false;
                     break;
                 case IGS_STRING_T: {
-                    if (io->value.s)
-                        free (io->value.s);
-                    io->value.s = strdup ("");
-                    io->value_size = sizeof (char);
+                    s_model_set_string (io, "", NULL);
                 } break;
                 case IGS_IMPULSION_T:
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
+                    model_free_io_data (io);
                     io->value_size = 0;
                 } break;
                 default:
@@ -1283,11 +1573,10 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
                     io->value_size = 0;
                     break;
                 case IGS_DATA_T: {
-                    if (io->value.data)
-                        free (io->value.data);
-                    io->value.data = NULL;
-                    io->value.data = (void *) zmalloc (size);
-                    memcpy (io->value.data, value, size);
+                    igs_data_t *data = (buffer) ? igs_data_ref (buffer) : model_data_copy (value, size);
+                    model_free_io_data (io);
+                    io->data_buffer = data;
+                    io->value.data = io->data_buffer->data;
                     io->value_size = size;
                 } break;
                 default:
@@ -1301,6 +1590,9 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
     }
 
     if (ret) {
+        model_update_io_handle (io);
+        if (type == IGS_OUTPUT_T && agent->rt_synchronous_mode_enabled)
+            io->is_dirty = true; //see igs_rt_set_time
         // compose log entry
         const char *log_io_type = NULL;
         switch (type) {
@@ -1373,67 +1665,162 @@ igs_io_t *model_write (igsagent_t *agent, const char *name,
     return io;
 }
 
+igs_io_t *model_write (igsagent_t *agent, const char *name,
+                       igs_io_type_t type, igs_io_value_type_t value_type,
+                       void *value, size_t size)
+{
+    return s_model_write (agent, name, type, value_type, value, size, NULL);
+}
+
+igs_io_t *model_write_data (igsagent_t *agent, const char *name,
+                            igs_io_type_t type, igs_io_value_type_t value_type,
+                            igs_data_t *data)
+{
+    assert (data);
+    assert (value_type == IGS_DATA_T
+            || (value_type == IGS_STRING_T && data->size > 0
+                && ((const char *) data->data)[data->size - 1] == '\0'));
+    return s_model_write (agent, name, type, value_type, data->data, data->size, data);
+}
+
+// snapshot of an io for the execution of its callbacks without lock
+typedef struct igs_io_callbacks_task {
+    igsagent_t *agent; //pool tasks only, referenced until model_pool_task_done
+    char agent_uuid[IGS_AGENT_UUID_LENGTH + 1];
+    igs_io_callbacks_t *callbacks;
+    igs_io_type_t io_type;
+    char name[IGS_MAX_IO_NAME_LENGTH + 1];
+    igs_io_value_type_t value_type;
+    union {
+        int i;
+        double d;
+        bool b;
+    } scalar;
+    igs_data_t *buffer; //string and data values
+    size_t value_size;
+} igs_io_callbacks_task_t;
+
+void s_model_run_io_callbacks (igsagent_t *agent, igs_io_callbacks_task_t *task)
+{
+    assert (agent);
+    assert (task);
+    void *value = NULL;
+    switch (task->value_type) {
+        case IGS_BOOL_T:
+            value = &task->scalar.b;
+            break;
+        case IGS_INTEGER_T:
+            value = &task->scalar.i;
+            break;
+        case IGS_DOUBLE_T:
+            value = &task->scalar.d;
+            break;
+        case IGS_STRING_T:
+        case IGS_DATA_T:
+            value = (task->buffer) ? task->buffer->data : NULL;
+            break;
+        default:
+            break;
+    }
+    for (size_t i = 0; i < task->callbacks->count && agent->uuid; i++) {
+        igs_observe_io_wrapper_t *cb = &task->callbacks->callbacks[i];
+        if (cb->callback_ptr)
+            cb->callback_ptr (agent, task->io_type, task->name, task->value_type,
+                              value, task->value_size, cb->data);
+    }
+    if (task->buffer)
+        igs_data_unref (&task->buffer);
+    model_free_io_callbacks (&task->callbacks);
+}
+
+// execution of io callbacks by the callbacks thread pool
+void s_model_pool_io_callbacks (void *args)
+{
+    igs_io_callbacks_task_t *task = (igs_io_callbacks_task_t *) args;
+    assert (task);
+    // our reference prevents igsagent_destroy from freeing the agent
+    igsagent_t *agent = task->agent;
+    assert (agent);
+    model_read_lock(__FUNCTION__, __LINE__);
+    bool is_alive = (agent->uuid != NULL);
+    model_read_unlock(__FUNCTION__, __LINE__);
+    if (is_alive)
+        s_model_run_io_callbacks (agent, task);
+    else {
+        if (task->buffer)
+            igs_data_unref (&task->buffer);
+        model_free_io_callbacks (&task->callbacks);
+    }
+    free (task);
+    model_pool_task_done (agent);
+}
+
 void model_LOCKED_handle_io_callbacks (igsagent_t *agent, igs_io_t *io){
     assert(agent);
     if (!agent->uuid) //protection against concurrent agent destruction
         return;
     assert(io);
-    if (!io->io_callbacks)
-        return;
-    if (!agent->uuid)
-        return;
+    // Callbacks are executed without lock, using a snapshot of the io taken
+    // under lock: string and data values are referenced, so that they remain
+    // valid even if the io is written or destroyed during the callbacks.
     model_read_write_lock(__FUNCTION__, __LINE__);
-    zlist_t *callbacks = zlist_dup(io->io_callbacks);
-    igs_observe_io_wrapper_t *cb = zlist_first(callbacks);
-    igs_io_type_t io_type = io->type;
-    char *name = strdup(io->name);
-    igs_io_value_type_t value_type = io->value_type;
-    while (cb && cb->callback_ptr && io->name) {
-        switch (io->value_type) {
-            case IGS_IMPULSION_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, NULL, 0, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            case IGS_BOOL_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, &io->value.b, io->value_size, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            case IGS_INTEGER_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, &io->value.i, io->value_size, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            case IGS_DOUBLE_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, &io->value.d, io->value_size, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            case IGS_STRING_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, io->value.s, io->value_size, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            case IGS_DATA_T:
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (agent->uuid)
-                    cb->callback_ptr (agent, io_type, name, value_type, io->value.data, io->value_size, cb->data);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                break;
-            default:
-                break;
+    if (!io->callbacks_snapshot || !agent->uuid || !io->name) {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return;
+    }
+    igs_io_callbacks_task_t snapshot;
+    bool use_pool = (core_context->callbacks_pool_size > 0);
+    igs_io_callbacks_task_t *task = (use_pool) ? (igs_io_callbacks_task_t *) zmalloc (sizeof (igs_io_callbacks_task_t)) : &snapshot;
+    snprintf (task->agent_uuid, IGS_AGENT_UUID_LENGTH + 1, "%s", agent->uuid);
+    task->callbacks = io->callbacks_snapshot;
+    IGS_ATOMIC_FETCH_ADD (task->callbacks->references, 1, IGS_MEMORY_ORDER_RELAXED);
+    task->io_type = io->type;
+    snprintf (task->name, IGS_MAX_IO_NAME_LENGTH + 1, "%s", io->name);
+    task->value_type = io->value_type;
+    task->value_size = io->value_size;
+    task->buffer = NULL;
+    switch (io->value_type) {
+        case IGS_BOOL_T:
+            task->scalar.b = io->value.b;
+            break;
+        case IGS_INTEGER_T:
+            task->scalar.i = io->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            task->scalar.d = io->value.d;
+            break;
+        case IGS_STRING_T:
+        case IGS_DATA_T:
+            task->buffer = model_share_io_data (io);
+            if (task->buffer)
+                task->buffer = igs_data_ref (task->buffer);
+            break;
+        case IGS_IMPULSION_T:
+            task->value_size = 0;
+            break;
+        default:
+            break;
+    }
+    if (use_pool) {
+        task->agent = agent;
+        if (!model_pool_post (agent, task->name, s_model_pool_io_callbacks, task)) {
+            if (task->buffer)
+                igs_data_unref (&task->buffer);
+            model_free_io_callbacks (&task->callbacks);
+            free (task);
         }
-        cb = zlist_next(callbacks);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return;
     }
-    free(name);
-    zlist_destroy(&callbacks);
     model_read_write_unlock(__FUNCTION__, __LINE__);
+    s_model_run_io_callbacks (agent, task);
+}
+
+igs_io_value_type_t model_get_io_value_type (igsagent_t *agent,
+                                             const char *name,
+                                             igs_io_type_t type)
+{
+    return s_model_get_type_for_io (agent, name, type);
 }
 
 igs_io_t *model_find_io_by_name (igsagent_t *agent,
@@ -1470,6 +1857,12 @@ void igs_log_include_services (bool enable)
     core_context->enable_service_logging = enable;
 }
 
+void igs_log_shout_services (bool enable)
+{
+    core_init_agent ();
+    core_context->enable_service_shouts = enable;
+}
+
 void igs_log_no_warning_if_undefined_service(bool enable){
     core_init_agent ();
     core_context->allow_undefined_services = enable;
@@ -1484,9 +1877,9 @@ igs_result_t igsagent_input_buffer (igsagent_t *agent,
     if (!agent->uuid)
         return IGS_FAILURE;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_read_io (agent, name, IGS_INPUT_T, value, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1499,9 +1892,9 @@ igs_result_t igsagent_output_buffer (igsagent_t *agent,
     if (!agent->uuid)
         return IGS_FAILURE;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_read_io (agent, name, IGS_OUTPUT_T, value, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1514,9 +1907,9 @@ igs_result_t igsagent_attribute_buffer (igsagent_t *agent,
     if (!agent->uuid)
         return IGS_FAILURE;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_read_io (agent, name, IGS_ATTRIBUTE_T, value, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1526,9 +1919,9 @@ bool igsagent_input_bool (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return false;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_read_io_as_bool (agent, name, IGS_INPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1538,9 +1931,9 @@ int igsagent_input_int (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     int res = s_model_read_io_as_int (agent, name, IGS_INPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1550,9 +1943,9 @@ double igsagent_input_double (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     double res = s_model_read_io_as_double (agent, name, IGS_INPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1562,9 +1955,9 @@ char *igsagent_input_string (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return NULL;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char *res = s_model_read_io_as_string (agent, name, IGS_INPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1580,9 +1973,9 @@ igs_result_t igsagent_input_data (igsagent_t *agent,
         return IGS_FAILURE;
     }
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_model_read_io_as_data (agent, name, IGS_INPUT_T, data, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1597,13 +1990,13 @@ igsagent_input_zmsg (igsagent_t *agent, const char *name, zmsg_t **msg)
     assert (name);
     void *data = NULL;
     size_t size = 0;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t ret = s_model_read_io_as_data (agent, name, IGS_INPUT_T, &data, &size);
     zframe_t *frame = zframe_new (data, size);
     free (data);
     *msg = zmsg_decode (frame);
     zframe_destroy (&frame);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return ret;
 }
 
@@ -1613,9 +2006,9 @@ bool igsagent_output_bool (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return false;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_read_io_as_bool (agent, name, IGS_OUTPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1625,9 +2018,9 @@ int igsagent_output_int (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     int res = s_model_read_io_as_int (agent, name, IGS_OUTPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1637,9 +2030,9 @@ double igsagent_output_double (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     double res = s_model_read_io_as_double (agent, name, IGS_OUTPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1649,9 +2042,9 @@ char *igsagent_output_string (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return NULL;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char *res = s_model_read_io_as_string (agent, name, IGS_OUTPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1667,9 +2060,9 @@ igs_result_t igsagent_output_data (igsagent_t *agent,
         return IGS_FAILURE;
     }
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_model_read_io_as_data (agent, name, IGS_OUTPUT_T, data, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1679,9 +2072,9 @@ bool igsagent_attribute_bool (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return false;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_read_io_as_bool (agent, name, IGS_ATTRIBUTE_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1691,9 +2084,9 @@ int igsagent_attribute_int (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     int res = s_model_read_io_as_int (agent, name, IGS_ATTRIBUTE_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1703,9 +2096,9 @@ double igsagent_attribute_double (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return 0;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     double res = s_model_read_io_as_double (agent, name, IGS_ATTRIBUTE_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1715,9 +2108,9 @@ char *igsagent_attribute_string (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return NULL;
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char *res = s_model_read_io_as_string (agent, name, IGS_ATTRIBUTE_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -1733,12 +2126,132 @@ igs_result_t igsagent_attribute_data (igsagent_t *agent,
         return IGS_FAILURE;
     }
     assert (name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_result_t res = s_model_read_io_as_data (agent, name, IGS_ATTRIBUTE_T, data, size);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
+igs_io_handle_t *igsagent_input_handle (igsagent_t *agent, const char *name)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return NULL;
+    assert (name);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_io_t *io = s_model_find_input_by_name (agent, name);
+    if (io == NULL) {
+        igsagent_error (agent, "Input %s cannot be found", name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return NULL;
+    }
+    if (!io->handle) {
+        if (!agent->io_handles)
+            agent->io_handles = zhashx_new ();
+        igs_io_handle_t *handle = (igs_io_handle_t *) zmalloc (sizeof (igs_io_handle_t));
+        handle->name = strdup (io->name);
+        IGS_ATOMIC_INIT (handle->sequence, 0);
+        IGS_ATOMIC_INIT (handle->value_type, IGS_UNKNOWN_T);
+        IGS_ATOMIC_INIT (handle->value, 0);
+        zhashx_insert (agent->io_handles, handle->name, handle);
+        handle->io = io;
+        io->handle = handle;
+        model_update_io_handle (io);
+    }
+    igs_io_handle_t *handle = io->handle;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return handle;
+}
+
+igs_io_value_type_t igs_io_handle_type (igs_io_handle_t *handle)
+{
+    assert (handle);
+    return (igs_io_value_type_t) IGS_ATOMIC_LOAD (handle->value_type, IGS_MEMORY_ORDER_ACQUIRE);
+}
+
+bool igs_io_handle_bool (igs_io_handle_t *handle)
+{
+    assert (handle);
+    igs_io_value_type_t value_type = IGS_UNKNOWN_T;
+    uint64_t value = 0;
+    s_model_load_io_handle (handle, &value_type, &value);
+    double d = s_model_io_handle_as_double (value_type, value);
+    return (d >= 0 && d <= 0) ? false : true;
+}
+
+int igs_io_handle_int (igs_io_handle_t *handle)
+{
+    assert (handle);
+    igs_io_value_type_t value_type = IGS_UNKNOWN_T;
+    uint64_t value = 0;
+    s_model_load_io_handle (handle, &value_type, &value);
+    double d = s_model_io_handle_as_double (value_type, value);
+    if (value_type != IGS_DOUBLE_T)
+        return (int) d;
+    return (d < 0) ? (int) (d - 0.5) : (int) (d + 0.5);
+}
+
+double igs_io_handle_double (igs_io_handle_t *handle)
+{
+    assert (handle);
+    igs_io_value_type_t value_type = IGS_UNKNOWN_T;
+    uint64_t value = 0;
+    s_model_load_io_handle (handle, &value_type, &value);
+    return s_model_io_handle_as_double (value_type, value);
+}
+
+igs_data_t *igsagent_input_data_ref (igsagent_t *agent, const char *name)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return NULL;
+    assert (name);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_io_t *io = s_model_find_input_by_name (agent, name);
+    if (io == NULL) {
+        igsagent_error (agent, "Input %s cannot be found", name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return NULL;
+    }
+    igs_data_t *data = (io->value_type == IGS_DATA_T) ? model_share_io_data (io) : NULL;
+    if (data)
+        data = igs_data_ref (data);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return data;
+}
+
+const void *igs_data_bytes (igs_data_t *data)
+{
+    assert (data);
+    return data->data;
+}
+
+size_t igs_data_size (igs_data_t *data)
+{
+    assert (data);
+    return data->size;
+}
+
+igs_data_t *igs_data_ref (igs_data_t *data)
+{
+    assert (data);
+    IGS_ATOMIC_FETCH_ADD (data->references, 1, IGS_MEMORY_ORDER_RELAXED);
+    return data;
+}
+
+void igs_data_unref (igs_data_t **data)
+{
+    assert (data);
+    if (!*data)
+        return;
+    if (IGS_ATOMIC_FETCH_SUB ((*data)->references, 1, IGS_MEMORY_ORDER_ACQ_REL) == 1) {
+        if ((*data)->free_fn)
+            (*data)->free_fn ((*data)->data, (*data)->hint);
+        free (*data);
+    }
+    *data = NULL;
+}
+
 // --------------------------------  WRITE
 // ------------------------------------//
 
@@ -1966,6 +2479,33 @@ igs_result_t igsagent_output_set_data (igsagent_t *agent,
         return IGS_FAILURE;
 }
 
+igs_result_t igsagent_output_set_data_owned (igsagent_t *agent,
+                                             const char *name,
+                                             void *data,
+                                             size_t size,
+                                             igs_data_free_fn *free_fn,
+                                             void *hint)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    igs_data_t *buffer = model_data_new (data, size, free_fn, hint);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_io_t *io = model_write_data (agent, name, IGS_OUTPUT_T, IGS_DATA_T, buffer);
+    if (io && !agent->rt_synchronous_mode_enabled)
+        network_publish_output (agent, io);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (!io)
+        buffer->free_fn = NULL; //data remains owned by the caller
+    igs_data_unref (&buffer);
+    if (io){
+        model_LOCKED_handle_io_callbacks(agent, io);
+        return IGS_SUCCESS;
+    } else
+        return IGS_FAILURE;
+}
+
 igs_result_t
 igsagent_output_set_zmsg (igsagent_t *agent, const char *name, zmsg_t *msg)
 {
@@ -2140,9 +2680,9 @@ char * igsagent_input_description(igsagent_t *self, const char *name)
     assert (self);
     if (!self->uuid)
         return NULL;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char * description =  s_model_get_description(self, IGS_INPUT_T, name);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return description;
 }
 
@@ -2162,9 +2702,9 @@ char * igsagent_output_description(igsagent_t *self, const char *name)
     assert (self);
     if (!self->uuid)
         return NULL;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char * description =  s_model_get_description(self, IGS_OUTPUT_T, name);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return description;
 }
 
@@ -2184,9 +2724,9 @@ char * igsagent_attribute_description(igsagent_t *self, const char *name)
     assert (self);
     if (!self->uuid)
         return NULL;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     char * description =  s_model_get_description(self, IGS_ATTRIBUTE_T, name);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return description;
 }
 
@@ -2268,9 +2808,9 @@ igs_io_value_type_t igsagent_input_type (igsagent_t *agent, const char *name)
         return IGS_UNKNOWN_T;
     assert (name);
     assert (strlen(name));
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_io_value_type_t res = s_model_get_type_for_io (agent, name, IGS_INPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2281,9 +2821,9 @@ igs_io_value_type_t igsagent_output_type (igsagent_t *agent, const char *name)
         return IGS_UNKNOWN_T;
     assert (name);
     assert (strlen(name));
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_io_value_type_t res = s_model_get_type_for_io (agent, name, IGS_OUTPUT_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2294,9 +2834,9 @@ igs_io_value_type_t igsagent_attribute_type (igsagent_t *agent, const char *name
         return IGS_UNKNOWN_T;
     assert (name);
     assert (strlen(name));
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_io_value_type_t res = s_model_get_type_for_io (agent, name, IGS_ATTRIBUTE_T);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2309,9 +2849,9 @@ size_t igsagent_input_count (igsagent_t *agent)
         igsagent_warn (agent, "definition is NULL");
         return 0;
     }
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     size_t size =  zhashx_size(agent->definition->inputs_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return size;
 }
 
@@ -2324,9 +2864,9 @@ size_t igsagent_output_count (igsagent_t *agent)
         igsagent_warn (agent, "definition is NULL");
         return 0;
     }
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     size_t size =  zhashx_size(agent->definition->outputs_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return size;
 }
 
@@ -2339,9 +2879,9 @@ size_t igsagent_attribute_count (igsagent_t *agent)
         igsagent_warn (agent, "definition is NULL");
         return 0;
     }
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     size_t size =  zhashx_size(agent->definition->attributes_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return size;
 }
 
@@ -2406,9 +2946,9 @@ bool igsagent_input_exists (igsagent_t *agent, const char *name)
     assert (name);
     if (agent->definition == NULL)
         return false;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_check_io_existence (agent, name, agent->definition->inputs_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2420,9 +2960,9 @@ bool igsagent_output_exists (igsagent_t *agent, const char *name)
     assert (name);
     if (agent->definition == NULL)
         return false;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_check_io_existence (agent, name, agent->definition->outputs_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2434,9 +2974,9 @@ bool igsagent_attribute_exists (igsagent_t *agent, const char *name)
     assert (name);
     if (agent->definition == NULL)
         return false;
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     bool res = s_model_check_io_existence (agent, name, agent->definition->attributes_table);
-    model_read_write_unlock(__FUNCTION__, __LINE__);
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
 
@@ -2547,14 +3087,93 @@ bool igsagent_output_is_muted (igsagent_t *agent, const char *name)
     if (!agent->uuid)
         return false;
     assert(name);
-    model_read_write_lock(__FUNCTION__, __LINE__);
+    model_read_lock(__FUNCTION__, __LINE__);
     igs_io_t *io = model_find_io_by_name (agent, name, IGS_OUTPUT_T);
     if (io == NULL || io->type != IGS_OUTPUT_T) {
         igsagent_warn (agent, "Output '%s' not found", name);
-        model_read_write_unlock(__FUNCTION__, __LINE__);
+        model_read_unlock(__FUNCTION__, __LINE__);
         return 0;
     }
     bool res = io->is_muted;
+    model_read_unlock(__FUNCTION__, __LINE__);
+    return res;
+}
+
+igs_result_t igsagent_input_set_conflated (igsagent_t *agent, const char *name, bool conflated)
+{
+    assert(agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert(name);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_io_t *io = model_find_io_by_name (agent, name, IGS_INPUT_T);
+    if (io == NULL || io->type != IGS_INPUT_T) {
+        igsagent_error (agent, "Input '%s' not found", name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    io->is_conflated = conflated;
+    if (conflated)
+        core_context->conflation_is_used = true;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+bool igsagent_input_is_conflated (igsagent_t *agent, const char *name)
+{
+    assert(agent);
+    if (!agent->uuid)
+        return false;
+    assert(name);
+    model_read_lock(__FUNCTION__, __LINE__);
+    igs_io_t *io = model_find_io_by_name (agent, name, IGS_INPUT_T);
+    if (io == NULL || io->type != IGS_INPUT_T) {
+        igsagent_warn (agent, "Input '%s' not found", name);
+        model_read_unlock(__FUNCTION__, __LINE__);
+        return false;
+    }
+    bool res = io->is_conflated;
+    model_read_unlock(__FUNCTION__, __LINE__);
+    return res;
+}
+
+// --------------------------------  CALLBACKS THREAD POOL ------------------------------------//
+
+void igs_set_callbacks_thread_pool (size_t nb_threads)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (core_context->network_actor) {
+        igs_error("Peer must be stopped for this function to work.");
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return;
+    }
+    zactor_t **previous_pool = core_context->callbacks_pool;
+    size_t previous_pool_size = core_context->callbacks_pool_size;
+    core_context->callbacks_pool = NULL;
+    core_context->callbacks_pool_size = 0;
+    if (nb_threads > 0) {
+        core_context->callbacks_pool = (zactor_t **) zmalloc (nb_threads * sizeof (zactor_t *));
+        for (size_t i = 0; i < nb_threads; i++) {
+            core_context->callbacks_pool[i] = zactor_new (s_model_pool_worker, NULL);
+            zsock_set_unbounded (zactor_sock (core_context->callbacks_pool[i]));
+        }
+        core_context->callbacks_pool_size = nb_threads;
+    }
     model_read_write_unlock(__FUNCTION__, __LINE__);
+    // previous workers execute their pending tasks, which may need the
+    // model lock, before being destroyed
+    for (size_t i = 0; i < previous_pool_size; i++)
+        zactor_destroy (&previous_pool[i]);
+    if (previous_pool)
+        free (previous_pool);
+}
+
+size_t igs_callbacks_thread_pool (void)
+{
+    core_init_agent ();
+    model_read_lock(__FUNCTION__, __LINE__);
+    size_t res = core_context->callbacks_pool_size;
+    model_read_unlock(__FUNCTION__, __LINE__);
     return res;
 }
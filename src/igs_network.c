@@ -19,9 +19,6 @@
 #include <czmq.h>
 #include <zyre.h>
 
-static int handle_publications_balance = 0;
-static int handle_publications_balance_max = 0;
-
 #if defined(__UTYPE_LINUX)
 #include <unistd.h>
 #endif
@@ -34,7 +31,11 @@ static int handle_publications_balance_max = 0;
 #endif
 
 #if defined(__UNIX__)
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include "ingescape.h"
@@ -77,6 +78,8 @@ PIP_ADAPTER_UNICAST_ADDRESS p_unicast = NULL;
 #define W_OK 02
 #endif
 
+#define IGS_CONFLATION_MAX_BATCH 1000 //max received publications handled at once when inputs are conflated
+
 ////////////////////////////////////////////////////////////////////////
 #pragma mark INTERNAL FUNCTIONS
 ////////////////////////////////////////////////////////////////////////
@@ -104,6 +107,362 @@ void s_unsubscribe_to_remote_agent_output (igs_remote_agent_t *remote_agent,
     }
 }
 
+// little endian serialization of 64 bits integers in compact publications
+void s_network_put_uint64 (uint8_t *buffer, uint64_t value)
+{
+    for (size_t i = 0; i < 8; i++)
+        buffer[i] = (uint8_t) (value >> (8 * i));
+}
+
+uint64_t s_network_get_uint64 (const uint8_t *buffer)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++)
+        value |= ((uint64_t) buffer[i]) << (8 * i);
+    return value;
+}
+
+int s_network_compare_topics (const void *a, const void *b)
+{
+    uint64_t topic_a = *((const uint64_t *) a);
+    uint64_t topic_b = *((const uint64_t *) b);
+    return (topic_a > topic_b) - (topic_a < topic_b);
+}
+
+// sort topics and keep the ones found several times, once each,
+// returning their number
+size_t s_network_colliding_topics (uint64_t *topics, size_t size)
+{
+    if (size < 2)
+        return 0;
+    qsort (topics, size, sizeof (uint64_t), s_network_compare_topics);
+    size_t nb_colliding = 0;
+    for (size_t i = 1; i < size; i++) {
+        if (topics[i] == topics[i - 1]
+            && (nb_colliding == 0 || topics[nb_colliding - 1] != topics[i]))
+            topics[nb_colliding++] = topics[i];
+    }
+    return nb_colliding;
+}
+
+// shared memory segments (see ingescape_private.h), unavailable on
+// Windows and iOS
+igs_shm_segment_t *s_shm_create (const char *name, size_t capacity)
+{
+    assert (name);
+#if defined(__UNIX__) && !defined(__UTYPE_IOS)
+    size_t mapped_size = IGS_SHM_HEADER_SIZE + capacity;
+    int fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        // left by a crashed process with the same pid
+        shm_unlink (name);
+        fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+    if (fd < 0) {
+        igs_error ("could not create shared memory segment %s (%s)", name, strerror (errno));
+        return NULL;
+    }
+    if (ftruncate (fd, (off_t) mapped_size) != 0) {
+        igs_error ("could not allocate %zu bytes for shared memory segment %s (%s)",
+                   mapped_size, name, strerror (errno));
+        close (fd);
+        shm_unlink (name);
+        return NULL;
+    }
+    void *base = mmap (NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+    if (base == MAP_FAILED) {
+        igs_error ("could not map shared memory segment %s (%s)", name, strerror (errno));
+        shm_unlink (name);
+        return NULL;
+    }
+    igs_shm_segment_t *segment = (igs_shm_segment_t *) zmalloc (sizeof (igs_shm_segment_t));
+    segment->name = strdup (name);
+    segment->header = (igs_shm_header_t *) base;
+    segment->values = (uint8_t *) base + IGS_SHM_HEADER_SIZE;
+    segment->capacity = capacity;
+    segment->mapped_size = mapped_size;
+    segment->is_owner = true;
+    segment->header->header_size = IGS_SHM_HEADER_SIZE;
+    segment->header->capacity = capacity;
+    IGS_ATOMIC_INIT (segment->header->reserved, 0);
+    IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_RELEASE);
+    segment->header->magic = IGS_SHM_MAGIC;
+    return segment;
+#else
+    IGS_UNUSED (capacity)
+    return NULL;
+#endif
+}
+
+igs_shm_segment_t *s_shm_attach (const char *name)
+{
+    assert (name);
+#if defined(__UNIX__) && !defined(__UTYPE_IOS)
+    int fd = shm_open (name, O_RDONLY, 0);
+    if (fd < 0) {
+        igs_error ("could not open shared memory segment %s (%s)", name, strerror (errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat (fd, &st) != 0 || (size_t) st.st_size < IGS_SHM_HEADER_SIZE) {
+        igs_error ("shared memory segment %s is not valid", name);
+        close (fd);
+        return NULL;
+    }
+    size_t mapped_size = (size_t) st.st_size;
+    void *base = mmap (NULL, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (base == MAP_FAILED) {
+        igs_error ("could not map shared memory segment %s (%s)", name, strerror (errno));
+        return NULL;
+    }
+    igs_shm_header_t *header = (igs_shm_header_t *) base;
+    if (header->magic != IGS_SHM_MAGIC
+        || header->header_size != IGS_SHM_HEADER_SIZE
+        || header->capacity == 0
+        || header->capacity != mapped_size - IGS_SHM_HEADER_SIZE) {
+        igs_error ("shared memory segment %s is not valid", name);
+        munmap (base, mapped_size);
+        return NULL;
+    }
+    igs_shm_segment_t *segment = (igs_shm_segment_t *) zmalloc (sizeof (igs_shm_segment_t));
+    segment->name = strdup (name);
+    segment->header = header;
+    segment->values = (uint8_t *) base + IGS_SHM_HEADER_SIZE;
+    segment->capacity = header->capacity;
+    segment->mapped_size = mapped_size;
+    return segment;
+#else
+    return NULL;
+#endif
+}
+
+void s_shm_destroy (igs_shm_segment_t **segment)
+{
+    assert (segment);
+    assert (*segment);
+#if defined(__UNIX__) && !defined(__UTYPE_IOS)
+    munmap ((*segment)->header, (*segment)->mapped_size);
+    if ((*segment)->is_owner)
+        shm_unlink ((*segment)->name);
+#endif
+    free ((*segment)->name);
+    free (*segment);
+    *segment = NULL;
+}
+
+// write a value in our segment, returning false if it is too large
+// NB: several threads may write concurrently, each one in its own reservation
+bool s_shm_write (igs_shm_segment_t *segment, const void *value, size_t size, uint64_t *position)
+{
+    assert (segment);
+    assert (segment->is_owner);
+    assert (position);
+    uint64_t capacity = segment->capacity;
+    if (!value || size == 0 || size > capacity / IGS_SHM_MAX_VALUE_RATIO)
+        return false;
+    uint_least64_t reserved = IGS_ATOMIC_LOAD (segment->header->reserved, IGS_MEMORY_ORDER_SEQ_CST);
+    uint_least64_t start = 0;
+    do {
+        start = reserved;
+        uint64_t offset = start % capacity;
+        if (offset + size > capacity)
+            start += capacity - offset; //values are never split around the end of the ring
+    } while (!IGS_ATOMIC_COMPARE_EXCHANGE (segment->header->reserved, reserved, start + size, IGS_MEMORY_ORDER_SEQ_CST));
+    // readers of older values shall see our reservation before our bytes
+    IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_RELEASE);
+    memcpy (segment->values + start % capacity, value, size);
+    *position = start;
+    return true;
+}
+
+// copy a value from the segment of a peer, NULL if the descriptor is not
+// valid or if the value was overwritten before being copied
+igs_data_t *s_shm_read (igs_shm_segment_t *segment, uint64_t position, uint64_t size)
+{
+    assert (segment);
+    uint64_t capacity = segment->capacity;
+    if (size == 0 || size > capacity || position % capacity + size > capacity)
+        return NULL;
+    uint_least64_t reserved = IGS_ATOMIC_LOAD (segment->header->reserved, IGS_MEMORY_ORDER_ACQUIRE);
+    if (reserved < position + size || reserved - position > capacity)
+        return NULL;
+    igs_data_t *buffer = model_data_copy (segment->values + position % capacity, (size_t) size);
+    // our copy is valid only if the writer did not reserve these bytes again
+    IGS_ATOMIC_FENCE (IGS_MEMORY_ORDER_ACQUIRE);
+    reserved = IGS_ATOMIC_LOAD (segment->header->reserved, IGS_MEMORY_ORDER_RELAXED);
+    if (reserved - position > capacity)
+        igs_data_unref (&buffer);
+    return buffer;
+}
+
+// keep a value received for a conflated input, replacing any value still
+// waiting for this input
+void s_conflate_publication (igsagent_t *agent,
+                             igs_io_t *input,
+                             igs_io_value_type_t value_type,
+                             void *data,
+                             size_t size,
+                             int64_t timestamp,
+                             igs_data_t *buffer)
+{
+    assert (agent);
+    assert (input);
+    igs_conflated_value_t *pending = input->conflated_value;
+    if (!pending) {
+        pending = (igs_conflated_value_t *) zmalloc (sizeof (igs_conflated_value_t));
+        snprintf (pending->agent_uuid, IGS_AGENT_UUID_LENGTH + 1, "%s", agent->uuid);
+        snprintf (pending->input_name, IGS_MAX_IO_NAME_LENGTH + 1, "%s", input->name);
+        input->conflated_value = pending;
+        if (!core_context->conflated_values)
+            core_context->conflated_values = zlist_new ();
+        zlist_append (core_context->conflated_values, pending);
+    } else
+        igs_data_unref (&pending->buffer);
+    pending->value_type = value_type;
+    pending->buffer = (buffer) ? igs_data_ref (buffer) : model_data_copy (data, size);
+    pending->timestamp = timestamp;
+}
+
+// write the values waiting for our conflated inputs, or just drop
+// them when the ingescape loop stops
+void s_flush_conflated_values (bool drop)
+{
+    if (!core_context->conflated_values)
+        return;
+    // values received during the callbacks go to a new list
+    zlist_t *values = core_context->conflated_values;
+    core_context->conflated_values = NULL;
+    igs_conflated_value_t *pending = zlist_first (values);
+    while (pending) {
+        igsagent_t *agent = zhashx_lookup (core_context->agents, pending->agent_uuid);
+        igs_io_t *input = NULL;
+        if (agent && agent->definition && agent->definition->inputs_table)
+            input = zhashx_lookup (agent->definition->inputs_table, pending->input_name);
+        if (input && input->conflated_value == pending) {
+            input->conflated_value = NULL;
+            if (!drop) {
+                agent->rt_current_timestamp_microseconds = pending->timestamp;
+                igs_io_t *io = NULL;
+                if (pending->value_type == IGS_STRING_T || pending->value_type == IGS_DATA_T)
+                    io = model_write_data (agent, input->name, IGS_INPUT_T, pending->value_type, pending->buffer);
+                else
+                    io = model_write (agent, input->name, IGS_INPUT_T, pending->value_type,
+                                      pending->buffer->data, pending->buffer->size);
+                if (io && io->name) {
+                    model_read_write_unlock(__FUNCTION__, __LINE__);
+                    model_LOCKED_handle_io_callbacks (agent, io);
+                    model_read_write_lock(__FUNCTION__, __LINE__);
+                }
+                if (agent->uuid)
+                    agent->rt_current_timestamp_microseconds = INT64_MIN;
+            }
+        }
+        igs_data_unref (&pending->buffer);
+        free (pending);
+        pending = zlist_next (values);
+    }
+    zlist_destroy (&values);
+}
+
+// dispatch a value received from a remote agent output to all our inputs
+// mapped to this output
+// NB: string values are passed as data including their terminating zero
+// NB: string and data values are shared with our inputs when buffer is not NULL
+void s_dispatch_publication (const char *agent_name,
+                             const char *output,
+                             igs_io_value_type_t value_type,
+                             void *data,
+                             size_t size,
+                             int64_t timestamp,
+                             igs_data_t *buffer)
+{
+    assert (output);
+    // Publication does not provide information about the targeted agents in our
+    // context. At this stage, we only know that one or more of our agents are
+    // targeted. The mapping index provides the inputs of our agents that are
+    // mapped to this output of this remote agent.
+    zlist_t *targets = NULL;
+    if (agent_name)
+        targets = mapping_index_targets (agent_name, output);
+    // Callbacks may modify our mappings and agents while the model is unlocked:
+    // before the first unlock, the remaining targets are copied as pairs of
+    // agent uuid and input name, and looked up again.
+    zlist_t *copied_targets = NULL;
+    char *copied_uuid = NULL;
+    char *copied_input = NULL;
+    igs_mapping_target_t *target = (targets) ? zlist_first(targets) : NULL;
+    igsagent_t *agent = (target) ? target->agent : NULL;
+    const char *input_name = (target) ? target->input_name : NULL;
+    while (agent) {
+        assert(agent->uuid);
+        assert(agent->definition);
+        // still need to check the targeted input existence in our definition
+        assert (agent->definition->inputs_table);
+        igs_io_t *found_input = zhashx_lookup(agent->definition->inputs_table, input_name);
+        if (!found_input)
+            igsagent_warn (agent,"Input %s is missing in our definition but expected in our mapping with %s.%s",
+                           input_name, agent_name, output);
+        else if (found_input->is_conflated)
+            s_conflate_publication (agent, found_input, value_type, data, size, timestamp, buffer);
+        else {
+            // we have a fully matching mapping element: use the input
+            agent->rt_current_timestamp_microseconds = timestamp;
+            igs_io_t *io = NULL;
+            if (buffer)
+                io = model_write_data (agent, found_input->name, IGS_INPUT_T, value_type, buffer);
+            else
+                io = model_write (agent, found_input->name, IGS_INPUT_T, value_type, data, size);
+            if (io && io->name){
+                if (!copied_targets) {
+                    copied_targets = zlist_new ();
+                    zlist_autofree (copied_targets);
+                    igs_mapping_target_t *next = zlist_next (targets);
+                    while (next) {
+                        zlist_append (copied_targets, next->agent->uuid);
+                        zlist_append (copied_targets, next->input_name);
+                        next = zlist_next (targets);
+                    }
+                }
+                char uuid[IGS_AGENT_UUID_LENGTH + 1] = "";
+                snprintf (uuid, IGS_AGENT_UUID_LENGTH + 1, "%s", agent->uuid);
+                model_read_write_unlock(__FUNCTION__, __LINE__);
+                model_LOCKED_handle_io_callbacks(agent, io);
+                model_read_write_lock(__FUNCTION__, __LINE__);
+                // our agent may have been deactivated or destroyed by the callbacks
+                agent = zhashx_lookup (core_context->created_agents, uuid);
+            }
+            if (agent && agent->uuid)
+                agent->rt_current_timestamp_microseconds = INT64_MIN;
+        }
+        if (!copied_targets) {
+            target = zlist_next(targets);
+            agent = (target) ? target->agent : NULL;
+            input_name = (target) ? target->input_name : NULL;
+        } else {
+            agent = NULL;
+            while (!agent && zlist_size (copied_targets) >= 2) {
+                free (copied_uuid);
+                free (copied_input);
+                copied_uuid = (char *) zlist_pop (copied_targets);
+                copied_input = (char *) zlist_pop (copied_targets);
+                agent = zhashx_lookup (core_context->agents, copied_uuid);
+                input_name = copied_input;
+            }
+        }
+    }
+    free (copied_uuid);
+    free (copied_input);
+    zlist_destroy (&copied_targets);
+}
+
+void s_network_free_value (void *data, void *hint)
+{
+    IGS_UNUSED (hint)
+    free (data);
+}
+
 // function actually handling messages from one of the remote agents we
 // subscribed to
 void s_handle_publication (zmsg_t **msg, igs_remote_agent_t *remote_agent)
@@ -250,51 +609,19 @@ void s_handle_publication (zmsg_t **msg, igs_remote_agent_t *remote_agent)
             && value_type <= IGS_TIMESTAMPED_DATA_T)
             value_type -= IGS_DATA_T; //translate value type to non-timestamped value type
 
-        // Publication does not provide information about the targeted agents in our
-        // context. At this stage, we only know that one or more of our agents are
-        // targeted. We need to iterate through our agents and their mappings to check
-        // which inputs need to be updated on which agent.
-        igsagent_t *agent = zhashx_first(core_context->agents);
-        while (agent && agent->uuid && agent->mapping) {
-            // try to find mapping elements matching with this subscriber's output
-            // and update mapped input(s) value accordingly
-            // TODO: optimize mapping storage to avoid iterating
-            // check that this agent has not been destroyed when we were locked
-            assert(agent->mapping->map_elements);
-            igs_map_t *elmt = zlist_first(agent->mapping->map_elements);
-            while (elmt && elmt->from_input && remote_agent->definition 
-                   && remote_agent->definition->name && agent->uuid) {
-                if (streq (elmt->to_agent, remote_agent->definition->name)
-                    && streq (elmt->to_output, output)) {
-                    // we have a match on emitting agent name and its ouput name :
-                    // still need to check the targeted input existence in our
-                    // definition
-                    assert (agent->definition->inputs_table);
-                    igs_io_t *found_input = zhashx_lookup(agent->definition->inputs_table, elmt->from_input);
-                    if (!found_input)
-                        igsagent_warn (agent,"Input %s is missing in our definition but expected in our mapping with %s.%s",
-                                       elmt->from_input, elmt->to_agent, elmt->to_output);
-                    else {
-                        // we have a fully matching mapping element: use the input
-                        agent->rt_current_timestamp_microseconds = timestamp;
-                        igs_io_t *io = NULL;
-                        if (value_type == IGS_STRING_T)
-                            io = model_write (agent, found_input->name, IGS_INPUT_T, value_type, value, strlen(value) + 1);
-                        else
-                            io = model_write (agent, found_input->name, IGS_INPUT_T, value_type, data, size);
-                        if (io && io->name){
-                            model_read_write_unlock(__FUNCTION__, __LINE__);
-                            model_LOCKED_handle_io_callbacks(agent, io);
-                            model_read_write_lock(__FUNCTION__, __LINE__);
-                        }
-                        if (agent->uuid)
-                            agent->rt_current_timestamp_microseconds = INT64_MIN;
-                    }
-                }
-                elmt = zlist_next(agent->mapping->map_elements);
-            }
-            agent = zhashx_next(core_context->agents);
-        }
+        if (value_type == IGS_STRING_T) {
+            // received string is shared with our inputs, without copy
+            igs_data_t *buffer = model_data_new (value, strlen(value) + 1, s_network_free_value, NULL);
+            value = NULL;
+            s_dispatch_publication (remote_agent->definition->name, output, value_type, buffer->data, buffer->size, timestamp, buffer);
+            igs_data_unref (&buffer);
+        } else if (value_type == IGS_DATA_T && frame) {
+            // received data is shared with our inputs, without copy
+            igs_data_t *buffer = model_data_from_frame (&frame, 0);
+            s_dispatch_publication (remote_agent->definition->name, output, value_type, data, size, timestamp, buffer);
+            igs_data_unref (&buffer);
+        } else
+            s_dispatch_publication (remote_agent->definition->name, output, value_type, data, size, timestamp, NULL);
         freen (output);
         if (value)
             freen(value);
@@ -307,6 +634,165 @@ void s_handle_publication (zmsg_t **msg, igs_remote_agent_t *remote_agent)
     zmsg_destroy (msg);
 }
 
+// copy of a data value received as a shared memory descriptor (see
+// ingescape_private.h), NULL if the value cannot be received
+igs_data_t *s_network_shm_value (igs_remote_agent_t *remote_agent,
+                                 const char *output_name,
+                                 igs_io_value_type_t value_type,
+                                 zframe_t **descriptor)
+{
+    assert (remote_agent);
+    assert (output_name);
+    if (value_type != IGS_DATA_T || !descriptor || !*descriptor
+        || zframe_size (*descriptor) != IGS_SHM_DESCRIPTOR_SIZE) {
+        igs_error ("value from %s.%s is corrupted in received publication : rejecting",
+                   remote_agent->definition->name, output_name);
+        return NULL;
+    }
+    igs_shm_segment_t *segment = (remote_agent->peer) ? remote_agent->peer->shm : NULL;
+    if (!segment) {
+        igs_error ("value from %s.%s is in a shared memory segment we could not attach to : rejecting",
+                   remote_agent->definition->name, output_name);
+        return NULL;
+    }
+    uint64_t position = s_network_get_uint64 (zframe_data (*descriptor));
+    uint64_t size = s_network_get_uint64 (zframe_data (*descriptor) + 8);
+    igs_data_t *buffer = s_shm_read (segment, position, size);
+    if (!buffer)
+        igs_error ("value from %s.%s (%llu bytes) was overwritten in shared memory before being received : rejecting (see igs_set_shm_size)",
+                   remote_agent->definition->name, output_name, (unsigned long long) size);
+    return buffer;
+}
+
+// function handling compact publications (see ingescape_private.h) from
+// one of the remote agents we subscribed to in a peer, received alone or
+// as part of a batch from the agent identified by batch_uuid
+// NB: when frame is not NULL, it contains bytes and string and data values
+// are shared with our inputs, taking frame ownership. When value_frame is not NULL,
+// it contains the value and bytes only contain the header.
+void s_handle_compact_publication (igs_core_context_t *context,
+                                   igs_zyre_peer_t *peer,
+                                   const uint8_t *bytes,
+                                   size_t frame_size,
+                                   const char *batch_uuid,
+                                   zframe_t **frame,
+                                   zframe_t **value_frame)
+{
+    assert (context);
+    assert (peer);
+    assert (bytes);
+    assert (frame_size >= IGS_COMPACT_PUBLICATION_HEADER_SIZE);
+    uint64_t topic = s_network_get_uint64 (bytes + 1);
+    igs_mapping_filter_t *filter = zhashx_lookup (peer->publication_topics, &topic);
+    if (!filter) {
+        // entries of batch publications may target outputs we do not subscribe to
+        if (!batch_uuid)
+            igs_debug ("no subscription for topic %llu in received publication : rejecting",
+                       (unsigned long long) topic);
+        return;
+    }
+    igs_remote_agent_t *remote_agent = filter->remote_agent;
+    assert (remote_agent);
+    if (batch_uuid && !streq (batch_uuid, remote_agent->uuid))
+        return; //output of another agent, published in legacy form
+    if (context->is_frozen == true) {
+        igs_debug ("Message received from %s but all traffic in our agent is currently frozen",
+                   remote_agent->definition->name);
+        return;
+    }
+    uint8_t type_byte = bytes[IGS_COMPACT_PUBLICATION_HEADER_SIZE - 1];
+    bool is_in_shm = (type_byte & IGS_SHM_PUBLICATION_FLAG);
+    igs_io_value_type_t value_type = (igs_io_value_type_t) (type_byte & ~IGS_SHM_PUBLICATION_FLAG);
+    if (value_type < IGS_INTEGER_T || value_type > IGS_TIMESTAMPED_DATA_T) {
+        igs_error ("output value type is not valid (%d) in received publication : rejecting", value_type);
+        return;
+    }
+    size_t offset = IGS_COMPACT_PUBLICATION_HEADER_SIZE;
+    int64_t timestamp = INT64_MIN;
+    if (value_type >= IGS_TIMESTAMPED_INTEGER_T) {
+        if (frame_size < offset + sizeof (int64_t)) {
+            igs_error ("timestamp from %s.%s is missing in received publication : rejecting",
+                       remote_agent->definition->name, filter->output_name);
+            return;
+        }
+        timestamp = (int64_t) s_network_get_uint64 (bytes + offset);
+        offset += sizeof (int64_t);
+        value_type -= IGS_DATA_T; //translate value type to non-timestamped value type
+    }
+    if (value_frame && *value_frame && offset != frame_size) {
+        igs_error ("value from %s.%s is corrupted in received publication : rejecting",
+                   remote_agent->definition->name, filter->output_name);
+        return;
+    }
+    igs_data_t *buffer = NULL;
+    if (is_in_shm) {
+        buffer = s_network_shm_value (remote_agent, filter->output_name, value_type, value_frame);
+        if (!buffer)
+            return;
+        bytes = buffer->data;
+        frame_size = buffer->size;
+        offset = 0;
+    } else if (value_frame && *value_frame) {
+        frame = value_frame;
+        bytes = zframe_data (*frame);
+        frame_size = zframe_size (*frame);
+        offset = 0;
+    }
+    void *data = (void *) (bytes + offset);
+    size_t size = frame_size - offset;
+    if (value_type == IGS_STRING_T
+        && (size == 0 || ((const char *) data)[size - 1] != '\0')) {
+        igs_error ("value from %s.%s is corrupted in received publication : rejecting",
+                   remote_agent->definition->name, filter->output_name);
+        return;
+    }
+    if (!buffer && (value_type == IGS_STRING_T || value_type == IGS_DATA_T) && frame && *frame)
+        buffer = model_data_from_frame (frame, offset);
+    // output name is copied because the subscription may be removed
+    // while our agents handle their callbacks
+    char output[IGS_MAX_IO_NAME_LENGTH] = "";
+    snprintf (output, IGS_MAX_IO_NAME_LENGTH, "%s", filter->output_name);
+    s_dispatch_publication (remote_agent->definition->name, output, value_type, data, size, timestamp, buffer);
+    if (buffer)
+        igs_data_unref (&buffer);
+}
+
+// function handling batch publications (see ingescape_private.h) from
+// one of the remote agents we subscribed to in a peer
+void s_handle_batch_publication (igs_core_context_t *context, igs_zyre_peer_t *peer, zframe_t *frame)
+{
+    assert (context);
+    assert (peer);
+    assert (frame);
+    const uint8_t *bytes = zframe_data (frame);
+    size_t frame_size = zframe_size (frame);
+    assert (frame_size >= IGS_BATCH_PUBLICATION_HEADER_SIZE);
+    // uuid is copied because the remote agent may disappear
+    // while our agents handle their callbacks
+    char uuid[IGS_AGENT_UUID_LENGTH + 1] = "";
+    memcpy (uuid, bytes + 1, IGS_AGENT_UUID_LENGTH);
+    size_t offset = IGS_BATCH_PUBLICATION_HEADER_SIZE;
+    while (offset < frame_size) {
+        if (frame_size - offset < IGS_BATCH_PUBLICATION_ENTRY_SIZE) {
+            igs_error ("batch publication from %s is corrupted : rejecting remaining values", uuid);
+            return;
+        }
+        size_t entry_size = (size_t) bytes[offset]
+            | ((size_t) bytes[offset + 1] << 8)
+            | ((size_t) bytes[offset + 2] << 16)
+            | ((size_t) bytes[offset + 3] << 24);
+        offset += IGS_BATCH_PUBLICATION_ENTRY_SIZE;
+        if (entry_size < IGS_COMPACT_PUBLICATION_HEADER_SIZE
+            || entry_size > frame_size - offset
+            || bytes[offset] != IGS_COMPACT_PUBLICATION_MARKER) {
+            igs_error ("batch publication from %s is corrupted : rejecting remaining values", uuid);
+            return;
+        }
+        s_handle_compact_publication (context, peer, bytes + offset, entry_size, uuid, NULL, NULL);
+        offset += entry_size;
+    }
+}
+
 // Timer callback to send GET_CURRENT_OUTPUTS notification for an agent we
 // subscribed to
 int s_trigger_outputs_request_to_newcomer (zloop_t *loop,
@@ -335,29 +821,45 @@ int s_trigger_outputs_request_to_newcomer (zloop_t *loop,
     return 0;
 }
 
-// manage incoming messages from one of the remote agents we subscribed to
-int s_manage_received_publication (zloop_t *loop, zsock_t *socket, void *arg)
+// handle one incoming message from one of the remote agents we subscribed to
+// in a peer (model locked)
+void s_handle_received_publication (igs_core_context_t *context, igs_zyre_peer_t *peer, zsock_t *socket)
 {
-    IGS_UNUSED (loop)
-    igs_core_context_t *context = (igs_core_context_t *) arg;
-    assert (socket);
-    assert (context);
-
-    model_read_write_lock(__FUNCTION__, __LINE__);
     zmsg_t *msg = zmsg_recv (socket);
     assert(msg);
+    zframe_t *first = zmsg_first (msg);
+    if (first && zframe_size (first) >= IGS_COMPACT_PUBLICATION_HEADER_SIZE
+        && zframe_data (first)[0] == IGS_COMPACT_PUBLICATION_MARKER) {
+        first = zmsg_pop (msg);
+        zframe_t *value = zmsg_pop (msg);
+        s_handle_compact_publication (context, peer, zframe_data (first), zframe_size (first), NULL, &first, &value);
+        if (first)
+            zframe_destroy (&first);
+        if (value)
+            zframe_destroy (&value);
+        zmsg_destroy (&msg);
+        return;
+    }
+    if (first && zframe_size (first) >= IGS_BATCH_PUBLICATION_HEADER_SIZE
+        && zframe_data (first)[0] == IGS_BATCH_PUBLICATION_MARKER) {
+        s_handle_batch_publication (context, peer, first);
+        zmsg_destroy (&msg);
+        return;
+    }
     // The output name includes the publishing agent uuid as a prefix.
     // We merged uuid and output to keep the ZeroMQ PUB/SUB filters working
     // in a context where a publishing peer possibly hosts multiple agents.
     char *publication_id = zmsg_popstr (msg);
     if (!publication_id) {
         igs_error ("publication id is NULL in received publication : rejecting");
-        return 0;
+        zmsg_destroy (&msg);
+        return;
     }
     if (strlen (publication_id) < IGS_AGENT_UUID_LENGTH) {
         igs_error ("publication id '%s' is missing information : rejecting", publication_id);
         free (publication_id);
-        return 0;
+        zmsg_destroy (&msg);
+        return;
     }
     publication_id[IGS_AGENT_UUID_LENGTH] = '\0'; //enable proper extraction of publishing agent UUID
 
@@ -369,37 +871,199 @@ int s_manage_received_publication (zloop_t *loop, zsock_t *socket, void *arg)
     if (!remote_agent) {
         igs_error ("no remote agent with uuid '%s' : rejecting", publication_id);
         free (publication_id);
-        model_read_write_unlock(__FUNCTION__, __LINE__);
-        return 0;
+        zmsg_destroy (&msg);
+        return;
     }
     free (publication_id);
     s_handle_publication (&msg, remote_agent);
+}
+
+// manage incoming messages from the remote agents we subscribed to
+// NB: when some of our inputs are conflated, the messages already waiting in
+// the socket are handled together so that only the latest value is written
+// to the conflated inputs.
+int s_manage_received_publication (zloop_t *loop, zsock_t *socket, void *arg)
+{
+    IGS_UNUSED (loop)
+    igs_zyre_peer_t *peer = (igs_zyre_peer_t *) arg;
+    igs_core_context_t *context = core_context;
+    assert (socket);
+    assert (peer);
+    assert (context);
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    size_t nb_messages = 0;
+    do {
+        s_handle_received_publication (context, peer, socket);
+    } while (context->conflation_is_used
+             && ++nb_messages < IGS_CONFLATION_MAX_BATCH
+             && (zsock_events (socket) & ZMQ_POLLIN));
+    s_flush_conflated_values (false);
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return 0;
 }
 
+void s_name_index_add (zhashx_t **index, const char *name, void *item)
+{
+    assert (index);
+    assert (name);
+    assert (item);
+    if (!*index)
+        *index = zhashx_new ();
+    zlist_t *items = zhashx_lookup (*index, name);
+    if (!items) {
+        items = zlist_new ();
+        zhashx_insert (*index, name, items);
+    }
+    zlist_append (items, item);
+}
+
+void s_name_index_remove (zhashx_t *index, const char *name, void *item)
+{
+    assert (name);
+    assert (item);
+    zlist_t *items = (index) ? zhashx_lookup (index, name) : NULL;
+    if (items) {
+        zlist_remove (items, item);
+        if (zlist_size (items) == 0) {
+            zhashx_delete (index, name);
+            zlist_destroy (&items);
+        }
+    }
+}
+
+void s_name_index_destroy (zhashx_t **index)
+{
+    assert (index);
+    if (*index) {
+        zlist_t *items = zhashx_first (*index);
+        while (items) {
+            zlist_destroy (&items);
+            items = zhashx_next (*index);
+        }
+        zhashx_destroy (index);
+    }
+}
+
 void s_clean_and_free_zyre_peer (igs_zyre_peer_t **zyre_peer, zloop_t *loop)
 {
     assert (zyre_peer);
     assert (*zyre_peer);
     igs_debug ("cleaning peer %s (%s)", (*zyre_peer)->name, (*zyre_peer)->peer_id);
+    if ((*zyre_peer)->name)
+        s_name_index_remove (core_context->zyre_peers_by_name, (*zyre_peer)->name, *zyre_peer);
     if ((*zyre_peer)->peer_id)
         free ((*zyre_peer)->peer_id);
     if ((*zyre_peer)->name)
         free ((*zyre_peer)->name);
     if ((*zyre_peer)->protocol)
         free ((*zyre_peer)->protocol);
+    if ((*zyre_peer)->has_publisher) {
+        if ((*zyre_peer)->compact_publications)
+            core_context->network_compact_peers--;
+        else
+            core_context->network_legacy_peers--;
+        if ((*zyre_peer)->batch_publications)
+            core_context->network_batch_peers--;
+    }
+    if ((*zyre_peer)->is_local && (*zyre_peer)->compact_publications)
+        core_context->network_local_peers--;
+    if ((*zyre_peer)->shm_publications)
+        core_context->network_shm_peers--;
+    if ((*zyre_peer)->shm)
+        s_shm_destroy (&((*zyre_peer)->shm));
     if ((*zyre_peer)->subscriber) {
         if (loop)
             zloop_reader_end (loop, (*zyre_peer)->subscriber);
         zsock_destroy (&((*zyre_peer)->subscriber));
     }
+    // compact subscriptions are owned by remote agents
+    zhashx_destroy (&((*zyre_peer)->publication_topics));
+    free ((*zyre_peer)->colliding_topics);
     free (*zyre_peer);
     *zyre_peer = NULL;
 }
 
 #define NOTIFY_REMOTE_AGENT_TIMER 500
 
+// subscribe to an output of a remote agent, in compact or legacy form
+void s_mapping_filter_subscribe (igs_remote_agent_t *remote_agent,
+                                 igs_mapping_filter_t *f,
+                                 bool is_compact)
+{
+    assert (remote_agent);
+    assert (remote_agent->peer->subscriber);
+    assert (f);
+    igs_zyre_peer_t *peer = remote_agent->peer;
+    f->is_compact = is_compact;
+    if (f->is_compact) {
+        zhashx_insert (peer->publication_topics, &(f->topic), f);
+        uint8_t compact_filter[IGS_COMPACT_PUBLICATION_FILTER_SIZE];
+        compact_filter[0] = IGS_COMPACT_PUBLICATION_MARKER;
+        s_network_put_uint64 (compact_filter + 1, f->topic);
+        igs_debug ("subscribe to agent %s output %s (compact topic %llu)",
+                   remote_agent->definition->name, f->output_name, (unsigned long long) f->topic);
+        zmq_setsockopt (zsock_resolve (peer->subscriber), ZMQ_SUBSCRIBE,
+                        compact_filter, IGS_COMPACT_PUBLICATION_FILTER_SIZE);
+        if (peer->batch_publications && !remote_agent->batch_subscription
+            && strlen (remote_agent->uuid) == IGS_AGENT_UUID_LENGTH) {
+            uint8_t batch_filter[IGS_BATCH_PUBLICATION_HEADER_SIZE];
+            batch_filter[0] = IGS_BATCH_PUBLICATION_MARKER;
+            memcpy (batch_filter + 1, remote_agent->uuid, IGS_AGENT_UUID_LENGTH);
+            igs_debug ("subscribe to agent %s batch publications", remote_agent->definition->name);
+            zmq_setsockopt (zsock_resolve (peer->subscriber), ZMQ_SUBSCRIBE,
+                            batch_filter, IGS_BATCH_PUBLICATION_HEADER_SIZE);
+            remote_agent->batch_subscription = true;
+        }
+    } else {
+        igs_debug ("subscribe to agent %s output %s (%s)",
+                   remote_agent->definition->name, f->output_name, f->filter);
+        zsock_set_subscribe (peer->subscriber, f->filter);
+    }
+}
+
+// remove the subscription made by s_mapping_filter_subscribe
+void s_mapping_filter_unsubscribe (igs_remote_agent_t *remote_agent,
+                                   igs_mapping_filter_t *f)
+{
+    assert (remote_agent);
+    assert (f);
+    igs_zyre_peer_t *peer = remote_agent->peer;
+    if (f->is_compact) {
+        uint8_t compact_filter[IGS_COMPACT_PUBLICATION_FILTER_SIZE];
+        compact_filter[0] = IGS_COMPACT_PUBLICATION_MARKER;
+        s_network_put_uint64 (compact_filter + 1, f->topic);
+        zmq_setsockopt (zsock_resolve (peer->subscriber), ZMQ_UNSUBSCRIBE,
+                        compact_filter, IGS_COMPACT_PUBLICATION_FILTER_SIZE);
+        zhashx_delete (peer->publication_topics, &(f->topic));
+    } else
+        zsock_set_unsubscribe (peer->subscriber, f->filter);
+}
+
+// outputs of a peer sharing their topic with another output of the same
+// peer are subscribed to in legacy form (see ingescape_private.h)
+bool s_mapping_filter_can_be_compact (igs_remote_agent_t *remote_agent,
+                                      igs_mapping_filter_t *f)
+{
+    assert (remote_agent);
+    assert (f);
+    igs_zyre_peer_t *peer = remote_agent->peer;
+    if (!peer->compact_publications)
+        return false;
+    if (peer->colliding_topics
+        && bsearch (&(f->topic), peer->colliding_topics, peer->colliding_topics_size,
+                    sizeof (uint64_t), s_network_compare_topics))
+        return false;
+    igs_mapping_filter_t *existing = zhashx_lookup (peer->publication_topics, &(f->topic));
+    if (existing && existing != f) {
+        // the definitions we know do not match the ones of the peer
+        igs_warn ("topic for %s.%s is already used by %s : using legacy subscription",
+                  remote_agent->definition->name, f->output_name, existing->filter);
+        return false;
+    }
+    return true;
+}
+
 // Adds proper filter to make sub socket subscribe to a specific output
 // of a given remote agent
 void s_subscribe_to_remote_agent_output (igs_remote_agent_t *remote_agent,
@@ -423,16 +1087,78 @@ void s_subscribe_to_remote_agent_output (igs_remote_agent_t *remote_agent,
         if (!filter_already_exists) {
             // Set subscriber to the output filter
             assert (remote_agent->peer->subscriber);
-            igs_debug ("subscribe to agent %s output %s (%s)",
-                       remote_agent->definition->name, output_name, filter_value);
-            zsock_set_subscribe (remote_agent->peer->subscriber, filter_value);
             igs_mapping_filter_t *f = (igs_mapping_filter_t *) zmalloc (sizeof (igs_mapping_filter_t));
             f->filter = strdup (filter_value);
+            f->output_name = strdup (output_name);
+            f->remote_agent = remote_agent;
+            f->topic = network_publication_topic (remote_agent->uuid, output_name);
+            s_mapping_filter_subscribe (remote_agent, f, s_mapping_filter_can_be_compact (remote_agent, f));
             zlist_append(remote_agent->mapping_filters, f);
         }
     }
 }
 
+// update the topics shared by several outputs of the agents in a peer,
+// and the form of our subscriptions to their outputs accordingly
+// NB: called each time the definition of one of these agents changes
+void s_update_peer_colliding_topics (igs_core_context_t *context, igs_zyre_peer_t *peer)
+{
+    assert (context);
+    assert (peer);
+    if (!peer->compact_publications)
+        return;
+    size_t size = 0;
+    igs_remote_agent_t *remote_agent = zhashx_first (context->remote_agents);
+    while (remote_agent) {
+        if (remote_agent->peer == peer && remote_agent->definition && remote_agent->definition->outputs_table)
+            size += zhashx_size (remote_agent->definition->outputs_table);
+        remote_agent = zhashx_next (context->remote_agents);
+    }
+    uint64_t *topics = (size > 0) ? (uint64_t *) zmalloc (size * sizeof (uint64_t)) : NULL;
+    size_t index = 0;
+    remote_agent = zhashx_first (context->remote_agents);
+    while (remote_agent) {
+        if (remote_agent->peer == peer && remote_agent->definition && remote_agent->definition->outputs_table) {
+            igs_io_t *io = zhashx_first (remote_agent->definition->outputs_table);
+            while (io) {
+                topics[index++] = network_publication_topic (remote_agent->uuid, io->name);
+                io = zhashx_next (remote_agent->definition->outputs_table);
+            }
+        }
+        remote_agent = zhashx_next (context->remote_agents);
+    }
+    assert (index == size);
+    free (peer->colliding_topics);
+    peer->colliding_topics_size = s_network_colliding_topics (topics, size);
+    peer->colliding_topics = (peer->colliding_topics_size > 0) ? topics : NULL;
+    if (!peer->colliding_topics)
+        free (topics);
+
+    // compact subscriptions are replaced by legacy ones for colliding
+    // topics, and restored when the collision disappears
+    remote_agent = zhashx_first (context->remote_agents);
+    while (remote_agent) {
+        if (remote_agent->peer == peer && remote_agent->peer->subscriber) {
+            igs_mapping_filter_t *f = zlist_first (remote_agent->mapping_filters);
+            while (f) {
+                if (f->is_compact && peer->colliding_topics
+                    && bsearch (&(f->topic), peer->colliding_topics, peer->colliding_topics_size,
+                                sizeof (uint64_t), s_network_compare_topics)) {
+                    igs_warn ("%s.%s shares its topic with another output of peer %s : using legacy subscription",
+                              remote_agent->definition->name, f->output_name, peer->name);
+                    s_mapping_filter_unsubscribe (remote_agent, f);
+                    s_mapping_filter_subscribe (remote_agent, f, false);
+                } else if (!f->is_compact && s_mapping_filter_can_be_compact (remote_agent, f)) {
+                    s_mapping_filter_unsubscribe (remote_agent, f);
+                    s_mapping_filter_subscribe (remote_agent, f, true);
+                }
+                f = zlist_next (remote_agent->mapping_filters);
+            }
+        }
+        remote_agent = zhashx_next (context->remote_agents);
+    }
+}
+
 int s_network_configure_mapping_to_remote_agent (igsagent_t *agent,
                                                  igs_remote_agent_t *remote_agent)
 {
@@ -497,7 +1223,11 @@ void s_send_definition_to_zyre_peer (igsagent_t *agent,
         zmsg_addstr (msg, def);
         zmsg_addstr (msg, agent->uuid);
         zmsg_addstr (msg, agent->definition->name);
-        if (notif) {
+        igs_zyre_peer_t *zyre_peer = zhashx_lookup (agent->context->zyre_peers, peer);
+        if (zyre_peer && zyre_peer->versioned_updates) {
+            zmsg_addstr (msg, (notif) ? "1" : "0");
+            zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_definition_version);
+        } else if (notif) {
             // Agent has been activated during runtime: we must
             // indicate that our peer already knows the distant peer
             zmsg_addstr (msg, "1");
@@ -520,6 +1250,67 @@ void s_send_mapping_to_zyre_peer (igsagent_t *agent,
         zmsg_addstr (msg, EXTERNAL_MAPPING_MSG);
         zmsg_addstr (msg, mapping);
         zmsg_addstr (msg, agent->uuid);
+        igs_zyre_peer_t *zyre_peer = zhashx_lookup (agent->context->zyre_peers, peer);
+        if (zyre_peer && zyre_peer->versioned_updates)
+            zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_mapping_version);
+        zyre_whisper (agent->context->node, peer, &msg);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    }
+}
+
+// Deltas since the previous version of our definition, to be sent to
+// peers supporting versioned updates (see IGS_VERSIONED_UPDATES_PROTOCOL)
+zmsg_t *s_new_definition_delta (igsagent_t *agent)
+{
+    assert (agent);
+    assert (agent->definition);
+    assert (agent->definition->deltas);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, DEFINITION_DELTA_MSG);
+    zmsg_addstr (msg, agent->uuid);
+    zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_definition_version - 1);
+    zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_definition_version);
+    igs_definition_delta_t *delta = zlist_first (agent->definition->deltas);
+    while (delta) {
+        zmsg_addstr (msg, (delta->removed) ? "-" : "+");
+        zmsg_addstrf (msg, "%d", delta->type);
+        zmsg_addstr (msg, delta->name);
+        if (!delta->removed)
+            zmsg_addstrf (msg, "%d", delta->value_type);
+        delta = zlist_next (agent->definition->deltas);
+    }
+    return msg;
+}
+
+zmsg_t *s_new_mapping_delta (igsagent_t *agent)
+{
+    assert (agent);
+    assert (agent->mapping);
+    assert (agent->mapping->deltas);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, MAPPING_DELTA_MSG);
+    zmsg_addstr (msg, agent->uuid);
+    zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_mapping_version - 1);
+    zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_mapping_version);
+    igs_mapping_delta_t *delta = zlist_first (agent->mapping->deltas);
+    while (delta) {
+        zmsg_addstr (msg, (delta->removed) ? "-" : "+");
+        zmsg_addstr (msg, delta->from_input);
+        zmsg_addstr (msg, delta->to_agent);
+        zmsg_addstr (msg, delta->to_output);
+        delta = zlist_next (agent->mapping->deltas);
+    }
+    return msg;
+}
+
+void s_send_delta_to_zyre_peer (igsagent_t *agent, const char *peer, zmsg_t *delta)
+{
+    assert (agent);
+    assert (peer);
+    assert (delta);
+    if (agent->uuid && agent->context && agent->context->node){
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zmsg_t *msg = zmsg_dup (delta);
         zyre_whisper (agent->context->node, peer, &msg);
         s_unlock_zyre_peer (__FUNCTION__, __LINE__);
     }
@@ -660,20 +1451,31 @@ void s_clean_and_free_remote_agent (igs_remote_agent_t **remote_agent)
                (*remote_agent)->definition->name, (*remote_agent)->uuid);
 
     // clean the agent definition & mapping
-    if ((*remote_agent)->definition)
-        definition_free_definition (&(*remote_agent)->definition);
+    if ((*remote_agent)->definition) {
+        s_name_index_remove (core_context->remote_agents_by_name,
+                             (*remote_agent)->definition->name, *remote_agent);
+        definition_release_remote (&(*remote_agent)->definition);
+    }
     if ((*remote_agent)->mapping)
         mapping_free_mapping (&(*remote_agent)->mapping);
 
     // clean the remote_agent itself
     igs_mapping_filter_t *elt = zlist_first((*remote_agent)->mapping_filters);
     while (elt) {
-        zsock_set_unsubscribe ((*remote_agent)->peer->subscriber, elt->filter);
+        s_mapping_filter_unsubscribe (*remote_agent, elt);
+        free (elt->output_name);
         free (elt->filter);
         free (elt);
         elt = zlist_next((*remote_agent)->mapping_filters);
     }
     zlist_destroy(&(*remote_agent)->mapping_filters);
+    if ((*remote_agent)->batch_subscription) {
+        uint8_t batch_filter[IGS_BATCH_PUBLICATION_HEADER_SIZE];
+        batch_filter[0] = IGS_BATCH_PUBLICATION_MARKER;
+        memcpy (batch_filter + 1, (*remote_agent)->uuid, IGS_AGENT_UUID_LENGTH);
+        zmq_setsockopt (zsock_resolve ((*remote_agent)->peer->subscriber), ZMQ_UNSUBSCRIBE,
+                        batch_filter, IGS_BATCH_PUBLICATION_HEADER_SIZE);
+    }
     if ((*remote_agent)->uuid){
         free ((*remote_agent)->uuid);
         (*remote_agent)->uuid = NULL;
@@ -686,1962 +1488,2536 @@ void s_clean_and_free_remote_agent (igs_remote_agent_t **remote_agent)
     *remote_agent = NULL;
 }
 
-// manage messages received on the private channel
-int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
+// service call received from a remote agent, to be executed by
+// the callbacks thread pool (see igs_set_callbacks_thread_pool)
+typedef struct igs_service_call_task {
+    igsagent_t *callee_agent; //referenced until model_pool_task_done
+    char *caller_name;
+    char *caller_uuid;
+    char *service_name;
+    igs_service_arg_t *args;
+    size_t nb_args;
+    char *token;
+    int64_t timestamp;
+} igs_service_call_task_t;
+
+igs_service_call_task_t *s_new_service_call_task (igsagent_t *callee_agent, const char *caller_name,
+                                                 const char *caller_uuid, const char *service_name,
+                                                 igs_service_arg_t **args, size_t nb_args, const char *token)
 {
-    IGS_UNUSED (socket)
-    igs_core_context_t *context = (igs_core_context_t *) arg;
-    assert (context);
-    zyre_t *node = context->node;
-    assert (node);
+    assert (callee_agent);
+    assert (args);
+    igs_service_call_task_t *task = (igs_service_call_task_t *) zmalloc (sizeof (igs_service_call_task_t));
+    task->callee_agent = callee_agent;
+    task->caller_name = strdup (caller_name);
+    task->caller_uuid = strdup (caller_uuid);
+    task->service_name = strdup (service_name);
+    task->args = *args; //task takes ownership of arguments
+    *args = NULL;
+    task->nb_args = nb_args;
+    task->token = (token) ? strdup (token) : NULL;
+    task->timestamp = callee_agent->rt_current_timestamp_microseconds;
+    return task;
+}
 
-    zyre_event_t *zyre_event = zyre_event_new (node);
-    const char *event = zyre_event_type (zyre_event);
-    const char *peerUUID = zyre_event_peer_uuid (zyre_event);
-    const char *name = zyre_event_peer_name (zyre_event);
-    const char *address = zyre_event_peer_addr (zyre_event);
-    zhash_t *headers = zyre_event_headers (zyre_event);
-    const char *group = zyre_event_group (zyre_event);
-    zmsg_t *msg = zyre_event_msg (zyre_event);
-    zmsg_t *msg_duplicate = zmsg_dup (msg);
+void s_free_service_call_task (igs_service_call_task_t **task)
+{
+    assert (task);
+    assert (*task);
+    free ((*task)->caller_name);
+    free ((*task)->caller_uuid);
+    free ((*task)->service_name);
+    if ((*task)->args)
+        igs_service_args_destroy (&(*task)->args);
+    if ((*task)->token)
+        free ((*task)->token);
+    free (*task);
+    *task = NULL;
+}
 
-    // parse event
-    if (streq (event, "ENTER")) {
+void s_run_service_call_task (void *args)
+{
+    igs_service_call_task_t *task = (igs_service_call_task_t *) args;
+    assert (task);
+    // our reference prevents igsagent_destroy from freeing the agent
+    igsagent_t *agent = task->callee_agent;
+    assert (agent);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_service_t *service = NULL;
+    if (agent->uuid && agent->definition && agent->definition->services_table)
+        service = zhashx_lookup (agent->definition->services_table, task->service_name);
+    igsagent_service_fn *service_cb = (service) ? service->service_cb : NULL;
+    void *cb_data = (service) ? service->cb_data : NULL;
+    if (service_cb)
+        agent->rt_current_timestamp_microseconds = task->timestamp;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (service_cb) {
+        service_cb (agent, task->caller_name, task->caller_uuid, task->service_name,
+                    task->args, task->nb_args, task->token, cb_data);
         model_read_write_lock(__FUNCTION__, __LINE__);
-        igs_debug ("->%s has entered the network with peer id %s and endpoint %s", name, peerUUID, address);
-        igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
-        if (!zyre_peer) {
-            zyre_peer = (igs_zyre_peer_t *) zmalloc (sizeof (igs_zyre_peer_t));
-            zyre_peer->peer_id = s_strndup (peerUUID, IGS_MAX_PEER_ID_LENGTH);
-            zhashx_insert(context->zyre_peers, zyre_peer->peer_id, zyre_peer);
-            zyre_peer->name = s_strndup (name, IGS_MAX_AGENT_NAME_LENGTH);
-            zlist_t *keys = zhash_keys (headers);
-            size_t s = zlist_size (keys);
-            if (s > 0) {
-                igs_debug ("Handling headers for peer %s (%s)", name, peerUUID);
-                char *k = zlist_first (keys);
-                const char *v;
-                while (k) {
-                    v = zyre_event_header (zyre_event, k);
-                    igs_debug ("\t%s -> %s", k, v);
-                    k = zlist_next (keys);
-                }
-                zlist_destroy (&keys);
-            }
+        if (agent->uuid)
+            agent->rt_current_timestamp_microseconds = INT64_MIN;
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+    }
+    s_free_service_call_task (&task);
+    model_pool_task_done (agent);
+}
 
-            const char *peer_public_key = zyre_event_header (zyre_event, "X-PUBLICKEY");
-            const char *protocol_version = zyre_event_header (zyre_event, "protocol");
-            if (protocol_version)
-                zyre_peer->protocol = s_strndup (protocol_version, 16);
+void s_request_snapshot (igs_core_context_t *context, const char *peer, const char *uuid)
+{
+    assert (context);
+    assert (peer);
+    assert (uuid);
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zmsg_t *request = zmsg_new ();
+    zmsg_addstr (request, GET_SNAPSHOT_MSG);
+    zmsg_addstr (request, uuid);
+    zyre_whisper (context->node, peer, &request);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
 
-            const char *publisher_port = zyre_event_header (zyre_event, "publisher");
-            if (publisher_port) {
-                // we extract the publisher adress to subscribe to from the zyre message
-                // header
-                char endpoint_address[128];
-                strncpy (endpoint_address, address, 127);
+// handlers of the private commands of the ingescape protocol, returning
+// IGS_WHISPER_HANDLED, IGS_WHISPER_REJECTED when the message is invalid and
+// IGS_WHISPER_STOP when our loop shall stop
+#define IGS_WHISPER_HANDLED 0
+#define IGS_WHISPER_REJECTED 1
+#define IGS_WHISPER_STOP -1
+typedef int (igs_whisper_handler_fn) (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg);
+
+igs_result_t network_apply_definition_delta (igs_remote_agent_t *remote_agent, const char *base_version,
+                                             const char *version, zmsg_t *msg)
+{
+    assert (remote_agent);
+    assert (base_version);
+    assert (version);
+    assert (msg);
+    if (!remote_agent->definition
+        || remote_agent->definition_version != strtoull (base_version, NULL, 10)) {
+        igs_debug ("definition delta %s->%s for agent %s does not match our version",
+                   base_version, version, remote_agent->uuid);
+        return IGS_FAILURE;
+    }
+    // shared remote definitions are immutable
+    definition_make_private (&remote_agent->definition);
+    bool is_valid = true;
+    char *op = zmsg_popstr (msg);
+    while (op && is_valid) {
+        bool removed = streq (op, "-");
+        char *io_type = zmsg_popstr (msg);
+        char *io_name = zmsg_popstr (msg);
+        char *value_type = (removed) ? NULL : zmsg_popstr (msg);
+        is_valid = (io_type && io_name && (removed || value_type));
+        if (is_valid)
+            definition_apply_delta (remote_agent->definition, io_name, atoi (io_type),
+                                    (value_type) ? atoi (value_type) : IGS_UNKNOWN_T, removed);
+        free (io_type);
+        free (io_name);
+        free (value_type);
+        free (op);
+        op = (is_valid) ? zmsg_popstr (msg) : NULL;
+    }
+    definition_update_json (remote_agent->definition);
+    if (!is_valid) {
+        igs_error ("invalid definition delta received for agent %s(%s)",
+                   remote_agent->definition->name, remote_agent->uuid);
+        return IGS_FAILURE;
+    }
+    remote_agent->definition_version = strtoull (version, NULL, 10);
+    return IGS_SUCCESS;
+}
 
-                // IP adress extraction
-                char *insert = endpoint_address + strlen (endpoint_address);
-                bool extractOK = true;
-                while (*insert != ':') {
-                    insert--;
-                    if (insert == endpoint_address) {
-                        igs_error ("Could not extract port from address %s", address);
-                        extractOK = false;
-                        break;
-                    }
+igs_result_t network_apply_mapping_delta (igs_remote_agent_t *remote_agent, const char *base_version,
+                                          const char *version, zmsg_t *msg)
+{
+    assert (remote_agent);
+    assert (base_version);
+    assert (version);
+    assert (msg);
+    if (remote_agent->mapping_version != strtoull (base_version, NULL, 10)) {
+        igs_debug ("mapping delta %s->%s for agent %s does not match our version",
+                   base_version, version, remote_agent->uuid);
+        return IGS_FAILURE;
+    }
+    if (!remote_agent->mapping) {
+        remote_agent->mapping = (igs_mapping_t *) zmalloc (sizeof (igs_mapping_t));
+        remote_agent->mapping->map_elements = zlist_new ();
+        remote_agent->mapping->split_elements = zlist_new ();
+    }
+    bool is_valid = true;
+    char *op = zmsg_popstr (msg);
+    while (op && is_valid) {
+        char *from_input = zmsg_popstr (msg);
+        char *to_agent = zmsg_popstr (msg);
+        char *to_output = zmsg_popstr (msg);
+        is_valid = (from_input && to_agent && to_output);
+        if (is_valid)
+            mapping_apply_delta (remote_agent->mapping, from_input, to_agent, to_output, streq (op, "-"));
+        free (from_input);
+        free (to_agent);
+        free (to_output);
+        free (op);
+        op = (is_valid) ? zmsg_popstr (msg) : NULL;
+    }
+    mapping_update_json (remote_agent->mapping);
+    if (!is_valid) {
+        igs_error ("invalid mapping delta received for agent %s", remote_agent->uuid);
+        return IGS_FAILURE;
+    }
+    remote_agent->mapping_version = strtoull (version, NULL, 10);
+    return IGS_SUCCESS;
+}
+
+// function applying a DEFINITION_DELTA message (see IGS_VERSIONED_UPDATES_PROTOCOL)
+static int s_handle_definition_delta (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg)
+{
+    assert (context);
+    assert (peerUUID);
+    assert (msg);
+    char *uuid = zmsg_popstr (msg);
+    char *base_version = zmsg_popstr (msg);
+    char *version = zmsg_popstr (msg);
+    if (!uuid || !base_version || !version) {
+        igs_error ("invalid %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (uuid);
+        free (base_version);
+        free (version);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_remote_agent_t *remote_agent = zhashx_lookup (context->remote_agents, uuid);
+    if (!remote_agent
+        || network_apply_definition_delta (remote_agent, base_version, version, msg) == IGS_FAILURE) {
+        igs_debug ("requesting snapshot of agent %s", uuid);
+        s_request_snapshot (context, peerUUID, uuid);
+    } else {
+        s_update_peer_colliding_topics (context, remote_agent->peer);
+        igsagent_t *agent = zhashx_first (context->agents);
+        while (agent) {
+            s_network_configure_mapping_to_remote_agent (agent, remote_agent);
+            agent = zhashx_next (context->agents);
+        }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        if (remote_agent->uuid)
+            agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION, uuid,
+                                                remote_agent->definition->name, remote_agent->definition->json);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+    }
+    free (uuid);
+    free (base_version);
+    free (version);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+// function applying a MAPPING_DELTA message (see IGS_VERSIONED_UPDATES_PROTOCOL)
+static int s_handle_mapping_delta (igs_core_context_t *context,
+                                   const char *peerUUID,
+                                   const char *name,
+                                   const char *title,
+                                   zmsg_t *msg)
+{
+    assert (context);
+    assert (peerUUID);
+    assert (msg);
+    char *uuid = zmsg_popstr (msg);
+    char *base_version = zmsg_popstr (msg);
+    char *version = zmsg_popstr (msg);
+    if (!uuid || !base_version || !version) {
+        igs_error ("invalid %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (uuid);
+        free (base_version);
+        free (version);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_remote_agent_t *remote_agent = zhashx_lookup (context->remote_agents, uuid);
+    if (!remote_agent
+        || network_apply_mapping_delta (remote_agent, base_version, version, msg) == IGS_FAILURE) {
+        igs_debug ("requesting snapshot of agent %s", uuid);
+        s_request_snapshot (context, peerUUID, uuid);
+    } else {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        if (remote_agent->uuid && remote_agent->definition)
+            agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, uuid,
+                                                remote_agent->definition->name, remote_agent->mapping->json);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+    }
+    free (uuid);
+    free (base_version);
+    free (version);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_remote_peer_knows_agent (igs_core_context_t *context,
+                                             const char *peerUUID,
+                                             const char *name,
+                                             const char *title,
+                                             zmsg_t *msg)
+{
+    // distant peer has received one of our agents definition
+    // => all agents in this peer know us
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (agent) {
+        //all remote agents attached to the peer know this agent : notify this agent
+        zlist_t *agent_event_callbacks = zlist_dup(agent->agent_event_callbacks);
+        igs_agent_event_wrapper_t *cb = zlist_first(agent_event_callbacks);
+        while (cb && cb->callback_ptr) {
+            // iterate on all remote agents *for this peer* : all ITS agents know THIS agent
+            zlistx_t *remote_agents = zhashx_values(core_context->remote_agents);
+            igs_remote_agent_t *r = zlistx_first(remote_agents);
+            while (agent->uuid && r && r->uuid) {
+                if (streq (r->peer->peer_id, peerUUID)){
+                    model_read_write_unlock(__FUNCTION__, __LINE__);
+                    if (agent->uuid && r->uuid)
+                        cb->callback_ptr (agent, IGS_AGENT_KNOWS_US, r->uuid, r->definition->name, NULL, cb->my_data);
+                    model_read_write_lock(__FUNCTION__, __LINE__);
                 }
+                r = zlistx_next(remote_agents);
+            }
+            zlistx_destroy(&remote_agents);
+            cb = zlist_next(agent_event_callbacks);
+        }
+        zlist_destroy(&agent_event_callbacks);
+    } // else agent has disappeared on our side (disabled or destroyed)
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-                if (extractOK) {
-                    // we found a possible publisher to subscribe to
-                    *(insert + 1) =
-                    '\0'; // close endpoint_address string after ':' location
+static int s_handle_external_definition (igs_core_context_t *context,
+                                         const char *peerUUID,
+                                         const char *name,
+                                         const char *title,
+                                         zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    // identify remote agent or create it if unknown.
+    // NB: we suppose that remote agent creation is achieved when
+    // the agent sends its definition for the first time.
+    // Agents without definition are considered impossible.
+    char *str_definition = zmsg_popstr (msg);
+    if (str_definition == NULL) {
+        igs_error ("no valid definition in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (str_definition);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *remote_agent_name = zmsg_popstr (msg);
+    if (remote_agent_name == NULL) {
+        igs_error ("no valid agent name in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (str_definition);
+        free (uuid);
+        return IGS_WHISPER_REJECTED;
+    }
+    // Additonal notification flag means that the remote agent has been
+    // started during runtime (see below). Since protocol v8, it is
+    // always present and followed by the definition version.
+    char *notification = zmsg_popstr (msg);
+    char *version = zmsg_popstr (msg);
 
-                    // check towards our own ip address (without port)
-                    char *incoming_ip_address =
-                    endpoint_address + 6; // ignore tcp://
-                    *insert = '\0';
-                    bool useIPC = false;
-                    bool use_inproc = false;
-                    const char *ipc_address = NULL;
-                    const char *inproc_address = NULL;
-                    if (streq (context->ip_address, incoming_ip_address)) {
-                        // same IP address : we can try to use ipc (or loopback on windows)
-                        // instead of TCP or we can use inproc if both agents are in the same
-                        // process
-                        int pid = atoi (zyre_event_header (zyre_event, "pid"));
-                        if (context->process_id == pid) {
-                            // same ip address and same process : we can use inproc
-                            inproc_address = zyre_event_header (zyre_event, "inproc");
-                            if (inproc_address) {
-                                use_inproc = true;
-                                igs_debug ("Use address %s to subscribe to %s", inproc_address, name);
-                            }
-                        }
-                        else {
-                            // try to recover agent ipc/loopback address
-#if defined(__UNIX__)
-                            ipc_address = zyre_event_header (zyre_event, "ipc");
-#elif defined(__WINDOWS__)
-                            ipc_address = zyre_event_header (zyre_event, "loopback");
-#endif
-                            if (ipc_address) {
-                                useIPC = true;
-                                igs_debug ("Use address %s to subscribe to %s", ipc_address, name);
-                            }
-                        }
-                    }
-                    *insert = ':';
-                    // add port to the endpoint to compose it fully
-                    strcat (endpoint_address, publisher_port);
-                    if (context->network_allow_inproc && use_inproc) {
-                        zyre_peer->subscriber = zsock_new_sub (inproc_address, NULL);
-                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
-                        igs_debug ("Subscription created for %s at %s (inproc)",
-                                   zyre_peer->name, inproc_address);
-                    }
-                    else if (context->network_allow_ipc && useIPC) {
-                        zyre_peer->subscriber = zsock_new_sub (ipc_address, NULL);
-                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
-                        igs_debug ("Subscription created for %s at %s (ipc)",
-                                   zyre_peer->name, ipc_address);
-                    }
-                    else {
-                        zyre_peer->subscriber = zsock_new_sub (endpoint_address, NULL);
-                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
-                        igs_debug ("Subscription created for %s at %s (tcp)",
-                                   zyre_peer->name, endpoint_address);
-                    }
-                    assert (zyre_peer->subscriber);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // Load definition from string content, or share the one
+    // already parsed for the same content
+    igs_definition_t *new_definition = definition_load_remote (str_definition);
+    if (new_definition && new_definition->name) {
+        bool is_remote_agent_new = false;
+        igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
+        if (!remote_agent) {
+            remote_agent = (igs_remote_agent_t *) zmalloc (sizeof (igs_remote_agent_t));
+            remote_agent->context = context;
+            remote_agent->uuid = strdup (uuid);
+            remote_agent->mapping_filters = zlist_new();
+            igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
+            assert (zyre_peer);
+            remote_agent->peer = zyre_peer;
+            remote_agent->definition = new_definition;
+            zhashx_insert(context->remote_agents, remote_agent->uuid, remote_agent);
+            s_name_index_add (&context->remote_agents_by_name, new_definition->name, remote_agent);
+            igs_debug ("registering agent %s(%s)", uuid, remote_agent_name);
+            is_remote_agent_new = true;
+        } else {
+            // else we already know this agent, its definition (possibly including name)
+            // has been updated
+            igs_debug ("Definition already exists for remote agent %s : new definition will overwrite the previous one...", remote_agent->definition->name);
+            if (strneq (remote_agent->definition->name,new_definition->name))
+                igs_debug ("Remote agent is changing name from %s to %s", remote_agent->definition->name, new_definition->name);
+            igs_definition_t *old_def = remote_agent->definition;
+            if (strneq (old_def->name, new_definition->name)) {
+                s_name_index_remove (context->remote_agents_by_name, old_def->name, remote_agent);
+                s_name_index_add (&context->remote_agents_by_name, new_definition->name, remote_agent);
+            }
+            remote_agent->definition = new_definition;
+            definition_release_remote (&old_def);
+        }
+        assert (remote_agent);
+        remote_agent->definition_version = (version) ? strtoull (version, NULL, 10) : 0;
+
+        igs_debug ("store definition for remote agent %s(%s)",
+                   remote_agent->definition->name, remote_agent->uuid);
+        s_update_peer_colliding_topics (context, remote_agent->peer);
+        // Check the involvement of this new remote agent and its definition in
+        // our agent mappings and update subscriptions. We check here because
+        // remote agent definition is required to handle received data.
+        igsagent_t *agent = zhashx_first(context->agents);
+        while (agent) {
+            s_network_configure_mapping_to_remote_agent (agent, remote_agent);
+            agent = zhashx_next(context->agents);
+        }
 
-                    if (context->security_is_enabled && peer_public_key) {
-                        zcert_apply (context->security_cert, zyre_peer->subscriber);
-                        zsock_set_curve_serverkey (zyre_peer->subscriber, peer_public_key);
+        if (is_remote_agent_new) {
+            // notify remote agent that our agents knows it
+            s_lock_zyre_peer (__FUNCTION__, __LINE__);
+            zmsg_t *msg_know = zmsg_new ();
+            zmsg_addstr (msg_know, REMOTE_PEER_KNOWS_AGENT_MSG);
+            zmsg_addstr (msg_know, uuid);
+            zyre_whisper (node, peerUUID, &msg_know);
+            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+
+            // Send hello message for splitter creation if a split exists with
+            // the new remote agent.
+            igsagent_t *elt_agent = zhashx_first(context->agents);
+            while (elt_agent) {
+                igs_split_t *elt = zlist_first(elt_agent->mapping->split_elements);
+                while (elt) {
+                    if (streq (elt->to_agent, remote_agent_name)) {
+                        zmsg_t *ready_message = zmsg_new ();
+                        zmsg_addstr (ready_message, WORKER_HELLO_MSG);
+                        zmsg_addstr (ready_message, elt_agent->uuid);
+                        zmsg_addstr (ready_message, elt->from_input);
+                        zmsg_addstr (ready_message, elt->to_output);
+                        zmsg_addstrf (ready_message, "%i", split_hello_credit (elt));
+                        model_read_write_unlock(__FUNCTION__, __LINE__);
+                        if (remote_agent->uuid)
+                            igs_channel_whisper_zmsg (remote_agent->uuid, &ready_message);
+                        model_read_write_lock(__FUNCTION__, __LINE__);
                     }
-                    zloop_reader (loop, zyre_peer->subscriber, s_manage_received_publication, context);
-                    zloop_reader_set_tolerant (loop, zyre_peer->subscriber);
+                    elt = zlist_next(elt_agent->mapping->split_elements);
                 }
+                elt_agent = zhashx_next(context->agents);
             }
-            zhash_t *headers_bis = zhash_dup (headers);
+
             model_read_write_unlock(__FUNCTION__, __LINE__);
-            agent_LOCKED_propagate_agent_event (IGS_PEER_ENTERED, peerUUID, name, headers_bis);
-            zhash_destroy (&headers_bis);
-        } else {
-            // Agent already exists, we set its reconnected flag
-            // (this is used below to avoid agent destruction on EXIT received after timeout)
-            zyre_peer->reconnected++;
+            agent_LOCKED_propagate_agent_event (IGS_AGENT_ENTERED, uuid, remote_agent_name, str_definition);
+            model_read_write_lock(__FUNCTION__, __LINE__);
+            // Notification flag means that the remote agent has been
+            // started during runtime: remote peer init has already been done and
+            // this remote agent knows our agents already => propagate to our
+            // agents immediately.
+            if (notification && strneq (notification, "0")) {
+                model_read_write_unlock(__FUNCTION__, __LINE__);
+                agent_LOCKED_propagate_agent_event (IGS_AGENT_KNOWS_US, uuid, remote_agent_name, NULL);
+                model_read_write_lock(__FUNCTION__, __LINE__);
+            }
+        }else{
+            model_read_write_unlock(__FUNCTION__, __LINE__);
+            if (remote_agent->uuid)
+                agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION,
+                                                    uuid, remote_agent_name, remote_agent->definition->json);
+            model_read_write_lock(__FUNCTION__, __LINE__);
+        }
+    } else {
+        if (new_definition && !new_definition->name){
+            igs_error ("received definition from remote agent %s(%s) does not contain a name : rejecting", remote_agent_name, uuid);
+            definition_release_remote(&new_definition);
+        }else
+            igs_error ("received definition from remote agent %s(%s) is empty or invalid : agent will not be registered",
+                       remote_agent_name, uuid);
+    }
+    free (str_definition);
+    free (uuid);
+    free (remote_agent_name);
+    free (notification);
+    free (version);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_external_mapping (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg)
+{
+    // identify remote agent
+    char *str_mapping = zmsg_popstr (msg);
+    if (str_mapping == NULL) {
+        igs_error ("no valid mapping in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("uuid is NULL in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (str_mapping);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *version = zmsg_popstr (msg); //since protocol v8
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
+    if (!remote_agent) {
+        igs_error ("no known remote agent with uuid '%s': rejecting", uuid);
+        free (str_mapping);
+        free (uuid);
+        free (version);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    remote_agent->mapping_version = (version) ? strtoull (version, NULL, 10) : 0;
+    free (version);
+    igs_mapping_t *new_mapping = NULL;
+    if (strlen (str_mapping) > 0) {
+        // load mapping from string content
+        new_mapping = parser_load_mapping (str_mapping);
+        if (new_mapping == NULL)
+            igs_error ("received mapping for agent %s(%s) could not be parsed properly",
+                       remote_agent->definition->name, remote_agent->uuid);
+    } else {
+        igs_debug ("received mapping from agent %s(%s) is empty", remote_agent->definition->name, remote_agent->uuid);
+        if (remote_agent && remote_agent->mapping) {
+            mapping_free_mapping (&remote_agent->mapping);
+            remote_agent->mapping = NULL;
             model_read_write_unlock(__FUNCTION__, __LINE__);
+            if (remote_agent->uuid)
+                agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, uuid,
+                                                    remote_agent->definition->name, NULL); //mapping is empty => arg is NULL
+            model_read_write_lock(__FUNCTION__, __LINE__);
         }
     }
-    else if (streq (event, "JOIN")) {
+
+    if (new_mapping && remote_agent) {
+        // look if this agent already has a mapping
+        if (remote_agent->mapping) {
+            igs_debug ("mapping already exists for agent %s(%s) : new mapping will overwrite the previous one...",
+                       remote_agent->definition->name, remote_agent->uuid);
+            mapping_free_mapping (&remote_agent->mapping);
+        }
+
+        igs_debug ("store mapping for agent %s(%s)", remote_agent->definition->name, remote_agent->uuid);
+        remote_agent->mapping = new_mapping;
+        mapping_update_json(remote_agent->mapping);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        if (remote_agent->uuid)
+            agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, uuid,
+                                                remote_agent->definition->name, str_mapping);
         model_read_write_lock(__FUNCTION__, __LINE__);
-        igs_debug ("+%s has joined %s", name, group);
-        if (streq (group, IGS_PRIVATE_CHANNEL)) {
-            // send information for all our agents to the newcomer
-            igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
-            assert (zyre_peer);
-            char *definition_str = NULL;
-            char *mapping_str = NULL;
-            igsagent_t *agent = zhashx_first(context->agents);
-            while (agent) {
-                // definition is sent to every newcomer on the channel (wether it is an ingescape agent or not)
-                if (zyre_peer->protocol && (streq (zyre_peer->protocol, "v2") || streq (zyre_peer->protocol, "v3")))
-                    definition_str = agent->definition->json_legacy_v3;
-                else if (zyre_peer->protocol && streq (zyre_peer->protocol, "v4"))
-                    definition_str = agent->definition->json_legacy_v4;
-                else
-                    definition_str = agent->definition->json;
-                if (definition_str)
-                    s_send_definition_to_zyre_peer (agent, peerUUID, definition_str, false);
-                else
-                    s_send_definition_to_zyre_peer (agent, peerUUID, "", false);
-                // and so is our mapping
-                if (zyre_peer->protocol && streq (zyre_peer->protocol, "v2"))
-                    mapping_str = agent->mapping->json_legacy;
-                else
-                    mapping_str = agent->mapping->json;
-                if (mapping_str)
-                    s_send_mapping_to_zyre_peer (agent, peerUUID, mapping_str);
-                else
-                    s_send_mapping_to_zyre_peer (agent, peerUUID, "");
-                // and so is the state of our internal variables
-                s_send_state_to (agent, peerUUID, true);
-                agent = zhashx_next(context->agents);
-            }
-            zyre_peer->has_joined_private_channel = true;
-        }
-        model_read_write_unlock(__FUNCTION__, __LINE__);
     }
-    else if (streq (event, "SHOUT")) {
-        if (streq (group, context->replay_channel)) {
-            // this is a replay message for one of our inputs
-            char *agent_name = zmsg_popstr (msg_duplicate);
-            char *input = zmsg_popstr (msg_duplicate);
-            if (agent_name == NULL) {
-                igs_error ("agent name is NULL for replay message from %s(%s): rejecting", name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                return 0;
-            }
-            if (input == NULL) {
-                igs_error ("input is NULL for replay message from %s(%s): rejecting", name, peerUUID);
-                free (agent_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                return 0;
-            }
+    free (str_mapping);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            char *value = NULL;
-            zframe_t *frame = NULL;
-            void *data = NULL;
-            size_t size = 0;
-            zlistx_t *agents = zhashx_values(context->agents);
-            igsagent_t *target_agent = zlistx_first(agents);
-            while (target_agent && target_agent->uuid) {
-                if (streq (agent_name, target_agent->definition->name)) {
-                    igs_io_value_type_t input_type = igsagent_input_type (target_agent, input);
-                    if (zmsg_size (msg_duplicate) > 0) {
-                        igs_debug ("replaying %s.%s", agent_name, input);
-                        if (input_type == IGS_STRING_T) {
-                            value = zmsg_popstr (msg_duplicate);
-                            if (value == NULL) {
-                                igs_error ("value is NULL for replay message from %s(%s): rejecting", name, peerUUID);
-                                free (agent_name);
-                                free (input);
-                                zmsg_destroy (&msg_duplicate);
-                                zyre_event_destroy (&zyre_event);
-                                model_read_write_unlock(__FUNCTION__, __LINE__);
-                                return 0;
-                            }
-                            igs_io_t *io = model_write (target_agent, input, IGS_INPUT_T, input_type, value, strlen(value)+1);
-                            if (io){
-                                model_read_write_unlock(__FUNCTION__, __LINE__);
-                                model_LOCKED_handle_io_callbacks(target_agent, io);
-                                model_read_write_lock(__FUNCTION__, __LINE__);
-                            }
-                            free (value);
-                        } else {
-                            frame = zmsg_pop (msg_duplicate);
-                            if (frame == NULL) {
-                                igs_error ("value is NULL for replay message from %s(%s): rejecting", name, peerUUID);
-                                free (agent_name);
-                                free (input);
-                                zmsg_destroy (&msg_duplicate);
-                                zyre_event_destroy (&zyre_event);
-                                model_read_write_unlock(__FUNCTION__, __LINE__);
-                                return 0;
-                            }
-                            data = zframe_data (frame);
-                            size = zframe_size (frame);
-                            igs_io_t *io = model_write (target_agent, input, IGS_INPUT_T, input_type, data, size);
-                            if (io){
-                                model_read_write_unlock(__FUNCTION__, __LINE__);
-                                model_LOCKED_handle_io_callbacks(target_agent, io);
-                                model_read_write_lock(__FUNCTION__, __LINE__);
-                            }
-                            zframe_destroy (&frame);
-                        }
-                    }
-                    else
-                        igsagent_error (target_agent, "replay message for input %s is not correct and was ignored", input);
-                }
-                target_agent = zlistx_next(agents);
-            }
-            zlistx_destroy(&agents);
-            free (agent_name);
-            free (input);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+static int s_handle_get_snapshot (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    // a peer missed some of our versioned updates
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_HANDLED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup (context->agents, uuid);
+    if (agent) {
+        s_send_definition_to_zyre_peer (agent, peerUUID,
+                                        (agent->definition->json) ? agent->definition->json : "", false);
+        s_send_mapping_to_zyre_peer (agent, peerUUID,
+                                     (agent->mapping->json) ? agent->mapping->json : "");
+    }
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-        }
-        else if (streq (group, IGS_PRIVATE_CHANNEL)) {
-            char *title = zmsg_popstr (msg_duplicate);
-            if (title && streq (title, REMOTE_AGENT_EXIT_MSG)) {
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                char *uuid = zmsg_popstr (msg_duplicate);
-                if (uuid){
-                    igs_remote_agent_t *remote = zhashx_lookup(context->remote_agents, uuid);
-                    if (remote) {
-                        igs_debug ("<-%s (%s) exited", remote->definition->name, uuid);
-                        split_remove_worker (context, uuid, NULL);
-                        zhashx_delete(context->remote_agents, remote->uuid);
-                        char *def_name = strdup(remote->definition->name);
-                        s_clean_and_free_remote_agent (&remote);
-                        model_read_write_unlock(__FUNCTION__, __LINE__);
-                        agent_LOCKED_propagate_agent_event (IGS_AGENT_EXITED, uuid, def_name, NULL);
-                        model_read_write_lock(__FUNCTION__, __LINE__);
-                        free(def_name);
-                    } else
-                        igs_error ("%s is not a known remote agent", uuid);
-                    free (uuid);
-                } else
-                    igs_error("exit message without UUID : rejecting");
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-            } else if (title && strncmp(title, RT_SET_TIME_MSG, strlen(RT_SET_TIME_MSG)) == 0){
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                char *timestamp_str = title + strlen(RT_SET_TIME_MSG);
-                if (*timestamp_str){
-                    int64_t timestamp = atoll(timestamp_str);
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    igs_rt_set_time(timestamp);
-                }else
-                    igs_error("timestamp missing in RT_SET_TIME command : rejecting");
-            } else if (!title)
-                igs_error("whisper message to private channel is missing title : rejecting");
-            free (title);
-        }
+static int s_handle_load_definition (igs_core_context_t *context,
+                                     const char *peerUUID,
+                                     const char *name,
+                                     const char *title,
+                                     zmsg_t *msg)
+{
+    // identify agent
+    char *str_definition = zmsg_popstr (msg);
+    if (str_definition == NULL) {
+        igs_error ("no valid definition in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (str_definition);
+        return IGS_WHISPER_REJECTED;
     }
-    else if (streq (event, "WHISPER")) {
-        char *title = zmsg_popstr (msg_duplicate);
-        if (!title) {
-            igs_error ("no header in message received from %s(%s): rejecting", name, peerUUID);
-            zmsg_destroy (&msg_duplicate);
-            zyre_event_destroy (&zyre_event);
-            return 0;
-        }
 
-        if (streq (title, REMOTE_PEER_KNOWS_AGENT_MSG)) {
-            // distant peer has received one of our agents definition
-            // => all agents in this peer know us
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (agent) {
-                //all remote agents attached to the peer know this agent : notify this agent
-                zlist_t *agent_event_callbacks = zlist_dup(agent->agent_event_callbacks);
-                igs_agent_event_wrapper_t *cb = zlist_first(agent_event_callbacks);
-                while (cb && cb->callback_ptr) {
-                    // iterate on all remote agents *for this peer* : all ITS agents know THIS agent
-                    zlistx_t *remote_agents = zhashx_values(core_context->remote_agents);
-                    igs_remote_agent_t *r = zlistx_first(remote_agents);
-                    while (agent->uuid && r && r->uuid) {
-                        if (streq (r->peer->peer_id, peerUUID)){
-                            model_read_write_unlock(__FUNCTION__, __LINE__);
-                            if (agent->uuid && r->uuid)
-                                cb->callback_ptr (agent, IGS_AGENT_KNOWS_US, r->uuid, r->definition->name, NULL, cb->my_data);
-                            model_read_write_lock(__FUNCTION__, __LINE__);
-                        }
-                        r = zlistx_next(remote_agents);
-                    }
-                    zlistx_destroy(&remote_agents);
-                    cb = zlist_next(agent_event_callbacks);
-                }
-                zlist_destroy(&agent_event_callbacks);
-            } // else agent has disappeared on our side (disabled or destroyed)
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        free (str_definition);
+        if (uuid)
             free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, EXTERNAL_DEFINITION_MSG)) {
-            // identify remote agent or create it if unknown.
-            // NB: we suppose that remote agent creation is achieved when
-            // the agent sends its definition for the first time.
-            // Agents without definition are considered impossible.
-            char *str_definition = zmsg_popstr (msg_duplicate);
-            if (str_definition == NULL) {
-                igs_error ("no valid definition in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (str_definition);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *remote_agent_name = zmsg_popstr (msg_duplicate);
-            if (remote_agent_name == NULL) {
-                igs_error ("no valid agent name in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (str_definition);
-                free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // Load definition from string content
-            igs_definition_t *new_definition = parser_load_definition (str_definition);
-            if (new_definition && new_definition->name) {
-                definition_update_json (new_definition);
-                bool is_remote_agent_new = false;
-                igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
-                if (!remote_agent) {
-                    remote_agent = (igs_remote_agent_t *) zmalloc (sizeof (igs_remote_agent_t));
-                    remote_agent->context = context;
-                    remote_agent->uuid = strdup (uuid);
-                    remote_agent->mapping_filters = zlist_new();
-                    igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
-                    assert (zyre_peer);
-                    remote_agent->peer = zyre_peer;
-                    remote_agent->definition = new_definition;
-                    zhashx_insert(context->remote_agents, remote_agent->uuid, remote_agent);
-                    igs_debug ("registering agent %s(%s)", uuid, remote_agent_name);
-                    is_remote_agent_new = true;
-                } else {
-                    // else we already know this agent, its definition (possibly including name)
-                    // has been updated
-                    igs_debug ("Definition already exists for remote agent %s : new definition will overwrite the previous one...", remote_agent->definition->name);
-                    if (strneq (remote_agent->definition->name,new_definition->name))
-                        igs_debug ("Remote agent is changing name from %s to %s", remote_agent->definition->name, new_definition->name);
-                    igs_definition_t *old_def = remote_agent->definition;
-                    remote_agent->definition = new_definition;
-                    definition_free_definition (&old_def);
-                }
-                assert (remote_agent);
-
-                igs_debug ("store definition for remote agent %s(%s)",
-                           remote_agent->definition->name, remote_agent->uuid);
-                // Check the involvement of this new remote agent and its definition in
-                // our agent mappings and update subscriptions. We check here because
-                // remote agent definition is required to handle received data.
-                igsagent_t *agent = zhashx_first(context->agents);
-                while (agent) {
-                    s_network_configure_mapping_to_remote_agent (agent, remote_agent);
-                    agent = zhashx_next(context->agents);
-                }
+    // load definition
+    if (igsagent_definition_load_str (agent, str_definition) == IGS_SUCCESS) {
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        // recheck mapping towards our new definition
+        igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
+        while (remote) {
+            s_network_configure_mapping_to_remote_agent (agent, remote);
+            remote = zhashx_next(context->remote_agents);
+        }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+    }
+    free (str_definition);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
 
-                if (is_remote_agent_new) {
-                    // notify remote agent that our agents knows it
-                    s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                    zmsg_t *msg_know = zmsg_new ();
-                    zmsg_addstr (msg_know, REMOTE_PEER_KNOWS_AGENT_MSG);
-                    zmsg_addstr (msg_know, uuid);
-                    zyre_whisper (node, peerUUID, &msg_know);
-                    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-
-                    // Send hello message for splitter creation if a split exists with
-                    // the new remote agent.
-                    igsagent_t *elt_agent = zhashx_first(context->agents);
-                    while (elt_agent) {
-                        igs_split_t *elt = zlist_first(elt_agent->mapping->split_elements);
-                        while (elt) {
-                            if (streq (elt->to_agent, remote_agent_name)) {
-                                zmsg_t *ready_message = zmsg_new ();
-                                zmsg_addstr (ready_message, WORKER_HELLO_MSG);
-                                zmsg_addstr (ready_message, elt_agent->uuid);
-                                zmsg_addstr (ready_message, elt->from_input);
-                                zmsg_addstr (ready_message, elt->to_output);
-                                zmsg_addstrf (ready_message, "%i",IGS_DEFAULT_WORKER_CREDIT);
-                                model_read_write_unlock(__FUNCTION__, __LINE__);
-                                if (remote_agent->uuid)
-                                    igs_channel_whisper_zmsg (remote_agent->uuid, &ready_message);
-                                model_read_write_lock(__FUNCTION__, __LINE__);
-                            }
-                            elt = zlist_next(elt_agent->mapping->split_elements);
-                        }
-                        elt_agent = zhashx_next(context->agents);
-                    }
+static int s_handle_load_mapping (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    // identify agent
+    char *str_mapping = zmsg_popstr (msg);
+    if (str_mapping == NULL) {
+        igs_error ("no valid mapping in %s message received from  %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (str_mapping);
+        return IGS_WHISPER_REJECTED;
+    }
 
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    agent_LOCKED_propagate_agent_event (IGS_AGENT_ENTERED, uuid, remote_agent_name, str_definition);
-                    model_read_write_lock(__FUNCTION__, __LINE__);
-                    // Additonal notification flag below means that the remote agent has been
-                    // started during runtime: remote peer init has already been done and
-                    // this remote agent knows our agents already => propagate to our
-                    // agents immediately.
-                    char *notification = zmsg_popstr (msg_duplicate);
-                    if (notification) {
-                        model_read_write_unlock(__FUNCTION__, __LINE__);
-                        agent_LOCKED_propagate_agent_event (IGS_AGENT_KNOWS_US, uuid, remote_agent_name, NULL);
-                        model_read_write_lock(__FUNCTION__, __LINE__);
-                        free (notification);
-                    }
-                }else{
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    if (remote_agent->uuid)
-                        agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION,
-                                                            uuid, remote_agent_name, remote_agent->definition->json);
-                    model_read_write_lock(__FUNCTION__, __LINE__);
-                }
-            } else {
-                if (new_definition && !new_definition->name){
-                    igs_error ("received definition from remote agent %s(%s) does not contain a name : rejecting", remote_agent_name, uuid);
-                    definition_free_definition(&new_definition);
-                }else
-                    igs_error ("received definition from remote agent %s(%s) is empty or invalid : agent will not be registered",
-                               remote_agent_name, uuid);
-            }
-            free (str_definition);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        free (str_mapping);
+        if (uuid)
             free (uuid);
-            free (remote_agent_name);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    // Load mapping from string content
+    igs_mapping_t *new_mapping = parser_load_mapping (str_mapping);
+    if (new_mapping) {
+        if (agent->mapping)
+            mapping_free_mapping (&agent->mapping);
+        agent->mapping = new_mapping;
+        mapping_index_update_agent(agent);
+        // check and activate mapping
+        igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
+        while (remote) {
+            s_network_configure_mapping_to_remote_agent (agent, remote);
+            remote = zhashx_next(context->remote_agents);
         }
-        else if (streq (title, EXTERNAL_MAPPING_MSG)) {
-            // identify remote agent
-            char *str_mapping = zmsg_popstr (msg_duplicate);
-            if (str_mapping == NULL) {
-                igs_error ("no valid mapping in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("uuid is NULL in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (str_mapping);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        mapping_update_json(agent->mapping);
+        agent->network_need_to_send_mapping_update = true;
+    }
+    free (str_mapping);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
-            if (!remote_agent) {
-                igs_error ("no known remote agent with uuid '%s': rejecting", uuid);
-                free (str_mapping);
-                free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
+// OTHER MESSAGES
+static int s_handle_get_current_outputs (igs_core_context_t *context,
+                                         const char *peerUUID,
+                                         const char *name,
+                                         const char *title,
+                                         zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    // identify agent
+    char *uuid = zmsg_popstr (msg);
+    if (!uuid) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        return IGS_WHISPER_REJECTED;
+    }
 
-            igs_mapping_t *new_mapping = NULL;
-            if (strlen (str_mapping) > 0) {
-                // load mapping from string content
-                new_mapping = parser_load_mapping (str_mapping);
-                if (new_mapping == NULL)
-                    igs_error ("received mapping for agent %s(%s) could not be parsed properly",
-                               remote_agent->definition->name, remote_agent->uuid);
-            } else {
-                igs_debug ("received mapping from agent %s(%s) is empty", remote_agent->definition->name, remote_agent->uuid);
-                if (remote_agent && remote_agent->mapping) {
-                    mapping_free_mapping (&remote_agent->mapping);
-                    remote_agent->mapping = NULL;
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    if (remote_agent->uuid)
-                        agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, uuid,
-                                                            remote_agent->definition->name, NULL); //mapping is empty => arg is NULL
-                    model_read_write_lock(__FUNCTION__, __LINE__);
-                }
-            }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    zmsg_t *msg_to_send = zmsg_new ();
+    zmsg_addstr (msg_to_send, CURRENT_OUTPUTS_MSG);
+    zmsg_addstr (msg_to_send, agent->uuid);
+    igs_io_t *current = zhashx_first(agent->definition->outputs_table);
+    while (current) {
+        switch (current->value_type) {
+            case IGS_INTEGER_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf(msg_to_send,"%d", current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.i), sizeof (int));
+                break;
+            case IGS_DOUBLE_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf(msg_to_send,"%d", current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.d), sizeof (double));
+                break;
+            case IGS_STRING_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf(msg_to_send,"%d", current->value_type);
+                if (current->value.s)
+                    zmsg_addstr (msg_to_send, current->value.s);
+                else
+                    zmsg_addstr (msg_to_send, "");
+                break;
+            case IGS_BOOL_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf(msg_to_send,"%d", current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.b), sizeof (bool));
+                break;
+            case IGS_IMPULSION_T:
+                // sending impulsions a posteriori does not make sense : skipping
+                break;
+            case IGS_DATA_T:
+                zmsg_addstr(msg_to_send, current->name);
+                zmsg_addstrf(msg_to_send,"%d", current->value_type);
+                zmsg_addmem(msg_to_send, current->value.data, current->value_size);
+                break;
 
-            if (new_mapping && remote_agent) {
-                // look if this agent already has a mapping
-                if (remote_agent->mapping) {
-                    igs_debug ("mapping already exists for agent %s(%s) : new mapping will overwrite the previous one...",
-                               remote_agent->definition->name, remote_agent->uuid);
-                    mapping_free_mapping (&remote_agent->mapping);
-                }
+            default:
+                break;
+        }
+        current = zhashx_next(agent->definition->outputs_table);
+    }
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    igs_debug ("send output values privately to %s", peerUUID);
+    zyre_whisper (node, peerUUID, &msg_to_send);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-                igs_debug ("store mapping for agent %s(%s)", remote_agent->definition->name, remote_agent->uuid);
-                remote_agent->mapping = new_mapping;
-                mapping_update_json(remote_agent->mapping);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                if (remote_agent->uuid)
-                    agent_LOCKED_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, uuid,
-                                                        remote_agent->definition->name, str_mapping);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-            }
-            free (str_mapping);
+static int s_handle_current_outputs (igs_core_context_t *context,
+                                     const char *peerUUID,
+                                     const char *name,
+                                     const char *title,
+                                     zmsg_t *msg)
+{
+    char *uuid = zmsg_popstr (msg);
+    if (!uuid) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
+    if (!remote_agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, LOAD_DEFINITION_MSG)) {
-            // identify agent
-            char *str_definition = zmsg_popstr (msg_duplicate);
-            if (str_definition == NULL) {
-                igs_error ("no valid definition in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (str_definition);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                free (str_definition);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("privately received output values from %s (%s)",
+               remote_agent->definition->name, remote_agent->uuid);
+    s_handle_publication (&msg, remote_agent);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-            // load definition
-            if (igsagent_definition_load_str (agent, str_definition) == IGS_SUCCESS) {
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                // recheck mapping towards our new definition
-                igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
-                while (remote) {
-                    s_network_configure_mapping_to_remote_agent (agent, remote);
-                    remote = zhashx_next(context->remote_agents);
-                }
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-            }
-            free (str_definition);
+static int s_handle_get_current_inputs (igs_core_context_t *context,
+                                        const char *peerUUID,
+                                        const char *name,
+                                        const char *title,
+                                        zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, LOAD_MAPPING_MSG)) {
-            // identify agent
-            char *str_mapping = zmsg_popstr (msg_duplicate);
-            if (str_mapping == NULL) {
-                igs_error ("no valid mapping in %s message received from  %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (str_mapping);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        return IGS_WHISPER_REJECTED;
+    }
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                free (str_mapping);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                return 0;
-            }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    zmsg_t *msg_to_send = zmsg_new ();
+    zmsg_addstr (msg_to_send, CURRENT_INPUTS_MSG);
+    zmsg_addstr (msg_to_send, agent->uuid);
+    const char* io_name = zlist_first(agent->definition->inputs_names_ordered);
+    while (io_name) {
+        igs_io_t *current = (igs_io_t*) zhashx_lookup (agent->definition->inputs_table, io_name);
+        assert(current);
+        switch (current->value_type) {
+            case IGS_INTEGER_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.i),
+                                sizeof (int));
+                break;
+            case IGS_DOUBLE_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.d),
+                                sizeof (double));
+                break;
+            case IGS_STRING_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addstr (msg_to_send, current->value.s);
+                break;
+            case IGS_BOOL_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.b),
+                                sizeof (bool));
+                break;
+            case IGS_IMPULSION_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, NULL, 0);
+                break;
+            case IGS_DATA_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, (current->value.data),
+                                current->value_size);
+                break;
 
-            // Load mapping from string content
-            igs_mapping_t *new_mapping = parser_load_mapping (str_mapping);
-            if (new_mapping) {
-                if (agent->mapping)
-                    mapping_free_mapping (&agent->mapping);
-                agent->mapping = new_mapping;
-                // check and activate mapping
-                igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
-                while (remote) {
-                    s_network_configure_mapping_to_remote_agent (agent, remote);
-                    remote = zhashx_next(context->remote_agents);
-                }
-                mapping_update_json(agent->mapping);
-                agent->network_need_to_send_mapping_update = true;
-            }
-            free (str_mapping);
-            free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+            default:
+                break;
         }
-        // OTHER MESSAGES
-        else if (streq (title, GET_CURRENT_OUTPUTS_MSG)) {
-            // identify agent
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (!uuid) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // check that this agent has not been destroyed when we were locked
-            zmsg_t *msg_to_send = zmsg_new ();
-            zmsg_addstr (msg_to_send, CURRENT_OUTPUTS_MSG);
-            zmsg_addstr (msg_to_send, agent->uuid);
-            igs_io_t *current = zhashx_first(agent->definition->outputs_table);
-            while (current) {
-                switch (current->value_type) {
-                    case IGS_INTEGER_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf(msg_to_send,"%d", current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.i), sizeof (int));
-                        break;
-                    case IGS_DOUBLE_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf(msg_to_send,"%d", current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.d), sizeof (double));
-                        break;
-                    case IGS_STRING_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf(msg_to_send,"%d", current->value_type);
-                        if (current->value.s)
-                            zmsg_addstr (msg_to_send, current->value.s);
-                        else
-                            zmsg_addstr (msg_to_send, "");
-                        break;
-                    case IGS_BOOL_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf(msg_to_send,"%d", current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.b), sizeof (bool));
-                        break;
-                    case IGS_IMPULSION_T:
-                        // sending impulsions a posteriori does not make sense : skipping
-                        break;
-                    case IGS_DATA_T:
-                        zmsg_addstr(msg_to_send, current->name);
-                        zmsg_addstrf(msg_to_send,"%d", current->value_type);
-                        zmsg_addmem(msg_to_send, current->value.data, current->value_size);
-                        break;
+        io_name = zlist_next(agent->definition->inputs_names_ordered);
+    }
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    igs_debug ("send input values to %s", peerUUID);
+    zyre_whisper (node, peerUUID, &msg_to_send);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-                    default:
-                        break;
-                }
-                current = zhashx_next(agent->definition->outputs_table);
-            }
-            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            igs_debug ("send output values privately to %s", peerUUID);
-            zyre_whisper (node, peerUUID, &msg_to_send);
-            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+static int s_handle_get_current_attributes (igs_core_context_t *context,
+                                            const char *peerUUID,
+                                            const char *name,
+                                            const char *title,
+                                            zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    // identify agent
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    zmsg_t *msg_to_send = zmsg_new ();
+    zmsg_addstr (msg_to_send, CURRENT_ATTRIBUTES_MSG);
+    zmsg_addstr (msg_to_send, agent->uuid);
+    const char* io_name = zlist_first(agent->definition->attributes_names_ordered);
+    while (io_name) {
+        igs_io_t *current = (igs_io_t*) zhashx_lookup (agent->definition->attributes_table, io_name);
+        assert(current);
+        switch (current->value_type) {
+            case IGS_INTEGER_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.i),
+                                sizeof (int));
+                break;
+            case IGS_DOUBLE_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.d),
+                                sizeof (double));
+                break;
+            case IGS_STRING_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addstr (msg_to_send, current->value.s);
+                break;
+            case IGS_BOOL_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, &(current->value.b),
+                                sizeof (bool));
+                break;
+            case IGS_IMPULSION_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, NULL, 0);
+                break;
+            case IGS_DATA_T:
+                zmsg_addstr (msg_to_send, current->name);
+                zmsg_addstrf (msg_to_send, "%d",
+                                current->value_type);
+                zmsg_addmem (msg_to_send, (current->value.data),
+                                current->value_size);
+                break;
+
+            default:
+                break;
         }
-        else if (streq (title, CURRENT_OUTPUTS_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (!uuid) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        io_name = zlist_next(agent->definition->attributes_names_ordered);
+    }
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    igs_debug ("send attributes values to %s", peerUUID);
+    zyre_whisper (node, peerUUID, &msg_to_send);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    free (uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igs_remote_agent_t *remote_agent = zhashx_lookup(context->remote_agents, uuid);
-            if (!remote_agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            igs_debug ("privately received output values from %s (%s)",
-                       remote_agent->definition->name, remote_agent->uuid);
-            s_handle_publication (&msg_duplicate, remote_agent);
-            free (uuid);
+static int s_handle_start_agent (igs_core_context_t *context,
+                                 const char *peerUUID,
+                                 const char *name,
+                                 const char *title,
+                                 zmsg_t *msg)
+{
+    char *agent_name = zmsg_popstr (msg);
+    if (agent_name == NULL) {
+        igs_error ("no agent name in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_debug ("received 'START_AGENT %s' command from %s (%s)", agent_name, name, peerUUID);
+    igsagent_t *a = zhashx_first (core_context->created_agents);
+    while (a && a->uuid) {
+        if (streq (a->definition->name, agent_name)) {
+            igs_info ("activating agent %s (%s)", a->definition->name, a->uuid);
             model_read_write_unlock(__FUNCTION__, __LINE__);
+            igsagent_activate (a);
+            model_read_write_lock(__FUNCTION__, __LINE__);
+            break;
         }
-        else if (streq (title, GET_CURRENT_INPUTS_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        a = zhashx_next (core_context->created_agents);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // check that this agent has not been destroyed when we were locked
-            zmsg_t *msg_to_send = zmsg_new ();
-            zmsg_addstr (msg_to_send, CURRENT_INPUTS_MSG);
-            zmsg_addstr (msg_to_send, agent->uuid);
-            const char* io_name = zlist_first(agent->definition->inputs_names_ordered);
-            while (io_name) {
-                igs_io_t *current = (igs_io_t*) zhashx_lookup (agent->definition->inputs_table, io_name);
-                assert(current);
-                switch (current->value_type) {
-                    case IGS_INTEGER_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.i),
-                                        sizeof (int));
-                        break;
-                    case IGS_DOUBLE_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.d),
-                                        sizeof (double));
-                        break;
-                    case IGS_STRING_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addstr (msg_to_send, current->value.s);
-                        break;
-                    case IGS_BOOL_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.b),
-                                        sizeof (bool));
-                        break;
-                    case IGS_IMPULSION_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, NULL, 0);
-                        break;
-                    case IGS_DATA_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, (current->value.data),
-                                        current->value_size);
-                        break;
+static int s_handle_stop_agent (igs_core_context_t *context,
+                                const char *peerUUID,
+                                const char *name,
+                                const char *title,
+                                zmsg_t *msg)
+{
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
 
-                    default:
-                        break;
-                }
-                io_name = zlist_next(agent->definition->inputs_names_ordered);
-            }
-            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            igs_debug ("send input values to %s", peerUUID);
-            zyre_whisper (node, peerUUID, &msg_to_send);
-            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, GET_CURRENT_ATTRIBUTES_MSG)) {
-            // identify agent
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received 'STOP_AGENT %s' command from %s (%s)", uuid, name, peerUUID);
+    igs_info ("deactivating agent %s (%s)", agent->definition->name, agent->uuid);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_deactivate (agent);
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // check that this agent has not been destroyed when we were locked
-            zmsg_t *msg_to_send = zmsg_new ();
-            zmsg_addstr (msg_to_send, CURRENT_ATTRIBUTES_MSG);
-            zmsg_addstr (msg_to_send, agent->uuid);
-            const char* io_name = zlist_first(agent->definition->attributes_names_ordered);
-            while (io_name) {
-                igs_io_t *current = (igs_io_t*) zhashx_lookup (agent->definition->attributes_table, io_name);
-                assert(current);
-                switch (current->value_type) {
-                    case IGS_INTEGER_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.i),
-                                        sizeof (int));
-                        break;
-                    case IGS_DOUBLE_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.d),
-                                        sizeof (double));
-                        break;
-                    case IGS_STRING_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addstr (msg_to_send, current->value.s);
-                        break;
-                    case IGS_BOOL_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, &(current->value.b),
-                                        sizeof (bool));
-                        break;
-                    case IGS_IMPULSION_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, NULL, 0);
-                        break;
-                    case IGS_DATA_T:
-                        zmsg_addstr (msg_to_send, current->name);
-                        zmsg_addstrf (msg_to_send, "%d",
-                                        current->value_type);
-                        zmsg_addmem (msg_to_send, (current->value.data),
-                                        current->value_size);
-                        break;
+static int s_handle_stop_peer (igs_core_context_t *context,
+                               const char *peerUUID,
+                               const char *name,
+                               const char *title,
+                               zmsg_t *msg)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    context->external_stop = true;
+    igs_debug ("received STOP_PEER command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_STOP;
+}
 
-                    default:
-                        break;
-                }
-                io_name = zlist_next(agent->definition->attributes_names_ordered);
-            }
-            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            igs_debug ("send attributes values to %s", peerUUID);
-            zyre_whisper (node, peerUUID, &msg_to_send);
-            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+static int s_handle_clear_mapping (igs_core_context_t *context,
+                                   const char *peerUUID,
+                                   const char *name,
+                                   const char *title,
+                                   zmsg_t *msg)
+{
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from  %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, START_AGENT_MSG)) {
-            char *agent_name = zmsg_popstr (msg_duplicate);
-            if (agent_name == NULL) {
-                igs_error ("no agent name in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received CLEAR_MAPPING command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_clear_mappings (agent);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
 
+static int s_handle_freeze (igs_core_context_t *context,
+                            const char *peerUUID,
+                            const char *name,
+                            const char *title,
+                            zmsg_t *msg)
+{
+    igs_debug ("received FREEZE command from %s (%s)", name, peerUUID);
+    igs_freeze ();
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igs_debug ("received 'START_AGENT %s' command from %s (%s)", agent_name, name, peerUUID);
-            igsagent_t *a = zhashx_first (core_context->created_agents);
-            while (a && a->uuid) {
-                if (streq (a->definition->name, agent_name)) {
-                    igs_info ("activating agent %s (%s)", a->definition->name, a->uuid);
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    igsagent_activate (a);
-                    model_read_write_lock(__FUNCTION__, __LINE__);
-                    break;
-                }
-                a = zhashx_next (core_context->created_agents);
-            }
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, STOP_AGENT_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
+static int s_handle_unfreeze (igs_core_context_t *context,
+                              const char *peerUUID,
+                              const char *name,
+                              const char *title,
+                              zmsg_t *msg)
+{
+    igs_debug ("received UNFREEZE command from %s (%s)", name, peerUUID);
+    igs_unfreeze ();
+    return IGS_WHISPER_HANDLED;
+}
 
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received 'STOP_AGENT %s' command from %s (%s)", uuid, name, peerUUID);
-            igs_info ("deactivating agent %s (%s)", agent->definition->name, agent->uuid);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_deactivate (agent);
-        }
-        else if (streq (title, STOP_PEER_MSG)) {
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            context->external_stop = true;
-            igs_debug ("received STOP_PEER command from %s (%s)", name, peerUUID);
-            free (title);
-            zmsg_destroy (&msg_duplicate);
-            zyre_event_destroy (&zyre_event);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            // stop our zyre loop by returning -1 : this will start the cleaning process
-            return -1;
-        }
-        else if (streq (title, CLEAR_MAPPING_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from  %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received CLEAR_MAPPING command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_clear_mappings (agent);
-            free (uuid);
-        }
-        else if (streq (title, FREEZE_MSG)) {
-            igs_debug ("received FREEZE command from %s (%s)", name, peerUUID);
-            igs_freeze ();
-        }
-        else if (streq (title, UNFREEZE_MSG)) {
-            igs_debug ("received UNFREEZE command from %s (%s)", name, peerUUID);
-            igs_unfreeze ();
-        }
-        else if (streq (title, MUTE_ALL_MSG)) {
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igs_debug ("received MUTE_ALL command from %s (%s)", name, peerUUID);
-            zlistx_t *agents = zhashx_values(context->agents);
-            igsagent_t *agent = zlistx_first(agents);
-            while (agent && agent->uuid) {
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                igsagent_mute (agent);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                agent = zlistx_next(agents);
-            }
-            zlistx_destroy(&agents);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, UNMUTE_ALL_MSG)) {
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igs_debug ("received UNMUTE_ALL command from %s (%s)", name, peerUUID);
-            zlistx_t *agents = zhashx_values(context->agents);
-            igsagent_t *agent = zlistx_first(agents);
-            while (agent) {
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                igsagent_unmute (agent);
-                model_read_write_lock(__FUNCTION__, __LINE__);
-                agent = zlistx_next(agents);
-            }
-            zlistx_destroy(&agents);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, MUTE_AGENT_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (!uuid) {
-                igs_error ("no valid uuid in %s message received from  %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received MUTE_AGENT command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_mute (agent);
+static int s_handle_mute_all (igs_core_context_t *context,
+                              const char *peerUUID,
+                              const char *name,
+                              const char *title,
+                              zmsg_t *msg)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_debug ("received MUTE_ALL command from %s (%s)", name, peerUUID);
+    zlistx_t *agents = zhashx_values(context->agents);
+    igsagent_t *agent = zlistx_first(agents);
+    while (agent && agent->uuid) {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        igsagent_mute (agent);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        agent = zlistx_next(agents);
+    }
+    zlistx_destroy(&agents);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_unmute_all (igs_core_context_t *context,
+                                const char *peerUUID,
+                                const char *name,
+                                const char *title,
+                                zmsg_t *msg)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_debug ("received UNMUTE_ALL command from %s (%s)", name, peerUUID);
+    zlistx_t *agents = zhashx_values(context->agents);
+    igsagent_t *agent = zlistx_first(agents);
+    while (agent) {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        igsagent_unmute (agent);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        agent = zlistx_next(agents);
+    }
+    zlistx_destroy(&agents);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_mute_agent (igs_core_context_t *context,
+                                const char *peerUUID,
+                                const char *name,
+                                const char *title,
+                                zmsg_t *msg)
+{
+    char *uuid = zmsg_popstr (msg);
+    if (!uuid) {
+        igs_error ("no valid uuid in %s message received from  %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received MUTE_AGENT command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_mute (agent);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_unmute_agent (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received UNMUTE_AGENT command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_unmute (agent);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_mute_output (igs_core_context_t *context,
+                                 const char *peerUUID,
+                                 const char *name,
+                                 const char *title,
+                                 zmsg_t *msg)
+{
+    char *io_name = zmsg_popstr (msg);
+    if (io_name == NULL) {
+        igs_error ("no valid io name in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (io_name);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        free (io_name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received MUTE command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_output_mute (agent, io_name);
+    free (io_name);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_unmute_output (igs_core_context_t *context,
+                                   const char *peerUUID,
+                                   const char *name,
+                                   const char *title,
+                                   zmsg_t *msg)
+{
+    char *io_name = zmsg_popstr (msg);
+    if (io_name == NULL) {
+        igs_error ("no valid io name in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (io_name);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        free (io_name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received UNMUTE command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_output_unmute (agent, io_name);
+    free (io_name);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_set_io (igs_core_context_t *context,
+                            const char *peerUUID,
+                            const char *name,
+                            const char *title,
+                            zmsg_t *msg)
+{
+    char *io_name = zmsg_popstr (msg);
+    if (io_name == NULL) {
+        igs_error ("no valid io name in %s message received from %s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *value = zmsg_popstr (msg);
+    if (value == NULL) {
+        igs_error ("no valid value in %s message received from %s(%s): rejecting",
+                   title, name, peerUUID);
+        free (io_name);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting",
+                   title, name, peerUUID);
+        free (io_name);
+        free (value);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        free (io_name);
+        free (value);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    bool shall_inject = true;
+    zframe_t *value_type_f = zmsg_pop(msg);
+    if (value_type_f){
+        int64_t value_type = 0;
+        memcpy(&value_type, zframe_data(value_type_f), sizeof(int64_t));
+        if (value_type>= IGS_TIMESTAMPED_INTEGER_T
+            && value_type <= IGS_TIMESTAMPED_DATA_T){
+            //TODO: implement msg decoding (from hex string), data extraction and timestamp set
+            if (streq (title, SET_INPUT_MSG))
+                igs_error("injection of timestamped values is not supported yet : input %s.%s will not be injected",
+                          agent->definition->name, io_name);
+            else if (streq (title, SET_OUTPUT_MSG))
+                igs_error("injection of timestamped values is not supported yet : output %s.%s will not be injected",
+                          agent->definition->name, io_name);
+            else if (streq (title, SET_ATTRIBUTE_MSG))
+                igs_error("injection of timestamped values is not supported yet : attribute %s.%s will not be injected",
+                          agent->definition->name, io_name);
+            shall_inject = false;
         }
-        else if (streq (title, UNMUTE_AGENT_MSG)) {
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received UNMUTE_AGENT command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_unmute (agent);
+        zframe_destroy(&value_type_f);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (shall_inject){
+        if (streq (title, SET_INPUT_MSG)){
+            igs_debug ("received SET_INPUT command from %s (%s)", name, peerUUID);
+            if (io_name && value)
+                igsagent_input_set_string (agent, io_name, value);
+        } else if (streq (title, SET_OUTPUT_MSG)){
+            igs_debug ("received SET_OUTPUT command from %s (%s)", name, peerUUID);
+            if (io_name && value)
+                igsagent_output_set_string (agent, io_name, value);
+        } else if (streq (title, SET_ATTRIBUTE_MSG)){
+            igs_debug ("received SET_ATTRIBUTE command from %s (%s)", name, peerUUID);
+            if (io_name && value)
+                igsagent_attribute_set_string (agent, io_name, value);
         }
-        else if (streq (title, MUTE_OUTPUT_MSG)) {
-            char *io_name = zmsg_popstr (msg_duplicate);
-            if (io_name == NULL) {
-                igs_error ("no valid io name in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (io_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (io_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received MUTE command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_output_mute (agent, io_name);
-            free (io_name);
+    }
+    free (io_name);
+    free (value);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_map (igs_core_context_t *context,
+                         const char *peerUUID,
+                         const char *name,
+                         const char *title,
+                         zmsg_t *msg)
+{
+    char *input = zmsg_popstr (msg);
+    if (input == NULL) {
+        igs_error ("no valid input in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *remote_agent = zmsg_popstr (msg);
+    if (remote_agent == NULL) {
+        igs_error (
+                   "no valid agent name in %s message received from %s(%s): "
+                   "rejecting",
+                   title, name, peerUUID);
+        free (input);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *output = zmsg_popstr (msg);
+    if (output == NULL) {
+        igs_error ("no valid output in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        free (output);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, UNMUTE_OUTPUT_MSG)) {
-            char *io_name = zmsg_popstr (msg_duplicate);
-            if (io_name == NULL) {
-                igs_error ("no valid io name in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (io_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (io_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received UNMUTE command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_output_unmute (agent, io_name);
-            free (io_name);
+        free (input);
+        free (remote_agent);
+        free (output);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    igs_debug ("received MAP command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (input && remote_agent && output)
+        igsagent_mapping_add (agent, input, remote_agent, output);
+    free (input);
+    free (remote_agent);
+    free (output);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_unmap (igs_core_context_t *context,
+                           const char *peerUUID,
+                           const char *name,
+                           const char *title,
+                           zmsg_t *msg)
+{
+    char *input = zmsg_popstr (msg);
+    if (input == NULL) {
+        igs_error ("no valid input in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *remote_agent = zmsg_popstr (msg);
+    if (remote_agent == NULL) {
+        igs_error (
+                   "no valid agent name in %s message received from %s(%s): "
+                   "rejecting",
+                   title, name, peerUUID);
+        free (input);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *output = zmsg_popstr (msg);
+    if (output == NULL) {
+        igs_error ("no valid output in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        free (output);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, SET_INPUT_MSG) || streq (title, SET_OUTPUT_MSG) || streq (title, SET_ATTRIBUTE_MSG)) {
-            char *io_name = zmsg_popstr (msg_duplicate);
-            if (io_name == NULL) {
-                igs_error ("no valid io name in %s message received from %s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *value = zmsg_popstr (msg_duplicate);
-            if (value == NULL) {
-                igs_error ("no valid value in %s message received from %s(%s): rejecting",
-                           title, name, peerUUID);
-                free (io_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting",
-                           title, name, peerUUID);
-                free (io_name);
-                free (value);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (io_name);
-                free (value);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
+        free (input);
+        free (remote_agent);
+        free (output);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
 
-            bool shall_inject = true;
-            zframe_t *value_type_f = zmsg_pop(msg_duplicate);
-            if (value_type_f){
-                int64_t value_type = 0;
-                memcpy(&value_type, zframe_data(value_type_f), sizeof(int64_t));
-                if (value_type>= IGS_TIMESTAMPED_INTEGER_T
-                    && value_type <= IGS_TIMESTAMPED_DATA_T){
-                    //TODO: implement msg decoding (from hex string), data extraction and timestamp set
-                    if (streq (title, SET_INPUT_MSG))
-                        igs_error("injection of timestamped values is not supported yet : input %s.%s will not be injected",
-                                  agent->definition->name, io_name);
-                    else if (streq (title, SET_OUTPUT_MSG))
-                        igs_error("injection of timestamped values is not supported yet : output %s.%s will not be injected",
-                                  agent->definition->name, io_name);
-                    else if (streq (title, SET_ATTRIBUTE_MSG))
-                        igs_error("injection of timestamped values is not supported yet : attribute %s.%s will not be injected",
-                                  agent->definition->name, io_name);
-                    shall_inject = false;
-                }
-                zframe_destroy(&value_type_f);
-            }
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            if (shall_inject){
-                if (streq (title, SET_INPUT_MSG)){
-                    igs_debug ("received SET_INPUT command from %s (%s)", name, peerUUID);
-                    if (io_name && value)
-                        igsagent_input_set_string (agent, io_name, value);
-                } else if (streq (title, SET_OUTPUT_MSG)){
-                    igs_debug ("received SET_OUTPUT command from %s (%s)", name, peerUUID);
-                    if (io_name && value)
-                        igsagent_output_set_string (agent, io_name, value);
-                } else if (streq (title, SET_ATTRIBUTE_MSG)){
-                    igs_debug ("received SET_ATTRIBUTE command from %s (%s)", name, peerUUID);
-                    if (io_name && value)
-                        igsagent_attribute_set_string (agent, io_name, value);
-                }
-            }
-            free (io_name);
-            free (value);
+    igs_debug ("received UNMAP command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (input && remote_agent && output)
+        igsagent_mapping_remove_with_name (agent, input,
+                                           remote_agent, output);
+    free (input);
+    free (remote_agent);
+    free (output);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_add_split_entry (igs_core_context_t *context,
+                                     const char *peerUUID,
+                                     const char *name,
+                                     const char *title,
+                                     zmsg_t *msg)
+{
+    char *input = zmsg_popstr (msg);
+    if (input == NULL) {
+        igs_error ("no valid input in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *remote_agent = zmsg_popstr (msg);
+    if (remote_agent == NULL) {
+        igs_error (
+                   "no valid agent name in %s message received from %s(%s): "
+                   "rejecting",
+                   title, name, peerUUID);
+        free (input);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *output = zmsg_popstr (msg);
+    if (output == NULL) {
+        igs_error ("no valid output in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        free (output);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, MAP_MSG)) {
-            char *input = zmsg_popstr (msg_duplicate);
-            if (input == NULL) {
-                igs_error ("no valid input in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *remote_agent = zmsg_popstr (msg_duplicate);
-            if (remote_agent == NULL) {
-                igs_error (
-                           "no valid agent name in %s message received from %s(%s): "
-                           "rejecting",
-                           title, name, peerUUID);
-                free (input);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *output = zmsg_popstr (msg_duplicate);
-            if (output == NULL) {
-                igs_error ("no valid output in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
+        free (input);
+        free (remote_agent);
+        free (output);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
 
-            igs_debug ("received MAP command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            if (input && remote_agent && output)
-                igsagent_mapping_add (agent, input, remote_agent, output);
-            free (input);
-            free (remote_agent);
-            free (output);
+    igs_debug ("received ADD_SPLIT_ENTRY command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (input && remote_agent && output)
+        igsagent_split_add (agent, input, remote_agent, output);
+    free (input);
+    free (remote_agent);
+    free (output);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_remove_split_entry (igs_core_context_t *context,
+                                        const char *peerUUID,
+                                        const char *name,
+                                        const char *title,
+                                        zmsg_t *msg)
+{
+    char *input = zmsg_popstr (msg);
+    if (input == NULL) {
+        igs_error ("no valid input in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *remote_agent = zmsg_popstr (msg);
+    if (remote_agent == NULL) {
+        igs_error (
+                   "no valid agent name in %s message received from %s(%s): "
+                   "rejecting",
+                   title, name, peerUUID);
+        free (input);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *output = zmsg_popstr (msg);
+    if (output == NULL) {
+        igs_error ("no valid output in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (input);
+        free (remote_agent);
+        free (output);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, UNMAP_MSG)) {
-            char *input = zmsg_popstr (msg_duplicate);
-            if (input == NULL) {
-                igs_error ("no valid input in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *remote_agent = zmsg_popstr (msg_duplicate);
-            if (remote_agent == NULL) {
-                igs_error (
-                           "no valid agent name in %s message received from %s(%s): "
-                           "rejecting",
-                           title, name, peerUUID);
-                free (input);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *output = zmsg_popstr (msg_duplicate);
-            if (output == NULL) {
-                igs_error ("no valid output in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
+        free (input);
+        free (remote_agent);
+        free (output);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
 
-            igs_debug ("received UNMAP command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            if (input && remote_agent && output)
-                igsagent_mapping_remove_with_name (agent, input,
-                                                   remote_agent, output);
-            free (input);
-            free (remote_agent);
-            free (output);
+    igs_debug ("received REMOVE_SPLIT_ENTRY_MSG command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (input && remote_agent && output)
+        igsagent_split_remove_with_name (agent, input, remote_agent, output);
+    free (input);
+    free (remote_agent);
+    free (output);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+// ADMIN API
+static int s_handle_enable_log_stream (igs_core_context_t *context,
+                                       const char *peerUUID,
+                                       const char *name,
+                                       const char *title,
+                                       zmsg_t *msg)
+{
+    igs_debug ("received ENABLE_LOG_STREAM command from %s (%s)", name, peerUUID);
+    igs_log_set_stream (true);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_disable_log_stream (igs_core_context_t *context,
+                                        const char *peerUUID,
+                                        const char *name,
+                                        const char *title,
+                                        zmsg_t *msg)
+{
+    igs_debug ("received DISABLE_LOG_STREAM command from %s (%s)", name, peerUUID);
+    igs_log_set_stream (false);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_enable_log_file (igs_core_context_t *context,
+                                     const char *peerUUID,
+                                     const char *name,
+                                     const char *title,
+                                     zmsg_t *msg)
+{
+    igs_debug ("received ENABLE_LOG_FILE command from %s (%s)", name, peerUUID);
+    igs_log_set_file (true, core_context->log_file_path);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_disable_log_file (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg)
+{
+    igs_debug ("received DISABLE_LOG_FILE command from %s (%s)", name, peerUUID);
+    igs_log_set_file (false, core_context->log_file_path);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_set_log_path (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    char *log_path = zmsg_popstr (msg);
+    igs_debug ("received SET_LOG_PATH command from %s (%s)", name, peerUUID);
+    igs_log_set_file(igs_log_file(), log_path);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_set_definition_path (igs_core_context_t *context,
+                                         const char *peerUUID,
+                                         const char *name,
+                                         const char *title,
+                                         zmsg_t *msg)
+{
+    char *definition_path = zmsg_popstr (msg);
+    if (definition_path == NULL) {
+        igs_error ( "no valid definition path in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (definition_path);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
-        }
-        else if (streq (title, ADD_SPLIT_ENTRY_MSG)) {
-            char *input = zmsg_popstr (msg_duplicate);
-            if (input == NULL) {
-                igs_error ("no valid input in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *remote_agent = zmsg_popstr (msg_duplicate);
-            if (remote_agent == NULL) {
-                igs_error (
-                           "no valid agent name in %s message received from %s(%s): "
-                           "rejecting",
-                           title, name, peerUUID);
-                free (input);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *output = zmsg_popstr (msg_duplicate);
-            if (output == NULL) {
-                igs_error ("no valid output in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
+        free (definition_path);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received SET_DEFINITION_PATH command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_definition_set_path (agent, definition_path);
+    free (definition_path);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
 
-            igs_debug ("received ADD_SPLIT_ENTRY command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            if (input && remote_agent && output)
-                igsagent_split_add (agent, input, remote_agent, output);
-            free (input);
-            free (remote_agent);
-            free (output);
+static int s_handle_set_mapping_path (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg)
+{
+    char *mapping_path = zmsg_popstr (msg);
+    if (mapping_path == NULL) {
+        igs_error ("no valid mapping path in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free (mapping_path);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        free (mapping_path);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received SET_MAPPING_PATH command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_mapping_set_path (agent, mapping_path);
+    free (mapping_path);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_save_definition_to_path (igs_core_context_t *context,
+                                             const char *peerUUID,
+                                             const char *name,
+                                             const char *title,
+                                             zmsg_t *msg)
+{
+    // identify agent
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
+            free (uuid);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received SAVE_DEFINITION_TO_PATH command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_definition_save (agent);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_save_mapping_to_path (igs_core_context_t *context,
+                                          const char *peerUUID,
+                                          const char *name,
+                                          const char *title,
+                                          zmsg_t *msg)
+{
+    // identify agent
+    char *uuid = zmsg_popstr (msg);
+    if (uuid == NULL) {
+        igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igsagent_t *agent = zhashx_lookup(context->agents, uuid);
+    if (!agent) {
+        igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
+        if (uuid)
             free (uuid);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+    igs_debug ("received SAVE_MAPPING_TO_PATH command from %s (%s)", name, peerUUID);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    igsagent_mapping_save (agent);
+    free (uuid);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_call_service (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    char *caller_uuid = zmsg_popstr (msg);
+    if (caller_uuid == NULL) {
+        igs_error ("no valid caller_uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        return IGS_WHISPER_REJECTED;
+    }
+    char *callee_uuid = zmsg_popstr (msg);
+    if (callee_uuid == NULL) {
+        igs_error ("no valid caller_uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
+        free(caller_uuid);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    char *caller_name = strdup(name); // default caller name is the one of the peer
+    if (streq (title, CALL_SERVICE_MSG_DEPRECATED))
+        igs_warn ("Remote agent %s(%s) uses an older version of Ingescape with deprecated messages. Please upgrade this agent.",
+                  caller_name, caller_uuid);
+
+    igs_remote_agent_t *caller_agent = zhashx_lookup(context->remote_agents, caller_uuid);
+    if (caller_agent) {
+        // replace caller name by the one of an actual agent
+        free(caller_name);
+        caller_name = strdup(caller_agent->definition->name);
+    }
+
+    igsagent_t *callee_agent = zhashx_lookup(context->agents, callee_uuid);
+    if (!callee_agent) {
+        igs_error ("no callee agent with uuid '%s' in %s message received from %s(%s): rejecting", callee_uuid, title, name, peerUUID);
+        free (callee_uuid);
+        free (caller_uuid);
+        free(caller_name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    char *service_name = zmsg_popstr (msg);
+    if (service_name == NULL) {
+        igs_error ("no service name in %s message received from "
+                   "%s(%s): rejecting",
+                   title, name, peerUUID);
+        free (caller_uuid);
+        free (callee_uuid);
+        free(caller_name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    char *token = zmsg_popstr (msg);
+    if (token == NULL) {
+        igs_error ("no token in %s message received from %s(%s): rejecting",
+                   title, name, peerUUID);
+        free (caller_uuid);
+        free (callee_uuid);
+        free(caller_name);
+        free (service_name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_WHISPER_REJECTED;
+    }
+
+    igs_pending_service_call_t *pending_call = service_take_pending_call (callee_agent, token);
+    if (pending_call) {
+        // this is a reply to an asynchronous call made by the callee agent
+        igs_service_arg_t *args = NULL;
+        if (service_make_reply_arguments_from_message (&args, caller_agent, pending_call->service_name,
+                                                       service_name, msg) == IGS_SUCCESS) {
+            model_read_write_unlock(__FUNCTION__, __LINE__);
+            service_complete_pending_call (&pending_call, caller_name, caller_uuid, service_name,
+                                           args, IGS_SERVICE_CALL_REPLIED);
+            model_read_write_lock(__FUNCTION__, __LINE__);
+        } else {
+            igsagent_error (callee_agent, "invalid reply %s from %s(%s) to service %s: call remains pending",
+                            service_name, caller_name, caller_uuid, pending_call->service_name);
+            service_restore_pending_call (pending_call);
         }
-        else if (streq (title, REMOVE_SPLIT_ENTRY_MSG)) {
-            char *input = zmsg_popstr (msg_duplicate);
-            if (input == NULL) {
-                igs_error ("no valid input in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *remote_agent = zmsg_popstr (msg_duplicate);
-            if (remote_agent == NULL) {
-                igs_error (
-                           "no valid agent name in %s message received from %s(%s): "
-                           "rejecting",
-                           title, name, peerUUID);
-                free (input);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *output = zmsg_popstr (msg_duplicate);
-            if (output == NULL) {
-                igs_error ("no valid output in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
+        igs_service_args_destroy (&args);
+    } else if (callee_agent->definition && callee_agent->definition->services_table) {
+        igs_service_t *service = zhashx_lookup(callee_agent->definition->services_table, service_name);
+        if (service) {
+            if (context->enable_service_shouts) {
+                s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                zyre_shouts (context->node, callee_agent->igs_channel, "CALLED %s from %s (%s)", service_name, caller_name, caller_uuid);
+                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
             }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (input);
-                free (remote_agent);
-                free (output);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
+            size_t nb_args = 0;
+            igs_service_arg_t *arg_count = service->arguments;
+            while (arg_count) {
+                nb_args++;
+                arg_count = arg_count->next;
+            }
+            size_t nb_frames = zmsg_size (msg);
+            igs_service_arg_t *args = NULL;
+            if (nb_frames >= nb_args){
+                service_make_values_to_arguments_from_message (&args, service, msg);
+                callee_agent->rt_current_timestamp_microseconds = INT64_MIN;
+                bool rest_of_the_message_is_ok = true;
+                if (zmsg_size(msg) >= 1){ //we still have the timestamp to handle
+                    /*
+                     We test >= 1 to be retro-compatible with future possible extensions of the protocol.
+                     In the situation when a caller calls with erroneous additional arguments, we won't
+                     be able to detect these additionnal arguments if the first erroneous additional
+                     argument has a 64 bits size. In this particular case, the first erroneous additional
+                     argument will be interpreted as a timestamp for the service call. In any other cases,
+                     we will log an error.
+                     This limitation is introduced because, on the caller side, we may not know the details
+                     of a service, especially if ingescape proxies are involved, and we may allow additional
+                     arguments without the possibility to block the call at its source.
+                     NB: if arguments are missing, the call to service_make_values_to_arguments_from_message
+                     here above will also reject the call.
+                     */
+                    zframe_t *timestamp_f = zmsg_pop(msg);
+                    assert(timestamp_f);
+                    if (zframe_size(timestamp_f) == sizeof(int64_t))
+                        memcpy(&callee_agent->rt_current_timestamp_microseconds, zframe_data(timestamp_f), sizeof(int64_t));
+                    else {
+                        igsagent_error (callee_agent, "received data is corrupted and will be ignored for service %s called from %s(%s)",
+                                        service_name, caller_name, caller_uuid);
+                        rest_of_the_message_is_ok = false;
+                    }
+                    zframe_destroy(&timestamp_f);
+                }
+                if (rest_of_the_message_is_ok) {
+                    if (core_context->enable_service_logging)
+                        service_log_received_service (callee_agent, caller_name, caller_uuid, service_name,
+                                                      args, callee_agent->rt_current_timestamp_microseconds);
+                    if (core_context->callbacks_pool_size > 0) {
+                        igs_service_call_task_t *task = s_new_service_call_task (callee_agent, caller_name,
+                                                                                caller_uuid, service_name,
+                                                                                &args, nb_args, token);
+                        if (!model_pool_post (callee_agent, "", s_run_service_call_task, task))
+                            s_free_service_call_task (&task);
+                    } else {
+                        model_read_write_unlock(__FUNCTION__, __LINE__);
+                        if (callee_agent->uuid && service->service_cb)
+                            (service->service_cb) (callee_agent, caller_name, caller_uuid, service_name,
+                                                   args, nb_args, token, service->cb_data);
+                        model_read_write_lock(__FUNCTION__, __LINE__);
+                    }
+                }
+                igs_service_args_destroy(&args);
+                if (callee_agent->uuid)
+                    callee_agent->rt_current_timestamp_microseconds = INT64_MIN;
+            } else
+                igs_error ("arguments count do not match in received message for service %s (%zu vs. %zu expected)",
+                           name, nb_frames, nb_args);
+        } else if (!core_context->allow_undefined_services)
+            igsagent_warn (callee_agent, "agent %s(%s) has no service named %s",
+                           callee_agent->definition->name, callee_uuid, service_name);
+    }
+    free (caller_uuid);
+    free (callee_uuid);
+    free(caller_name);
+    free (service_name);
+    if (token)
+        free (token);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+// PERFORMANCE
+static int s_handle_ping (igs_core_context_t *context,
+                          const char *peerUUID,
+                          const char *name,
+                          const char *title,
+                          zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // we are pinged by another agent
+    zframe_t *countF = zmsg_pop (msg);
+    size_t count = 0;
+    memcpy (&count, zframe_data (countF), sizeof (size_t));
+    zframe_t *payload = zmsg_pop (msg);
+    // igsagent_info(agent, "ping %zu from %s", count, peer);
+    zmsg_t *back = zmsg_new ();
+    zmsg_addstr (back, PONG_MSG);
+    zmsg_addmem (back, &count, sizeof (size_t));
+    zmsg_append (back, &payload);
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zyre_whisper (node, peerUUID, &back);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_pong (igs_core_context_t *context,
+                          const char *peerUUID,
+                          const char *name,
+                          const char *title,
+                          zmsg_t *msg)
+{
+    zyre_t *node = context->node;
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    // continue performance measurement
+    zframe_t *countF = zmsg_pop (msg);
+    size_t count = 0;
+    memcpy (&count, zframe_data (countF), sizeof (size_t));
+    zframe_t *payload = zmsg_pop (msg);
+    // igsagent_info(agent, "pong %zu from %s", count, peer);
+    if (count != context->performance_msg_counter)
+        igs_error ("pong message lost at index %zu from %s", count, peerUUID);
+    else if (count == context->performance_msg_count_target) {
+        // last message received
+        context->performance_stop = zclock_usecs ();
+        igs_info ("message size: %zu bytes", context->performance_msg_size);
+        igs_info ("roundtrip count: %zu", context->performance_msg_count_target);
+        igs_info ("average latency: %.3f µs",
+                  ((double) context->performance_stop - (double) context->performance_start) / context->performance_msg_count_target);
+        size_t throughput = (size_t) ((double) context->performance_msg_count_target /
+                                      ((double) context->performance_stop - (double) context->performance_start) * 1000000);
+        double megabytes = (double) throughput * context->performance_msg_size / (1024 * 1024);
+        igs_info ("average roundtrip throughput: %zu msg/s", (size_t) throughput);
+        igs_info ("average roundtrip throughput: %.3f MB/s", megabytes);
+        context->performance_msg_count_target = 0;
+    }
+    else {
+        context->performance_msg_counter++;
+        zmsg_t *back = zmsg_new ();
+        zmsg_addstr (back, PING_MSG);
+        zmsg_addmem (back, &context->performance_msg_counter,
+                     sizeof (size_t));
+        zmsg_append (back, &payload);
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zyre_whisper (node, peerUUID, &back);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_worker_message (igs_core_context_t *context,
+                                    const char *peerUUID,
+                                    const char *name,
+                                    const char *title,
+                                    zmsg_t *msg)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    split_message_from_worker (title, msg, context);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_splitter_message (igs_core_context_t *context,
+                                      const char *peerUUID,
+                                      const char *name,
+                                      const char *title,
+                                      zmsg_t *msg)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    //NB: there is an internal unlock/lock in model_LOCKED_handle_io_callbacks called by split_message_from_splitter
+    split_message_from_splitter (title, msg, context);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_shm_attached (igs_core_context_t *context,
+                                  const char *peerUUID,
+                                  const char *name,
+                                  const char *title,
+                                  zmsg_t *msg)
+{
+    // a local peer has attached to our shared memory segment
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_zyre_peer_t *zyre_peer = zhashx_lookup (context->zyre_peers, peerUUID);
+    if (zyre_peer && zyre_peer->is_local && !zyre_peer->shm_publications) {
+        zyre_peer->shm_publications = true;
+        context->network_shm_peers++;
+        igs_debug ("%s(%s) attached to our shared memory segment", name, peerUUID);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_WHISPER_HANDLED;
+}
+
+static int s_handle_other_command (igs_core_context_t *context,
+                                   const char *peerUUID,
+                                   const char *name,
+                                   const char *title,
+                                   zmsg_t **msg)
+{
+    // commands registered by the application (see igs_private_command_init)
+    // are checked before the commands using their title as value
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_private_command_t *private_command = (core_context->private_commands) ?
+        zhashx_lookup (core_context->private_commands, title) : NULL;
+    igs_private_command_fn *private_command_cb = (private_command) ? private_command->cb : NULL;
+    void *private_command_data = (private_command) ? private_command->my_data : NULL;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (private_command_cb)
+        private_command_cb (peerUUID, name, title, msg, private_command_data);
+    else if (strncmp(title, RT_SET_TIME_MSG, strlen(RT_SET_TIME_MSG)) == 0){
+        const char *timestamp_str = title + strlen(RT_SET_TIME_MSG);
+        if (*timestamp_str){
+            int64_t timestamp = atoll(timestamp_str);
+            igs_rt_set_time(timestamp);
+        }else
+            igs_error("timestamp missing in RT_SET_TIME command : rejecting");
+    }
+    return IGS_WHISPER_HANDLED;
+}
+
+typedef struct {
+    const char *title;
+    igs_whisper_handler_fn *handler;
+} igs_whisper_command_entry_t;
+
+// private commands of the ingescape protocol, indexed by their title
+static const igs_whisper_command_entry_t s_whisper_commands_table[] = {
+    {REMOTE_PEER_KNOWS_AGENT_MSG, s_handle_remote_peer_knows_agent},
+    {EXTERNAL_DEFINITION_MSG, s_handle_external_definition},
+    {EXTERNAL_MAPPING_MSG, s_handle_external_mapping},
+    {DEFINITION_DELTA_MSG, s_handle_definition_delta},
+    {MAPPING_DELTA_MSG, s_handle_mapping_delta},
+    {GET_SNAPSHOT_MSG, s_handle_get_snapshot},
+    {LOAD_DEFINITION_MSG, s_handle_load_definition},
+    {LOAD_MAPPING_MSG, s_handle_load_mapping},
+    {GET_CURRENT_OUTPUTS_MSG, s_handle_get_current_outputs},
+    {CURRENT_OUTPUTS_MSG, s_handle_current_outputs},
+    {GET_CURRENT_INPUTS_MSG, s_handle_get_current_inputs},
+    {GET_CURRENT_ATTRIBUTES_MSG, s_handle_get_current_attributes},
+    {START_AGENT_MSG, s_handle_start_agent},
+    {STOP_AGENT_MSG, s_handle_stop_agent},
+    {STOP_PEER_MSG, s_handle_stop_peer},
+    {CLEAR_MAPPING_MSG, s_handle_clear_mapping},
+    {FREEZE_MSG, s_handle_freeze},
+    {UNFREEZE_MSG, s_handle_unfreeze},
+    {MUTE_ALL_MSG, s_handle_mute_all},
+    {UNMUTE_ALL_MSG, s_handle_unmute_all},
+    {MUTE_AGENT_MSG, s_handle_mute_agent},
+    {UNMUTE_AGENT_MSG, s_handle_unmute_agent},
+    {MUTE_OUTPUT_MSG, s_handle_mute_output},
+    {UNMUTE_OUTPUT_MSG, s_handle_unmute_output},
+    {SET_INPUT_MSG, s_handle_set_io},
+    {SET_OUTPUT_MSG, s_handle_set_io},
+    {SET_ATTRIBUTE_MSG, s_handle_set_io},
+    {MAP_MSG, s_handle_map},
+    {UNMAP_MSG, s_handle_unmap},
+    {ADD_SPLIT_ENTRY_MSG, s_handle_add_split_entry},
+    {REMOVE_SPLIT_ENTRY_MSG, s_handle_remove_split_entry},
+    {ENABLE_LOG_STREAM_MSG, s_handle_enable_log_stream},
+    {DISABLE_LOG_STREAM_MSG, s_handle_disable_log_stream},
+    {ENABLE_LOG_FILE_MSG, s_handle_enable_log_file},
+    {DISABLE_LOG_FILE_MSG, s_handle_disable_log_file},
+    {SET_LOG_PATH_MSG, s_handle_set_log_path},
+    {SET_DEFINITION_PATH_MSG, s_handle_set_definition_path},
+    {SET_MAPPING_PATH_MSG, s_handle_set_mapping_path},
+    {SAVE_DEFINITION_TO_PATH_MSG, s_handle_save_definition_to_path},
+    {SAVE_MAPPING_TO_PATH_MSG, s_handle_save_mapping_to_path},
+    {CALL_SERVICE_MSG, s_handle_call_service},
+    {CALL_SERVICE_MSG_DEPRECATED, s_handle_call_service},
+    {PING_MSG, s_handle_ping},
+    {PONG_MSG, s_handle_pong},
+    {WORKER_HELLO_MSG, s_handle_worker_message},
+    {WORKER_READY_MSG, s_handle_worker_message},
+    {WORKER_GOODBYE_MSG, s_handle_worker_message},
+    {WORKER_CREDIT_MSG, s_handle_worker_message},
+    {SPLITTER_WORK_MSG, s_handle_splitter_message},
+    {SPLITTER_WORKS_MSG, s_handle_splitter_message},
+    {SHM_ATTACHED_MSG, s_handle_shm_attached}
+};
+static zhashx_t *s_whisper_commands = NULL; //igs_whisper_command_entry_t, destroyed when our loop stops
+
+// NB: only called from the ingescape thread, which owns the index
+igs_whisper_handler_fn *s_whisper_handler (const char *title)
+{
+    assert (title);
+    if (!s_whisper_commands) {
+        s_whisper_commands = zhashx_new ();
+        size_t nb_commands = sizeof (s_whisper_commands_table) / sizeof (igs_whisper_command_entry_t);
+        for (size_t i = 0; i < nb_commands; i++)
+            zhashx_insert (s_whisper_commands, s_whisper_commands_table[i].title,
+                           (void *) &s_whisper_commands_table[i]);
+    }
+    const igs_whisper_command_entry_t *entry = zhashx_lookup (s_whisper_commands, title);
+    return (entry) ? entry->handler : NULL;
+}
+
+bool network_is_protocol_command (const char *title)
+{
+    assert (title);
+    size_t nb_commands = sizeof (s_whisper_commands_table) / sizeof (igs_whisper_command_entry_t);
+    for (size_t i = 0; i < nb_commands; i++) {
+        if (streq (s_whisper_commands_table[i].title, title))
+            return true;
+    }
+    return (strncmp (title, RT_SET_TIME_MSG, strlen (RT_SET_TIME_MSG)) == 0);
+}
+
+// manage messages received on the private channel
+int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
+{
+    IGS_UNUSED (socket)
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    zyre_t *node = context->node;
+    assert (node);
+
+    zyre_event_t *zyre_event = zyre_event_new (node);
+    const char *event = zyre_event_type (zyre_event);
+    const char *peerUUID = zyre_event_peer_uuid (zyre_event);
+    const char *name = zyre_event_peer_name (zyre_event);
+    const char *address = zyre_event_peer_addr (zyre_event);
+    zhash_t *headers = zyre_event_headers (zyre_event);
+    const char *group = zyre_event_group (zyre_event);
+    // the message is consumed in place unless channel observers need
+    // an untouched copy of it at the end of this function
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    bool msg_is_observed = (zlist_size (context->zyre_callbacks) > 0);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    zmsg_t *msg = (msg_is_observed) ? zyre_event_msg (zyre_event) : NULL;
+    zmsg_t *consumed_msg = (msg_is_observed) ? zmsg_dup (msg) : zyre_event_get_msg (zyre_event);
+
+    // parse event
+    if (streq (event, "ENTER")) {
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        igs_debug ("->%s has entered the network with peer id %s and endpoint %s", name, peerUUID, address);
+        igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
+        if (!zyre_peer) {
+            zyre_peer = (igs_zyre_peer_t *) zmalloc (sizeof (igs_zyre_peer_t));
+            zyre_peer->peer_id = s_strndup (peerUUID, IGS_MAX_PEER_ID_LENGTH);
+            zhashx_insert(context->zyre_peers, zyre_peer->peer_id, zyre_peer);
+            zyre_peer->name = s_strndup (name, IGS_MAX_AGENT_NAME_LENGTH);
+            s_name_index_add (&context->zyre_peers_by_name, zyre_peer->name, zyre_peer);
+            zyre_peer->publication_topics = core_new_topic_table ();
+            zlist_t *keys = zhash_keys (headers);
+            size_t s = zlist_size (keys);
+            if (s > 0) {
+                igs_debug ("Handling headers for peer %s (%s)", name, peerUUID);
+                char *k = zlist_first (keys);
+                const char *v;
+                while (k) {
+                    v = zyre_event_header (zyre_event, k);
+                    igs_debug ("\t%s -> %s", k, v);
+                    k = zlist_next (keys);
+                }
+                zlist_destroy (&keys);
             }
 
-            igs_debug ("received REMOVE_SPLIT_ENTRY_MSG command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            if (input && remote_agent && output)
-                igsagent_split_remove_with_name (agent, input, remote_agent, output);
-            free (input);
-            free (remote_agent);
-            free (output);
-            free (uuid);
-        }
-        // ADMIN API
-        else if (streq (title, ENABLE_LOG_STREAM_MSG)) {
-            igs_debug ("received ENABLE_LOG_STREAM command from %s (%s)", name, peerUUID);
-            igs_log_set_stream (true);
-        }
-        else if (streq (title, DISABLE_LOG_STREAM_MSG)) {
-            igs_debug ("received DISABLE_LOG_STREAM command from %s (%s)", name, peerUUID);
-            igs_log_set_stream (false);
-        }
-        else if (streq (title, ENABLE_LOG_FILE_MSG)) {
-            igs_debug ("received ENABLE_LOG_FILE command from %s (%s)", name, peerUUID);
-            igs_log_set_file (true, core_context->log_file_path);
-        }
-        else if (streq (title, DISABLE_LOG_FILE_MSG)) {
-            igs_debug ("received DISABLE_LOG_FILE command from %s (%s)", name, peerUUID);
-            igs_log_set_file (false, core_context->log_file_path);
-        }
-        else if (streq (title, SET_LOG_PATH_MSG)) {
-            char *log_path = zmsg_popstr (msg_duplicate);
-            igs_debug ("received SET_LOG_PATH command from %s (%s)", name, peerUUID);
-            igs_log_set_file(igs_log_file(), log_path);
-        }
-        else if (streq (title, SET_DEFINITION_PATH_MSG)) {
-            char *definition_path = zmsg_popstr (msg_duplicate);
-            if (definition_path == NULL) {
-                igs_error ( "no valid definition path in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (definition_path);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (definition_path);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received SET_DEFINITION_PATH command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_definition_set_path (agent, definition_path);
-            free (definition_path);
-            free (uuid);
-        }
-        else if (streq (title, SET_MAPPING_PATH_MSG)) {
-            char *mapping_path = zmsg_popstr (msg_duplicate);
-            if (mapping_path == NULL) {
-                igs_error ("no valid mapping path in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
+            const char *peer_public_key = zyre_event_header (zyre_event, "X-PUBLICKEY");
+            const char *protocol_version = zyre_event_header (zyre_event, "protocol");
+            if (protocol_version)
+                zyre_peer->protocol = s_strndup (protocol_version, 16);
+            if (protocol_version && protocol_version[0] == 'v'
+                && atoi (protocol_version + 1) >= IGS_COMPACT_PUBLICATION_PROTOCOL) {
+                zyre_peer->compact_publications = true;
+                if (atoi (protocol_version + 1) >= IGS_BATCH_PUBLICATION_PROTOCOL)
+                    zyre_peer->batch_publications = true;
+                if (atoi (protocol_version + 1) >= IGS_VERSIONED_UPDATES_PROTOCOL)
+                    zyre_peer->versioned_updates = true;
+                if (atoi (protocol_version + 1) >= IGS_SPLIT_BATCH_PROTOCOL)
+                    zyre_peer->split_batches = true;
             }
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free (mapping_path);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
+
+            const char *publisher_port = zyre_event_header (zyre_event, "publisher");
+            // only ingescape agents subscribing to our outputs shape our
+            // publications: other zyre nodes and tools are not counted
+            zyre_peer->has_publisher = (publisher_port != NULL);
+            if (zyre_peer->has_publisher) {
+                if (zyre_peer->compact_publications)
+                    context->network_compact_peers++;
+                else
+                    context->network_legacy_peers++;
+                if (zyre_peer->batch_publications)
+                    context->network_batch_peers++;
             }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                free (mapping_path);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
+            if (publisher_port) {
+                // we extract the publisher adress to subscribe to from the zyre message
+                // header
+                char endpoint_address[128];
+                strncpy (endpoint_address, address, 127);
+
+                // IP adress extraction
+                char *insert = endpoint_address + strlen (endpoint_address);
+                bool extractOK = true;
+                while (*insert != ':') {
+                    insert--;
+                    if (insert == endpoint_address) {
+                        igs_error ("Could not extract port from address %s", address);
+                        extractOK = false;
+                        break;
+                    }
+                }
+
+                if (extractOK) {
+                    // we found a possible publisher to subscribe to
+                    *(insert + 1) =
+                    '\0'; // close endpoint_address string after ':' location
+
+                    // check towards our own ip address (without port)
+                    char *incoming_ip_address =
+                    endpoint_address + 6; // ignore tcp://
+                    *insert = '\0';
+                    bool useIPC = false;
+                    bool use_inproc = false;
+                    const char *ipc_address = NULL;
+                    const char *inproc_address = NULL;
+                    if (streq (context->ip_address, incoming_ip_address)) {
+                        // same IP address : we can try to use ipc (or loopback on windows)
+                        // instead of TCP or we can use inproc if both agents are in the same
+                        // process
+                        int pid = atoi (zyre_event_header (zyre_event, "pid"));
+                        if (context->process_id == pid) {
+                            // same ip address and same process : we can use inproc
+                            inproc_address = zyre_event_header (zyre_event, "inproc");
+                            if (inproc_address) {
+                                use_inproc = true;
+                                igs_debug ("Use address %s to subscribe to %s", inproc_address, name);
+                            }
+                        }
+                        else {
+                            // try to recover agent ipc/loopback address
+#if defined(__UNIX__)
+                            ipc_address = zyre_event_header (zyre_event, "ipc");
+#elif defined(__WINDOWS__)
+                            ipc_address = zyre_event_header (zyre_event, "loopback");
+#endif
+                            if (ipc_address) {
+                                useIPC = true;
+                                igs_debug ("Use address %s to subscribe to %s", ipc_address, name);
+                            }
+#if defined(__UNIX__) && !defined(__UTYPE_IOS)
+                            if (ipc_address && zyre_peer->compact_publications) {
+                                zyre_peer->is_local = true;
+                                context->network_local_peers++;
+                                const char *shm_name = zyre_event_header (zyre_event, "shm");
+                                if (shm_name && context->shm_segment)
+                                    zyre_peer->shm = s_shm_attach (shm_name);
+                                if (zyre_peer->shm) {
+                                    // the peer sends descriptors only once we confirm
+                                    igs_debug ("Attached to shared memory segment %s of %s", shm_name, name);
+                                    zmsg_t *attached_msg = zmsg_new ();
+                                    zmsg_addstr (attached_msg, SHM_ATTACHED_MSG);
+                                    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                                    zyre_whisper (node, peerUUID, &attached_msg);
+                                    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                                }
+                            }
+#endif
+                        }
+                    }
+                    *insert = ':';
+                    // add port to the endpoint to compose it fully
+                    strcat (endpoint_address, publisher_port);
+                    if (context->network_allow_inproc && use_inproc) {
+                        zyre_peer->subscriber = zsock_new_sub (inproc_address, NULL);
+                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
+                        igs_debug ("Subscription created for %s at %s (inproc)",
+                                   zyre_peer->name, inproc_address);
+                    }
+                    else if (context->network_allow_ipc && useIPC) {
+                        zyre_peer->subscriber = zsock_new_sub (ipc_address, NULL);
+                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
+                        igs_debug ("Subscription created for %s at %s (ipc)",
+                                   zyre_peer->name, ipc_address);
+                    }
+                    else {
+                        zyre_peer->subscriber = zsock_new_sub (endpoint_address, NULL);
+                        zsock_set_rcvhwm (zyre_peer->subscriber, context->network_hwm_value);
+                        igs_debug ("Subscription created for %s at %s (tcp)",
+                                   zyre_peer->name, endpoint_address);
+                    }
+                    assert (zyre_peer->subscriber);
+
+                    if (context->security_is_enabled && peer_public_key) {
+                        zcert_apply (context->security_cert, zyre_peer->subscriber);
+                        zsock_set_curve_serverkey (zyre_peer->subscriber, peer_public_key);
+                    }
+                    zloop_reader (loop, zyre_peer->subscriber, s_manage_received_publication, zyre_peer);
+                    zloop_reader_set_tolerant (loop, zyre_peer->subscriber);
+                }
             }
-            igs_debug ("received SET_MAPPING_PATH command from %s (%s)", name, peerUUID);
+            zhash_t *headers_bis = zhash_dup (headers);
             model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_mapping_set_path (agent, mapping_path);
-            free (mapping_path);
-            free (uuid);
-        }
-        else if (streq (title, SAVE_DEFINITION_TO_PATH_MSG)) {
-            // identify agent
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-            igs_debug ("received SAVE_DEFINITION_TO_PATH command from %s (%s)", name, peerUUID);
+            agent_LOCKED_propagate_agent_event (IGS_PEER_ENTERED, peerUUID, name, headers_bis);
+            zhash_destroy (&headers_bis);
+        } else {
+            // Agent already exists, we set its reconnected flag
+            // (this is used below to avoid agent destruction on EXIT received after timeout)
+            zyre_peer->reconnected++;
             model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_definition_save (agent);
-            free (uuid);
         }
-        else if (streq (title, SAVE_MAPPING_TO_PATH_MSG)) {
-            // identify agent
-            char *uuid = zmsg_popstr (msg_duplicate);
-            if (uuid == NULL) {
-                igs_error ("no valid uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                free(title);
-                return 0;
-            }
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            igsagent_t *agent = zhashx_lookup(context->agents, uuid);
-            if (!agent) {
-                igs_debug ("no agent with uuid '%s' in %s message received from %s(%s): rejecting", uuid, title, name, peerUUID);
-                if (uuid)
-                    free (uuid);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
+    }
+    else if (streq (event, "JOIN")) {
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        igs_debug ("+%s has joined %s", name, group);
+        if (streq (group, IGS_PRIVATE_CHANNEL)) {
+            // send information for all our agents to the newcomer
+            igs_zyre_peer_t *zyre_peer = zhashx_lookup(context->zyre_peers, peerUUID);
+            assert (zyre_peer);
+            const char *definition_str = NULL;
+            const char *mapping_str = NULL;
+            igsagent_t *agent = zhashx_first(context->agents);
+            while (agent) {
+                // definition is sent to every newcomer on the channel (wether it is an ingescape agent or not)
+                if (zyre_peer->protocol && (streq (zyre_peer->protocol, "v2") || streq (zyre_peer->protocol, "v3")))
+                    definition_str = definition_json_legacy_v3 (agent->definition);
+                else if (zyre_peer->protocol && streq (zyre_peer->protocol, "v4"))
+                    definition_str = definition_json_legacy_v4 (agent->definition);
+                else
+                    definition_str = agent->definition->json;
+                if (definition_str)
+                    s_send_definition_to_zyre_peer (agent, peerUUID, definition_str, false);
+                else
+                    s_send_definition_to_zyre_peer (agent, peerUUID, "", false);
+                // and so is our mapping
+                if (zyre_peer->protocol && streq (zyre_peer->protocol, "v2"))
+                    mapping_str = mapping_json_legacy (agent->mapping);
+                else
+                    mapping_str = agent->mapping->json;
+                if (mapping_str)
+                    s_send_mapping_to_zyre_peer (agent, peerUUID, mapping_str);
+                else
+                    s_send_mapping_to_zyre_peer (agent, peerUUID, "");
+                // and so is the state of our internal variables
+                s_send_state_to (agent, peerUUID, true);
+                agent = zhashx_next(context->agents);
             }
-            igs_debug ("received SAVE_MAPPING_TO_PATH command from %s (%s)", name, peerUUID);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-            igsagent_mapping_save (agent);
-            free (uuid);
+            zyre_peer->has_joined_private_channel = true;
         }
-        else if (streq (title, CALL_SERVICE_MSG) || streq (title, CALL_SERVICE_MSG_DEPRECATED)) {
-            char *caller_uuid = zmsg_popstr (msg_duplicate);
-            if (caller_uuid == NULL) {
-                igs_error ("no valid caller_uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                zmsg_destroy (&msg_duplicate);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+    }
+    else if (streq (event, "SHOUT")) {
+        if (streq (group, context->replay_channel)) {
+            // this is a replay message for one of our inputs
+            char *agent_name = zmsg_popstr (consumed_msg);
+            char *input = zmsg_popstr (consumed_msg);
+            if (agent_name == NULL) {
+                igs_error ("agent name is NULL for replay message from %s(%s): rejecting", name, peerUUID);
+                zmsg_destroy (&consumed_msg);
                 zyre_event_destroy (&zyre_event);
-                free(title);
                 return 0;
             }
-            char *callee_uuid = zmsg_popstr (msg_duplicate);
-            if (callee_uuid == NULL) {
-                igs_error ("no valid caller_uuid in %s message received from %s(%s): rejecting", title, name, peerUUID);
-                free(caller_uuid);
-                zmsg_destroy (&msg_duplicate);
+            if (input == NULL) {
+                igs_error ("input is NULL for replay message from %s(%s): rejecting", name, peerUUID);
+                free (agent_name);
+                zmsg_destroy (&consumed_msg);
                 zyre_event_destroy (&zyre_event);
-                free(title);
                 return 0;
             }
 
             model_read_write_lock(__FUNCTION__, __LINE__);
-            char *caller_name = strdup(name); // default caller name is the one of the peer
-            if (streq (title, CALL_SERVICE_MSG_DEPRECATED))
-                igs_warn ("Remote agent %s(%s) uses an older version of Ingescape with deprecated messages. Please upgrade this agent.",
-                          caller_name, caller_uuid);
-
-            igs_remote_agent_t *caller_agent = zhashx_lookup(context->remote_agents, caller_uuid);
-            if (caller_agent) {
-                // replace caller name by the one of an actual agent
-                free(caller_name);
-                caller_name = strdup(caller_agent->definition->name);
-            }
-
-            igsagent_t *callee_agent = zhashx_lookup(context->agents, callee_uuid);
-            if (!callee_agent) {
-                igs_error ("no callee agent with uuid '%s' in %s message received from %s(%s): rejecting", callee_uuid, title, name, peerUUID);
-                free (callee_uuid);
-                free (caller_uuid);
-                free(caller_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-
-            char *service_name = zmsg_popstr (msg_duplicate);
-            if (service_name == NULL) {
-                igs_error ("no service name in %s message received from "
-                           "%s(%s): rejecting",
-                           title, name, peerUUID);
-                free (caller_uuid);
-                free (callee_uuid);
-                free(caller_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-
-            char *token = zmsg_popstr (msg_duplicate);
-            if (token == NULL) {
-                igs_error ("no token in %s message received from %s(%s): rejecting",
-                           title, name, peerUUID);
-                free (caller_uuid);
-                free (callee_uuid);
-                free(caller_name);
-                free (service_name);
-                zmsg_destroy (&msg_duplicate);
-                zyre_event_destroy (&zyre_event);
-                model_read_write_unlock(__FUNCTION__, __LINE__);
-                free(title);
-                return 0;
-            }
-
-            if (callee_agent->definition && callee_agent->definition->services_table) {
-                igs_service_t *service = zhashx_lookup(callee_agent->definition->services_table, service_name);
-                if (service) {
-                    s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                    zyre_shouts (context->node, callee_agent->igs_channel, "CALLED %s from %s (%s)", service_name, caller_name, caller_uuid);
-                    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-                    size_t nb_args = 0;
-                    igs_service_arg_t *arg_count = service->arguments;
-                    while (arg_count) {
-                        nb_args++;
-                        arg_count = arg_count->next;
-                    }
-                    size_t nb_frames = zmsg_size (msg);
-                    igs_service_arg_t *args = NULL;
-                    if (nb_frames >= nb_args){
-                        service_make_values_to_arguments_from_message (&args, service, msg_duplicate);
-                        callee_agent->rt_current_timestamp_microseconds = INT64_MIN;
-                        bool rest_of_the_message_is_ok = true;
-                        if (zmsg_size(msg_duplicate) >= 1){ //we still have the timestamp to handle
-                            /*
-                             We test >= 1 to be retro-compatible with future possible extensions of the protocol.
-                             In the situation when a caller calls with erroneous additional arguments, we won't
-                             be able to detect these additionnal arguments if the first erroneous additional
-                             argument has a 64 bits size. In this particular case, the first erroneous additional
-                             argument will be interpreted as a timestamp for the service call. In any other cases,
-                             we will log an error.
-                             This limitation is introduced because, on the caller side, we may not know the details
-                             of a service, especially if ingescape proxies are involved, and we may allow additional
-                             arguments without the possibility to block the call at its source.
-                             NB: if arguments are missing, the call to service_make_values_to_arguments_from_message
-                             here above will also reject the call.
-                             */
-                            zframe_t *timestamp_f = zmsg_pop(msg_duplicate);
-                            assert(timestamp_f);
-                            if (zframe_size(timestamp_f) == sizeof(int64_t))
-                                memcpy(&callee_agent->rt_current_timestamp_microseconds, zframe_data(timestamp_f), sizeof(int64_t));
-                            else {
-                                igsagent_error (callee_agent, "received data is corrupted and will be ignored for service %s called from %s(%s)",
-                                                service_name, caller_name, caller_uuid);
-                                rest_of_the_message_is_ok = false;
+            char *value = NULL;
+            zframe_t *frame = NULL;
+            void *data = NULL;
+            size_t size = 0;
+            zlistx_t *agents = zhashx_values(context->agents);
+            igsagent_t *target_agent = zlistx_first(agents);
+            while (target_agent && target_agent->uuid) {
+                if (streq (agent_name, target_agent->definition->name)) {
+                    igs_io_value_type_t input_type = model_get_io_value_type (target_agent, input, IGS_INPUT_T);
+                    if (zmsg_size (consumed_msg) > 0) {
+                        igs_debug ("replaying %s.%s", agent_name, input);
+                        if (input_type == IGS_STRING_T) {
+                            value = zmsg_popstr (consumed_msg);
+                            if (value == NULL) {
+                                igs_error ("value is NULL for replay message from %s(%s): rejecting", name, peerUUID);
+                                free (agent_name);
+                                free (input);
+                                zmsg_destroy (&consumed_msg);
+                                zyre_event_destroy (&zyre_event);
+                                model_read_write_unlock(__FUNCTION__, __LINE__);
+                                return 0;
+                            }
+                            igs_io_t *io = model_write (target_agent, input, IGS_INPUT_T, input_type, value, strlen(value)+1);
+                            if (io){
+                                model_read_write_unlock(__FUNCTION__, __LINE__);
+                                model_LOCKED_handle_io_callbacks(target_agent, io);
+                                model_read_write_lock(__FUNCTION__, __LINE__);
                             }
-                            zframe_destroy(&timestamp_f);
-                        }
-                        if (rest_of_the_message_is_ok) {
-                            if (core_context->enable_service_logging)
-                                service_log_received_service (callee_agent, caller_name, caller_uuid, service_name,
-                                                              args, callee_agent->rt_current_timestamp_microseconds);
-                            model_read_write_unlock(__FUNCTION__, __LINE__);
-                            if (callee_agent->uuid && service->service_cb)
-                                (service->service_cb) (callee_agent, caller_name, caller_uuid, service_name,
-                                                       args, nb_args, token, service->cb_data);
-                            model_read_write_lock(__FUNCTION__, __LINE__);
+                            free (value);
+                        } else {
+                            frame = zmsg_pop (consumed_msg);
+                            if (frame == NULL) {
+                                igs_error ("value is NULL for replay message from %s(%s): rejecting", name, peerUUID);
+                                free (agent_name);
+                                free (input);
+                                zmsg_destroy (&consumed_msg);
+                                zyre_event_destroy (&zyre_event);
+                                model_read_write_unlock(__FUNCTION__, __LINE__);
+                                return 0;
+                            }
+                            data = zframe_data (frame);
+                            size = zframe_size (frame);
+                            igs_io_t *io = model_write (target_agent, input, IGS_INPUT_T, input_type, data, size);
+                            if (io){
+                                model_read_write_unlock(__FUNCTION__, __LINE__);
+                                model_LOCKED_handle_io_callbacks(target_agent, io);
+                                model_read_write_lock(__FUNCTION__, __LINE__);
+                            }
+                            zframe_destroy (&frame);
                         }
-                        igs_service_args_destroy(&args);
-                        if (callee_agent->uuid)
-                            callee_agent->rt_current_timestamp_microseconds = INT64_MIN;
-                    } else
-                        igs_error ("arguments count do not match in received message for service %s (%zu vs. %zu expected)",
-                                   name, nb_frames, nb_args);
-                } else if (!core_context->allow_undefined_services)
-                    igsagent_warn (callee_agent, "agent %s(%s) has no service named %s",
-                                   callee_agent->definition->name, callee_uuid, service_name);
-            }
-            free (caller_uuid);
-            free (callee_uuid);
-            free(caller_name);
-            free (service_name);
-            if (token)
-                free (token);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        // PERFORMANCE
-        else if (streq (title, PING_MSG)) {
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // we are pinged by another agent
-            zframe_t *countF = zmsg_pop (msg_duplicate);
-            size_t count = 0;
-            memcpy (&count, zframe_data (countF), sizeof (size_t));
-            zframe_t *payload = zmsg_pop (msg_duplicate);
-            // igsagent_info(agent, "ping %zu from %s", count, peer);
-            zmsg_t *back = zmsg_new ();
-            zmsg_addstr (back, PONG_MSG);
-            zmsg_addmem (back, &count, sizeof (size_t));
-            zmsg_append (back, &payload);
-            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            zyre_whisper (node, peerUUID, &back);
-            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
-        }
-        else if (streq (title, PONG_MSG)) {
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            // continue performance measurement
-            zframe_t *countF = zmsg_pop (msg_duplicate);
-            size_t count = 0;
-            memcpy (&count, zframe_data (countF), sizeof (size_t));
-            zframe_t *payload = zmsg_pop (msg_duplicate);
-            // igsagent_info(agent, "pong %zu from %s", count, peer);
-            if (count != context->performance_msg_counter)
-                igs_error ("pong message lost at index %zu from %s", count, peerUUID);
-            else if (count == context->performance_msg_count_target) {
-                // last message received
-                context->performance_stop = zclock_usecs ();
-                igs_info ("message size: %zu bytes", context->performance_msg_size);
-                igs_info ("roundtrip count: %zu", context->performance_msg_count_target);
-                igs_info ("average latency: %.3f µs",
-                          ((double) context->performance_stop - (double) context->performance_start) / context->performance_msg_count_target);
-                size_t throughput = (size_t) ((double) context->performance_msg_count_target /
-                                              ((double) context->performance_stop - (double) context->performance_start) * 1000000);
-                double megabytes = (double) throughput * context->performance_msg_size / (1024 * 1024);
-                igs_info ("average roundtrip throughput: %zu msg/s", (size_t) throughput);
-                igs_info ("average roundtrip throughput: %.3f MB/s", megabytes);
-                context->performance_msg_count_target = 0;
-            }
-            else {
-                context->performance_msg_counter++;
-                zmsg_t *back = zmsg_new ();
-                zmsg_addstr (back, PING_MSG);
-                zmsg_addmem (back, &context->performance_msg_counter,
-                             sizeof (size_t));
-                zmsg_append (back, &payload);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                zyre_whisper (node, peerUUID, &back);
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                    }
+                    else
+                        igsagent_error (target_agent, "replay message for input %s is not correct and was ignored", input);
+                }
+                target_agent = zlistx_next(agents);
             }
+            zlistx_destroy(&agents);
+            free (agent_name);
+            free (input);
             model_read_write_unlock(__FUNCTION__, __LINE__);
+
         }
-        else if (streq (title, WORKER_HELLO_MSG)
-                 || streq (title, WORKER_READY_MSG)
-                 || streq (title, WORKER_GOODBYE_MSG)){
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            split_message_from_worker (title, msg_duplicate, context);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+        else if (streq (group, IGS_PRIVATE_CHANNEL)) {
+            char *title = zmsg_popstr (consumed_msg);
+            if (title && streq (title, REMOTE_AGENT_EXIT_MSG)) {
+                model_read_write_lock(__FUNCTION__, __LINE__);
+                char *uuid = zmsg_popstr (consumed_msg);
+                if (uuid){
+                    igs_remote_agent_t *remote = zhashx_lookup(context->remote_agents, uuid);
+                    if (remote) {
+                        igs_debug ("<-%s (%s) exited", remote->definition->name, uuid);
+                        split_remove_worker (context, uuid, NULL);
+                        zhashx_delete(context->remote_agents, remote->uuid);
+                        char *def_name = strdup(remote->definition->name);
+                        igs_zyre_peer_t *remote_peer = remote->peer;
+                        s_clean_and_free_remote_agent (&remote);
+                        s_update_peer_colliding_topics (context, remote_peer);
+                        model_read_write_unlock(__FUNCTION__, __LINE__);
+                        agent_LOCKED_propagate_agent_event (IGS_AGENT_EXITED, uuid, def_name, NULL);
+                        model_read_write_lock(__FUNCTION__, __LINE__);
+                        free(def_name);
+                    } else
+                        igs_error ("%s is not a known remote agent", uuid);
+                    free (uuid);
+                } else
+                    igs_error("exit message without UUID : rejecting");
+                model_read_write_unlock(__FUNCTION__, __LINE__);
+            } else if (title && strncmp(title, RT_SET_TIME_MSG, strlen(RT_SET_TIME_MSG)) == 0){
+                model_read_write_lock(__FUNCTION__, __LINE__);
+                char *timestamp_str = title + strlen(RT_SET_TIME_MSG);
+                if (*timestamp_str){
+                    int64_t timestamp = atoll(timestamp_str);
+                    model_read_write_unlock(__FUNCTION__, __LINE__);
+                    igs_rt_set_time(timestamp);
+                }else
+                    igs_error("timestamp missing in RT_SET_TIME command : rejecting");
+            } else if (!title)
+                igs_error("whisper message to private channel is missing title : rejecting");
+            free (title);
         }
-        else if (streq (title, SPLITTER_WORK_MSG)){
-            model_read_write_lock(__FUNCTION__, __LINE__);
-            //NB: there is an internal unlock/lock in model_LOCKED_handle_io_callbacks called by split_message_from_splitter
-            split_message_from_splitter (msg_duplicate, context);
-            model_read_write_unlock(__FUNCTION__, __LINE__);
+    }
+    else if (streq (event, "WHISPER")) {
+        char *title = zmsg_popstr (consumed_msg);
+        if (!title) {
+            igs_error ("no header in message received from %s(%s): rejecting", name, peerUUID);
+            zmsg_destroy (&consumed_msg);
+            zyre_event_destroy (&zyre_event);
+            return 0;
         }
-        else if (strncmp(title, RT_SET_TIME_MSG, strlen(RT_SET_TIME_MSG)) == 0){
-            char *timestamp_str = title + strlen(RT_SET_TIME_MSG);
-            if (*timestamp_str){
-                int64_t timestamp = atoll(timestamp_str);
-                igs_rt_set_time(timestamp);
-            }else
-                igs_error("timestamp missing in RT_SET_TIME command : rejecting");
+
+        igs_whisper_handler_fn *handler = s_whisper_handler (title);
+        int rc = (handler) ? handler (context, peerUUID, name, title, consumed_msg)
+                           : s_handle_other_command (context, peerUUID, name, title, &consumed_msg);
+        if (rc != IGS_WHISPER_HANDLED) {
+            zmsg_destroy (&consumed_msg);
+            zyre_event_destroy (&zyre_event);
+            free (title);
+            // stopping our zyre loop by returning -1 starts the cleaning process
+            return (rc == IGS_WHISPER_STOP) ? -1 : 0;
         }
         free (title);
     }
@@ -2758,7 +4134,7 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
     }
     zlist_destroy(&zyre_callbacks);
 
-    zmsg_destroy (&msg_duplicate);
+    zmsg_destroy (&consumed_msg);
     zyre_event_destroy (&zyre_event);
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return 0;
@@ -2775,19 +4151,32 @@ int s_trigger_definition_update (zloop_t *loop, int timer_id, void *arg)
     model_read_write_lock(__FUNCTION__, __LINE__);
     zlistx_t *agents = zhashx_values(context->agents);
     igsagent_t *agent = zlistx_first(agents);
+    while (agent && !agent->network_need_to_send_definition_update)
+        agent = zlistx_next(agents);
+    if (agent)
+        // our peers are about to know the new outputs
+        network_update_colliding_topics (context);
+    agent = zlistx_first(agents);
     while (agent && agent->uuid && agent->context) {
         if (agent->network_need_to_send_definition_update) {
+            agent->network_definition_version++;
+            zmsg_t *delta = NULL;
+            if (!agent->network_activation_during_runtime
+                && definition_has_complete_deltas (agent->definition))
+                delta = s_new_definition_delta (agent);
             igs_zyre_peer_t *p = zhashx_first(context->zyre_peers);
             while (p) {
                 if (p->has_joined_private_channel) {
                     if (p->protocol && (streq (p->protocol, "v2") || streq (p->protocol, "v3"))){
-                        if (agent->definition->json_legacy_v3)
+                        if (definition_json_legacy_v3 (agent->definition))
                             s_send_definition_to_zyre_peer (agent, p->peer_id, agent->definition->json_legacy_v3,
                                                             agent->network_activation_during_runtime);
                     }else if (p->protocol && streq (p->protocol, "v4")){
-                        if (agent->definition->json_legacy_v4)
+                        if (definition_json_legacy_v4 (agent->definition))
                             s_send_definition_to_zyre_peer (agent, p->peer_id, agent->definition->json_legacy_v4,
                                                             agent->network_activation_during_runtime);
+                    }else if (p->versioned_updates && delta){
+                        s_send_delta_to_zyre_peer (agent, p->peer_id, delta);
                     }else{
                         if (agent->definition->json)
                             s_send_definition_to_zyre_peer (agent, p->peer_id, agent->definition->json,
@@ -2796,6 +4185,10 @@ int s_trigger_definition_update (zloop_t *loop, int timer_id, void *arg)
                 }
                 p = zhashx_next(context->zyre_peers);
             }
+            // a full definition is followed by the full mapping, as before versioned updates
+            agent->network_definition_snapshot_sent = (delta == NULL);
+            zmsg_destroy (&delta);
+            definition_reset_deltas (agent->definition);
             agent->network_activation_during_runtime = false; // reset flag
             // NB: this is not optimal to resend state details on definition change
             // but it is the cleanest way to send state on after-start agent
@@ -2820,8 +4213,31 @@ int s_trigger_definition_update (zloop_t *loop, int timer_id, void *arg)
     return 0;
 }
 
-// Timer callback to update and (re)send our mapping to agents on the private
-// channel
+// Timer callback completing the asynchronous service calls whose
+// deadline has passed, the model being locked only when some calls
+// have a deadline
+int s_check_service_call_deadlines (zloop_t *loop, int timer_id, void *arg)
+{
+    IGS_UNUSED (loop)
+    IGS_UNUSED (timer_id)
+    IGS_UNUSED (arg)
+    if (IGS_ATOMIC_LOAD (core_context->pending_call_deadlines, IGS_MEMORY_ORDER_RELAXED) == 0)
+        return 0;
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    zlist_t *expired_calls = service_take_expired_calls (zclock_mono ());
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (expired_calls) {
+        igs_pending_service_call_t *call = zlist_first (expired_calls);
+        while (call) {
+            igs_debug ("service call %s timed out", call->token);
+            service_complete_pending_call (&call, NULL, NULL, NULL, NULL, IGS_SERVICE_CALL_TIMED_OUT);
+            call = zlist_next (expired_calls);
+        }
+        zlist_destroy (&expired_calls);
+    }
+    return 0;
+}
+
 int s_trigger_mapping_update (zloop_t *loop, int timer_id, void *arg)
 {
     IGS_UNUSED (loop)
@@ -2834,12 +4250,26 @@ int s_trigger_mapping_update (zloop_t *loop, int timer_id, void *arg)
     igsagent_t *agent = zlistx_first(agents);
     while (agent) {
         if (agent->network_need_to_send_mapping_update) {
+            // peers supporting versioned updates receive the mapping deltas, or
+            // nothing if the mapping did not change since its last publication
+            zmsg_t *delta = NULL;
+            bool mapping_changed = agent->network_definition_snapshot_sent
+                || agent->mapping->revision != agent->mapping->published_revision;
+            if (mapping_changed) {
+                agent->network_mapping_version++;
+                if (!agent->network_definition_snapshot_sent
+                    && mapping_has_complete_deltas (agent->mapping))
+                    delta = s_new_mapping_delta (agent);
+            }
             igs_zyre_peer_t *p = zhashx_first(context->zyre_peers);
             while (p) {
                 if (p->has_joined_private_channel) {
                     if (p->protocol && streq (p->protocol, "v2")){
-                        if (agent->mapping->json_legacy)
+                        if (mapping_json_legacy (agent->mapping))
                             s_send_mapping_to_zyre_peer (agent, p->peer_id, agent->mapping->json_legacy);
+                    }else if (p->versioned_updates && (delta || !mapping_changed)){
+                        if (delta)
+                            s_send_delta_to_zyre_peer (agent, p->peer_id, delta);
                     }else{
                         if (agent->mapping->json)
                             s_send_mapping_to_zyre_peer (agent, p->peer_id, agent->mapping->json);
@@ -2847,6 +4277,9 @@ int s_trigger_mapping_update (zloop_t *loop, int timer_id, void *arg)
                 }
                 p = zhashx_next(context->zyre_peers);
             }
+            agent->network_definition_snapshot_sent = false;
+            zmsg_destroy (&delta);
+            mapping_reset_deltas (agent->mapping);
             igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
             while (remote) {
                 s_network_configure_mapping_to_remote_agent (agent, remote);
@@ -2889,11 +4322,209 @@ void s_network_unlock (void)
 }
 
 // manage messages from the parent thread
-int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
+// Local publications queue
+// NB: the queue is a bounded multi-producer/multi-consumer array in which each
+// cell carries a sequence number telling producers and consumers whether it
+// can be written or read at their position. Publications are pushed by the
+// publishing threads and popped by the ingescape loop, except with the drop
+// oldest policy where publishing threads also pop the oldest publications.
+static IGS_THREAD_LOCAL bool s_is_network_thread = false;
+
+igs_local_queue_t * s_local_queue_new (size_t capacity)
 {
-    IGS_UNUSED (loop)
-    IGS_UNUSED (arg)
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    igs_local_queue_t *queue = (igs_local_queue_t *) zmalloc (sizeof (igs_local_queue_t));
+    queue->cells = (igs_local_queue_cell_t *) zmalloc (size * sizeof (igs_local_queue_cell_t));
+    for (size_t i = 0; i < size; i++)
+        IGS_ATOMIC_INIT (queue->cells[i].sequence, i);
+    queue->mask = size - 1;
+    IGS_ATOMIC_INIT (queue->enqueue_position, 0);
+    IGS_ATOMIC_INIT (queue->dequeue_position, 0);
+    IGS_ATOMIC_INIT (queue->is_signaled, false);
+    IGS_ATOMIC_INIT (queue->published, 0);
+    IGS_ATOMIC_INIT (queue->dispatched, 0);
+    IGS_ATOMIC_INIT (queue->dropped, 0);
+    IGS_ATOMIC_INIT (queue->conflated, 0);
+    IGS_ATOMIC_INIT (queue->blocked, 0);
+    IGS_ATOMIC_INIT (queue->max_pending, 0);
+    return queue;
+}
+
+bool s_local_queue_push (igs_local_queue_t *queue, igs_local_publication_t *publication)
+{
+    assert (queue);
+    assert (publication);
+    igs_local_queue_cell_t *cell = NULL;
+    size_t position = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = IGS_ATOMIC_LOAD (cell->sequence, IGS_MEMORY_ORDER_ACQUIRE);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) position;
+        if (diff == 0) {
+            if (IGS_ATOMIC_COMPARE_EXCHANGE (queue->enqueue_position, position, position + 1, IGS_MEMORY_ORDER_RELAXED))
+                break;
+        } else if (diff < 0)
+            return false; //queue is full
+        else
+            position = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+    }
+    cell->publication = publication;
+    IGS_ATOMIC_STORE (cell->sequence, position + 1, IGS_MEMORY_ORDER_RELEASE);
+    return true;
+}
+
+igs_local_publication_t * s_local_queue_pop (igs_local_queue_t *queue)
+{
+    assert (queue);
+    igs_local_queue_cell_t *cell = NULL;
+    size_t position = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = IGS_ATOMIC_LOAD (cell->sequence, IGS_MEMORY_ORDER_ACQUIRE);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) (position + 1);
+        if (diff == 0) {
+            if (IGS_ATOMIC_COMPARE_EXCHANGE (queue->dequeue_position, position, position + 1, IGS_MEMORY_ORDER_RELAXED))
+                break;
+        } else if (diff < 0)
+            return NULL; //queue is empty
+        else
+            position = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+    }
+    igs_local_publication_t *publication = cell->publication;
+    IGS_ATOMIC_STORE (cell->sequence, position + queue->mask + 1, IGS_MEMORY_ORDER_RELEASE);
+    return publication;
+}
+
+size_t s_local_queue_pending (igs_local_queue_t *queue)
+{
+    assert (queue);
+    size_t enqueued = IGS_ATOMIC_LOAD (queue->enqueue_position, IGS_MEMORY_ORDER_RELAXED);
+    size_t dequeued = IGS_ATOMIC_LOAD (queue->dequeue_position, IGS_MEMORY_ORDER_RELAXED);
+    return (enqueued > dequeued) ? enqueued - dequeued : 0;
+}
+
+void s_local_publication_destroy (igs_local_publication_t **publication)
+{
+    assert (publication);
+    assert (*publication);
+    if ((*publication)->buffer)
+        igs_data_unref (&(*publication)->buffer);
+    free (*publication);
+    *publication = NULL;
+}
+
+// keep a publication outside the queue, replacing any publication
+// of the same output (model locked)
+void s_local_queue_conflate (igs_local_queue_t *queue, igs_local_publication_t *publication)
+{
+    assert (queue);
+    assert (publication);
+    if (!queue->overflow)
+        queue->overflow = zhashx_new ();
+    char key[IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2] = "";
+    snprintf (key, IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2, "%s.%s",
+              publication->agent_uuid, publication->output_name);
+    igs_local_publication_t *previous = zhashx_lookup (queue->overflow, key);
+    if (previous) {
+        s_local_publication_destroy (&previous);
+        zhashx_delete (queue->overflow, key);
+    }
+    zhashx_insert (queue->overflow, key, publication);
+    IGS_ATOMIC_FETCH_ADD (queue->conflated, 1, IGS_MEMORY_ORDER_RELAXED);
+}
+
+void s_local_publication_dispatch (igs_local_publication_t **publication)
+{
+    assert (publication);
+    assert (*publication);
+    igs_local_publication_t *p = *publication;
+    if (!core_context->is_frozen) {
+        if (p->buffer)
+            s_dispatch_publication (p->agent_name, p->output_name, p->value_type,
+                                    p->buffer->data, p->buffer->size, p->timestamp, p->buffer);
+        else {
+            size_t size = 0;
+            if (p->value_type == IGS_INTEGER_T)
+                size = sizeof (int);
+            else if (p->value_type == IGS_DOUBLE_T)
+                size = sizeof (double);
+            else if (p->value_type == IGS_BOOL_T)
+                size = sizeof (bool);
+            s_dispatch_publication (p->agent_name, p->output_name, p->value_type,
+                                    (size > 0) ? &p->scalar : NULL, size, p->timestamp, NULL);
+        }
+    } else
+        igs_debug ("Local publication of %s.%s received but all traffic in our agent is currently frozen",
+                   p->agent_name, p->output_name);
+    s_local_publication_destroy (publication);
+}
+
+// handle the local publications by batches, then the ones kept
+// outside the queue, which are more recent
+void s_local_queue_drain (void)
+{
+    igs_local_queue_t *queue = core_context->local_queue;
+    if (!queue)
+        return;
+    IGS_ATOMIC_STORE (queue->is_signaled, false, IGS_MEMORY_ORDER_SEQ_CST);
+    igs_local_publication_t *batch[IGS_LOCAL_QUEUE_BATCH];
+    size_t nb_publications = 0;
+    do {
+        // publications are popped without lock so that
+        // blocked publishers can proceed
+        nb_publications = 0;
+        while (nb_publications < IGS_LOCAL_QUEUE_BATCH
+               && (batch[nb_publications] = s_local_queue_pop (queue)) != NULL)
+            nb_publications++;
+        if (nb_publications > 0)
+            core_signal_notify (&core_context->queue_room); //publishers blocked on a full queue
+        if (core_context->monitor_pipe_stack && nb_publications > 0)
+            printf ("---LOCAL_PUBLICATIONS - %zu\n", s_local_queue_pending (queue));
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        for (size_t i = 0; i < nb_publications; i++)
+            s_local_publication_dispatch (&batch[i]);
+        IGS_ATOMIC_FETCH_ADD (queue->dispatched, nb_publications, IGS_MEMORY_ORDER_RELAXED);
+        if (nb_publications < IGS_LOCAL_QUEUE_BATCH && queue->overflow && zhashx_size (queue->overflow) > 0) {
+            // publications may be conflated during the callbacks
+            zhashx_t *overflow = queue->overflow;
+            queue->overflow = NULL;
+            igs_local_publication_t *publication = zhashx_first (overflow);
+            while (publication) {
+                s_local_publication_dispatch (&publication);
+                IGS_ATOMIC_FETCH_ADD (queue->dispatched, 1, IGS_MEMORY_ORDER_RELAXED);
+                publication = zhashx_next (overflow);
+            }
+            zhashx_destroy (&overflow);
+        }
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+    } while (nb_publications == IGS_LOCAL_QUEUE_BATCH);
+}
+
+// drop the remaining local publications when the ingescape loop stops
+void s_local_queue_purge (igs_local_queue_t *queue)
+{
+    assert (queue);
+    igs_local_publication_t *publication = s_local_queue_pop (queue);
+    while (publication) {
+        s_local_publication_destroy (&publication);
+        publication = s_local_queue_pop (queue);
+    }
+    if (queue->overflow) {
+        publication = zhashx_first (queue->overflow);
+        while (publication) {
+            s_local_publication_destroy (&publication);
+            publication = zhashx_next (queue->overflow);
+        }
+        zhashx_destroy (&queue->overflow);
+    }
+    IGS_ATOMIC_STORE (queue->is_signaled, false, IGS_MEMORY_ORDER_SEQ_CST);
+    core_signal_notify (&core_context->queue_room);
+}
 
+int s_handle_parent_message (zsock_t *pipe)
+{
     zmsg_t *msg = zmsg_recv (pipe);
     assert (msg);
     char *command = zmsg_popstr (msg);
@@ -2906,24 +4537,8 @@ int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
         free (command);
         zmsg_destroy (&msg);
         return -1;
-    } else if (streq (command, "HANDLE_PUBLICATION")){
-        model_read_write_lock(__FUNCTION__, __LINE__);
-        char *name = zmsg_popstr (msg);
-        assert(name);
-        // Generate a temporary fake remote agent, containing only
-        // necessary information
-        igs_remote_agent_t *fake_remote = (igs_remote_agent_t *) zmalloc (sizeof (igs_remote_agent_t));
-        fake_remote->context = core_context;
-        fake_remote->definition = (igs_definition_t *) zmalloc (sizeof (igs_definition_t));
-        fake_remote->definition->name = name;
-        s_handle_publication (&msg, fake_remote); //destroys msg
-        free (fake_remote->definition);
-        free (fake_remote);
-        free (name);
-        if (core_context->monitor_pipe_stack)
-            printf("---HANDLE_PUBLICATION - %d (max: %d)\n", --handle_publications_balance, handle_publications_balance_max);
-        model_read_write_unlock(__FUNCTION__, __LINE__);
-    }
+    } else if (streq (command, LOCAL_PUBLICATIONS_CMD))
+        s_local_queue_drain ();
     //else: nothing to do so far
     free (command);
     if (msg)
@@ -2931,8 +4546,30 @@ int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
     return 0;
 }
 
+// NB: publications from our agents are handled together when some
+// of our inputs are conflated (see s_manage_received_publication)
+int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
+{
+    IGS_UNUSED (loop)
+    IGS_UNUSED (arg)
+    int res = 0;
+    size_t nb_messages = 0;
+    do {
+        res = s_handle_parent_message (pipe);
+    } while (res == 0 && core_context->conflation_is_used
+             && ++nb_messages < IGS_CONFLATION_MAX_BATCH
+             && (zsock_events (pipe) & ZMQ_POLLIN));
+    if (core_context->conflation_is_used) {
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        s_flush_conflated_values (res != 0);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+    }
+    return res;
+}
+
 static void s_run_loop (zsock_t *mypipe, void *args)
 {
+    s_is_network_thread = true;
     s_network_lock ();
     igs_core_context_t *context = (igs_core_context_t *) args;
     context->internal_pipe = mypipe;
@@ -2991,6 +4628,7 @@ static void s_run_loop (zsock_t *mypipe, void *args)
     zloop_reader_set_tolerant (context->loop, zyre_socket (context->node));
     zloop_timer (context->loop, 1000, 0, s_trigger_definition_update, context);
     zloop_timer (context->loop, 1000, 0, s_trigger_mapping_update, context);
+    zloop_timer (context->loop, IGS_SERVICE_CALL_DEADLINE_CHECK, 0, s_check_service_call_deadlines, context);
 
     zsock_signal (mypipe, 0);
     s_network_unlock ();
@@ -3004,6 +4642,7 @@ static void s_run_loop (zsock_t *mypipe, void *args)
     igs_debug ("loop stopping..."); // clean dynamic part of the context
     zloop_destroy (&context->loop);
     context->internal_pipe = NULL;
+    zhashx_destroy (&s_whisper_commands);
 
     // zmq stack cleaning
     igs_debug ("cleaning network stack...");
@@ -3020,14 +4659,23 @@ static void s_run_loop (zsock_t *mypipe, void *args)
     free (context->network_ipc_full_path);
     context->network_ipc_full_path = NULL;
 #endif
+    if (context->shm_segment)
+        s_shm_destroy (&context->shm_segment);
 #if !defined(__UTYPE_IOS)
     if (context->inproc_publisher)
         zsock_destroy (&context->inproc_publisher);
 #endif
-    if (context->logger)
+    if (context->logger) {
+        // the asynchronous log writer may be using it
+        admin_log_lock ();
         zsock_destroy (&context->logger);
+        admin_log_unlock ();
+    }
 
     igs_debug ("cleaning network structures...");
+    s_flush_conflated_values (true);
+    if (context->local_queue)
+        s_local_queue_purge (context->local_queue);
     igs_remote_agent_t *remote = zhashx_first(context->remote_agents);
     while (remote) {
         s_clean_and_free_remote_agent (&remote);
@@ -3041,6 +4689,8 @@ static void s_run_loop (zsock_t *mypipe, void *args)
         zyre_peer = zhashx_next(context->zyre_peers);
     }
     zhashx_purge(context->zyre_peers);
+    s_name_index_destroy (&context->remote_agents_by_name);
+    s_name_index_destroy (&context->zyre_peers_by_name);
 
     igs_timer_t *current_timer = zlist_first(context->timers);
     while (current_timer) {
@@ -3267,6 +4917,21 @@ void s_init_loop (igs_core_context_t *context)
     zyre_set_header (context->node, "ipc", "%s", context->network_ipc_endpoint);
     s_unlock_zyre_peer (__FUNCTION__, __LINE__);
 
+    // shared memory segment for large data values (see ingescape_private.h)
+    if (context->network_allow_shm && context->network_allow_ipc && !context->security_is_enabled) {
+        static unsigned int shm_counter = 0;
+        char shm_name[32] = "";
+        snprintf (shm_name, 32, "/igs%d-%u", (int) getpid (), shm_counter++);
+        size_t shm_size = (context->network_shm_size) ? context->network_shm_size : IGS_SHM_DEFAULT_SIZE;
+        context->shm_segment = s_shm_create (shm_name, shm_size);
+        if (context->shm_segment) {
+            s_lock_zyre_peer (__FUNCTION__, __LINE__);
+            zyre_set_header (context->node, "shm", "%s", shm_name);
+            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        } else
+            igs_error ("shared memory is disabled for this run of the agent");
+    }
+
 #elif defined(__WINDOWS__)
     context->network_ipc_endpoint = strdup ("tcp://127.0.0.1:*");
     zsock_t *ipc_publisher = context->ipc_publisher = zsock_new_pub (context->network_ipc_endpoint);
@@ -3383,42 +5048,452 @@ void s_init_loop (igs_core_context_t *context)
         zyre_set_header (context->node, "commandline", "%s", exe_file_path);
         s_unlock_zyre_peer (__FUNCTION__, __LINE__);
     }
-    else {
-        s_lock_zyre_peer (__FUNCTION__, __LINE__);
-        zyre_set_header (context->node, "commandline", "%s", context->command_line);
-        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    else {
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zyre_set_header (context->node, "commandline", "%s", context->command_line);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    }
+    DWORD pid = GetCurrentProcessId ();
+    context->process_id = (int) pid;
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zyre_set_header (context->node, "pid", "%i", (int) pid);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+#endif
+
+    // hostname
+    char hostname[1024];
+    hostname[1023] = '\0';
+    gethostname (hostname, 1023);
+#if defined(__WINDOWS__)
+    WSACleanup ();
+#endif
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zyre_set_header (context->node, "hostname", "%s", hostname);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    s_network_unlock ();
+
+    context->network_actor = zactor_new (s_run_loop, context);
+    if (core_context->unbind_pipe){
+        zsock_t *pipe = zactor_sock(context->network_actor);
+        zsock_set_unbounded(pipe);
+        assert(zsock_hwm(pipe) == 0);
+    }
+}
+
+// value of an output as published on the network
+// NB: string values include their terminating zero
+const void *s_network_publication_value (const igs_io_t *io, size_t *size)
+{
+    assert (io);
+    assert (size);
+    switch (io->value_type) {
+        case IGS_INTEGER_T:
+            *size = sizeof (int);
+            return &(io->value.i);
+        case IGS_DOUBLE_T:
+            *size = sizeof (double);
+            return &(io->value.d);
+        case IGS_BOOL_T:
+            *size = sizeof (bool);
+            return &(io->value.b);
+        case IGS_STRING_T:
+            *size = (io->value.s) ? strlen (io->value.s) + 1 : 1;
+            return (io->value.s) ? io->value.s : "";
+        case IGS_DATA_T:
+            *size = (io->value.data) ? io->value_size : 0;
+            return io->value.data;
+        default:
+            *size = 0;
+            return NULL;
+    }
+}
+
+void s_network_release_data (void **hint)
+{
+    assert (hint);
+    igs_data_t *data = (igs_data_t *) *hint;
+    igs_data_unref (&data);
+    *hint = NULL;
+}
+
+// frame sharing the value of a data output without copy: the io data
+// is kept alive until ZeroMQ has actually sent the frame
+zframe_t *s_network_data_frame (igs_io_t *io)
+{
+    assert (io);
+    assert (io->value_type == IGS_DATA_T);
+    igs_data_t *data = model_share_io_data (io);
+    if (!data || data->size == 0)
+        return zframe_new (NULL, 0);
+    return zframe_frommem (data->data, data->size, s_network_release_data, igs_data_ref (data));
+}
+
+// write the compact publication header (see ingescape_private.h)
+// and return its size
+size_t s_network_write_compact_header (uint8_t *bytes,
+                                       uint64_t topic,
+                                       igs_io_value_type_t value_type,
+                                       int64_t timestamp)
+{
+    bytes[0] = IGS_COMPACT_PUBLICATION_MARKER;
+    s_network_put_uint64 (bytes + 1, topic);
+    if (timestamp != INT64_MIN) {
+        bytes[IGS_COMPACT_PUBLICATION_HEADER_SIZE - 1] = (uint8_t) (value_type + IGS_DATA_T);
+        s_network_put_uint64 (bytes + IGS_COMPACT_PUBLICATION_HEADER_SIZE, (uint64_t) timestamp);
+        return IGS_COMPACT_PUBLICATION_HEADER_SIZE + sizeof (int64_t);
+    }
+    bytes[IGS_COMPACT_PUBLICATION_HEADER_SIZE - 1] = (uint8_t) value_type;
+    return IGS_COMPACT_PUBLICATION_HEADER_SIZE;
+}
+
+// get the publication cache of an output, (re)creating it if needed
+igs_publication_cache_t *s_network_publication_cache (igsagent_t *agent, igs_io_t *io)
+{
+    assert (agent);
+    assert (io);
+    if (io->publication_cache && io->publication_cache->value_type != io->value_type)
+        network_free_publication_cache (&io->publication_cache);
+    if (!io->publication_cache) {
+        igs_publication_cache_t *cache = (igs_publication_cache_t *) zmalloc (sizeof (igs_publication_cache_t));
+        cache->value_type = io->value_type;
+        cache->topic = network_publication_topic (agent->uuid, io->name);
+        char buffer[IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2] = "";
+        snprintf (buffer, IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2, "%s-%s", agent->uuid, io->name);
+        cache->legacy_topic = zframe_new (buffer, strlen (buffer));
+        snprintf (buffer, IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2, "%d", io->value_type);
+        cache->legacy_type = zframe_new (buffer, strlen (buffer));
+        if (io->value_type == IGS_INTEGER_T
+            || io->value_type == IGS_DOUBLE_T
+            || io->value_type == IGS_BOOL_T
+            || io->value_type == IGS_IMPULSION_T) {
+            size_t value_size = 0;
+            s_network_publication_value (io, &value_size);
+            cache->legacy_value = zframe_new (NULL, value_size);
+            cache->compact = zframe_new (NULL, IGS_COMPACT_PUBLICATION_HEADER_SIZE + value_size);
+            cache->compact_timestamped = zframe_new (NULL, IGS_COMPACT_PUBLICATION_HEADER_SIZE
+                                                     + sizeof (int64_t) + value_size);
+            assert (zframe_size (cache->compact_timestamped) <= IGS_MAX_REUSED_FRAME_SIZE);
+        }
+        io->publication_cache = cache;
+    }
+    // only one of our outputs per topic uses compact publications,
+    // the others take over when it disappears (see ingescape_private.h)
+    igs_publication_cache_t *cache = io->publication_cache;
+    if (!cache->is_topic_owner && !zhashx_lookup (agent->context->published_topics, &(cache->topic))) {
+        zhashx_insert (agent->context->published_topics, &(cache->topic), cache);
+        cache->is_topic_owner = true;
+    }
+    return cache;
+}
+
+// get the compact publication frame for an output: cached frames are
+// used for scalar values, new frames are created for the other values
+// NB: when value_frame is not NULL, data values are shared in a second
+// frame returned in value_frame, after a frame containing the header only
+zframe_t *s_network_compact_publication (igs_io_t *io,
+                                         igs_publication_cache_t *cache,
+                                         int64_t timestamp,
+                                         bool *is_cached,
+                                         zframe_t **value_frame)
+{
+    assert (io);
+    assert (cache);
+    assert (is_cached);
+    size_t value_size = 0;
+    const void *value = s_network_publication_value (io, &value_size);
+    if (value_frame && io->value_type == IGS_DATA_T) {
+        *value_frame = s_network_data_frame (io);
+        value_size = 0;
+    }
+    zframe_t *frame = NULL;
+    if (cache->compact) {
+        frame = (timestamp != INT64_MIN) ? cache->compact_timestamped : cache->compact;
+        *is_cached = true;
+    } else {
+        size_t header_size = IGS_COMPACT_PUBLICATION_HEADER_SIZE;
+        if (timestamp != INT64_MIN)
+            header_size += sizeof (int64_t);
+        frame = zframe_new (NULL, header_size + value_size);
+        *is_cached = false;
+    }
+    uint8_t *bytes = zframe_data (frame);
+    size_t header_size = s_network_write_compact_header (bytes, cache->topic, io->value_type, timestamp);
+    assert (zframe_size (frame) == header_size + value_size);
+    if (value_size > 0)
+        memcpy (bytes + header_size, value, value_size);
+    return frame;
+}
+
+// get the value frame of a legacy publication for an output: cached
+// frames are used for scalar values, new frames are created for the other values
+zframe_t *s_network_legacy_value (igs_io_t *io,
+                                  igs_publication_cache_t *cache,
+                                  bool *is_cached)
+{
+    assert (io);
+    assert (cache);
+    assert (is_cached);
+    size_t value_size = 0;
+    const void *value = s_network_publication_value (io, &value_size);
+    if (io->value_type == IGS_STRING_T)
+        value_size--; //legacy strings are sent without their terminating zero
+    if (cache->legacy_value) {
+        assert (zframe_size (cache->legacy_value) == value_size);
+        if (value_size > 0)
+            memcpy (zframe_data (cache->legacy_value), value, value_size);
+        *is_cached = true;
+        return cache->legacy_value;
+    }
+    *is_cached = false;
+    if (io->value_type == IGS_DATA_T)
+        return s_network_data_frame (io);
+    return zframe_new (value, value_size);
+}
+
+// write a data value in our shared memory segment and build the compact
+// header and descriptor frames to be sent instead of the value to the
+// peers on the same computer (see ingescape_private.h)
+bool s_network_shm_publication (igs_core_context_t *context,
+                                igs_io_t *io,
+                                igs_publication_cache_t *cache,
+                                int64_t timestamp,
+                                zframe_t **header_frame,
+                                zframe_t **descriptor)
+{
+    assert (context);
+    assert (io);
+    assert (cache);
+    assert (header_frame);
+    assert (descriptor);
+    if (!context->shm_segment || !context->ipc_publisher
+        || io->value_type != IGS_DATA_T
+        || context->network_local_peers == 0
+        || context->network_shm_peers != context->network_local_peers)
+        return false;
+    size_t value_size = 0;
+    const void *value = s_network_publication_value (io, &value_size);
+    size_t threshold = (context->network_shm_threshold) ? context->network_shm_threshold : IGS_SHM_DEFAULT_THRESHOLD;
+    uint64_t position = 0;
+    if (value_size < threshold
+        || !s_shm_write (context->shm_segment, value, value_size, &position))
+        return false;
+    size_t header_size = IGS_COMPACT_PUBLICATION_HEADER_SIZE;
+    if (timestamp != INT64_MIN)
+        header_size += sizeof (int64_t);
+    *header_frame = zframe_new (NULL, header_size);
+    uint8_t *bytes = zframe_data (*header_frame);
+    s_network_write_compact_header (bytes, cache->topic, io->value_type, timestamp);
+    bytes[IGS_COMPACT_PUBLICATION_HEADER_SIZE - 1] |= IGS_SHM_PUBLICATION_FLAG;
+    *descriptor = zframe_new (NULL, IGS_SHM_DESCRIPTOR_SIZE);
+    s_network_put_uint64 (zframe_data (*descriptor), position);
+    s_network_put_uint64 (zframe_data (*descriptor) + 8, value_size);
+    return true;
+}
+
+// send a publication on one of our publishers, using the legacy
+// message or the legacy value frame, and the compact frame if any,
+// followed by its value frame if any
+int s_network_send_publication (zsock_t *socket,
+                                igs_publication_cache_t *cache,
+                                zmsg_t *legacy_msg,
+                                zframe_t *legacy_value,
+                                zframe_t *compact_frame,
+                                zframe_t *compact_value)
+{
+    assert (socket);
+    assert (cache);
+    int rc = 0;
+    if (legacy_value) {
+        if (zframe_send (&cache->legacy_topic, socket, ZFRAME_MORE + ZFRAME_REUSE) != 0
+            || zframe_send (&cache->legacy_type, socket, ZFRAME_MORE + ZFRAME_REUSE) != 0
+            || zframe_send (&legacy_value, socket, ZFRAME_REUSE) != 0)
+            rc = -1;
+    } else if (legacy_msg && zsock_send (socket, "m", legacy_msg) != 0)
+        rc = -1;
+    if (compact_frame && compact_value) {
+        if (zframe_send (&compact_frame, socket, ZFRAME_MORE + ZFRAME_REUSE) != 0
+            || zframe_send (&compact_value, socket, ZFRAME_REUSE) != 0)
+            rc = -1;
+    } else if (compact_frame && zframe_send (&compact_frame, socket, ZFRAME_REUSE) != 0)
+        rc = -1;
+    return rc;
+}
+
+// timestamp for the publications of an agent, INT64_MIN if not timestamped
+int64_t s_network_publication_timestamp (igsagent_t *agent)
+{
+    assert (agent);
+    if (!agent->rt_timestamps_enabled)
+        return INT64_MIN;
+    if (agent->context->rt_current_microseconds != INT64_MIN)
+        return agent->context->rt_current_microseconds;
+    return zclock_usecs();
+}
+
+// build the batch publication frame (see ingescape_private.h) for
+// the outputs of an agent, NULL if none of them shall be published
+zframe_t *s_network_batch_publication (igsagent_t *agent, zlist_t *outputs)
+{
+    assert (agent);
+    assert (outputs);
+    assert (strlen (agent->uuid) == IGS_AGENT_UUID_LENGTH);
+    int64_t timestamp = s_network_publication_timestamp (agent);
+    size_t timestamp_size = (timestamp != INT64_MIN) ? sizeof (int64_t) : 0;
+    size_t frame_size = IGS_BATCH_PUBLICATION_HEADER_SIZE;
+    igs_io_t *io = zlist_first (outputs);
+    while (io) {
+        // outputs not owning their topic are only published in legacy form
+        if (!io->is_muted && s_network_publication_cache (agent, io)->is_topic_owner) {
+            size_t value_size = 0;
+            s_network_publication_value (io, &value_size);
+            frame_size += IGS_BATCH_PUBLICATION_ENTRY_SIZE + IGS_COMPACT_PUBLICATION_HEADER_SIZE
+                          + timestamp_size + value_size;
+        }
+        io = zlist_next (outputs);
+    }
+    if (frame_size == IGS_BATCH_PUBLICATION_HEADER_SIZE)
+        return NULL;
+    zframe_t *frame = zframe_new (NULL, frame_size);
+    uint8_t *bytes = zframe_data (frame);
+    bytes[0] = IGS_BATCH_PUBLICATION_MARKER;
+    memcpy (bytes + 1, agent->uuid, IGS_AGENT_UUID_LENGTH);
+    size_t offset = IGS_BATCH_PUBLICATION_HEADER_SIZE;
+    io = zlist_first (outputs);
+    while (io) {
+        igs_publication_cache_t *cache = s_network_publication_cache (agent, io);
+        if (!io->is_muted && cache->is_topic_owner) {
+            size_t value_size = 0;
+            const void *value = s_network_publication_value (io, &value_size);
+            uint8_t *entry = bytes + offset + IGS_BATCH_PUBLICATION_ENTRY_SIZE;
+            size_t entry_size = s_network_write_compact_header (entry, cache->topic, io->value_type, timestamp);
+            if (value_size > 0)
+                memcpy (entry + entry_size, value, value_size);
+            entry_size += value_size;
+            for (size_t i = 0; i < IGS_BATCH_PUBLICATION_ENTRY_SIZE; i++)
+                bytes[offset + i] = (uint8_t) (entry_size >> (8 * i));
+            offset += IGS_BATCH_PUBLICATION_ENTRY_SIZE + entry_size;
+        }
+        io = zlist_next (outputs);
     }
-    DWORD pid = GetCurrentProcessId ();
-    context->process_id = (int) pid;
-    s_lock_zyre_peer (__FUNCTION__, __LINE__);
-    zyre_set_header (context->node, "pid", "%i", (int) pid);
-    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-#endif
+    assert (offset == frame_size);
+    return frame;
+}
 
-    // hostname
-    char hostname[1024];
-    hostname[1023] = '\0';
-    gethostname (hostname, 1023);
-#if defined(__WINDOWS__)
-    WSACleanup ();
-#endif
-    s_lock_zyre_peer (__FUNCTION__, __LINE__);
-    zyre_set_header (context->node, "hostname", "%s", hostname);
-    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-    s_network_unlock ();
+// the ingescape loop is notified once until it drains the queue
+void s_local_queue_signal (igs_local_queue_t *queue)
+{
+    if (!IGS_ATOMIC_EXCHANGE (queue->is_signaled, true, IGS_MEMORY_ORDER_SEQ_CST)) {
+        zsock_t *pipe = zactor_sock (core_context->network_actor);
+        if (pipe)
+            zstr_send (pipe, LOCAL_PUBLICATIONS_CMD);
+    }
+}
 
-    context->network_actor = zactor_new (s_run_loop, context);
-    if (core_context->unbind_pipe){
-        zsock_t *pipe = zactor_sock(context->network_actor);
-        zsock_set_unbounded(pipe);
-        assert(zsock_hwm(pipe) == 0);
+// queue an output publication for the other agents in our peer (model locked)
+// NB: when can_wait is true, the model may be unlocked while waiting for room
+void s_local_queue_publish (igsagent_t *agent, igs_io_t *io, int64_t timestamp, bool can_wait)
+{
+    assert (agent);
+    assert (agent->uuid);
+    assert (agent->definition && agent->definition->name);
+    assert (io);
+    if (!core_context->local_queue)
+        core_context->local_queue = s_local_queue_new ((core_context->local_queue_capacity > 0) ?
+                                                       core_context->local_queue_capacity :
+                                                       IGS_LOCAL_QUEUE_DEFAULT_CAPACITY);
+    igs_local_queue_t *queue = core_context->local_queue;
+
+    size_t agent_name_length = strlen (agent->definition->name) + 1;
+    size_t output_name_length = strlen (io->name) + 1;
+    igs_local_publication_t *publication = (igs_local_publication_t *) zmalloc (sizeof (igs_local_publication_t)
+                                                                                + agent_name_length
+                                                                                + output_name_length);
+    publication->agent_name = (char *) (publication + 1);
+    publication->output_name = publication->agent_name + agent_name_length;
+    memcpy (publication->agent_name, agent->definition->name, agent_name_length);
+    memcpy (publication->output_name, io->name, output_name_length);
+    snprintf (publication->agent_uuid, IGS_AGENT_UUID_LENGTH + 1, "%s", agent->uuid);
+    publication->value_type = io->value_type;
+    publication->timestamp = timestamp;
+    switch (io->value_type) {
+        case IGS_INTEGER_T:
+            publication->scalar.i = io->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            publication->scalar.d = io->value.d;
+            break;
+        case IGS_BOOL_T:
+            publication->scalar.b = io->value.b;
+            break;
+        case IGS_STRING_T:
+        case IGS_DATA_T: {
+            // values are shared with the publication when possible
+            igs_data_t *shared = model_share_io_data (io);
+            if (shared)
+                publication->buffer = igs_data_ref (shared);
+            else {
+                size_t size = 0;
+                const void *value = s_network_publication_value (io, &size);
+                publication->buffer = model_data_copy (value, size);
+            }
+        } break;
+        default:
+            break;
+    }
+
+    IGS_ATOMIC_FETCH_ADD (queue->published, 1, IGS_MEMORY_ORDER_RELAXED);
+    bool is_blocked = false;
+    while (!s_local_queue_push (queue, publication)) {
+        if (core_context->local_queue_policy == IGS_LOCAL_QUEUE_DROP_OLDEST) {
+            igs_local_publication_t *oldest = s_local_queue_pop (queue);
+            if (oldest) {
+                s_local_publication_destroy (&oldest);
+                IGS_ATOMIC_FETCH_ADD (queue->dropped, 1, IGS_MEMORY_ORDER_RELAXED);
+            }
+        } else if (core_context->local_queue_policy == IGS_LOCAL_QUEUE_CONFLATE
+                   || s_is_network_thread || !can_wait) {
+            // NB: the ingescape loop cannot wait for itself, and callers
+            // holding outputs across the publication cannot release the model
+            s_local_queue_conflate (queue, publication);
+            publication = NULL;
+            break;
+        } else {
+            if (!is_blocked) {
+                is_blocked = true;
+                IGS_ATOMIC_FETCH_ADD (queue->blocked, 1, IGS_MEMORY_ORDER_RELAXED);
+            }
+            // the ingescape loop needs the model to dispatch the publications
+            // and wakes us up when it pops them
+            uint64_t count = core_signal_prepare (&core_context->queue_room);
+            if (s_local_queue_pending (queue) <= queue->mask) {
+                // popped since our push
+                core_signal_cancel (&core_context->queue_room);
+                continue;
+            }
+            s_local_queue_signal (queue);
+            model_read_write_unlock(__FUNCTION__, __LINE__);
+            core_signal_wait (&core_context->queue_room, count);
+            model_read_write_lock(__FUNCTION__, __LINE__);
+            if (core_context->local_queue != queue || !core_context->network_actor) {
+                // the ingescape loop stopped while we were waiting
+                s_local_publication_destroy (&publication);
+                return;
+            }
+        }
     }
+    size_t pending = s_local_queue_pending (queue);
+    size_t max_pending = IGS_ATOMIC_LOAD (queue->max_pending, IGS_MEMORY_ORDER_RELAXED);
+    while (pending > max_pending
+           && !IGS_ATOMIC_COMPARE_EXCHANGE (queue->max_pending, max_pending, pending, IGS_MEMORY_ORDER_RELAXED));
+    if (core_context->monitor_pipe_stack)
+        printf ("+++LOCAL_PUBLICATIONS - %zu (max: %zu)\n", pending, (pending > max_pending) ? pending : max_pending);
+
+    s_local_queue_signal (queue);
 }
 
-////////////////////////////////////////////////////////////////////////
-#pragma mark PRIVATE API
-////////////////////////////////////////////////////////////////////////
-igs_result_t network_publish_output (igsagent_t *agent, const igs_io_t *io)
+// publish an output, except to the peers receiving it in a batch
+// publication when is_batched is true
+igs_result_t s_network_publish_output (igsagent_t *agent, igs_io_t *io, bool is_batched, bool can_wait)
 {
     assert (agent);
     if (!agent->context){
@@ -3431,169 +5506,209 @@ igs_result_t network_publish_output (igsagent_t *agent, const igs_io_t *io)
     int result = IGS_SUCCESS;
 
     if (!agent->is_whole_agent_muted && !io->is_muted && !agent->context->is_frozen) {
-        split_add_work_to_queue (agent->context, agent->uuid, io);
-        int64_t current_microseconds = INT64_MIN;
-        if (agent->rt_timestamps_enabled){
-            if (agent->context->rt_current_microseconds != INT64_MIN)
-                current_microseconds = agent->context->rt_current_microseconds;
-            else
-                current_microseconds = zclock_usecs();
-        }
-        zmsg_t *msg = zmsg_new ();
-        zmsg_addstrf (msg, "%s-%s", agent->uuid, io->name);
-        if (current_microseconds == INT64_MIN) //no timestamping, we add value type immediately
-            zmsg_addstrf (msg, "%d", io->value_type);
-        switch (io->value_type) {
-            case IGS_INTEGER_T:
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_INTEGER_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_addmem (packaged_value, &(io->value.i), sizeof (int));
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes %s int with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, current_microseconds);
-                } else {
-                    zmsg_addmem (msg, &(io->value.i), sizeof (int));
-                    igsagent_debug (agent, "%s(%s) publishes %s int",
-                                    agent->definition->name, agent->uuid,
-                                    io->name);
-                }
-                break;
-            case IGS_DOUBLE_T:
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_DOUBLE_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_addmem (packaged_value, &(io->value.d), sizeof (double));
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes %s double with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, current_microseconds);
-                } else {
-                    zmsg_addmem (msg, &(io->value.d), sizeof (double));
-                    igsagent_debug (agent, "%s(%s) publishes %s double",
-                                    agent->definition->name, agent->uuid,
-                                    io->name);
-                }
-                break;
-            case IGS_BOOL_T:
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_BOOL_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_addmem (packaged_value, &(io->value.b), sizeof (bool));
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes %s bool with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, current_microseconds);
-                } else {
-                    zmsg_addmem (msg, &(io->value.b), sizeof (bool));
-                    igsagent_debug (agent, "%s(%s) publishes %s bool",
-                                    agent->definition->name, agent->uuid,
-                                    io->name);
-                }
-                break;
-            case IGS_STRING_T:
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_STRING_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_addstr (packaged_value, io->value.s);
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes %s string with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, current_microseconds);
-                } else {
-                    zmsg_addstr (msg, io->value.s);
-                    igsagent_debug (agent, "%s(%s) publishes %s string",
-                                    agent->definition->name, agent->uuid,
-                                    io->name);
-                }
-                break;
-            case IGS_IMPULSION_T:
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_IMPULSION_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_addmem (packaged_value, NULL, 0);
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes %s impulsion with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, current_microseconds);
-                } else {
-                    zmsg_addmem (msg, NULL, 0);
-                    igsagent_debug (agent, "%s(%s) publishes %s impulsion",
-                                    agent->definition->name, agent->uuid,
-                                    io->name);
-                }
-                break;
-            case IGS_DATA_T: {
-                zframe_t *frame = zframe_new (io->value.data, io->value_size);
-                if (current_microseconds != INT64_MIN){
-                    zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_DATA_T);
-                    zmsg_t *packaged_value = zmsg_new();
-                    zmsg_append (packaged_value, &frame);
-                    zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
-                    zmsg_addmsg(msg, &packaged_value);
-                    igsagent_debug (agent, "%s(%s) publishes data %s (%zu bytes) with timestamp %lld",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, io->value_size, current_microseconds);
-                } else {
-                    zmsg_append (msg, &frame);
-                    igsagent_debug (agent, "%s(%s) publishes data %s (%zu bytes)",
-                                    agent->definition->name, agent->uuid,
-                                    io->name, io->value_size);
-                }
-            } break;
-            default:
-                break;
+        // NB: the model may be unlocked while waiting for our workers
+        io = split_add_work_to_queue (agent->context, agent->uuid, io, can_wait);
+        if (!io)
+            return IGS_FAILURE;
+        int64_t current_microseconds = s_network_publication_timestamp (agent);
+        // Subscribing peers and agents in the same process are not known individually.
+        // We only build the messages that are actually useful:
+        // - the legacy multi-frame message for peers not supporting compact publications,
+        // and for all peers when the output shares its topic with another one,
+        // - the compact single frame message for the other peers, unless they receive
+        // the output in a batch publication or another output owns its topic,
+        // - a local publication for the agents in our own process.
+        igs_publication_cache_t *cache = s_network_publication_cache (agent, io);
+        bool is_colliding = (io->has_colliding_topic || !cache->is_topic_owner);
+        size_t nb_active_agents = zhashx_size(agent->context->agents);
+        bool is_started = (agent->context->network_actor && agent->context->publisher);
+        bool local_publication = (agent->context->network_actor && !agent->is_virtual && nb_active_agents > 1);
+        bool legacy_publication = (is_started && (agent->context->network_legacy_peers > 0
+                                                  || (is_colliding && agent->context->network_compact_peers > 0)));
+        bool compact_publication = (is_started && !is_batched && cache->is_topic_owner
+                                    && agent->context->network_compact_peers > 0);
+        // Scalar values are published with cached frames updated in place, without any
+        // allocation, except for timestamped legacy publications which use nested messages.
+        // Data values are shared with ZeroMQ without copy, in a separate value frame for
+        // compact publications when all the compact peers support it.
+        zframe_t *compact_frame = NULL;
+        zframe_t *compact_value = NULL;
+        bool compact_frame_is_cached = false;
+        bool shared_compact_value = (agent->context->network_batch_peers == agent->context->network_compact_peers);
+        if (compact_publication)
+            compact_frame = s_network_compact_publication (io, cache, current_microseconds,
+                                                           &compact_frame_is_cached,
+                                                           (shared_compact_value) ? &compact_value : NULL);
+        // Large data values are written once in our shared memory segment for
+        // the peers on the same computer, which receive a descriptor instead.
+        zframe_t *shm_frame = NULL;
+        zframe_t *shm_descriptor = NULL;
+        if (compact_publication)
+            s_network_shm_publication (agent->context, io, cache, current_microseconds,
+                                       &shm_frame, &shm_descriptor);
+        zframe_t *legacy_value = NULL;
+        bool legacy_value_is_cached = false;
+        if (legacy_publication && current_microseconds == INT64_MIN)
+            legacy_value = s_network_legacy_value (io, cache, &legacy_value_is_cached);
+        zmsg_t *msg = NULL;
+        if (legacy_publication && !legacy_value) {
+            msg = zmsg_new ();
+            zmsg_addstrf (msg, "%s-%s", agent->uuid, io->name);
+            if (current_microseconds == INT64_MIN) //no timestamping, we add value type immediately
+                zmsg_addstrf (msg, "%d", io->value_type);
+            switch (io->value_type) {
+                case IGS_INTEGER_T:
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_INTEGER_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_addmem (packaged_value, &(io->value.i), sizeof (int));
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes %s int with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, current_microseconds);
+                    } else {
+                        zmsg_addmem (msg, &(io->value.i), sizeof (int));
+                        igsagent_debug (agent, "%s(%s) publishes %s int",
+                                        agent->definition->name, agent->uuid,
+                                        io->name);
+                    }
+                    break;
+                case IGS_DOUBLE_T:
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_DOUBLE_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_addmem (packaged_value, &(io->value.d), sizeof (double));
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes %s double with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, current_microseconds);
+                    } else {
+                        zmsg_addmem (msg, &(io->value.d), sizeof (double));
+                        igsagent_debug (agent, "%s(%s) publishes %s double",
+                                        agent->definition->name, agent->uuid,
+                                        io->name);
+                    }
+                    break;
+                case IGS_BOOL_T:
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_BOOL_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_addmem (packaged_value, &(io->value.b), sizeof (bool));
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes %s bool with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, current_microseconds);
+                    } else {
+                        zmsg_addmem (msg, &(io->value.b), sizeof (bool));
+                        igsagent_debug (agent, "%s(%s) publishes %s bool",
+                                        agent->definition->name, agent->uuid,
+                                        io->name);
+                    }
+                    break;
+                case IGS_STRING_T:
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_STRING_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_addstr (packaged_value, io->value.s);
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes %s string with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, current_microseconds);
+                    } else {
+                        zmsg_addstr (msg, io->value.s);
+                        igsagent_debug (agent, "%s(%s) publishes %s string",
+                                        agent->definition->name, agent->uuid,
+                                        io->name);
+                    }
+                    break;
+                case IGS_IMPULSION_T:
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_IMPULSION_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_addmem (packaged_value, NULL, 0);
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes %s impulsion with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, current_microseconds);
+                    } else {
+                        zmsg_addmem (msg, NULL, 0);
+                        igsagent_debug (agent, "%s(%s) publishes %s impulsion",
+                                        agent->definition->name, agent->uuid,
+                                        io->name);
+                    }
+                    break;
+                case IGS_DATA_T: {
+                    zframe_t *frame = s_network_data_frame (io);
+                    if (current_microseconds != INT64_MIN){
+                        zmsg_addstrf (msg, "%d", IGS_TIMESTAMPED_DATA_T);
+                        zmsg_t *packaged_value = zmsg_new();
+                        zmsg_append (packaged_value, &frame);
+                        zmsg_addmem(packaged_value, &current_microseconds, sizeof(int64_t));
+                        zmsg_addmsg(msg, &packaged_value);
+                        igsagent_debug (agent, "%s(%s) publishes data %s (%zu bytes) with timestamp %lld",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, io->value_size, current_microseconds);
+                    } else {
+                        zmsg_append (msg, &frame);
+                        igsagent_debug (agent, "%s(%s) publishes data %s (%zu bytes)",
+                                        agent->definition->name, agent->uuid,
+                                        io->name, io->value_size);
+                    }
+                } break;
+                default:
+                    break;
+            }
         }
 
         // 1- publish to TCP
-        if (agent->context->network_actor && agent->context->publisher) {
-            if (zsock_send (core_context->publisher, "m", msg) != 0) {
+        zmsg_t *legacy_msg = (legacy_publication) ? msg : NULL;
+        if (is_started) {
+            if (s_network_send_publication (core_context->publisher, cache, legacy_msg,
+                                            legacy_value, compact_frame, compact_value) != 0) {
                 igsagent_error (agent, "Could not publish output %s on the network\n", io->name);
                 result = IGS_FAILURE;
             }
             // 2- publish to IPC
-            if (core_context->ipc_publisher) {
-                // publisher can be NULL on IOS or for read/write problems with assigned
-                // IPC path in both cases, an error message has been issued at start
-                if (zsock_send (core_context->ipc_publisher, "m", msg) != 0) {
-                    igsagent_error (agent, "Could not publish output %s using IPC\n", io->name);
-                    result = IGS_FAILURE;
-                }
+            // publisher can be NULL on IOS or for read/write problems with assigned
+            // IPC path in both cases, an error message has been issued at start
+            if (core_context->ipc_publisher
+                && s_network_send_publication (core_context->ipc_publisher, cache, legacy_msg, legacy_value,
+                                               (shm_frame) ? shm_frame : compact_frame,
+                                               (shm_frame) ? shm_descriptor : compact_value) != 0) {
+                igsagent_error (agent, "Could not publish output %s using IPC\n", io->name);
+                result = IGS_FAILURE;
             }
             // 3- publish to inproc
-            if (core_context->inproc_publisher) {
-                if (zsock_send (core_context->inproc_publisher, "m", msg) != 0) {
-                    igsagent_error (agent, "Could not publish output %s using inproc\n", io->name);
-                    result = IGS_FAILURE;
-                }
+            if (core_context->inproc_publisher
+                && s_network_send_publication (core_context->inproc_publisher, cache, legacy_msg,
+                                               legacy_value, compact_frame, compact_value) != 0) {
+                igsagent_error (agent, "Could not publish output %s using inproc\n", io->name);
+                result = IGS_FAILURE;
             }
         }else
             igsagent_debug (agent, "agent not started : could not publish output %s to the "
                             "network (published to agents in same process only)", io->name);
-
-        // 4- distribute publication message to other agents inside our context
-        size_t nb_active_agents = zhashx_size(agent->context->agents);
-        if (agent->context && agent->context->network_actor && !agent->is_virtual && nb_active_agents > 1) {
-            free (zmsg_popstr (msg)); // remove composite uuid/io name from message
-            zmsg_pushstr (msg, io->name); // replace it by simple io name
-            if (core_context->monitor_pipe_stack){
-                if (++handle_publications_balance > handle_publications_balance_max)
-                    handle_publications_balance_max = handle_publications_balance;
-                printf("+++HANDLE_PUBLICATION - %d (max: %d)\n", handle_publications_balance, handle_publications_balance_max);
-            }
-            zsock_t *pipe = zactor_sock(agent->context->network_actor);
-            if (pipe){
-                zmsg_pushstr(msg, agent->definition->name);
-                zmsg_pushstr(msg, "HANDLE_PUBLICATION");
-                zmsg_send(&msg, pipe);
-            }
-        } else
+        if (compact_frame && !compact_frame_is_cached)
+            zframe_destroy (&compact_frame);
+        if (compact_value)
+            zframe_destroy (&compact_value);
+        if (shm_frame)
+            zframe_destroy (&shm_frame);
+        if (shm_descriptor)
+            zframe_destroy (&shm_descriptor);
+        if (legacy_value && !legacy_value_is_cached)
+            zframe_destroy (&legacy_value);
+
+        // 4- distribute publication to other agents inside our context
+        // NB: io must not be used after this step when can_wait is true
+        if (local_publication)
+            s_local_queue_publish (agent, io, current_microseconds, can_wait);
+        if (msg)
             zmsg_destroy (&msg);
 
     } else {
@@ -3609,6 +5724,229 @@ igs_result_t network_publish_output (igsagent_t *agent, const igs_io_t *io)
     return result;
 }
 
+////////////////////////////////////////////////////////////////////////
+#pragma mark PRIVATE API
+////////////////////////////////////////////////////////////////////////
+bool network_is_loop_thread (void)
+{
+    return s_is_network_thread;
+}
+
+void network_local_queue_destroy (igs_local_queue_t **queue)
+{
+    assert (queue);
+    assert (*queue);
+    s_local_queue_purge (*queue);
+    free ((*queue)->cells);
+    free (*queue);
+    *queue = NULL;
+}
+
+zlist_t *network_remote_agents_named (const char *name_or_uuid)
+{
+    assert (name_or_uuid);
+    assert (core_context);
+    zlist_t *result = zlist_new ();
+    igs_remote_agent_t *by_uuid = zhashx_lookup (core_context->remote_agents, name_or_uuid);
+    if (by_uuid)
+        zlist_append (result, by_uuid);
+    zlist_t *by_name = (core_context->remote_agents_by_name) ?
+        zhashx_lookup (core_context->remote_agents_by_name, name_or_uuid) : NULL;
+    igs_remote_agent_t *remote_agent = (by_name) ? zlist_first (by_name) : NULL;
+    while (remote_agent) {
+        if (remote_agent != by_uuid)
+            zlist_append (result, remote_agent);
+        remote_agent = zlist_next (by_name);
+    }
+    return result;
+}
+
+zlist_t *network_zyre_peers_named (const char *name_or_peer_id)
+{
+    assert (name_or_peer_id);
+    assert (core_context);
+    zlist_t *result = zlist_new ();
+    igs_zyre_peer_t *by_id = zhashx_lookup (core_context->zyre_peers, name_or_peer_id);
+    if (by_id)
+        zlist_append (result, by_id);
+    zlist_t *by_name = (core_context->zyre_peers_by_name) ?
+        zhashx_lookup (core_context->zyre_peers_by_name, name_or_peer_id) : NULL;
+    igs_zyre_peer_t *zyre_peer = (by_name) ? zlist_first (by_name) : NULL;
+    while (zyre_peer) {
+        if (zyre_peer != by_id)
+            zlist_append (result, zyre_peer);
+        zyre_peer = zlist_next (by_name);
+    }
+    return result;
+}
+
+// topic used by compact publications for an output of an agent: FNV-1a
+// hash of the legacy "uuid-output" topic, with a final mix of its bits
+// NB: different outputs may still share a topic (see ingescape_private.h)
+uint64_t network_publication_topic (const char *agent_uuid, const char *output_name)
+{
+    assert (agent_uuid);
+    assert (output_name);
+    const char *parts[] = {agent_uuid, "-", output_name};
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof (parts) / sizeof (parts[0]); i++) {
+        for (const uint8_t *c = (const uint8_t *) parts[i]; *c; c++) {
+            hash ^= *c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+// flag the outputs of our agents sharing their topic with another one,
+// as known by our peers from our definitions (see ingescape_private.h)
+// NB: flags are never cleared, so that the subscribers still using legacy
+// subscriptions for these outputs keep receiving them.
+void network_update_colliding_topics (igs_core_context_t *context)
+{
+    assert (context);
+    size_t size = 0;
+    igsagent_t *agent = zhashx_first (context->agents);
+    while (agent) {
+        if (agent->uuid && agent->definition && agent->definition->outputs_table)
+            size += zhashx_size (agent->definition->outputs_table);
+        agent = zhashx_next (context->agents);
+    }
+    if (size < 2)
+        return;
+    uint64_t *topics = (uint64_t *) zmalloc (size * sizeof (uint64_t));
+    size_t index = 0;
+    agent = zhashx_first (context->agents);
+    while (agent) {
+        if (agent->uuid && agent->definition && agent->definition->outputs_table) {
+            igs_io_t *io = zhashx_first (agent->definition->outputs_table);
+            while (io) {
+                topics[index++] = network_publication_topic (agent->uuid, io->name);
+                io = zhashx_next (agent->definition->outputs_table);
+            }
+        }
+        agent = zhashx_next (context->agents);
+    }
+    assert (index == size);
+    size_t nb_colliding = s_network_colliding_topics (topics, size);
+    agent = (nb_colliding > 0) ? zhashx_first (context->agents) : NULL;
+    while (agent) {
+        if (agent->uuid && agent->definition && agent->definition->outputs_table) {
+            igs_io_t *io = zhashx_first (agent->definition->outputs_table);
+            while (io) {
+                uint64_t topic = network_publication_topic (agent->uuid, io->name);
+                if (!io->has_colliding_topic
+                    && bsearch (&topic, topics, nb_colliding, sizeof (uint64_t), s_network_compare_topics)) {
+                    igsagent_warn (agent, "output %s shares its topic with another output : it will also be published in legacy form",
+                                   io->name);
+                    io->has_colliding_topic = true;
+                }
+                io = zhashx_next (agent->definition->outputs_table);
+            }
+        }
+        agent = zhashx_next (context->agents);
+    }
+    free (topics);
+}
+
+void network_free_publication_cache (igs_publication_cache_t **cache)
+{
+    assert (cache);
+    assert (*cache);
+    if ((*cache)->is_topic_owner && core_context && core_context->published_topics)
+        zhashx_delete (core_context->published_topics, &((*cache)->topic));
+    zframe_destroy (&(*cache)->legacy_topic);
+    zframe_destroy (&(*cache)->legacy_type);
+    if ((*cache)->legacy_value)
+        zframe_destroy (&(*cache)->legacy_value);
+    if ((*cache)->compact)
+        zframe_destroy (&(*cache)->compact);
+    if ((*cache)->compact_timestamped)
+        zframe_destroy (&(*cache)->compact_timestamped);
+    free (*cache);
+    *cache = NULL;
+}
+
+// free the publication caches of an agent being deactivated, so that
+// its topics can be used by the outputs of our other agents
+void network_release_publication_caches (igsagent_t *agent)
+{
+    assert (agent);
+    if (!agent->definition || !agent->definition->outputs_table)
+        return;
+    igs_io_t *io = zhashx_first (agent->definition->outputs_table);
+    while (io) {
+        if (io->publication_cache)
+            network_free_publication_cache (&io->publication_cache);
+        io = zhashx_next (agent->definition->outputs_table);
+    }
+}
+
+igs_result_t network_publish_output (igsagent_t *agent, igs_io_t *io)
+{
+    assert (agent);
+    assert (io);
+    if (agent->output_batch) {
+        // publication is postponed to the commit of the batch
+        if (!io->is_in_batch) {
+            io->is_in_batch = true;
+            zlist_append (agent->output_batch, io->name);
+        }
+        return IGS_SUCCESS;
+    }
+    return s_network_publish_output (agent, io, false, true);
+}
+
+// publish several outputs of an agent, using a single batch publication
+// for the peers supporting it
+igs_result_t network_publish_outputs (igsagent_t *agent, zlist_t *outputs)
+{
+    assert (agent);
+    assert (outputs);
+    if (!agent->context){
+        igsagent_debug(agent, "agent is not activated: no publication");
+        return IGS_FAILURE;
+    }
+    assert (agent->uuid);
+    int result = IGS_SUCCESS;
+    bool is_started = (agent->context->network_actor && agent->context->publisher);
+    zframe_t *batch = NULL;
+    if (is_started && !agent->is_whole_agent_muted && !agent->context->is_frozen
+        && agent->context->network_batch_peers > 0
+        && agent->context->network_batch_peers == agent->context->network_compact_peers)
+        batch = s_network_batch_publication (agent, outputs);
+    igs_io_t *io = zlist_first (outputs);
+    while (io) {
+        // the other outputs of the list must remain valid
+        if (s_network_publish_output (agent, io, batch != NULL, false) != IGS_SUCCESS)
+            result = IGS_FAILURE;
+        io = zlist_next (outputs);
+    }
+    if (batch) {
+        if (zframe_send (&batch, core_context->publisher, ZFRAME_REUSE) != 0) {
+            igsagent_error (agent, "Could not publish batch on the network\n");
+            result = IGS_FAILURE;
+        }
+        if (core_context->ipc_publisher
+            && zframe_send (&batch, core_context->ipc_publisher, ZFRAME_REUSE) != 0) {
+            igsagent_error (agent, "Could not publish batch using IPC\n");
+            result = IGS_FAILURE;
+        }
+        if (core_context->inproc_publisher
+            && zframe_send (&batch, core_context->inproc_publisher, ZFRAME_REUSE) != 0) {
+            igsagent_error (agent, "Could not publish batch using inproc\n");
+            result = IGS_FAILURE;
+        }
+        zframe_destroy (&batch);
+    }
+    return result;
+}
+
 int s_manage_network_timer (zloop_t *loop, int timer_id, void *arg)
 {
     IGS_UNUSED (loop)
@@ -3634,6 +5972,58 @@ void igs_observe_channels (igs_channels_fn cb, void *my_data)
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
 
+igs_result_t igs_private_command_init (const char *command,
+                                       igs_private_command_fn cb,
+                                       void *my_data)
+{
+    assert (command);
+    assert (cb);
+    core_init_agent ();
+    if (strlen (command) == 0) {
+        igs_error ("private command name cannot be empty");
+        return IGS_FAILURE;
+    }
+    if (network_is_protocol_command (command)) {
+        igs_error ("%s is a command of the ingescape protocol and cannot be registered", command);
+        return IGS_FAILURE;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (!core_context->private_commands)
+        core_context->private_commands = zhashx_new ();
+    if (zhashx_lookup (core_context->private_commands, command)) {
+        igs_error ("private command %s is already registered", command);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    igs_private_command_t *private_command =
+    (igs_private_command_t *) zmalloc (sizeof (igs_private_command_t));
+    private_command->command = strdup (command);
+    private_command->cb = cb;
+    private_command->my_data = my_data;
+    zhashx_insert (core_context->private_commands, private_command->command, private_command);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igs_private_command_remove (const char *command)
+{
+    assert (command);
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_private_command_t *private_command = (core_context->private_commands) ?
+        zhashx_lookup (core_context->private_commands, command) : NULL;
+    if (!private_command) {
+        igs_error ("private command %s is not registered", command);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    zhashx_delete (core_context->private_commands, command);
+    free (private_command->command);
+    free (private_command);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
 igs_result_t igs_start_with_device (const char *network_device,
                                     unsigned int port)
 {
@@ -4765,6 +7155,47 @@ const char *igs_ipc_dir (void)
     model_read_write_unlock(__FUNCTION__, __LINE__);
     return res;
 }
+
+void igs_set_shm (bool allow)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (core_context->network_actor)
+        igs_error("Peer must be stopped for this function to work.");
+    else
+        core_context->network_allow_shm = allow;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
+
+bool igs_has_shm (void)
+{
+    core_init_agent ();
+    return core_context->network_allow_shm;
+}
+
+void igs_set_shm_size (size_t size)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (core_context->network_actor)
+        igs_error("Peer must be stopped for this function to work.");
+    else if (size < IGS_SHM_MAX_VALUE_RATIO)
+        igs_error("shared memory size must be at least %d bytes", IGS_SHM_MAX_VALUE_RATIO);
+    else
+        core_context->network_shm_size = size;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
+
+void igs_set_shm_threshold (size_t size)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (core_context->network_actor)
+        igs_error("Peer must be stopped for this function to work.");
+    else
+        core_context->network_shm_threshold = size;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
 #endif
 
 void igs_set_allow_inproc (bool allow)
@@ -4826,6 +7257,47 @@ void igs_unbind_pipe(void){
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
 
+void igs_local_queue_set_capacity (size_t capacity)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (core_context->network_actor)
+        igs_error("Peer must be stopped for this function to work.");
+    else {
+        core_context->local_queue_capacity = capacity;
+        if (core_context->local_queue)
+            network_local_queue_destroy (&core_context->local_queue);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
+
+void igs_local_queue_set_policy (igs_local_queue_policy_t policy)
+{
+    core_init_agent ();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    core_context->local_queue_policy = policy;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
+
+void igs_local_queue_stats (igs_local_queue_stats_t *stats)
+{
+    assert (stats);
+    core_init_agent ();
+    memset (stats, 0, sizeof (igs_local_queue_stats_t));
+    model_read_lock(__FUNCTION__, __LINE__);
+    igs_local_queue_t *queue = core_context->local_queue;
+    if (queue) {
+        stats->published = IGS_ATOMIC_LOAD (queue->published, IGS_MEMORY_ORDER_SEQ_CST);
+        stats->dispatched = IGS_ATOMIC_LOAD (queue->dispatched, IGS_MEMORY_ORDER_SEQ_CST);
+        stats->dropped = IGS_ATOMIC_LOAD (queue->dropped, IGS_MEMORY_ORDER_SEQ_CST);
+        stats->conflated = IGS_ATOMIC_LOAD (queue->conflated, IGS_MEMORY_ORDER_SEQ_CST);
+        stats->blocked = IGS_ATOMIC_LOAD (queue->blocked, IGS_MEMORY_ORDER_SEQ_CST);
+        stats->pending = s_local_queue_pending (queue);
+        stats->max_pending = IGS_ATOMIC_LOAD (queue->max_pending, IGS_MEMORY_ORDER_SEQ_CST);
+    }
+    model_read_unlock(__FUNCTION__, __LINE__);
+}
+
 void igs_monitor_pipe_stack(bool monitor){
     core_init_agent ();
     model_read_write_lock(__FUNCTION__, __LINE__);
@@ -1802,6 +1802,7 @@ igs_result_t igsagent_definition_load_str (igsagent_t *agent,
     }
     definition_free_definition (&agent->definition);
     agent->definition = tmp;
+    model_attach_io_handles (agent);
     definition_update_json (agent->definition);
     agent->network_need_to_send_definition_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
@@ -1827,6 +1828,7 @@ igs_result_t igsagent_definition_load_file (igsagent_t *agent,
     definition_free_definition (&agent->definition);
     agent->definition_path = s_strndup (file_path, IGS_MAX_PATH_LENGTH);
     agent->definition = tmp;
+    model_attach_io_handles (agent);
     definition_update_json (agent->definition);
     agent->network_need_to_send_definition_update = true;
     model_read_write_unlock(__FUNCTION__, __LINE__);
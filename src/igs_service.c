@@ -312,6 +312,221 @@ void service_log_received_service (igsagent_t *agent,
     igsagent_debug (agent, "%s", service_log);
 }
 
+void s_service_free_pending_call (igs_pending_service_call_t **call)
+{
+    assert(call);
+    assert(*call);
+    if ((*call)->token)
+        free ((*call)->token);
+    if ((*call)->service_name)
+        free ((*call)->service_name);
+    free (*call);
+    *call = NULL;
+}
+
+// pending calls table accessors, counting the calls checked
+// by s_check_service_call_deadlines (model locked)
+void s_service_insert_pending_call (igs_pending_service_call_t *call)
+{
+    assert (call);
+    zhashx_insert (core_context->pending_service_calls, call->token, call);
+    if (call->deadline > 0)
+        IGS_ATOMIC_FETCH_ADD (core_context->pending_call_deadlines, 1, IGS_MEMORY_ORDER_RELAXED);
+}
+
+void s_service_delete_pending_call (igs_pending_service_call_t *call)
+{
+    assert (call);
+    if (call->deadline > 0)
+        IGS_ATOMIC_FETCH_SUB (core_context->pending_call_deadlines, 1, IGS_MEMORY_ORDER_RELAXED);
+    zhashx_delete (core_context->pending_service_calls, call->token);
+}
+
+char * service_call_async (igsagent_t *agent,
+                           const char *agent_name_or_uuid,
+                           const char *service_name,
+                           igs_service_arg_t **list,
+                           unsigned int timeout_ms,
+                           igsagent_service_reply_fn agent_cb,
+                           igs_service_reply_fn cb,
+                           void *my_data)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return NULL;
+    assert (agent_name_or_uuid);
+    assert (service_name);
+    assert (agent_cb || cb);
+
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (!core_context->pending_service_calls)
+        core_context->pending_service_calls = zhashx_new ();
+    char token[IGS_MAX_AGENT_NAME_LENGTH] = "";
+    snprintf (token, IGS_MAX_AGENT_NAME_LENGTH, "%s#%zu", agent->uuid, ++core_context->service_calls_counter);
+    igs_pending_service_call_t *call = (igs_pending_service_call_t *) zmalloc (sizeof (igs_pending_service_call_t));
+    call->token = strdup (token);
+    call->agent = agent;
+    call->service_name = strdup (service_name);
+    call->deadline = (timeout_ms > 0) ? zclock_mono () + timeout_ms : 0;
+    call->agent_cb = agent_cb;
+    call->cb = cb;
+    call->my_data = my_data;
+    s_service_insert_pending_call (call);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+
+    //NB: replies from local agents may complete the call before igsagent_service_call returns
+    if (igsagent_service_call (agent, agent_name_or_uuid, service_name, list, token) == IGS_FAILURE) {
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        call = service_take_pending_call (agent, token);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        if (call)
+            s_service_free_pending_call (&call);
+        return NULL;
+    }
+    return strdup (token);
+}
+
+igs_pending_service_call_t * service_take_pending_call (igsagent_t *agent, const char *token)
+{
+    assert (agent);
+    assert (token);
+    if (!core_context->pending_service_calls)
+        return NULL;
+    igs_pending_service_call_t *call = zhashx_lookup (core_context->pending_service_calls, token);
+    if (!call || call->agent != agent)
+        return NULL;
+    s_service_delete_pending_call (call);
+    return call;
+}
+
+void service_restore_pending_call (igs_pending_service_call_t *call)
+{
+    assert (call);
+    assert (core_context->pending_service_calls);
+    s_service_insert_pending_call (call);
+}
+
+zlist_t * service_take_expired_calls (int64_t now)
+{
+    if (!core_context->pending_service_calls
+        || zhashx_size (core_context->pending_service_calls) == 0)
+        return NULL;
+    zlist_t *expired_calls = NULL;
+    igs_pending_service_call_t *call = zhashx_first (core_context->pending_service_calls);
+    while (call) {
+        if (call->deadline > 0 && call->deadline <= now) {
+            if (!expired_calls)
+                expired_calls = zlist_new ();
+            zlist_append (expired_calls, call);
+        }
+        call = zhashx_next (core_context->pending_service_calls);
+    }
+    if (expired_calls) {
+        call = zlist_first (expired_calls);
+        while (call) {
+            s_service_delete_pending_call (call);
+            call = zlist_next (expired_calls);
+        }
+    }
+    return expired_calls;
+}
+
+igs_result_t service_make_reply_arguments_from_message (igs_service_arg_t **args,
+                                                        igs_remote_agent_t *replier,
+                                                        const char *service_name,
+                                                        const char *reply_name,
+                                                        zmsg_t *msg)
+{
+    assert (args);
+    assert (service_name);
+    assert (reply_name);
+    assert (msg);
+    igs_service_t *reply = NULL;
+    if (replier && replier->definition && replier->definition->services_table) {
+        igs_service_t *service = zhashx_lookup (replier->definition->services_table, service_name);
+        if (service && service->replies)
+            reply = zhashx_lookup (service->replies, reply_name);
+    }
+    if (reply)
+        return service_make_values_to_arguments_from_message (args, reply, msg);
+
+    //reply is not specified by the replier : pass raw frames
+    zframe_t *frame = zmsg_pop (msg);
+    while (frame) {
+        igs_service_args_add_data (args, zframe_data (frame), zframe_size (frame));
+        zframe_destroy (&frame);
+        frame = zmsg_pop (msg);
+    }
+    return IGS_SUCCESS;
+}
+
+void service_complete_pending_call (igs_pending_service_call_t **call,
+                                    const char *replier_agent_name,
+                                    const char *replier_agent_uuid,
+                                    const char *reply_name,
+                                    igs_service_arg_t *args,
+                                    igs_service_call_status_t status)
+{
+    assert (call);
+    assert (*call);
+    size_t nb_args = 0;
+    igs_service_arg_t *arg = args;
+    while (arg) {
+        nb_args++;
+        arg = arg->next;
+    }
+    igs_pending_service_call_t *c = *call;
+    if (c->agent_cb)
+        c->agent_cb (c->agent, replier_agent_name, replier_agent_uuid, reply_name,
+                     args, nb_args, c->token, status, c->my_data);
+    else if (c->cb)
+        c->cb (replier_agent_name, replier_agent_uuid, reply_name,
+               args, nb_args, c->token, status, c->my_data);
+    s_service_free_pending_call (call);
+}
+
+void service_cancel_pending_calls (igsagent_t *agent)
+{
+    assert (agent);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (!core_context->pending_service_calls) {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return;
+    }
+    zlist_t *canceled_calls = zlist_new ();
+    igs_pending_service_call_t *call = zhashx_first (core_context->pending_service_calls);
+    while (call) {
+        if (call->agent == agent)
+            zlist_append (canceled_calls, call);
+        call = zhashx_next (core_context->pending_service_calls);
+    }
+    call = zlist_first (canceled_calls);
+    while (call) {
+        s_service_delete_pending_call (call);
+        call = zlist_next (canceled_calls);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    call = zlist_first (canceled_calls);
+    while (call) {
+        service_complete_pending_call (&call, NULL, NULL, NULL, NULL, IGS_SERVICE_CALL_CANCELED);
+        call = zlist_next (canceled_calls);
+    }
+    zlist_destroy (&canceled_calls);
+}
+
+void service_free_pending_calls (void)
+{
+    if (!core_context->pending_service_calls)
+        return;
+    igs_pending_service_call_t *call = zhashx_first (core_context->pending_service_calls);
+    while (call) {
+        s_service_free_pending_call (&call);
+        call = zhashx_next (core_context->pending_service_calls);
+    }
+    zhashx_destroy (&core_context->pending_service_calls);
+    IGS_ATOMIC_STORE (core_context->pending_call_deadlines, 0, IGS_MEMORY_ORDER_RELAXED);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -1086,12 +1301,12 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
             current_microseconds = zclock_usecs();
     }
     
-    // 1- iteration on remote agents
+    // 1- remote agents matching name or uuid
     if (agent->context && agent->context->node) {
-        igs_remote_agent_t *remote_agent = zhashx_first(agent->context->remote_agents);
+        zlist_t *remote_agents = network_remote_agents_named (agent_name_or_uuid);
+        igs_remote_agent_t *remote_agent = zlist_first(remote_agents);
         while (remote_agent) {
-            if ((remote_agent->definition && streq (remote_agent->definition->name, agent_name_or_uuid))
-                || streq (remote_agent->uuid, agent_name_or_uuid)) {
+            if (remote_agent->definition) {
                 // we found a matching agent
                 found = true;
                 /*NB: We removed verifications on the service on sender side to enable
@@ -1149,11 +1364,12 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                 if (agent->rt_timestamps_enabled)
                     zmsg_addmem(msg, &current_microseconds, sizeof(int64_t));
                 s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                zyre_shouts (agent->context->node, agent->igs_channel,
-                             "SERVICE %s(%s) called %s.%s(%s)",
-                             agent->definition->name, agent->uuid,
-                             remote_agent->definition->name, service_name,
-                             remote_agent->uuid);
+                if (core_context->enable_service_shouts)
+                    zyre_shouts (agent->context->node, agent->igs_channel,
+                                 "SERVICE %s(%s) called %s.%s(%s)",
+                                 agent->definition->name, agent->uuid,
+                                 remote_agent->definition->name, service_name,
+                                 remote_agent->uuid);
                 zyre_whisper (agent->context->node, remote_agent->peer->peer_id, &msg);
                 s_unlock_zyre_peer (__FUNCTION__, __LINE__);
                 if (core_context->enable_service_logging)
@@ -1164,8 +1380,9 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                                     remote_agent->definition->name,
                                     remote_agent->uuid, service_name);
             }
-            remote_agent = zhashx_next(agent->context->remote_agents);
+            remote_agent = zlist_next(remote_agents);
         }
+        zlist_destroy(&remote_agents);
     } else if (agent->context && !agent->context->node)
         igsagent_debug (agent, "peer is not started, service was not called on the network");
     
@@ -1180,6 +1397,16 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                 // we found a matching agent
                 assert(local_agent->definition && local_agent->definition->services_table);
                 found = true;
+                igs_pending_service_call_t *pending_call = (token) ? service_take_pending_call (local_agent, token) : NULL;
+                if (pending_call) {
+                    // this is a reply to an asynchronous call made by the local agent
+                    model_read_write_unlock(__FUNCTION__, __LINE__);
+                    service_complete_pending_call (&pending_call, agent->definition->name, agent->uuid, service_name,
+                                                   (list)?*list:NULL, IGS_SERVICE_CALL_REPLIED);
+                    model_read_write_lock(__FUNCTION__, __LINE__);
+                    local_agent = zlistx_next(local_agents);
+                    continue;
+                }
                 igs_service_t *service = zhashx_lookup(local_agent->definition->services_table, service_name);
                 if (service && service->name){
                     size_t nb_arguments = 0;
@@ -1204,11 +1431,13 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                         if (core_context->enable_service_logging)
                             service_log_received_service (local_agent, agent->definition->name, agent->uuid, service_name,
                                                           (list)?*list:NULL, current_microseconds);
-                        s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                        if (core_context->node)
-                            zyre_shouts (agent->context->node, agent->igs_channel, "SERVICE %s(%s) called %s.%s(%s)",
-                                         agent->definition->name, agent->uuid, local_agent->definition->name, service_name, local_agent->uuid);
-                        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                        if (core_context->enable_service_shouts) {
+                            s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                            if (core_context->node)
+                                zyre_shouts (agent->context->node, agent->igs_channel, "SERVICE %s(%s) called %s.%s(%s)",
+                                             agent->definition->name, agent->uuid, local_agent->definition->name, service_name, local_agent->uuid);
+                            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                        }
                         
                         if (core_context->enable_service_logging)
                             s_service_log_sent_service (agent, local_agent->definition->name, local_agent->uuid,
@@ -1246,6 +1475,34 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
     return res;
 }
 
+char * igsagent_service_call_async (igsagent_t *agent,
+                                   const char *agent_name_or_uuid,
+                                   const char *service_name,
+                                   igs_service_arg_t **list,
+                                   unsigned int timeout_ms,
+                                   igsagent_service_reply_fn cb,
+                                   void *data)
+{
+    assert (agent);
+    assert (cb);
+    return service_call_async (agent, agent_name_or_uuid, service_name, list, timeout_ms, cb, NULL, data);
+}
+
+igs_result_t igsagent_service_call_cancel (igsagent_t *agent, const char *token)
+{
+    assert (agent);
+    assert (token);
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_pending_service_call_t *call = service_take_pending_call (agent, token);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    if (!call) {
+        igsagent_debug (agent, "no pending service call with token %s", token);
+        return IGS_FAILURE;
+    }
+    service_complete_pending_call (&call, NULL, NULL, NULL, NULL, IGS_SERVICE_CALL_CANCELED);
+    return IGS_SUCCESS;
+}
+
 size_t igsagent_service_count (igsagent_t *agent)
 {
     assert(agent);
@@ -17,169 +17,593 @@
 ////////////////////////////////////////////////////////////////////////
 #pragma mark INTERNAL FUNCTIONS
 ////////////////////////////////////////////////////////////////////////
-void s_split_trigger_send_message_to_worker (igs_core_context_t *context,
-                                             char *agent_uuid,
-                                             const igs_io_t *output)
+#define IGS_SPLIT_KEY_LENGTH (IGS_AGENT_UUID_LENGTH + IGS_MAX_IO_NAME_LENGTH + 2)
+
+// key of our splitters (agent uuid and output name) in context->splitters
+// and of their workers (remote agent uuid and input name) in splitter->workers
+void s_split_key (char *key, const char *uuid, const char *name)
 {
-    assert(context);
-    assert(agent_uuid);
-    assert(output);
+    snprintf (key, IGS_SPLIT_KEY_LENGTH, "%s.%s", uuid, name);
+}
 
-    zlist_t *splitters = zlist_dup(context->splitters);
-    igs_splitter_t *splitter = zlist_first(splitters);
-    while (splitter) {
-        if(streq(splitter->agent_uuid, agent_uuid) && streq(splitter->output_name, output->name)){
-            igs_worker_t *max_credit_worker = NULL;
-            zlist_t *workers = zlist_dup(splitter->workers);
-            igs_worker_t *worker = max_credit_worker = zlist_first(workers);
-            while (worker) {
-                if(max_credit_worker->credit < worker->credit //take worker with more credits
-                   || (max_credit_worker->credit == worker->credit //take worker with same credits but less uses
-                       && worker->uses < max_credit_worker->uses))
-                    max_credit_worker = worker;
-                worker = zlist_next(workers);
+// Queued works are taken from and released to the pool of the context,
+// keeping their string or data buffer unless it is too large.
+igs_queued_work_t *s_split_work_new (void)
+{
+    if (core_context->split_work_pool_size > 0)
+        return core_context->split_work_pool[--core_context->split_work_pool_size];
+    return (igs_queued_work_t *) zmalloc (sizeof (igs_queued_work_t));
+}
+
+void s_split_free_queued_work (igs_queued_work_t **work)
+{
+    assert (work);
+    assert (*work);
+    if ((*work)->buffer_size > IGS_SPLIT_POOLED_BUFFER_SIZE) {
+        free ((*work)->buffer);
+        (*work)->buffer = NULL;
+        (*work)->buffer_size = 0;
+    }
+    if (core_context && core_context->split_work_pool_size < IGS_SPLIT_WORK_POOL_SIZE) {
+        if (!core_context->split_work_pool)
+            core_context->split_work_pool = (igs_queued_work_t **) zmalloc (IGS_SPLIT_WORK_POOL_SIZE
+                                                                            * sizeof (igs_queued_work_t *));
+        core_context->split_work_pool[core_context->split_work_pool_size++] = *work;
+    } else {
+        if ((*work)->buffer)
+            free ((*work)->buffer);
+        free (*work);
+    }
+    *work = NULL;
+}
+
+// copy the current value of our output into a new or queued work
+void s_split_work_set_value (igs_queued_work_t *work, const igs_io_t *output)
+{
+    work->value_type = output->value_type;
+    work->value_size = output->value_size;
+    switch (output->value_type) {
+        case IGS_INTEGER_T:
+            work->value.i = output->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            work->value.d = output->value.d;
+            break;
+        case IGS_BOOL_T:
+            work->value.b = output->value.b;
+            break;
+        case IGS_STRING_T:
+        case IGS_DATA_T: {
+            const void *value = (output->value_type == IGS_STRING_T) ? (const void *) output->value.s : output->value.data;
+            size_t size = (output->value_type == IGS_STRING_T) ? ((value) ? strlen (value) + 1 : 1) : output->value_size;
+            if (work->buffer_size < size) {
+                work->buffer = realloc (work->buffer, size);
+                assert (work->buffer);
+                work->buffer_size = size;
             }
-            zlist_destroy(&workers);
-            if(max_credit_worker && max_credit_worker->credit > 0){
-                igs_queued_work_t *work = zlist_first(splitter->queued_works);
-                if(work){
-                    char *max_credit_worker_uuid = strdup(max_credit_worker->agent_uuid);
-                    zmsg_t *readyMessage = zmsg_new();
-                    zmsg_addstr(readyMessage, SPLITTER_WORK_MSG);
-                    zmsg_addstr(readyMessage, splitter->agent_uuid );
-                    zmsg_addstr(readyMessage, max_credit_worker->input_name);
-                    zmsg_addstr(readyMessage, output->name);
-                    zmsg_addstrf(readyMessage, "%d", output->value_type);
-                    switch (output->value_type) {
-                        case IGS_INTEGER_T:
-                            zmsg_addmem(readyMessage, &(work->value.i), sizeof(int));
-                            break;
-                        case IGS_DOUBLE_T:
-                            zmsg_addmem(readyMessage, &(work->value.d), sizeof(double));
-                            break;
-                        case IGS_BOOL_T:
-                            zmsg_addmem(readyMessage, &(work->value.b), sizeof(bool));
-                            break;
-                        case IGS_STRING_T:
-                            zmsg_addstr(readyMessage, work->value.s);
-                            break;
-                        case IGS_IMPULSION_T:
-                            zmsg_addmem(readyMessage, NULL, 0);
-                            break;
-                        case IGS_DATA_T:{
-                            zframe_t *frame = zframe_new (work->value.data, work->value_size);
-                            zmsg_append(readyMessage, &frame);}
-                            break;
-                        default:
-                            break;
-                    }
-                    
-                    zlist_remove(splitter->queued_works, work);
-                    if(work->value_type == IGS_STRING_T)
-                        free(work->value.s);
-                    else if (work->value_type == IGS_DATA_T)
-                        free(work->value.data);
-                    free(work);
-                    max_credit_worker->uses++;
-                    max_credit_worker->credit--;
-                    
-                    if (context->node) {
-                        zlistx_t *agents = zhashx_values(context->agents);
-                        igsagent_t *local_agent = zlistx_first(agents);
-                        while (local_agent) {
-                            if(streq(local_agent->uuid, agent_uuid)){
-                                zlistx_t *remote_agents = zhashx_values(context->remote_agents);
-                                igs_remote_agent_t *remote_agent = zlistx_first(remote_agents);
-                                while (remote_agent) {
-                                    if(streq(remote_agent->uuid, max_credit_worker->agent_uuid)){
-                                        s_lock_zyre_peer(__FUNCTION__, __LINE__);
-                                        zyre_shouts (context->node, local_agent->igs_channel,
-                                                     "SPLIT %s(%s).%s to %s(%s).%s",
-                                                     local_agent->definition->name,
-                                                     splitter->agent_uuid,
-                                                     output->name,
-                                                     remote_agent->definition->name,
-                                                     max_credit_worker->agent_uuid,
-                                                     max_credit_worker->input_name);
-                                        s_unlock_zyre_peer(__FUNCTION__, __LINE__);
-                                    }
-                                    remote_agent = zlistx_next(remote_agents);
-                                }
-                                zlistx_destroy(&remote_agents);
-                            }
-                            local_agent = zlistx_next(agents);
-                        }
-                        zlistx_destroy(&agents);
-                    }
-                    model_read_write_unlock(__FUNCTION__, __LINE__);
-                    igs_channel_whisper_zmsg(max_credit_worker_uuid, &readyMessage);
-                    free(max_credit_worker_uuid);
-                    model_read_write_lock(__FUNCTION__, __LINE__);
-                }
+            if (value && size > 0)
+                memcpy (work->buffer, value, size);
+            else if (output->value_type == IGS_STRING_T)
+                ((char *) work->buffer)[0] = '\0';
+            if (output->value_type == IGS_STRING_T)
+                work->value.s = (char *) work->buffer;
+            else
+                work->value.data = work->buffer;
+        } break;
+        default:
+            break;
+    }
+}
+
+size_t s_split_pending_works (igs_splitter_t *splitter)
+{
+    return zlist_size (splitter->queued_works) + splitter->keyed_works;
+}
+
+// output of one of our agents a splitter is dedicated to
+igs_io_t *s_split_output (igs_core_context_t *context, igs_splitter_t *splitter)
+{
+    igsagent_t *agent = zhashx_lookup (context->agents, splitter->agent_uuid);
+    if (!agent || !agent->definition)
+        return NULL;
+    return model_find_io_by_name (agent, splitter->output_name, IGS_OUTPUT_T);
+}
+
+// The workers of a splitter are kept in a binary heap whose first
+// element is the best worker, i.e. the one with the most credits and
+// then the fewest uses.
+bool s_split_worker_is_better (const igs_worker_t *worker, const igs_worker_t *other)
+{
+    return worker->credit > other->credit
+           || (worker->credit == other->credit && worker->uses < other->uses);
+}
+
+void s_split_heap_swap (igs_splitter_t *splitter, size_t i, size_t j)
+{
+    igs_worker_t *worker = splitter->workers_heap[i];
+    splitter->workers_heap[i] = splitter->workers_heap[j];
+    splitter->workers_heap[j] = worker;
+    splitter->workers_heap[i]->heap_index = i;
+    splitter->workers_heap[j]->heap_index = j;
+}
+
+void s_split_heap_sift_up (igs_splitter_t *splitter, size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!s_split_worker_is_better (splitter->workers_heap[index], splitter->workers_heap[parent]))
+            break;
+        s_split_heap_swap (splitter, index, parent);
+        index = parent;
+    }
+}
+
+void s_split_heap_sift_down (igs_splitter_t *splitter, size_t index)
+{
+    while (true) {
+        size_t best = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < splitter->workers_heap_size
+            && s_split_worker_is_better (splitter->workers_heap[left], splitter->workers_heap[best]))
+            best = left;
+        if (right < splitter->workers_heap_size
+            && s_split_worker_is_better (splitter->workers_heap[right], splitter->workers_heap[best]))
+            best = right;
+        if (best == index)
+            break;
+        s_split_heap_swap (splitter, index, best);
+        index = best;
+    }
+}
+
+// restore heap order after the credits or uses of a worker changed
+void s_split_heap_update (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    s_split_heap_sift_up (splitter, worker->heap_index);
+    s_split_heap_sift_down (splitter, worker->heap_index);
+}
+
+void s_split_heap_insert (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    if (splitter->workers_heap_size == splitter->workers_heap_capacity) {
+        splitter->workers_heap_capacity = (splitter->workers_heap_capacity) ? 2 * splitter->workers_heap_capacity : 8;
+        splitter->workers_heap = (igs_worker_t **) realloc (splitter->workers_heap,
+                                                            splitter->workers_heap_capacity * sizeof (igs_worker_t *));
+        assert (splitter->workers_heap);
+    }
+    worker->heap_index = splitter->workers_heap_size++;
+    splitter->workers_heap[worker->heap_index] = worker;
+    s_split_heap_sift_up (splitter, worker->heap_index);
+}
+
+void s_split_heap_remove (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    size_t index = worker->heap_index;
+    assert (index < splitter->workers_heap_size && splitter->workers_heap[index] == worker);
+    splitter->workers_heap_size--;
+    if (index < splitter->workers_heap_size) {
+        splitter->workers_heap[index] = splitter->workers_heap[splitter->workers_heap_size];
+        splitter->workers_heap[index]->heap_index = index;
+        s_split_heap_update (splitter, splitter->workers_heap[index]);
+    }
+}
+
+igs_worker_t *s_split_worker_new (const char *worker_uuid, const char *input_name, int credit, int uses)
+{
+    igs_worker_t *worker = (igs_worker_t *) zmalloc (sizeof (igs_worker_t));
+    worker->agent_uuid = s_strndup (worker_uuid, strlen (worker_uuid));
+    worker->input_name = s_strndup (input_name, strlen (input_name));
+    worker->credit = credit;
+    worker->uses = uses;
+    worker->keyed_works = zlist_new ();
+    return worker;
+}
+
+// The workers having keyed works and credits are indexed, so that
+// dispatching keyed works does not scan all the workers of a splitter.
+// NB: to be called each time the credits or keyed works of a worker change
+void s_split_update_ready_worker (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    bool is_ready = (worker->credit > 0 && zlist_size (worker->keyed_works) > 0);
+    if (is_ready && !worker->ready_handle)
+        worker->ready_handle = zlistx_add_end (splitter->ready_workers, worker);
+    else if (!is_ready && worker->ready_handle) {
+        zlistx_delete (splitter->ready_workers, worker->ready_handle);
+        worker->ready_handle = NULL;
+    }
+}
+
+void s_split_worker_destroy (igs_worker_t **worker)
+{
+    assert (worker);
+    assert (*worker);
+    if ((*worker)->input_name)
+        free ((*worker)->input_name);
+    if ((*worker)->agent_uuid)
+        free ((*worker)->agent_uuid);
+    igs_queued_work_t *work = zlist_pop ((*worker)->keyed_works);
+    while (work) {
+        s_split_free_queued_work (&work);
+        work = zlist_pop ((*worker)->keyed_works);
+    }
+    zlist_destroy (&(*worker)->keyed_works);
+    free (*worker);
+    *worker = NULL;
+}
+
+// FNV-1a, followed by a finalizer spreading the keys differing
+// by their last bytes only over the whole ring
+uint64_t s_split_hash (const void *bytes, size_t size)
+{
+    const uint8_t *b = (const uint8_t *) bytes;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= b[i];
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+int s_split_compare_ring_points (const void *a, const void *b)
+{
+    uint64_t hash_a = ((const igs_split_ring_point_t *) a)->hash;
+    uint64_t hash_b = ((const igs_split_ring_point_t *) b)->hash;
+    return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+// The points of a worker only depend on its uuid and input name, so
+// that adding or removing a worker only moves the keys of its points.
+void s_split_ring_rebuild (igs_splitter_t *splitter)
+{
+    if (splitter->ring)
+        free (splitter->ring);
+    splitter->ring = NULL;
+    splitter->ring_size = splitter->workers_heap_size * IGS_SPLIT_RING_POINTS;
+    if (splitter->ring_size == 0)
+        return;
+    splitter->ring = (igs_split_ring_point_t *) zmalloc (splitter->ring_size * sizeof (igs_split_ring_point_t));
+    size_t index = 0;
+    for (size_t i = 0; i < splitter->workers_heap_size; i++) {
+        igs_worker_t *worker = splitter->workers_heap[i];
+        for (int point = 0; point < IGS_SPLIT_RING_POINTS; point++) {
+            char point_name[IGS_SPLIT_KEY_LENGTH + 8] = "";
+            snprintf (point_name, IGS_SPLIT_KEY_LENGTH + 8, "%s.%s#%d",
+                      worker->agent_uuid, worker->input_name, point);
+            splitter->ring[index].hash = s_split_hash (point_name, strlen (point_name));
+            splitter->ring[index].worker = worker;
+            index++;
+        }
+    }
+    qsort (splitter->ring, splitter->ring_size, sizeof (igs_split_ring_point_t), s_split_compare_ring_points);
+}
+
+// worker owning the first point following the key on the ring
+igs_worker_t *s_split_ring_worker (igs_splitter_t *splitter, uint64_t key)
+{
+    if (splitter->ring_size == 0)
+        return NULL;
+    size_t low = 0;
+    size_t high = splitter->ring_size;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (splitter->ring[middle].hash < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == splitter->ring_size)
+        low = 0;
+    return splitter->ring[low].worker;
+}
+
+// split key of a value written on one of our outputs, if any
+bool s_split_work_key (const igs_io_t *output, uint64_t *key)
+{
+    switch (output->split_mode) {
+        case IGS_SPLIT_BY_JSON_FIELD: {
+            if (output->value_type != IGS_STRING_T || !output->value.s || !output->split_key_path)
+                return false;
+            igs_json_node_t *json = igs_json_node_parse_from_str (output->value.s);
+            if (!json)
+                return false;
+            igs_json_node_t *field = igs_json_node_find (json, (const char **) output->split_key_path);
+            bool found = (field != NULL);
+            if (field && field->type == IGS_JSON_STRING)
+                *key = s_split_hash (field->u.string, strlen (field->u.string));
+            else if (field) {
+                char *dump = igs_json_node_dump (field);
+                *key = s_split_hash (dump, strlen (dump));
+                free (dump);
             }
+            igs_json_node_destroy (&json);
+            return found;
+        }
+        case IGS_SPLIT_BY_DATA_RANGE:
+            if (output->value_type != IGS_DATA_T || !output->value.data
+                || output->split_key_offset + output->split_key_size > output->value_size)
+                return false;
+            *key = s_split_hash ((const uint8_t *) output->value.data + output->split_key_offset,
+                                 output->split_key_size);
+            return true;
+        case IGS_SPLIT_BY_KEY:
+            if (!output->split_key)
+                return false;
+            *key = s_split_hash (output->split_key, strlen (output->split_key));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The keyed works of a removed worker go to the workers now owning their
+// keys, or to the shared queue when no worker is left. Returns true if
+// works were moved.
+bool s_split_remove_worker_from_splitter (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    char key[IGS_SPLIT_KEY_LENGTH] = "";
+    s_split_key (key, worker->agent_uuid, worker->input_name);
+    zhashx_delete (splitter->workers, key);
+    s_split_heap_remove (splitter, worker);
+    s_split_ring_rebuild (splitter);
+    if (worker->ready_handle)
+        zlistx_delete (splitter->ready_workers, worker->ready_handle);
+    bool has_moved_works = (zlist_size (worker->keyed_works) > 0);
+    igs_queued_work_t *work = zlist_pop (worker->keyed_works);
+    while (work) {
+        igs_worker_t *target = s_split_ring_worker (splitter, work->key);
+        if (target) {
+            zlist_append (target->keyed_works, work);
+            s_split_update_ready_worker (splitter, target);
+        } else {
+            zlist_append (splitter->queued_works, work);
+            splitter->keyed_works--;
+        }
+        work = zlist_pop (worker->keyed_works);
+    }
+    s_split_worker_destroy (&worker);
+    return has_moved_works;
+}
+
+void s_split_add_work_value (zmsg_t *work_message, igs_queued_work_t *work)
+{
+    switch (work->value_type) {
+        case IGS_INTEGER_T:
+            zmsg_addmem (work_message, &(work->value.i), sizeof (int));
             break;
+        case IGS_DOUBLE_T:
+            zmsg_addmem (work_message, &(work->value.d), sizeof (double));
+            break;
+        case IGS_BOOL_T:
+            zmsg_addmem (work_message, &(work->value.b), sizeof (bool));
+            break;
+        case IGS_STRING_T:
+            zmsg_addstr (work_message, work->value.s);
+            break;
+        case IGS_IMPULSION_T:
+            zmsg_addmem (work_message, NULL, 0);
+            break;
+        case IGS_DATA_T:
+            zmsg_addmem (work_message, work->value.data, work->value_size);
+            break;
+        default:
+            break;
+    }
+}
+
+// message for the next works of a splitter or worker queue, removing them
+// from the queue: a single work for the workers not supporting batches
+zmsg_t *s_split_work_message (igs_splitter_t *splitter, igs_worker_t *worker,
+                              zlist_t *works, size_t nb_works)
+{
+    assert (nb_works > 0);
+    zmsg_t *work_message = zmsg_new ();
+    zmsg_addstr (work_message, (worker->batches_works) ? SPLITTER_WORKS_MSG : SPLITTER_WORK_MSG);
+    zmsg_addstr (work_message, splitter->agent_uuid);
+    zmsg_addstr (work_message, worker->input_name);
+    zmsg_addstr (work_message, splitter->output_name);
+    if (worker->batches_works) {
+        zmsg_addstrf (work_message, "%zu", nb_works);
+        zmsg_addstrf (work_message, "%lld", (long long) worker->credit_timestamp);
+        worker->credit_timestamp = 0;
+    }
+    for (size_t i = 0; i < nb_works; i++) {
+        igs_queued_work_t *work = zlist_pop (works);
+        assert (work);
+        zmsg_addstrf (work_message, "%d", work->value_type);
+        s_split_add_work_value (work_message, work);
+        s_split_free_queued_work (&work);
+    }
+    return work_message;
+}
+
+// send the keyed works of one of our splitters to their workers and its
+// shared queued works to its best workers, as long as they have credits
+void s_split_trigger_splitter (igs_core_context_t *context, const char *key)
+{
+    assert(context);
+    assert(key);
+    igs_splitter_t *splitter = zhashx_lookup (context->splitters, key);
+    while (splitter) {
+        igs_worker_t *worker = zlistx_first (splitter->ready_workers);
+        zlist_t *works = (worker) ? worker->keyed_works : NULL;
+        if (!worker && splitter->workers_heap_size > 0
+            && splitter->workers_heap[0]->credit > 0
+            && zlist_size (splitter->queued_works) > 0) {
+            worker = splitter->workers_heap[0];
+            works = splitter->queued_works;
         }
-        splitter = zlist_next(splitters);
+        if (!worker)
+            break;
+        size_t nb_works = 1;
+        if (worker->batches_works) {
+            nb_works = zlist_size (works);
+            if (nb_works > (size_t) worker->credit)
+                nb_works = (size_t) worker->credit;
+            if (nb_works > IGS_SPLIT_MAX_BATCH)
+                nb_works = IGS_SPLIT_MAX_BATCH;
+        }
+        if (works != splitter->queued_works)
+            splitter->keyed_works -= nb_works;
+        zmsg_t *work_message = s_split_work_message (splitter, worker, works, nb_works);
+        igs_io_t *output = s_split_output (context, splitter);
+        if (output)
+            output->split_stats.dispatched += nb_works;
+        worker->uses += (int) nb_works;
+        worker->credit -= (int) nb_works;
+        s_split_heap_update (splitter, worker);
+        s_split_update_ready_worker (splitter, worker);
+        if (worker->ready_handle)
+            zlistx_move_end (splitter->ready_workers, worker->ready_handle); //round robin
+        core_signal_notify (&context->queue_room); //publishers blocked on a full queue
+
+        if (context->node) {
+            igsagent_t *local_agent = zhashx_lookup (context->agents, splitter->agent_uuid);
+            igs_remote_agent_t *remote_agent = zhashx_lookup (context->remote_agents, worker->agent_uuid);
+            if (local_agent && remote_agent) {
+                s_lock_zyre_peer(__FUNCTION__, __LINE__);
+                zyre_shouts (context->node, local_agent->igs_channel,
+                             "SPLIT %s(%s).%s to %s(%s).%s",
+                             local_agent->definition->name,
+                             splitter->agent_uuid,
+                             splitter->output_name,
+                             remote_agent->definition->name,
+                             worker->agent_uuid,
+                             worker->input_name);
+                s_unlock_zyre_peer(__FUNCTION__, __LINE__);
+            }
+        }
+        char *worker_uuid = strdup (worker->agent_uuid);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        igs_channel_whisper_zmsg (worker_uuid, &work_message);
+        free (worker_uuid);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        // our splitter may have been removed while we were unlocked
+        splitter = zhashx_lookup (context->splitters, key);
     }
-    zlist_destroy(&splitters);
 }
 
-void s_split_add_credit_to_worker (igs_core_context_t *context, char* agent_uuid, igs_io_t* output,
-                                   char* worker_uuid, char* input_name, int credit, bool is_new_worker)
+void s_split_trigger_send_message_to_worker (igs_core_context_t *context,
+                                             const char *agent_uuid,
+                                             const char *output_name)
+{
+    assert(context);
+    assert(agent_uuid);
+    assert(output_name);
+    char key[IGS_SPLIT_KEY_LENGTH] = "";
+    s_split_key (key, agent_uuid, output_name);
+    s_split_trigger_splitter (context, key);
+}
+
+void s_split_add_credit_to_worker (igs_core_context_t *context, const char *agent_uuid, const char *output_name,
+                                   const char *worker_uuid, const char *input_name, int credit,
+                                   int64_t credit_timestamp, bool is_new_worker)
 {
     assert(context);
     assert(agent_uuid);
+    assert(output_name);
     assert(worker_uuid);
     assert(input_name);
-    assert(output);
-    assert(output->name);
 
-    bool worker_found = false;
-    bool splitter_found = false;
-    igs_splitter_t *splitter = zlist_first(context->splitters);
-    while (splitter) {
-        if(streq(splitter->agent_uuid, agent_uuid)
-           && streq(splitter->output_name, output->name)){
-            int maxUses = 0;
-            igs_worker_t *worker = zlist_first(splitter->workers);
-            while (worker) {
-                if(streq(worker_uuid, worker->agent_uuid)
-                   && streq(input_name, worker->input_name)){
-                    worker->credit += credit;
-                    worker_found = true;
-                }
-                if (maxUses < worker->uses)
-                    maxUses = worker->uses;
-                worker = zlist_next(splitter->workers);
-            }
-            if(!worker_found && is_new_worker){
-                igs_worker_t *new_worker = (igs_worker_t *) zmalloc (sizeof(igs_worker_t));
-                new_worker->agent_uuid = s_strndup(worker_uuid, strlen(worker_uuid));
-                new_worker->input_name = s_strndup(input_name, strlen(input_name));
-                new_worker->credit = credit;
-                new_worker->uses = maxUses;
-                zlist_append(splitter->workers, new_worker);
-            }
-            splitter_found = true;
+    char key[IGS_SPLIT_KEY_LENGTH] = "";
+    s_split_key (key, agent_uuid, output_name);
+    igs_splitter_t *splitter = zhashx_lookup (context->splitters, key);
+    if (!splitter && is_new_worker) {
+        splitter = (igs_splitter_t *) zmalloc (sizeof (igs_splitter_t));
+        splitter->agent_uuid = s_strndup (agent_uuid, strlen (agent_uuid));
+        splitter->output_name = strdup (output_name);
+        splitter->workers = zhashx_new ();
+        splitter->queued_works = zlist_new ();
+        splitter->ready_workers = zlistx_new ();
+        zhashx_insert (context->splitters, key, splitter);
+    }
+    if (splitter) {
+        char worker_key[IGS_SPLIT_KEY_LENGTH] = "";
+        s_split_key (worker_key, worker_uuid, input_name);
+        igs_worker_t *worker = zhashx_lookup (splitter->workers, worker_key);
+        if (worker) {
+            worker->credit += credit;
+            worker->credit_timestamp = credit_timestamp;
+            s_split_heap_update (splitter, worker);
+            s_split_update_ready_worker (splitter, worker);
+        } else if (is_new_worker) {
+            // new workers start with the most uses to avoid being flooded
+            int max_uses = 0;
+            for (size_t i = 0; i < splitter->workers_heap_size; i++)
+                if (max_uses < splitter->workers_heap[i]->uses)
+                    max_uses = splitter->workers_heap[i]->uses;
+            worker = s_split_worker_new (worker_uuid, input_name, credit, max_uses);
+            igs_remote_agent_t *remote_agent = zhashx_lookup (context->remote_agents, worker_uuid);
+            worker->batches_works = (remote_agent && remote_agent->peer && remote_agent->peer->split_batches);
+            zhashx_insert (splitter->workers, worker_key, worker);
+            s_split_heap_insert (splitter, worker);
+            s_split_ring_rebuild (splitter);
         }
-        splitter = zlist_next(context->splitters);
     }
-    if(!splitter_found && is_new_worker){
-        igs_splitter_t *new_splitter = (igs_splitter_t *)zmalloc(sizeof(igs_splitter_t));
-        new_splitter->agent_uuid = s_strndup(agent_uuid, strlen(agent_uuid));
-        new_splitter->output_name = strdup(output->name);
-        new_splitter->workers = zlist_new();
-        new_splitter->queued_works = zlist_new();
-        zlist_append(context->splitters, new_splitter);
-        igs_worker_t *new_worker = (igs_worker_t *)zmalloc(sizeof(igs_worker_t));
-        new_worker->agent_uuid = s_strndup(worker_uuid, strlen(worker_uuid));
-        new_worker->input_name = s_strndup(input_name, strlen(input_name));
-        new_worker->credit = credit;
-        zlist_append(new_splitter->workers, new_worker);
+    s_split_trigger_send_message_to_worker (context, agent_uuid, output_name);
+    if (credit_timestamp) {
+        // the timestamp is only echoed with works sent immediately
+        splitter = zhashx_lookup (context->splitters, key);
+        char worker_key[IGS_SPLIT_KEY_LENGTH] = "";
+        s_split_key (worker_key, worker_uuid, input_name);
+        igs_worker_t *worker = (splitter) ? zhashx_lookup (splitter->workers, worker_key) : NULL;
+        if (worker)
+            worker->credit_timestamp = 0;
     }
-    s_split_trigger_send_message_to_worker(context, agent_uuid, output);
 }
 
+// split element of one of our agents receiving works from a splitter
+igs_split_t *s_split_element (igs_core_context_t *context, const char *worker_uuid,
+                              const char *splitter_uuid, const char *input_name, const char *output_name)
+{
+    igsagent_t *agent = zhashx_lookup (context->agents, worker_uuid);
+    igs_remote_agent_t *splitter_agent = zhashx_lookup (context->remote_agents, splitter_uuid);
+    if (!agent || !agent->mapping || !splitter_agent || !splitter_agent->definition)
+        return NULL;
+    igs_split_t *split = zlist_first (agent->mapping->split_elements);
+    while (split) {
+        if (streq (split->from_input, input_name)
+            && streq (split->to_output, output_name)
+            && streq (split->to_agent, splitter_agent->definition->name))
+            return split;
+        split = zlist_next (agent->mapping->split_elements);
+    }
+    return NULL;
+}
+
+// credits given back to a splitter after handling a batch of works: the
+// works themselves, adjusted by the change of our credit window
+int s_split_returned_credit (igs_split_t *split, size_t nb_works, int64_t echoed_timestamp,
+                             int64_t received, int64_t handled)
+{
+    assert (split);
+    assert (nb_works > 0);
+    int window = split->credit;
+    if (window <= 0) {
+        double processing_time = (double) (handled - received) / (double) nb_works;
+        split->processing_time = (split->processing_time > 0) ?
+            0.8 * split->processing_time + 0.2 * processing_time : processing_time;
+        if (echoed_timestamp > 0 && echoed_timestamp <= received) {
+            double round_trip = (double) (received - echoed_timestamp);
+            split->round_trip = (split->round_trip > 0) ?
+                0.8 * split->round_trip + 0.2 * round_trip : round_trip;
+        }
+        double processing = (split->processing_time > 1) ? split->processing_time : 1;
+        // works being processed plus works in flight during twice the round trip
+        double in_flight = 2 * split->round_trip / processing;
+        window = (in_flight >= IGS_SPLIT_MAX_WINDOW - 2) ? IGS_SPLIT_MAX_WINDOW : 2 + (int) in_flight;
+    }
+    int credit = (int) nb_works + window - split->window;
+    if (credit < 0)
+        credit = 0;
+    split->window += credit - (int) nb_works;
+    return credit;
+}
 
 ////////////////////////////////////////////////////////////////////////
 #pragma mark PRIVATE API
@@ -208,24 +632,18 @@ void split_free_splitter (igs_splitter_t **splitter)
         free((*splitter)->agent_uuid);
     if ((*splitter)->output_name)
         free((*splitter)->output_name);
-    igs_worker_t *worker = zlist_first((*splitter)->workers);
-    while (worker) {
-        if (worker->input_name)
-            free(worker->input_name);
-        if (worker->agent_uuid)
-            free(worker->agent_uuid);
-        free(worker);
-        worker = zlist_next((*splitter)->workers);
-    }
-    zlist_destroy(&(*splitter)->workers);
-    igs_queued_work_t *work = zlist_first((*splitter)->queued_works);
+    for (size_t i = 0; i < (*splitter)->workers_heap_size; i++)
+        s_split_worker_destroy (&((*splitter)->workers_heap[i]));
+    if ((*splitter)->workers_heap)
+        free ((*splitter)->workers_heap);
+    if ((*splitter)->ring)
+        free ((*splitter)->ring);
+    zhashx_destroy(&(*splitter)->workers);
+    zlistx_destroy(&(*splitter)->ready_workers);
+    igs_queued_work_t *work = zlist_pop((*splitter)->queued_works);
     while (work) {
-        if (work->value_type == IGS_STRING_T && work->value.s)
-            free(work->value.s);
-        else if (work->value_type == IGS_DATA_T && work->value.data)
-            free(work->value.data);
-        free(work);
-        work = zlist_next((*splitter)->queued_works);
+        s_split_free_queued_work (&work);
+        work = zlist_pop((*splitter)->queued_works);
     }
     zlist_destroy(&(*splitter)->queued_works);
     free(*splitter);
@@ -236,39 +654,56 @@ void split_remove_worker (igs_core_context_t *context, char *uuid, char *input_n
 {
     assert(uuid);
     assert(context);
-    igs_splitter_t *splitter = zlist_first(context->splitters);
+    zlist_t *emptied_splitters = zlist_new ();
+    zlist_t *removed_workers = zlist_new ();
+    zlist_t *moved_splitters = zlist_new ();
+    zlist_autofree (moved_splitters);
+    igs_splitter_t *splitter = zhashx_first(context->splitters);
     while (splitter) {
-        igs_worker_t *worker = zlist_first(splitter->workers);
+        for (size_t i = 0; i < splitter->workers_heap_size; i++) {
+            igs_worker_t *worker = splitter->workers_heap[i];
+            if (streq(uuid, worker->agent_uuid)
+                && (!input_name || streq(input_name, worker->input_name)))
+                zlist_append (removed_workers, worker);
+        }
+        bool has_moved_works = false;
+        igs_worker_t *worker = zlist_pop (removed_workers);
         while (worker) {
-            if (streq(uuid, worker->agent_uuid) &&
-                (!input_name || (input_name && streq(input_name, worker->input_name)))){
-                zlist_remove(splitter->workers, worker);
-                free(worker->agent_uuid);
-                free(worker->input_name);
-                free(worker);
-            }
-            worker = zlist_next(splitter->workers);
+            if (s_split_remove_worker_from_splitter (splitter, worker))
+                has_moved_works = true;
+            worker = zlist_pop (removed_workers);
         }
-        if(zlist_size(splitter->workers) == 0){
-            zlist_destroy(&splitter->workers);
-            zlist_remove(context->splitters, splitter);
-            free(splitter->agent_uuid);
-            free(splitter->output_name);
-            igs_queued_work_t *work_elt = zlist_first(splitter->queued_works);
-            while (work_elt) {
-                zlist_remove(splitter->queued_works, work_elt);
-                if(work_elt->value_type == IGS_DATA_T)
-                    free(work_elt->value.data);
-                else if(work_elt->value_type == IGS_STRING_T)
-                    free(work_elt->value.s);
-                free(work_elt);
-                work_elt = zlist_next(splitter->queued_works);
-            }
-            zlist_destroy(&splitter->queued_works);
-            free(splitter);
+        if (splitter->workers_heap_size == 0)
+            zlist_append (emptied_splitters, splitter);
+        else if (has_moved_works) {
+            char key[IGS_SPLIT_KEY_LENGTH] = "";
+            s_split_key (key, splitter->agent_uuid, splitter->output_name);
+            zlist_append (moved_splitters, key);
         }
-        splitter = zlist_next(context->splitters);
+        splitter = zhashx_next(context->splitters);
+    }
+    zlist_destroy (&removed_workers);
+    // splitters losing their last worker are destroyed with their pending works
+    splitter = zlist_pop (emptied_splitters);
+    while (splitter) {
+        char key[IGS_SPLIT_KEY_LENGTH] = "";
+        s_split_key (key, splitter->agent_uuid, splitter->output_name);
+        zhashx_delete (context->splitters, key);
+        igs_io_t *output = s_split_output (context, splitter);
+        if (output)
+            output->split_stats.dropped += s_split_pending_works (splitter);
+        split_free_splitter (&splitter);
+        core_signal_notify (&context->queue_room);
+        splitter = zlist_pop (emptied_splitters);
     }
+    zlist_destroy (&emptied_splitters);
+    // moved keyed works may be sent to their new workers right away
+    char *key = zlist_first (moved_splitters);
+    while (key) {
+        s_split_trigger_splitter (context, key);
+        key = zlist_next (moved_splitters);
+    }
+    zlist_destroy (&moved_splitters);
 }
 
 igs_split_t *split_create_split_element (const char *from_input,
@@ -285,54 +720,121 @@ igs_split_t *split_create_split_element (const char *from_input,
     return new_split_elmt;
 }
 
-void split_add_work_to_queue (igs_core_context_t *context, 
-                              char* agent_uuid,
-                              const igs_io_t *output)
+// wait for room in the queue of a splitter with the model unlocked, so
+// that credits can be received, and look up our output again: we sleep
+// until works are dispatched or splitters are removed
+igs_io_t *s_split_wait_for_room (igs_core_context_t *context, const char *key,
+                                 const char *agent_uuid, igs_io_t *output, size_t capacity)
+{
+    char *uuid = strdup (agent_uuid);
+    char *output_name = strdup (output->name);
+    output->split_stats.blocked++;
+    uint64_t count = core_signal_prepare (&context->queue_room);
+    igs_splitter_t *splitter = zhashx_lookup (context->splitters, key);
+    while (splitter && s_split_pending_works (splitter) >= capacity) {
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        core_signal_wait (&context->queue_room, count);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        count = core_signal_prepare (&context->queue_room);
+        splitter = zhashx_lookup (context->splitters, key);
+    }
+    core_signal_cancel (&context->queue_room);
+    igsagent_t *agent = zhashx_lookup (context->agents, uuid);
+    output = (agent && agent->definition) ? model_find_io_by_name (agent, output_name, IGS_OUTPUT_T) : NULL;
+    free (uuid);
+    free (output_name);
+    return output;
+}
+
+// drop the oldest work of a queue to make room for a new one
+bool s_split_drop_oldest_work (igs_splitter_t *splitter, zlist_t *works)
+{
+    igs_queued_work_t *oldest = zlist_pop (works);
+    if (!oldest)
+        return false;
+    if (works != splitter->queued_works)
+        splitter->keyed_works--;
+    s_split_free_queued_work (&oldest);
+    return true;
+}
+
+igs_io_t *split_add_work_to_queue (igs_core_context_t *context,
+                                   char* agent_uuid,
+                                   igs_io_t *output,
+                                   bool can_wait)
 {
     assert(context);
     assert(agent_uuid);
     assert(output);
     assert(output->name);
-    zlist_t *splitters = zlist_dup(context->splitters);
-    igs_splitter_t *splitter = zlist_first(splitters);
-    while (splitter) {
-        assert(splitter->workers);
-        if(streq(splitter->agent_uuid, agent_uuid)
-           && streq(splitter->output_name, output->name)){
-            igs_queued_work_t *new_work = (igs_queued_work_t *) zmalloc (sizeof(igs_queued_work_t));
-            new_work->value_size = output->value_size;
-            new_work->value_type = output->value_type;
-            switch (output->value_type) {
-                case IGS_INTEGER_T:
-                    new_work->value.i = output->value.i;
-                    break;
-                case IGS_DOUBLE_T:
-                    new_work->value.d = output->value.d;
-                    break;
-                case IGS_BOOL_T:
-                    new_work->value.b = output->value.b;
-                    break;
-                case IGS_STRING_T:
-                    new_work->value.s = strdup(output->value.s);
-                    break;
-                case IGS_IMPULSION_T:
-                    break;
-                case IGS_DATA_T:
-                    new_work->value.data = (void *)zmalloc( output->value_size);
-                    memcpy(new_work->value.data, output->value.data, output->value_size);
-                    break;
-                default:
-                    break;
+    if (zhashx_size(context->splitters) == 0)
+        return output; //spare the key formatting for each publication
+    char key[IGS_SPLIT_KEY_LENGTH];
+    s_split_key (key, agent_uuid, output->name);
+    igs_splitter_t *splitter = zhashx_lookup(context->splitters, key);
+    if (!splitter)
+        return output;
+    size_t capacity = (output->split_queue_capacity > 0) ? output->split_queue_capacity : IGS_SPLIT_DEFAULT_QUEUE_CAPACITY;
+    igs_split_queue_policy_t policy = output->split_queue_policy;
+    if (policy == IGS_SPLIT_QUEUE_BLOCK && (!can_wait || network_is_loop_thread()))
+        policy = IGS_SPLIT_QUEUE_CONFLATE; //the ingescape loop cannot wait for itself
+    if (policy == IGS_SPLIT_QUEUE_BLOCK && s_split_pending_works(splitter) >= capacity) {
+        output = s_split_wait_for_room(context, key, agent_uuid, output, capacity);
+        splitter = zhashx_lookup(context->splitters, key);
+        if (!output || !splitter)
+            return output;
+    }
+    output->split_stats.enqueued++;
+
+    uint64_t work_key = 0;
+    bool has_key = (output->split_mode != IGS_SPLIT_BALANCED && s_split_work_key(output, &work_key));
+    igs_worker_t *keyed_worker = (has_key) ? s_split_ring_worker(splitter, work_key) : NULL;
+    zlist_t *works = (keyed_worker) ? keyed_worker->keyed_works : splitter->queued_works;
+    if (s_split_pending_works(splitter) >= capacity) {
+        if (policy == IGS_SPLIT_QUEUE_DROP_NEWEST) {
+            output->split_stats.dropped++;
+            return output;
+        }
+        if (policy == IGS_SPLIT_QUEUE_CONFLATE) {
+            igs_queued_work_t *latest = NULL;
+            igs_queued_work_t *work = zlist_first(works);
+            while (work) {
+                if (work->has_key == has_key && work->key == work_key)
+                    latest = work;
+                work = zlist_next(works);
+            }
+            if (latest) {
+                s_split_work_set_value(latest, output);
+                output->split_stats.conflated++;
+                return output;
             }
-            zlist_append(splitter->queued_works, new_work);
         }
-        s_split_trigger_send_message_to_worker(context, agent_uuid, output);
-        splitter = zlist_next(splitters);
+        // the queue may be full of works for other workers
+        if (!s_split_drop_oldest_work(splitter, works)) {
+            output->split_stats.dropped++;
+            return output;
+        }
+        output->split_stats.dropped++;
     }
-    zlist_destroy(&splitters);
+
+    igs_queued_work_t *new_work = s_split_work_new();
+    s_split_work_set_value(new_work, output);
+    new_work->has_key = has_key;
+    new_work->key = work_key;
+    if (keyed_worker) {
+        zlist_append(keyed_worker->keyed_works, new_work);
+        splitter->keyed_works++;
+        s_split_update_ready_worker(splitter, keyed_worker);
+    } else
+        zlist_append(splitter->queued_works, new_work);
+    size_t pending = s_split_pending_works(splitter);
+    if (output->split_stats.max_pending < pending)
+        output->split_stats.max_pending = pending;
+    s_split_trigger_send_message_to_worker(context, agent_uuid, output->name);
+    return output;
 }
 
-int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *context)
+int split_message_from_worker (const char *command, zmsg_t *msg, igs_core_context_t *context)
 {
     assert(command);
     assert(context);
@@ -369,14 +871,8 @@ int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *c
         }
         igsagent_t *agent = zhashx_lookup(context->agents, agent_uuid);
         if (agent) {
-            igs_io_t *io = zhashx_first(agent->definition->outputs_table);
-            while (io) {
-                if (streq(outputName, io->name)){
-                    s_split_add_credit_to_worker(context, agent->uuid, io, worker_uuid, inputName, credit, true);
-                    break;
-                }
-                io = zhashx_next(agent->definition->outputs_table);
-            }
+            if (zhashx_lookup(agent->definition->outputs_table, outputName))
+                s_split_add_credit_to_worker(context, agent->uuid, outputName, worker_uuid, inputName, credit, 0, true);
         } else
             igs_error("%s is not a known UUID for our agents", agent_uuid);
         free(creditStr);
@@ -390,20 +886,32 @@ int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *c
             free(outputName);
             return 1;
         }
-        igsagent_t *agent = zhashx_first(context->agents);
-        while (agent) {
-            if(streq(agent_uuid, agent->uuid)){
-                igs_io_t *io = zhashx_first(agent->definition->outputs_table);
-                while (io) {
-                    if (streq(outputName, io->name)){
-                        s_split_add_credit_to_worker (context, agent->uuid, io, worker_uuid, inputName, 1, false);
-                        break;
-                    }
-                    io = zhashx_next(agent->definition->outputs_table);
-                }
-            }
-            agent = zhashx_next(context->agents);
+        igsagent_t *agent = zhashx_lookup(context->agents, agent_uuid);
+        if (agent && zhashx_lookup(agent->definition->outputs_table, outputName))
+            s_split_add_credit_to_worker (context, agent->uuid, outputName, worker_uuid, inputName, 1, 0, false);
+        free(agent_uuid);
+    }else if(streq(command, WORKER_CREDIT_MSG)){
+        char *creditStr = zmsg_popstr(msg);
+        char *timestampStr = zmsg_popstr(msg);
+        char *agent_uuid = zmsg_popstr(msg);
+        if(!creditStr || !timestampStr || !agent_uuid){
+            igs_error ("no valid credit or splitter uuid in message %s from worker %s : rejecting", command, worker_uuid);
+            free(creditStr);
+            free(timestampStr);
+            free(agent_uuid);
+            free(worker_uuid);
+            free(inputName);
+            free(outputName);
+            return 1;
         }
+        int credit = atoi(creditStr);
+        int64_t credit_timestamp = (int64_t) strtoll(timestampStr, NULL, 10);
+        igsagent_t *agent = zhashx_lookup(context->agents, agent_uuid);
+        if (credit >= 0 && agent && zhashx_lookup(agent->definition->outputs_table, outputName))
+            s_split_add_credit_to_worker (context, agent->uuid, outputName, worker_uuid, inputName,
+                                          credit, credit_timestamp, false);
+        free(creditStr);
+        free(timestampStr);
         free(agent_uuid);
     }else if(streq(command, WORKER_GOODBYE_MSG))
         split_remove_worker(context, worker_uuid, inputName);
@@ -413,10 +921,12 @@ int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *c
     return 0;
 }
 
-int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
+int split_message_from_splitter (const char *command, zmsg_t *msg, igs_core_context_t *context)
 {
+    assert(command);
     assert(msg);
     assert(context);
+    bool is_batch = streq(command, SPLITTER_WORKS_MSG);
     char * agent_uuid = zmsg_popstr(msg);
     if(!agent_uuid){
         igs_error ("no valid splitter uuid in work message from splitter : rejecting");
@@ -435,90 +945,74 @@ int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
         free(inputName);
         return 1;
     }
-    char * vType = zmsg_popstr(msg);
-    if(vType == NULL){
-        igs_error ("no valid value type in work message from splitter %s : rejecting", agent_uuid);
-        free(agent_uuid);
-        free(inputName);
-        free(outputName);
-        return 1;
+    size_t nb_works = 1;
+    int64_t echoed_timestamp = 0;
+    if (is_batch) {
+        char *count = zmsg_popstr(msg);
+        char *timestamp = zmsg_popstr(msg);
+        nb_works = (count) ? (size_t) strtoul(count, NULL, 10) : 0;
+        echoed_timestamp = (timestamp) ? (int64_t) strtoll(timestamp, NULL, 10) : 0;
+        free(count);
+        free(timestamp);
     }
-    igs_io_value_type_t valueType = atoi(vType);
-
-    free(vType);
-    vType = NULL;
-    if (valueType < IGS_INTEGER_T || valueType > IGS_DATA_T){
-        igs_error("input type is not valid (%d) in received publication : rejecting", valueType);
+    // works are followed by our worker uuid
+    char * worker_uuid = NULL;
+    if (nb_works > 0 && nb_works <= IGS_SPLIT_MAX_BATCH && zmsg_size(msg) == 2 * nb_works + 1)
+        worker_uuid = zframe_strdup(zmsg_last(msg));
+    if(!worker_uuid){
+        igs_error ("no valid works or worker uuid in work message from splitter %s : rejecting", agent_uuid);
         free(agent_uuid);
         free(inputName);
         free(outputName);
         return 1;
     }
 
-    zframe_t *frame = NULL;
-    void *data = NULL;
-    size_t size = 0;
-    char * value = NULL;
-    if (valueType == IGS_STRING_T){
-        value = zmsg_popstr(msg);
-        if (!value){
-            igs_error("value is NULL in received publication : rejecting");
-            free(agent_uuid);
-            free(inputName);
-            free(outputName);
-            return 1;
+    int64_t received = zclock_usecs();
+    for (size_t i = 0; i < nb_works; i++) {
+        char * vType = zmsg_popstr(msg);
+        igs_io_value_type_t valueType = (vType) ? atoi(vType) : 0;
+        free(vType);
+        zframe_t *frame = zmsg_pop(msg);
+        if (valueType < IGS_INTEGER_T || valueType > IGS_DATA_T){
+            igs_error("input type is not valid (%d) in received publication : rejecting", valueType);
+            zframe_destroy(&frame);
+            continue;
         }
-    }else{
-        frame = zmsg_pop(msg);
-        if (!frame){
-            igs_error("value is NULL in received publication : rejecting");
-            free(agent_uuid);
-            free(inputName);
-            free(outputName);
-            return 1;
-        }
-        data = zframe_data(frame);
-        size = zframe_size(frame);
-    }
-    
-    char * worker_uuid = zmsg_popstr(msg);
-    if(!worker_uuid){
-        igs_error ("no valid worker uuid in work message from splitter %s : rejecting", agent_uuid);
-        free(agent_uuid);
-        free(inputName);
-        free(outputName);
-        if (data)
-            free(data);
-        if (value)
-            free(value);
-        return 1;
-    }
-    
-    zlistx_t *agents = zhashx_values(context->agents);
-    igsagent_t *agent = zlistx_first(agents);
-    while (agent && agent->uuid) {
-        if (streq(agent->uuid, worker_uuid)){
+        // the agent may be removed while its callbacks are called
+        igsagent_t *agent = zhashx_lookup(context->agents, worker_uuid);
+        if (agent){
             igs_io_t *io = NULL;
-            if (valueType == IGS_STRING_T)
+            if (valueType == IGS_STRING_T){
+                char *value = zframe_strdup(frame);
                 io = model_write(agent, inputName, IGS_INPUT_T, valueType, value, strlen(value)+1);
-            else
-                io = model_write(agent, inputName, IGS_INPUT_T, valueType, data, size);
+                free(value);
+            }else
+                io = model_write(agent, inputName, IGS_INPUT_T, valueType, zframe_data(frame), zframe_size(frame));
             model_read_write_unlock(__FUNCTION__, __LINE__);
             if (io && io->name)
                 model_LOCKED_handle_io_callbacks(agent, io);
             model_read_write_lock(__FUNCTION__, __LINE__);
-            break;
         }
-        agent = zlistx_next(agents);
-    }
-    zlistx_destroy(&agents);
-    if(frame)
         zframe_destroy(&frame);
+    }
+
     zmsg_t *readyMessage = zmsg_new();
-    zmsg_addstr(readyMessage, WORKER_READY_MSG);
-    zmsg_addstr(readyMessage, worker_uuid);
-    zmsg_addstr(readyMessage, inputName);
-    zmsg_addstr(readyMessage, outputName);
+    if (is_batch) {
+        int64_t handled = zclock_usecs();
+        igs_split_t *split = s_split_element(context, worker_uuid, agent_uuid, inputName, outputName);
+        int credit = (split) ? s_split_returned_credit(split, nb_works, echoed_timestamp, received, handled) : (int) nb_works;
+        zmsg_addstr(readyMessage, WORKER_CREDIT_MSG);
+        zmsg_addstr(readyMessage, worker_uuid);
+        zmsg_addstr(readyMessage, inputName);
+        zmsg_addstr(readyMessage, outputName);
+        zmsg_addstrf(readyMessage, "%d", credit);
+        zmsg_addstrf(readyMessage, "%lld", (long long) handled);
+    } else {
+        zmsg_addstr(readyMessage, WORKER_READY_MSG);
+        zmsg_addstr(readyMessage, worker_uuid);
+        zmsg_addstr(readyMessage, inputName);
+        zmsg_addstr(readyMessage, outputName);
+    }
     model_read_write_unlock(__FUNCTION__, __LINE__);
     igs_channel_whisper_zmsg(agent_uuid, &readyMessage);
     model_read_write_lock(__FUNCTION__, __LINE__);
@@ -529,6 +1023,45 @@ int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
     return 0;
 }
 
+int split_hello_credit (igs_split_t *split)
+{
+    assert (split);
+    split->window = (split->credit > 0) ? split->credit : IGS_DEFAULT_WORKER_CREDIT;
+    return split->window;
+}
+
+void split_clear_output_key (igs_io_t *output)
+{
+    assert (output);
+    if (output->split_key_path) {
+        for (char **field = output->split_key_path; *field; field++)
+            free (*field);
+        free (output->split_key_path);
+        output->split_key_path = NULL;
+    }
+    if (output->split_key) {
+        free (output->split_key);
+        output->split_key = NULL;
+    }
+    output->split_key_offset = 0;
+    output->split_key_size = 0;
+    output->split_mode = IGS_SPLIT_BALANCED;
+}
+
+void split_free_work_pool (igs_core_context_t *context)
+{
+    assert (context);
+    for (size_t i = 0; i < context->split_work_pool_size; i++) {
+        if (context->split_work_pool[i]->buffer)
+            free (context->split_work_pool[i]->buffer);
+        free (context->split_work_pool[i]);
+    }
+    if (context->split_work_pool)
+        free (context->split_work_pool);
+    context->split_work_pool = NULL;
+    context->split_work_pool_size = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////
 #pragma mark PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -601,7 +1134,7 @@ uint64_t igsagent_split_add (igsagent_t *agent,
                 zmsg_addstr (ready_message, agent->uuid);
                 zmsg_addstr (ready_message, from_our_input);
                 zmsg_addstr (ready_message, with_output);
-                zmsg_addstrf (ready_message, "%i", IGS_DEFAULT_WORKER_CREDIT);
+                zmsg_addstrf (ready_message, "%i", split_hello_credit (new_split));
                 char *remote_uuid = strdup(remote->uuid);
                 model_read_write_unlock(__FUNCTION__, __LINE__);
                 igs_channel_whisper_zmsg (remote_uuid, &ready_message);
@@ -713,3 +1246,201 @@ igs_result_t igsagent_split_remove_with_name (igsagent_t *agent,
     }
     return IGS_SUCCESS;
 }
+
+igs_result_t igsagent_split_set_credit (igsagent_t *agent,
+                                        uint64_t the_id,
+                                        int credit)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (agent->mapping);
+    if (credit < 0 || credit > IGS_SPLIT_MAX_WINDOW) {
+        igsagent_error (agent, "credit must be between 0 (adaptive) and %d", IGS_SPLIT_MAX_WINDOW);
+        return IGS_FAILURE;
+    }
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_split_t *split = zlist_first(agent->mapping->split_elements);
+    while (split) {
+        if (split->id == the_id)
+            break;
+        split = zlist_next(agent->mapping->split_elements);
+    }
+    if (!split) {
+        igsagent_error (agent, "id %llu is not part of the current split", the_id);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    // the new window applies when we give credits back to the splitters
+    split->credit = credit;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+// output whose split mode is changed, with the model locked, or NULL
+igs_io_t *s_split_lock_output (igsagent_t *agent, const char *name)
+{
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_io_t *output = model_find_io_by_name (agent, name, IGS_OUTPUT_T);
+    if (output == NULL || output->type != IGS_OUTPUT_T) {
+        igsagent_error (agent, "Output '%s' not found", name);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return NULL;
+    }
+    return output;
+}
+
+igs_result_t igsagent_output_split_balanced (igsagent_t *agent, const char *name)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    igs_io_t *output = s_split_lock_output (agent, name);
+    if (!output)
+        return IGS_FAILURE;
+    split_clear_output_key (output);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_output_split_by_json_field (igsagent_t *agent, const char *name, const char *field_path)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    assert (field_path);
+    size_t nb_fields = 1;
+    for (const char *c = field_path; *c; c++)
+        if (*c == '/')
+            nb_fields++;
+    char **fields = (char **) zmalloc ((nb_fields + 1) * sizeof (char *));
+    size_t index = 0;
+    const char *field = field_path;
+    while (*field) {
+        const char *end = strchr (field, '/');
+        size_t length = (end) ? (size_t) (end - field) : strlen (field);
+        if (length > 0)
+            fields[index++] = s_strndup (field, length);
+        field += (end) ? length + 1 : length;
+    }
+    if (index == 0) {
+        free (fields);
+        igsagent_error (agent, "'%s' is not a valid JSON field path", field_path);
+        return IGS_FAILURE;
+    }
+    igs_io_t *output = s_split_lock_output (agent, name);
+    if (!output) {
+        for (size_t i = 0; i < index; i++)
+            free (fields[i]);
+        free (fields);
+        return IGS_FAILURE;
+    }
+    if (output->value_type != IGS_STRING_T)
+        igsagent_warn (agent, "output '%s' is not a string : its works will be balanced", name);
+    split_clear_output_key (output);
+    output->split_mode = IGS_SPLIT_BY_JSON_FIELD;
+    output->split_key_path = fields;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_output_split_by_data_range (igsagent_t *agent, const char *name, size_t offset, size_t size)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    if (size == 0) {
+        igsagent_error (agent, "split key range must not be empty");
+        return IGS_FAILURE;
+    }
+    igs_io_t *output = s_split_lock_output (agent, name);
+    if (!output)
+        return IGS_FAILURE;
+    if (output->value_type != IGS_DATA_T)
+        igsagent_warn (agent, "output '%s' is not a data : its works will be balanced", name);
+    split_clear_output_key (output);
+    output->split_mode = IGS_SPLIT_BY_DATA_RANGE;
+    output->split_key_offset = offset;
+    output->split_key_size = size;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_output_split_by_key (igsagent_t *agent, const char *name, const char *key)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    assert (key);
+    igs_io_t *output = s_split_lock_output (agent, name);
+    if (!output)
+        return IGS_FAILURE;
+    split_clear_output_key (output);
+    output->split_mode = IGS_SPLIT_BY_KEY;
+    output->split_key = strdup (key);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_split_mode_t igsagent_output_split_mode (igsagent_t *agent, const char *name)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_SPLIT_BALANCED;
+    assert (name);
+    model_read_lock(__FUNCTION__, __LINE__);
+    igs_io_t *output = model_find_io_by_name (agent, name, IGS_OUTPUT_T);
+    if (output == NULL || output->type != IGS_OUTPUT_T) {
+        igsagent_warn (agent, "Output '%s' not found", name);
+        model_read_unlock(__FUNCTION__, __LINE__);
+        return IGS_SPLIT_BALANCED;
+    }
+    igs_split_mode_t res = output->split_mode;
+    model_read_unlock(__FUNCTION__, __LINE__);
+    return res;
+}
+
+igs_result_t igsagent_output_set_split_queue (igsagent_t *agent, const char *name, size_t capacity,
+                                              igs_split_queue_policy_t policy)
+{
+    assert (agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    igs_io_t *output = s_split_lock_output (agent, name);
+    if (!output)
+        return IGS_FAILURE;
+    output->split_queue_capacity = capacity;
+    output->split_queue_policy = policy;
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_output_split_queue_stats (igsagent_t *agent, const char *name,
+                                                igs_split_queue_stats_t *stats)
+{
+    assert (agent);
+    assert (stats);
+    memset (stats, 0, sizeof (igs_split_queue_stats_t));
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    assert (name);
+    model_read_lock(__FUNCTION__, __LINE__);
+    igs_io_t *output = model_find_io_by_name (agent, name, IGS_OUTPUT_T);
+    if (output == NULL || output->type != IGS_OUTPUT_T) {
+        igsagent_error (agent, "Output '%s' not found", name);
+        model_read_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    *stats = output->split_stats;
+    char key[IGS_SPLIT_KEY_LENGTH] = "";
+    s_split_key (key, agent->uuid, name);
+    igs_splitter_t *splitter = (core_context->splitters) ? model_lookup (core_context->splitters, key) : NULL;
+    stats->pending = (splitter) ? s_split_pending_works (splitter) : 0;
+    model_read_unlock(__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
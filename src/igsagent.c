@@ -51,6 +51,7 @@ igsagent_t *igsagent_new (const char *name, bool activate_immediately)
     core_init_context ();
     model_read_write_lock(__FUNCTION__, __LINE__);
     igsagent_t *agent = (igsagent_t *) zmalloc (sizeof (igsagent_t));
+    IGS_ATOMIC_INIT (agent->pool_tasks, 0);
     zuuid_t *uuid = zuuid_new ();
     agent->uuid = strdup (zuuid_str (uuid));
     zuuid_destroy (&uuid);
@@ -76,11 +77,15 @@ void igsagent_destroy (igsagent_t **agent)
         igsagent_deactivate (*agent);
     if (!(*agent)->uuid)
         return;
+    service_cancel_pending_calls (*agent);
     
     model_read_write_lock(__FUNCTION__, __LINE__);
     zhashx_delete (core_context->created_agents, (*agent)->uuid);
     free ((*agent)->uuid);
     (*agent)->uuid = NULL;
+    // pending tasks of the callbacks thread pool, possibly including the
+    // caller, still reference the agent: the last of them frees it
+    bool is_freed_by_pool = (IGS_ATOMIC_LOAD ((*agent)->pool_tasks, IGS_MEMORY_ORDER_ACQUIRE) > 0);
     
     if ((*agent)->state)
         free ((*agent)->state);
@@ -117,7 +122,13 @@ void igsagent_destroy (igsagent_t **agent)
         mapping_free_mapping (&(*agent)->mapping);
     if ((*agent)->definition)
         definition_free_definition (&(*agent)->definition);
-    free (*agent);
+    model_free_io_handles (*agent);
+    if ((*agent)->output_batch)
+        zlist_destroy (&(*agent)->output_batch);
+    if (is_freed_by_pool)
+        (*agent)->is_freed_by_pool = true;
+    else
+        free (*agent);
     *agent = NULL;
     model_read_write_unlock(__FUNCTION__, __LINE__);
 }
@@ -140,6 +151,7 @@ igs_result_t igsagent_activate (igsagent_t *agent)
     agent->network_need_to_send_definition_update = true; // will also trigger mapping update
     agent->network_activation_during_runtime = true;
     zhashx_insert (core_context->agents, agent->uuid, agent);
+    mapping_index_update_agent(agent);
     
     if (agent->context && agent->context->node) {
         s_lock_zyre_peer (__FUNCTION__, __LINE__);
@@ -247,6 +259,8 @@ igs_result_t igsagent_deactivate (igsagent_t *agent)
     }
 
     zhashx_delete(core_context->agents, agent->uuid);
+    mapping_index_remove_agent(agent);
+    network_release_publication_caches(agent);
     agent->context = NULL;
     char *uuid = strdup(agent->uuid);
     char *name = strdup(agent->definition->name);
@@ -368,6 +382,64 @@ bool igsagent_rt_synchronous_mode(igsagent_t *agent){
     return agent->rt_synchronous_mode_enabled;
 }
 
+void igsagent_rt_set_keyframe_interval(igsagent_t *agent, unsigned int ticks){
+    assert(agent);
+    if (!agent->uuid)
+        return;
+    agent->rt_keyframe_interval = ticks;
+}
+
+unsigned int igsagent_rt_keyframe_interval(igsagent_t *agent){
+    assert(agent);
+    if (!agent->uuid)
+        return 0;
+    return agent->rt_keyframe_interval;
+}
+
+void igsagent_output_batch_begin(igsagent_t *agent){
+    assert(agent);
+    if (!agent->uuid)
+        return;
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (agent->output_batch)
+        igsagent_warn(agent, "a batch is already in progress");
+    else {
+        agent->output_batch = zlist_new();
+        zlist_autofree(agent->output_batch);
+    }
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+}
+
+igs_result_t igsagent_output_batch_commit(igsagent_t *agent){
+    assert(agent);
+    if (!agent->uuid)
+        return IGS_FAILURE;
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    if (!agent->output_batch){
+        igsagent_error(agent, "no batch in progress");
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    zlist_t *outputs = zlist_new();
+    char *name = zlist_first(agent->output_batch);
+    while (name) {
+        igs_io_t *io = (agent->definition) ? zhashx_lookup(agent->definition->outputs_table, name) : NULL;
+        //NB: outputs removed and created again during the batch may appear twice
+        if (io && io->is_in_batch){
+            io->is_in_batch = false;
+            zlist_append(outputs, io);
+        }
+        name = zlist_next(agent->output_batch);
+    }
+    zlist_destroy(&agent->output_batch);
+    igs_result_t res = IGS_SUCCESS;
+    if (zlist_size(outputs) > 0)
+        res = network_publish_outputs(agent, outputs);
+    zlist_destroy(&outputs);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    return res;
+}
+
 //DEPRECATED functions management for parameters
 igs_result_t igsagent_parameter_create(igsagent_t *self, const char *name,
                                   igs_iop_value_type_t value_type,
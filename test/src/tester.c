@@ -176,6 +176,38 @@ void testerServiceCallback(const char *senderAgentName, const char *senderAgentU
 
 //callbacks for channels
 size_t msgCountForAutoTests = 0;
+void testerPrivateCommandCallback(const char *peerID, const char *name, const char *command,
+                                  zmsg_t **msg_p, void *myCbData){
+    IGS_UNUSED(msg_p)
+    IGS_UNUSED(myCbData)
+    printf("private command %s received from %s(%s)\n", command, name, peerID);
+}
+
+void agentAsyncServiceCallback(igsagent_t *agent, const char *senderAgentName, const char *senderAgentUUID,
+                               const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                               const char *token, void* myCbData){
+    IGS_UNUSED(senderAgentName)
+    IGS_UNUSED(serviceName)
+    IGS_UNUSED(myCbData)
+    assert(nbArgs == 1);
+    igs_service_arg_t *reply = NULL;
+    igs_service_args_add_int(&reply, firstArgument->i + 1);
+    igsagent_service_call(agent, senderAgentUUID, "secondAsyncReply", &reply, token);
+}
+
+int asyncServiceReplyValue = 0;
+void agentAsyncServiceReplyCallback(igsagent_t *agent, const char *replierAgentName, const char *replierAgentUUID,
+                                    const char *replyName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                                    const char *token, igs_service_call_status_t status, void *myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(replierAgentUUID)
+    IGS_UNUSED(token)
+    IGS_UNUSED(myCbData)
+    assert(status == IGS_SERVICE_CALL_REPLIED);
+    assert(streq(replierAgentName, "secondAgent") && streq(replyName, "secondAsyncReply") && nbArgs == 1);
+    asyncServiceReplyValue = firstArgument->i;
+}
+
 void testerChannelCallback(const char *event, const char *peerID, const char *name,
                             const char *address, const char *channel,
                             zhash_t *headers, zmsg_t *msg, void *myCbData){
@@ -369,6 +401,33 @@ void testerIOCallback(igs_io_type_t ioType, const char* name, igs_io_value_type_
 
 
 // static tests function
+int poolCallbacksCount = 0;
+void poolIOCallback(igsagent_t *agent, igs_io_type_t ioType, const char* name, igs_io_value_type_t valueType,
+                    void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(ioType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(value)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    zclock_sleep(5);
+    poolCallbacksCount++;
+}
+
+int poolDestroyCount = 0;
+void poolDestroyCallback(igsagent_t *agent, igs_io_type_t ioType, const char* name, igs_io_value_type_t valueType,
+                         void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(ioType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(value)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    poolDestroyCount++;
+    igsagent_destroy(&agent);
+}
+
 void run_static_tests (int argc, const char * argv[]){
     igs_log_set_syslog(false);
     //agent name and uuid
@@ -489,6 +548,32 @@ void run_static_tests (int argc, const char * argv[]){
     logPath = igs_log_file_path();
     assert(strlen(logPath) > 0);
     free(logPath);
+    assert(!igs_log_async());
+    logPath = igs_log_file_path();
+    FILE *asyncLogFile = fopen(logPath, "r");
+    assert(asyncLogFile);
+    fseek(asyncLogFile, 0, SEEK_END);
+    long asyncLogStart = ftell(asyncLogFile);
+    igs_log_set_queue_capacity(64);
+    igs_log_set_async(true);
+    assert(igs_log_async());
+    for (int i = 0; i < 100; i++)
+        igs_debug("asynchronous log %d", i);
+    igs_info("asynchronous multi-line log \n second line");
+    igs_log_set_async(false);
+    assert(!igs_log_async());
+    //every asynchronous log is either written or dropped
+    size_t nbAsyncLogs = 0;
+    char logLine[2048] = "";
+    fseek(asyncLogFile, asyncLogStart, SEEK_SET);
+    while (fgets(logLine, 2048, asyncLogFile))
+        if (strstr(logLine, "asynchronous"))
+            nbAsyncLogs++;
+    fclose(asyncLogFile);
+    free(logPath);
+    logPath = NULL;
+    assert(nbAsyncLogs > 0);
+    assert(nbAsyncLogs + igs_log_dropped() == 101);
 
     //try to write uninitialized definition and mapping (generates errors)
     igs_definition_save();
@@ -562,6 +647,7 @@ void run_static_tests (int argc, const char * argv[]){
     assert(!igs_output_is_muted("toto"));
     igs_output_mute("toto");
     igs_output_unmute("toto");
+    assert(igs_input_set_conflated("toto", true) == IGS_FAILURE);
     assert(!igs_input_bool("toto"));
     assert(!igs_input_int("toto"));
     assert(igs_input_double("toto") < 0.000001);
@@ -609,6 +695,11 @@ void run_static_tests (int argc, const char * argv[]){
     assert(igs_output_is_muted("toto"));
     igs_output_unmute("toto");
     assert(!igs_output_is_muted("toto"));
+    assert(!igs_input_is_conflated("toto"));
+    assert(igs_input_set_conflated("toto", true) == IGS_SUCCESS);
+    assert(igs_input_is_conflated("toto"));
+    assert(igs_input_set_conflated("toto", false) == IGS_SUCCESS);
+    assert(!igs_input_is_conflated("toto"));
     assert(igs_input_remove("toto") == IGS_SUCCESS);
     assert(igs_output_remove("toto") == IGS_SUCCESS);
     assert(igs_attribute_remove("toto") == IGS_SUCCESS);
@@ -677,6 +768,19 @@ void run_static_tests (int argc, const char * argv[]){
     igs_input_data("my double", &data, &dataSize);//intentional memory leak here
     assert(data && *(double *)data - 2  < 0.000001 && dataSize == sizeof(double));
     assert(igs_input_double("my double") - 2 < 0.000001);
+    assert(igs_input_handle("toto") == NULL);
+    igs_io_handle_t *int_handle = igs_input_handle("my int");
+    assert(int_handle && int_handle == igs_input_handle("my int"));
+    assert(igs_io_handle_type(int_handle) == IGS_INTEGER_T);
+    assert(igs_io_handle_int(int_handle) == 2);
+    assert(igs_io_handle_bool(int_handle));
+    assert(igs_input_set_int("my int", 3) == IGS_SUCCESS);
+    assert(igs_io_handle_int(int_handle) == 3);
+    assert(igs_io_handle_double(int_handle) - 3 < 0.000001);
+    assert(igs_input_set_int("my int", 2) == IGS_SUCCESS);
+    igs_io_handle_t *double_handle = igs_input_handle("my double");
+    assert(igs_io_handle_type(double_handle) == IGS_DOUBLE_T);
+    assert(igs_io_handle_double(double_handle) - 2 < 0.000001);
     assert(igs_input_set_string("", "new string") == IGS_FAILURE);
     assert(igs_input_set_string("my string", "new string") == IGS_SUCCESS);
     igs_input_data("my string", &data, &dataSize);//intentional memory leak here
@@ -694,7 +798,13 @@ void run_static_tests (int argc, const char * argv[]){
     free(data);
     data = NULL;
     dataSize = 0;
+    igs_data_t *dataRef = igs_input_data_ref("my data");
+    assert(dataRef && igs_data_size(dataRef) == 64 && memcmp(igs_data_bytes(dataRef), myOtherData, 64) == 0);
     igs_clear_input("my data");
+    assert(igs_data_size(dataRef) == 64 && memcmp(igs_data_bytes(dataRef), myOtherData, 64) == 0);
+    igs_data_unref(&dataRef);
+    assert(dataRef == NULL);
+    assert(igs_input_data_ref("toto") == NULL);
     data = NULL;
     dataSize = 0;
     assert(igs_input_data("my data", &data, &dataSize) == IGS_SUCCESS);
@@ -731,6 +841,22 @@ void run_static_tests (int argc, const char * argv[]){
     assert(igs_output_exists("my string"));
     assert(igs_output_type("my data") == IGS_DATA_T);
     assert(igs_output_exists("my data"));
+    assert(igs_output_split_mode("my string") == IGS_SPLIT_BALANCED);
+    assert(igs_output_split_by_json_field("my string", "track/id") == IGS_SUCCESS);
+    assert(igs_output_split_mode("my string") == IGS_SPLIT_BY_JSON_FIELD);
+    assert(igs_output_split_by_json_field("my string", "/") == IGS_FAILURE);
+    assert(igs_output_split_by_data_range("my data", 0, 4) == IGS_SUCCESS);
+    assert(igs_output_split_by_data_range("my data", 0, 0) == IGS_FAILURE);
+    assert(igs_output_split_mode("my data") == IGS_SPLIT_BY_DATA_RANGE);
+    assert(igs_output_split_by_key("my int", "session") == IGS_SUCCESS);
+    assert(igs_output_split_by_key("unknown", "session") == IGS_FAILURE);
+    assert(igs_output_split_balanced("my int") == IGS_SUCCESS);
+    assert(igs_output_split_mode("my int") == IGS_SPLIT_BALANCED);
+    assert(igs_output_set_split_queue("my int", 16, IGS_SPLIT_QUEUE_DROP_NEWEST) == IGS_SUCCESS);
+    assert(igs_output_set_split_queue("unknown", 16, IGS_SPLIT_QUEUE_BLOCK) == IGS_FAILURE);
+    igs_split_queue_stats_t splitStats;
+    assert(igs_output_split_queue_stats("my int", &splitStats) == IGS_SUCCESS);
+    assert(splitStats.enqueued == 0 && splitStats.pending == 0);
     assert(igs_output_bool("my bool"));
     assert(igs_output_int("my int") == 1);
     assert(igs_output_double("my double") - 1.0 < 0.000001);
@@ -768,11 +894,48 @@ void run_static_tests (int argc, const char * argv[]){
     free(data);
     data = NULL;
     dataSize = 0;
+    assert(igs_output_set_data_owned("", myOtherData, 64, NULL, NULL) == IGS_FAILURE);
+    assert(igs_output_set_data_owned("my data", myOtherData, 64, NULL, NULL) == IGS_SUCCESS);
+    assert(igs_output_data("my data", &data, &dataSize) == IGS_SUCCESS);
+    assert(dataSize == 64 && memcmp(data, myOtherData, dataSize) == 0);
+    free(data);
+    data = NULL;
+    dataSize = 0;
     igs_clear_output("my data");
     data = NULL;
     dataSize = 0;
     assert(igs_output_data("my data", &data, &dataSize) == IGS_SUCCESS);
     assert(dataSize == 0 && data == NULL);
+    igs_output_batch_begin();
+    assert(igs_output_set_int("my int", 3) == IGS_SUCCESS);
+    assert(igs_output_set_int("my int", 4) == IGS_SUCCESS);
+    assert(igs_output_set_double("my double", 3) == IGS_SUCCESS);
+    assert(igs_output_int("my int") == 4);
+    assert(igs_output_batch_commit() == IGS_SUCCESS);
+    assert(igs_output_batch_commit() == IGS_FAILURE);
+    assert(igs_callbacks_thread_pool() == 0);
+    igs_set_callbacks_thread_pool(2);
+    assert(igs_callbacks_thread_pool() == 2);
+    //agents are not freed while their pooled callbacks are pending
+    igsagent_t *poolAgent = igsagent_new("poolAgent", true);
+    igsagent_input_create(poolAgent, "pool_int", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(poolAgent, "pool_int", poolIOCallback, NULL);
+    for (int i = 0; i < 10; i++)
+        igsagent_input_set_int(poolAgent, "pool_int", i);
+    igsagent_destroy(&poolAgent);
+    assert(poolAgent == NULL);
+    assert(poolCallbacksCount <= 10);
+    //agents destroyed by their own pooled callbacks are freed by their last task
+    igs_set_callbacks_thread_pool(1);
+    poolAgent = igsagent_new("poolAgent", true);
+    igsagent_input_create(poolAgent, "pool_int", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(poolAgent, "pool_int", poolDestroyCallback, NULL);
+    igsagent_input_set_int(poolAgent, "pool_int", 1);
+    igsagent_input_set_int(poolAgent, "pool_int", 2);
+    poolAgent = NULL;
+    igs_set_callbacks_thread_pool(0);
+    assert(poolDestroyCount == 1);
+    assert(igs_callbacks_thread_pool() == 0);
 
 
     //parameters
@@ -1046,6 +1209,92 @@ void run_static_tests (int argc, const char * argv[]){
     assert(igs_attribute_data("my data", &data, &dataSize) == IGS_SUCCESS);
     assert(dataSize == 0 && data == NULL);
     free(data);
+
+    //remote definitions with the same JSON are parsed once and shared
+    char *remoteDefJson = igs_definition_json();
+    model_read_write_lock(__FUNCTION__, __LINE__);
+    igs_definition_t *remoteDef1 = definition_load_remote(remoteDefJson);
+    igs_definition_t *remoteDef2 = definition_load_remote(remoteDefJson);
+    igs_definition_t *remoteDef3 = definition_load_remote(remoteDefJson);
+    assert(remoteDef1 && remoteDef1->cache_key);
+    assert(remoteDef2 == remoteDef1 && remoteDef3 == remoteDef1);
+    definition_release_remote(&remoteDef1);
+    assert(remoteDef1 == NULL);
+    assert(remoteDef2->name && zhashx_size(remoteDef2->inputs_table) == 6);
+    definition_make_private(&remoteDef3);
+    assert(remoteDef3 && remoteDef3 != remoteDef2 && !remoteDef3->cache_key);
+    assert(remoteDef2->cache_key);
+    if (remoteDef3->description)
+        free(remoteDef3->description);
+    remoteDef3->description = strdup("private description");
+    assert(!remoteDef2->description || !streq(remoteDef2->description, "private description"));
+    assert(zhashx_size(remoteDef2->inputs_table) == 6);
+    remoteDef1 = definition_load_remote(remoteDefJson);
+    assert(remoteDef1 == remoteDef2);
+    definition_release_remote(&remoteDef1);
+    definition_release_remote(&remoteDef2);
+    assert(zhashx_size(core_context->remote_definitions) == 0);
+    definition_release_remote(&remoteDef3);
+    assert(remoteDef3 == NULL);
+
+    //definition and mapping deltas apply on the version we know, snapshots
+    //being needed after a version gap
+    igs_remote_agent_t *deltaAgent = (igs_remote_agent_t *) zmalloc(sizeof(igs_remote_agent_t));
+    deltaAgent->uuid = strdup("delta agent uuid");
+    deltaAgent->definition = definition_load_remote(remoteDefJson);
+    deltaAgent->definition_version = 3;
+    zmsg_t *deltaMsg = zmsg_new();
+    zmsg_addstr(deltaMsg, "+");
+    zmsg_addstrf(deltaMsg, "%d", IGS_INPUT_T);
+    zmsg_addstr(deltaMsg, "delta input");
+    zmsg_addstrf(deltaMsg, "%d", IGS_INTEGER_T);
+    zmsg_addstr(deltaMsg, "-");
+    zmsg_addstrf(deltaMsg, "%d", IGS_OUTPUT_T);
+    zmsg_addstr(deltaMsg, "my int");
+    assert(network_apply_definition_delta(deltaAgent, "3", "4", deltaMsg) == IGS_SUCCESS);
+    zmsg_destroy(&deltaMsg);
+    assert(deltaAgent->definition_version == 4);
+    assert(!deltaAgent->definition->cache_key); //made private before modification
+    assert(zhashx_size(deltaAgent->definition->inputs_table) == 7);
+    assert(zhashx_lookup(deltaAgent->definition->inputs_table, "delta input"));
+    assert(zhashx_size(deltaAgent->definition->outputs_table) == 5);
+    assert(strstr(deltaAgent->definition->json, "delta input"));
+    deltaMsg = zmsg_new();
+    zmsg_addstr(deltaMsg, "+");
+    zmsg_addstrf(deltaMsg, "%d", IGS_INPUT_T);
+    zmsg_addstr(deltaMsg, "gap input");
+    zmsg_addstrf(deltaMsg, "%d", IGS_INTEGER_T);
+    assert(network_apply_definition_delta(deltaAgent, "5", "6", deltaMsg) == IGS_FAILURE);
+    zmsg_destroy(&deltaMsg);
+    assert(deltaAgent->definition_version == 4);
+    assert(!zhashx_lookup(deltaAgent->definition->inputs_table, "gap input"));
+    deltaMsg = zmsg_new();
+    zmsg_addstr(deltaMsg, "+");
+    zmsg_addstr(deltaMsg, "my int");
+    zmsg_addstr(deltaMsg, "other_agent");
+    zmsg_addstr(deltaMsg, "tata");
+    assert(network_apply_mapping_delta(deltaAgent, "0", "1", deltaMsg) == IGS_SUCCESS);
+    zmsg_destroy(&deltaMsg);
+    assert(deltaAgent->mapping_version == 1);
+    assert(deltaAgent->mapping && zlist_size(deltaAgent->mapping->map_elements) == 1);
+    deltaMsg = zmsg_new();
+    zmsg_addstr(deltaMsg, "-");
+    zmsg_addstr(deltaMsg, "my int");
+    zmsg_addstr(deltaMsg, "other_agent");
+    zmsg_addstr(deltaMsg, "tata");
+    assert(network_apply_mapping_delta(deltaAgent, "2", "3", deltaMsg) == IGS_FAILURE);
+    assert(deltaAgent->mapping_version == 1);
+    assert(zlist_size(deltaAgent->mapping->map_elements) == 1);
+    assert(network_apply_mapping_delta(deltaAgent, "1", "2", deltaMsg) == IGS_SUCCESS);
+    zmsg_destroy(&deltaMsg);
+    assert(deltaAgent->mapping_version == 2);
+    assert(zlist_size(deltaAgent->mapping->map_elements) == 0);
+    definition_release_remote(&deltaAgent->definition);
+    mapping_free_mapping(&deltaAgent->mapping);
+    free(deltaAgent->uuid);
+    free(deltaAgent);
+    model_read_write_unlock(__FUNCTION__, __LINE__);
+    free(remoteDefJson);
     igs_clear_definition();
 
 
@@ -1088,6 +1337,10 @@ void run_static_tests (int argc, const char * argv[]){
     uint64_t splitId = igs_split_add("toto", "other_agent", "tata");
     assert(splitId > 0);
     assert(igs_split_count() == 1);
+    assert(igs_split_set_credit(splitId, 16) == IGS_SUCCESS);
+    assert(igs_split_set_credit(splitId, 0) == IGS_SUCCESS);
+    assert(igs_split_set_credit(splitId, -1) == IGS_FAILURE);
+    assert(igs_split_set_credit(12345, 16) == IGS_FAILURE);
     assert(igs_split_remove_with_id(12345) == IGS_FAILURE);
     assert(igs_split_remove_with_id(splitId) == IGS_SUCCESS);
     assert(igs_split_count() == 0);
@@ -1511,6 +1764,23 @@ void run_static_tests (int argc, const char * argv[]){
     assert(igs_channel_join("toto") == IGS_FAILURE);
     igs_channel_leave("toto");
     assert(igs_peer_add_header("new key", "toto") == IGS_SUCCESS);
+    assert(igs_private_command_init("PING", testerPrivateCommandCallback, NULL) == IGS_FAILURE);
+    assert(igs_private_command_init("", testerPrivateCommandCallback, NULL) == IGS_FAILURE);
+    assert(igs_private_command_init("TESTER_COMMAND", testerPrivateCommandCallback, NULL) == IGS_SUCCESS);
+    assert(igs_private_command_init("TESTER_COMMAND", testerPrivateCommandCallback, NULL) == IGS_FAILURE);
+    assert(igs_private_command_remove("TESTER_COMMAND") == IGS_SUCCESS);
+    assert(igs_private_command_remove("TESTER_COMMAND") == IGS_FAILURE);
+    igs_local_queue_set_policy(IGS_LOCAL_QUEUE_BLOCK);
+    igs_local_queue_stats_t queueStats;
+    igs_local_queue_stats(&queueStats);
+    assert(queueStats.published == 0 && queueStats.pending == 0 && queueStats.dropped == 0);
+#if defined (__UNIX__)
+    assert(!igs_has_shm());
+    igs_set_shm(true);
+    assert(igs_has_shm());
+    igs_set_shm_size(16 * 1024 * 1024);
+    igs_set_shm_threshold(32 * 1024);
+#endif
 
 
     //prepare agent for dynamic tests by adding proper complete definitions
@@ -1922,6 +2192,17 @@ void run_static_tests (int argc, const char * argv[]){
     igs_service_args_add_data(&list, data, dataSize);
     igsagent_service_call(firstAgent, "secondAgent", "secondService", &list, "token");
 
+    //test asynchronous service in the same process
+    igsagent_service_init(secondAgent, "secondAsyncService", agentAsyncServiceCallback, NULL);
+    igsagent_service_arg_add(secondAgent, "secondAsyncService", "value", IGS_INTEGER_T);
+    list = NULL;
+    igs_service_args_add_int(&list, 41);
+    char *asyncToken = igsagent_service_call_async(firstAgent, "secondAgent", "secondAsyncService", &list, 1000,
+                                                   agentAsyncServiceReplyCallback, NULL);
+    assert(asyncToken && asyncServiceReplyValue == 42);
+    assert(igsagent_service_call_cancel(firstAgent, asyncToken) == IGS_FAILURE);
+    free(asyncToken);
+
     //test agent events in same process
     igsagent_deactivate(secondAgent);
     igsagent_deactivate(firstAgent);
@@ -2117,6 +2398,7 @@ int main(int argc, const char * argv[]) {
     //log stream --info --debug --predicate 'sender == "ingescape"' --style syslog
     igs_log_include_data(true);
     igs_log_include_services(true);
+    igs_log_shout_services(true);
     igs_log_set_syslog(false);
 
     if (staticTests){
@@ -2242,6 +2524,7 @@ int main(int argc, const char * argv[]) {
         assert(igs_start_with_brokers(buffer) == IGS_SUCCESS);
     } else {
         //start/stop stress tests
+        igs_local_queue_set_capacity(16);
         igs_start_with_device(networkDevice, port);
 //    igs_start_with_device(networkDevice, port);
 //    igs_stop();
@@ -2249,6 +2532,68 @@ int main(int argc, const char * argv[]) {
 //    igs_stop();
 
         igs_start_with_device(networkDevice, port);
+
+        //saturation of the local queue must not block publishers
+        char saturationOutput[IGS_MAX_IO_NAME_LENGTH] = "";
+        for (int i = 0; i < 100; i++){
+            snprintf(saturationOutput, IGS_MAX_IO_NAME_LENGTH, "saturation_%d", i);
+            igs_output_create(saturationOutput, IGS_INTEGER_T, &i, sizeof(int));
+        }
+        igs_output_batch_begin();
+        for (int i = 0; i < 100; i++){
+            snprintf(saturationOutput, IGS_MAX_IO_NAME_LENGTH, "saturation_%d", i);
+            igs_output_set_int(saturationOutput, i + 1);
+        }
+        assert(igs_output_batch_commit() == IGS_SUCCESS);
+        for (int i = 0; i < 200; i++)
+            igs_output_set_int("saturation_0", i);
+        for (int i = 0; i < 100; i++){
+            snprintf(saturationOutput, IGS_MAX_IO_NAME_LENGTH, "saturation_%d", i);
+            igs_output_remove(saturationOutput);
+        }
+
+        //outputs sharing a compact topic: only the topic owner uses compact publications
+        int topicValue = 0;
+        igs_output_create("ab", IGS_INTEGER_T, &topicValue, sizeof(int));
+        igs_output_create("bA", IGS_INTEGER_T, &topicValue, sizeof(int));
+        uint64_t topic = network_publication_topic(core_agent->uuid, "bA");
+        assert(network_publication_topic(core_agent->uuid, "ab") != topic);
+        igs_output_set_int("ab", 1);
+        igs_io_t *topicOwner = model_find_io_by_name(core_agent, "ab", IGS_OUTPUT_T);
+        igs_io_t *topicOutput = model_find_io_by_name(core_agent, "bA", IGS_OUTPUT_T);
+        assert(topicOwner->publication_cache && topicOwner->publication_cache->is_topic_owner);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        zhashx_insert(core_context->published_topics, &topic, topicOwner->publication_cache);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        igs_output_set_int("bA", 1);
+        assert(topicOutput->publication_cache && !topicOutput->publication_cache->is_topic_owner);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        zhashx_delete(core_context->published_topics, &topic);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        igs_output_set_int("bA", 2);
+        assert(topicOutput->publication_cache->is_topic_owner);
+        model_read_write_lock(__FUNCTION__, __LINE__);
+        network_update_colliding_topics(core_context);
+        model_read_write_unlock(__FUNCTION__, __LINE__);
+        assert(!topicOwner->has_colliding_topic && !topicOutput->has_colliding_topic);
+        igs_output_remove("ab");
+        igs_output_remove("bA");
+
+        //outputs are only marked for the next tick in synchronous mode
+        int dirtyValue = 0;
+        bool timestamps = igs_rt_timestamps();
+        igs_output_create("dirty", IGS_INTEGER_T, &dirtyValue, sizeof(int));
+        igs_io_t *dirtyOutput = model_find_io_by_name(core_agent, "dirty", IGS_OUTPUT_T);
+        igs_output_set_int("dirty", 1);
+        assert(!dirtyOutput->is_dirty);
+        igs_rt_set_synchronous_mode(true);
+        igs_output_set_int("dirty", 2);
+        assert(dirtyOutput->is_dirty);
+        igs_rt_set_time(zclock_mono()*1000);
+        assert(!dirtyOutput->is_dirty);
+        igs_rt_set_synchronous_mode(false);
+        igs_rt_set_timestamps(timestamps);
+        igs_output_remove("dirty");
     }
 
     //mainloop management (two modes)